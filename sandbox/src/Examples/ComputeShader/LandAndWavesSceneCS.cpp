@@ -7,13 +7,14 @@ namespace sandbox
 {
 LandAndWavesSceneCS::LandAndWavesSceneCS(std::shared_ptr<DeviceResources> deviceResources) :
 	m_deviceResources(deviceResources),
+	m_generatedTextures(deviceResources),
 	m_mainRenderPass()
 {
 	PROFILE_SCOPE("LandAndWavesSceneCS()");
 
 	Engine::Init(m_deviceResources);
 	DescriptorManager::Init(m_deviceResources);
-	TextureManager::Init(m_deviceResources);
+	TextureManager::Init(m_deviceResources, "texture-index.txt"); // Remembers texture hashes between runs
 
 
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Reset(m_deviceResources->GetCommandAllocator(), nullptr));
@@ -24,9 +25,12 @@ LandAndWavesSceneCS::LandAndWavesSceneCS(std::shared_ptr<DeviceResources> device
 	m_gpuWaves = std::make_unique<GPUWaves>(m_deviceResources, 256, 256, 0.25f, 0.03f, 2.0f, 0.2f);
 
 	LoadTextures();
+	BuildGeneratedTextures();
 	BuildLandAndWaterScene();
 
-	// Execute the initialization commands.
+	// Submit the mesh/texture uploads that were staged while building the scene (the direct queue waits for them
+	// on the GPU), then execute the initialization commands.
+	Engine::SubmitPendingUploads();
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Close());
 	ID3D12CommandList* cmdsLists[] = { m_deviceResources->GetCommandList() };
 	m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
@@ -57,9 +61,44 @@ void LandAndWavesSceneCS::LoadTextures()
 {
 	PROFILE_FUNCTION();
 
+	// Read every file in parallel and upload them in one batch. GetTexture() then just takes a reference
+	TextureManager::PreloadAll();
 	for (int iii = 0; iii < (int)TEXTURE::Count; ++iii)
 		m_textures[iii] = TextureManager::GetTexture(iii);
 }
+void LandAndWavesSceneCS::BuildGeneratedTextures()
+{
+	PROFILE_FUNCTION();
+
+	// Checkerboard: imported from pixels, which builds the mip chain and compresses every mip to BC1 on the CPU
+	constexpr UINT checkerSize = 128;
+	std::vector<std::uint32_t> checkerPixels(checkerSize * checkerSize);
+	for (UINT y = 0; y < checkerSize; ++y)
+	{
+		for (UINT x = 0; x < checkerSize; ++x)
+			checkerPixels[y * checkerSize + x] = ((x / 16 + y / 16) % 2 == 0) ? 0xFFE0E0E0 : 0xFFA05030; // 0xAABBGGRR
+	}
+
+	TextureVector::ImportOptions importOptions;
+	importOptions.Compression = DXGI_FORMAT_BC1_UNORM;
+	m_checkerTexture = m_generatedTextures.EmplaceBackFromPixels(DXGI_FORMAT_R8G8B8A8_UNORM, checkerSize, checkerSize,
+		checkerPixels.data(), checkerSize * sizeof(std::uint32_t), importOptions);
+
+	// Fence pattern: mip 0 is drawn by FencePatternCS every frame (see the 'Fence Pattern' compute layer) and the rest
+	// of the chain is generated from it on the GPU. That needs typed UAV loads for R8G8B8A8_UNORM, so devices without
+	// them only get mip 0
+	const UINT16 fenceMips = Engine::SupportsGPUMipGeneration(DXGI_FORMAT_R8G8B8A8_UNORM) ? FenceTextureMips : 1;
+	if (fenceMips == 1)
+		LOG_WARN("{}", "R8G8B8A8_UNORM does not support typed UAV loads on this device, so the fence texture will not have mips");
+
+	CD3DX12_RESOURCE_DESC fenceDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, FenceTextureSize, FenceTextureSize,
+		1, fenceMips, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+	m_fenceTexture = m_generatedTextures.EmplaceBack(fenceDesc, true, true);
+
+	// Creates the per-mip UAVs now rather than in the middle of the first frame. Nothing has been drawn into mip 0
+	// yet, but the whole chain is rewritten before anything reads it
+	m_fenceTexture->GenerateMips();
+}
 void LandAndWavesSceneCS::BuildLandAndWaterScene()
 {
 	PROFILE_FUNCTION();
@@ -69,7 +108,7 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	m_mainRenderPass.RenderPassLayers.reserve(3);
 
 	// Compute Layer: Update ---------------------------------------------------------------------------------
-	m_mainRenderPass.ComputeLayers.reserve(1);
+	m_mainRenderPass.ComputeLayers.reserve(2);
 	ComputeLayer& computeLayer = m_mainRenderPass.ComputeLayers.emplace_back(m_deviceResources);
 	computeLayer.Name = "Compute Layer: Update";
 
@@ -151,14 +190,14 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 		dt->DescriptorHandle = m_gpuWaves->NextSol()->GetUAVHandle();
 	};
 
-	computeLayer.PreWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList*, const Timer*, int) -> bool
+	computeLayer.PreWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList* commandList, const Timer*, int) -> bool
 	{
-		m_gpuWaves->PreUpdate();
+		m_gpuWaves->PreUpdate(commandList);
 		return true;
 	};
-	computeLayer.PostWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList*, const Timer*, int) 
+	computeLayer.PostWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList* commandList, const Timer*, int) 
 	{
-		m_gpuWaves->PostUpdate();
+		m_gpuWaves->PostUpdate(commandList);
 	};
 
 
@@ -212,7 +251,7 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 		dt->DescriptorHandle = m_gpuWaves->NextSol()->GetUAVHandle();
 	};
 
-	m_wavesComputeLayerDisturb->PreWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList*, const Timer* timer, int frameIndex) -> bool
+	m_wavesComputeLayerDisturb->PreWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList* commandList, const Timer* timer, int frameIndex) -> bool
 	{
 		// Every quarter second, generate a random wave.
 		static float t_base = 0.0f;
@@ -222,7 +261,7 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 		{
 			t_base += 0.25f;
 
-			m_gpuWaves->PreUpdate(); // Call PreUpdate to tansition the texture to UAV
+			m_gpuWaves->PreUpdate(commandList); // Call PreUpdate to tansition the texture to UAV
 
 			WavesUpdateSettings settings;
 			settings.WaveConstant0 = m_gpuWaves->WaveConstant(0);
@@ -249,6 +288,68 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	};
 
 
+	// Compute Layer: Fence Pattern ---------------------------------------------------------------------------------
+	ComputeLayer& fenceLayer = m_mainRenderPass.ComputeLayers.emplace_back(m_deviceResources);
+	fenceLayer.Name = "Compute Layer: Fence Pattern";
+
+	// Root Signature
+	CD3DX12_DESCRIPTOR_RANGE fenceUAVTable;
+	fenceUAVTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0);
+
+	CD3DX12_ROOT_PARAMETER fenceSlotRootParameter[2];
+	fenceSlotRootParameter[0].InitAsConstantBufferView(0);
+	fenceSlotRootParameter[1].InitAsDescriptorTable(1, &fenceUAVTable);
+
+	CD3DX12_ROOT_SIGNATURE_DESC fenceRootSigDesc(2, fenceSlotRootParameter, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+
+	fenceLayer.RootSignature = std::make_shared<RootSignature>(m_deviceResources, fenceRootSigDesc);
+
+	// PSO
+	m_fencePatternCS = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/FencePatternCS.cso");
+
+	D3D12_COMPUTE_PIPELINE_STATE_DESC fencePatternPSO = wavesUpdatePSO;
+	fencePatternPSO.pRootSignature = fenceLayer.RootSignature->Get();
+	fencePatternPSO.CS = m_fencePatternCS->GetShaderByteCode();
+
+	fenceLayer.SetPSO(fencePatternPSO);
+
+	// Compute Item
+	ComputeItem& fenceItem = fenceLayer.ComputeItems.emplace_back();
+	fenceItem.ThreadGroupCountX = FenceTextureSize / 16;
+	fenceItem.ThreadGroupCountY = FenceTextureSize / 16;
+	fenceItem.ThreadGroupCountZ = 1;
+
+	m_fenceSettingsCB = std::make_unique<ConstantBufferT<FenceSettings>>(m_deviceResources);
+	auto& fenceCBV = fenceItem.ConstantBufferViews.emplace_back(0, m_fenceSettingsCB.get());
+	fenceCBV.Update = [this](const Timer& timer, int frameIndex)
+	{
+		FenceSettings settings;
+		settings.TotalTime = timer.TotalTime();
+		settings.Width = FenceTextureSize;
+		settings.Height = FenceTextureSize;
+
+		m_fenceSettingsCB->CopyData(frameIndex, settings);
+	};
+
+	auto& fenceDT = fenceItem.DescriptorTables.emplace_back(1, m_fenceTexture->GetUAVHandle());
+	fenceDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
+	{
+		// No update here because the UAV (mip 0) never changes
+	};
+
+	fenceLayer.PreWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList* commandList, const Timer*, int) -> bool
+	{
+		m_fenceTexture->TransitionToState(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, commandList);
+		return true;
+	};
+	fenceLayer.PostWork = [this](const ComputeLayer&, ID3D12GraphicsCommandList* commandList, const Timer*, int)
+	{
+		// Build mips 1 and up from the pattern that was just drawn, then hand the texture to the alpha tested layer
+		m_fenceTexture->GenerateMips(commandList);
+		m_fenceTexture->TransitionToState(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, commandList);
+	};
+
+
 
 
 
@@ -354,6 +455,8 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	// Render Pass Layer: Opaque ----------------------------------------------------------------------
 	RenderPassLayer& opaqueLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	opaqueLayer.Name = "Opaque Layer";
+	opaqueLayer.SortRenderItems = true;
+	opaqueLayer.FrustumCull = true;
 
 	// PSO
 	m_standardVS = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/LightingVS.cso");
@@ -425,7 +528,7 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	m_gridObject->SetTextureTransform(DirectX::XMMatrixScaling(5.0f, 5.0f, 1.0f));
 	RenderItem* gridRI = m_gridObject->CreateRenderItem(&opaqueLayer);
 
-	gridRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	gridRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& gridDT = gridRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::GRASS]->GetSRVHandle());
 	gridDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -440,6 +543,7 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	// Render Pass Layer: Alpha Test ----------------------------------------------------------------------
 	RenderPassLayer& alphaTestLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	alphaTestLayer.Name = "Alpha Test Layer";
+	alphaTestLayer.FrustumCull = true;
 
 	// PSO
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC alphaTestDesc = opaqueDesc;
@@ -479,7 +583,7 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	m_boxObject->SetWorldTransform(DirectX::XMMatrixTranslation(3.0f, 2.0f, -9.0f));
 	RenderItem* boxRI = m_boxObject->CreateRenderItem(&alphaTestLayer);
 
-	boxRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	boxRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& boxDT = boxRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WIRE_FENCE]->GetSRVHandle());
 	boxDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -487,6 +591,38 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 		// No update here because the texture is static
 	};
 
+	// Box with the checkerboard that was imported from pixels (see BuildGeneratedTextures())
+	m_checkerBoxObject = std::make_unique<GameObject>(m_deviceResources);
+	m_checkerBoxObject->SetMaterialDiffuseAlbedo(DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+	m_checkerBoxObject->SetMaterialFresnelR0(DirectX::XMFLOAT3(0.1f, 0.1f, 0.1f));
+	m_checkerBoxObject->SetMaterialRoughness(0.25f);
+	m_checkerBoxObject->SetWorldTransform(DirectX::XMMatrixTranslation(-8.0f, 2.0f, -5.0f));
+	RenderItem* checkerBoxRI = m_checkerBoxObject->CreateRenderItem(&alphaTestLayer);
+
+	checkerBoxRI->SetSubmeshIndex(0);
+
+	auto& checkerBoxDT = checkerBoxRI->DescriptorTables.emplace_back(0, m_checkerTexture->GetSRVHandle());
+	checkerBoxDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
+	{
+		// No update here because the texture is static
+	};
+
+	// Box with the fence pattern that is drawn and mipmapped on the GPU every frame
+	m_fenceBoxObject = std::make_unique<GameObject>(m_deviceResources);
+	m_fenceBoxObject->SetMaterialDiffuseAlbedo(DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+	m_fenceBoxObject->SetMaterialFresnelR0(DirectX::XMFLOAT3(0.1f, 0.1f, 0.1f));
+	m_fenceBoxObject->SetMaterialRoughness(0.25f);
+	m_fenceBoxObject->SetWorldTransform(DirectX::XMMatrixTranslation(14.0f, 2.0f, -5.0f));
+	RenderItem* fenceBoxRI = m_fenceBoxObject->CreateRenderItem(&alphaTestLayer);
+
+	fenceBoxRI->SetSubmeshIndex(0);
+
+	auto& fenceBoxDT = fenceBoxRI->DescriptorTables.emplace_back(0, m_fenceTexture->GetSRVHandle());
+	fenceBoxDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
+	{
+		// No update here because the SRV covers every mip and never changes
+	};
+
 
 
 
@@ -547,7 +683,8 @@ void LandAndWavesSceneCS::BuildLandAndWaterScene()
 	m_wavesObject->SetGridSpatialStep(m_gpuWaves->SpatialStep());
 	RenderItem* wavesRI = m_wavesObject->CreateRenderItem(&gpuWavesLayer);
 
-	wavesRI->submeshIndex = 0;
+	wavesRI->SetSubmeshIndex(0);
+	wavesRI->SetUpdateMode(RenderItem::UpdateMode::EveryFrame); // The displacement map handle changes every frame
 
 	auto& wavesDT = wavesRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WATER1]->GetSRVHandle());
 	wavesDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -603,6 +740,7 @@ void LandAndWavesSceneCS::UpdateCamera(const Timer& timer)
 		m_camera.Strafe(10.0f * dt);
 
 	m_camera.UpdateViewMatrix();
+	Engine::SetCullingCamera(m_camera);
 }
 
 void LandAndWavesSceneCS::UpdateWavesMaterials(const Timer& timer)
@@ -784,13 +922,13 @@ namespace landandwavescs
 		m_nextSol->TransitionToState(D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
 	}
 
-	void GPUWaves::PreUpdate()
+	void GPUWaves::PreUpdate(ID3D12GraphicsCommandList* commandList)
 	{
 		// The current solution needs to be transitioned to have unordered access by the compute shader
-		m_currSol->TransitionToState(D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		m_currSol->TransitionToState(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, commandList);
 	}
 
-	void GPUWaves::PostUpdate()
+	void GPUWaves::PostUpdate(ID3D12GraphicsCommandList* commandList)
 	{
 		Texture* tmp = m_prevSol;
 		m_prevSol = m_currSol;
@@ -798,7 +936,7 @@ namespace landandwavescs
 		m_nextSol = tmp;
 
 		// The current solution needs to be able to be read by the vertex shader, so change its state to GENERIC_READ.
-		m_currSol->TransitionToState(D3D12_RESOURCE_STATE_GENERIC_READ);
+		m_currSol->TransitionToState(D3D12_RESOURCE_STATE_GENERIC_READ, commandList);
 	}
 
 }
@@ -67,6 +67,17 @@ namespace sandbox
 			DirectX::XMINT2 DisturbIndex = DirectX::XMINT2(0, 0);
 		};
 
+		static constexpr UINT FenceTextureSize = 256;
+		static constexpr UINT16 FenceTextureMips = 9; // 256x256 down to 1x1
+
+		struct FenceSettings
+		{
+			float TotalTime = 0.0f;
+			UINT Width = 0;
+			UINT Height = 0;
+			float Pad = 0.0f;
+		};
+
 		class GPUWaves
 		{
 		public:
@@ -80,8 +91,8 @@ namespace sandbox
 			GPUWaves& operator=(GPUWaves&& rhs) = delete;
 			~GPUWaves() {}
 
-			void PreUpdate();
-			void PostUpdate();
+			void PreUpdate(ID3D12GraphicsCommandList* commandList);
+			void PostUpdate(ID3D12GraphicsCommandList* commandList);
 
 			ND inline float WaveConstant(unsigned int iii) const noexcept { return m_k[iii]; }
 
@@ -138,6 +149,7 @@ public:
 
 private:
 	void LoadTextures();
+	void BuildGeneratedTextures();
 	void BuildLandAndWaterScene();
 
 	std::shared_ptr<tiny::DeviceResources> m_deviceResources;
@@ -154,6 +166,12 @@ private:
 	// Textures
 	std::array<tiny::Texture*, (int)TEXTURE::Count> m_textures;
 
+	// Textures that are not read from file: a checkerboard imported from pixels on the CPU (mips built and BC1
+	// compressed on the CPU), and a fence pattern drawn by a compute shader every frame (mips built on the GPU)
+	tiny::TextureVector m_generatedTextures;
+	tiny::Texture* m_checkerTexture = nullptr;
+	tiny::Texture* m_fenceTexture = nullptr;
+
 	// Land and Water Scene ------------------------------------------------------------------
 	// 
 	float GetHillsHeight(float x, float z) const;
@@ -176,6 +194,12 @@ private:
 
 	// Box
 	std::unique_ptr<GameObject> m_boxObject = nullptr;
+	std::unique_ptr<GameObject> m_checkerBoxObject = nullptr;
+	std::unique_ptr<GameObject> m_fenceBoxObject = nullptr;
+
+	// Fence pattern
+	std::unique_ptr<tiny::Shader> m_fencePatternCS = nullptr;
+	std::unique_ptr<tiny::ConstantBufferT<landandwavescs::FenceSettings>> m_fenceSettingsCB = nullptr;
 
 	// Waves
 	std::unique_ptr<landandwavescs::GPUWaves> m_gpuWaves = nullptr;
@@ -183,7 +207,7 @@ private:
 	std::unique_ptr<tiny::Shader> m_wavesDisturbCS = nullptr;
 	std::unique_ptr<tiny::Shader> m_wavesUpdateCS = nullptr;
 	std::unique_ptr<tiny::ConstantBufferT<landandwavescs::WavesUpdateSettings>> m_waveUpdateSettingsCB = nullptr;
-	int m_waveUpdateNumFramesDirty = tiny::gNumFrameResources;
+	int m_waveUpdateNumFramesDirty = static_cast<int>(tiny::Engine::GetFrameResourceCount());
 	std::unique_ptr<GridGameObject> m_wavesObject = nullptr;
 	std::unique_ptr<tiny::ComputeLayer> m_wavesComputeLayerDisturb = nullptr;
 
@@ -13,8 +13,12 @@ LandAndWavesScene::LandAndWavesScene(std::shared_ptr<DeviceResources> deviceReso
 
 	Engine::Init(m_deviceResources);
 	DescriptorManager::Init(m_deviceResources);
-	TextureManager::Init(m_deviceResources);
+	TextureManager::Init(m_deviceResources, "texture-index.txt"); // Remembers texture hashes between runs
 
+	// Stream the textures in the background (they are white until they arrive), and keep up to 64MB of textures
+	// around after they are released
+	TextureManager::EnableStreaming(static_cast<unsigned int>(TEXTURE::WHITE1X1));
+	TextureManager::SetBudget(64ull * 1024 * 1024);
 
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Reset(m_deviceResources->GetCommandAllocator(), nullptr));
 
@@ -24,7 +28,9 @@ LandAndWavesScene::LandAndWavesScene(std::shared_ptr<DeviceResources> deviceReso
 	LoadTextures();
 	BuildLandAndWaterScene();
 
-	// Execute the initialization commands.
+	// Submit the mesh/texture uploads that were staged while building the scene (the direct queue waits for them
+	// on the GPU), then execute the initialization commands.
+	Engine::SubmitPendingUploads();
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Close());
 	ID3D12CommandList* cmdsLists[] = { m_deviceResources->GetCommandList() };
 	m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
@@ -64,25 +70,26 @@ void LandAndWavesScene::BuildLandAndWaterScene()
 
 	// Add name for debug/profiling purposes
 	m_mainRenderPass.Name = "Main Render Pass";
-	m_mainRenderPass.RenderPassLayers.reserve(3);
+	m_mainRenderPass.RenderPassLayers.reserve(4);
 
 	// Root Signature --------------------------------------------------------------------------------
 	CD3DX12_DESCRIPTOR_RANGE texTable;
 	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
 
 	// Root parameter can be a table, root descriptor or root constants.
-	CD3DX12_ROOT_PARAMETER slotRootParameter[4];
+	CD3DX12_ROOT_PARAMETER slotRootParameter[5];
 
 	// Perfomance TIP: Order from most frequent to least frequent.
 	slotRootParameter[0].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL);
 	slotRootParameter[1].InitAsConstantBufferView(0); // ObjectCB
 	slotRootParameter[2].InitAsConstantBufferView(1); // PassConstants
 	slotRootParameter[3].InitAsConstantBufferView(2); // MaterialCB
+	slotRootParameter[4].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX); // Per-instance data (Instanced Layer only)
 
 	auto staticSamplers = GetStaticSamplers();
 
 	// A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(4, slotRootParameter,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(5, slotRootParameter,
 		(UINT)staticSamplers.size(), staticSamplers.data(),
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -152,6 +159,8 @@ void LandAndWavesScene::BuildLandAndWaterScene()
 	// Render Pass Layer: Opaque ----------------------------------------------------------------------
 	RenderPassLayer& opaqueLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	opaqueLayer.Name = "Opaque Layer";
+	opaqueLayer.SortRenderItems = true;
+	opaqueLayer.FrustumCull = true;
 
 	// PSO
 	m_standardVS = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/LightingVS.cso");
@@ -223,7 +232,7 @@ void LandAndWavesScene::BuildLandAndWaterScene()
 	m_gridObject->SetTextureTransform(DirectX::XMMatrixScaling(5.0f, 5.0f, 1.0f));
 	RenderItem* gridRI = m_gridObject->CreateRenderItem(&opaqueLayer);
 
-	gridRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	gridRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& gridDT = gridRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::GRASS]->GetSRVHandle());
 	gridDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -233,11 +242,81 @@ void LandAndWavesScene::BuildLandAndWaterScene()
 
 
 
+	// Render Pass Layer: Instanced ----------------------------------------------------------------------
+	// Boxes scattered over the hills. They all share the same submesh, texture and material, so the Engine draws all
+	// of them (minus the ones that are culled) with a single DrawIndexedInstanced call. Each box's per-object constants
+	// are packed into a structured buffer, which LightingInstancedVS indexes with SV_InstanceID
+	RenderPassLayer& instancedLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
+	instancedLayer.Name = "Instanced Layer";
+	instancedLayer.FrustumCull = true;
+	instancedLayer.InstanceRenderItems = true;
+	instancedLayer.Instancing.PerObjectRootParameterIndex = 1;		// ObjectCB (not bound when instancing)
+	instancedLayer.Instancing.InstanceBufferRootParameterIndex = 4;	// Root SRV t1
+
+	// PSO
+	m_instancedVS = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/LightingInstancedVS.cso");
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC instancedDesc = opaqueDesc;
+	instancedDesc.VS = m_instancedVS->GetShaderByteCode();
+
+	instancedLayer.SetPSO(instancedDesc);
+
+	// Topology
+	instancedLayer.Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+	// MeshGroup
+	GeometryGenerator::MeshData crate = geoGen.CreateBox(1.5f, 1.5f, 1.5f, 0);
+
+	std::vector<std::vector<Vertex>> allCrateVertices(1);
+	for (const auto& v : crate.Vertices)
+		allCrateVertices[0].push_back({ v.Position, v.Normal, v.TexC });
+	std::vector<std::vector<std::uint16_t>> allCrateIndices(1, crate.GetIndices16());
+
+	instancedLayer.Meshes = std::make_shared<MeshGroupT<Vertex>>(m_deviceResources, allCrateVertices, allCrateIndices);
+
+	// Material (shared by every box, which is what allows them to be instanced together)
+	BasicMaterial crateMaterial;
+	crateMaterial.FresnelR0 = DirectX::XMFLOAT3(0.05f, 0.05f, 0.05f);
+	crateMaterial.Roughness = 0.5f;
+	m_instancedCrateMaterialCB = std::make_unique<ConstantBufferT<BasicMaterial>>(m_deviceResources);
+	m_instancedCrateMaterialCB->CopyData(0, crateMaterial); // MatTransform is the identity, so no need to transpose it
+
+	// Render Items: one per box, on the land only (the water level is at 0)
+	for (float x = -72.0f; x <= 72.0f; x += 6.0f)
+	{
+		for (float z = -72.0f; z <= 72.0f; z += 6.0f)
+		{
+			float y = GetHillsHeight(x, z);
+			if (y < 1.0f)
+				continue;
+
+			DirectX::XMFLOAT4X4 world;
+			DirectX::XMStoreFloat4x4(&world, DirectX::XMMatrixTranslation(x, y + 0.75f, z));
+
+			// The constants never change, so they are written once here and the item never needs to update
+			BasicObjectConstants constants;
+			DirectX::XMStoreFloat4x4(&constants.World, DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&world)));
+			auto& crateCB = m_instancedCrateConstantsCBs.emplace_back(std::make_unique<ConstantBufferT<BasicObjectConstants>>(m_deviceResources));
+			crateCB->CopyData(0, constants);
+
+			RenderItem& crateRI = instancedLayer.RenderItems.emplace_back();
+			crateRI.SetUpdateMode(RenderItem::UpdateMode::WhenDirty);
+			crateRI.SetWorldTransform(world);
+			crateRI.SetSubmeshIndex(0);
+			crateRI.ConstantBufferViews.emplace_back(1, crateCB.get());
+			crateRI.ConstantBufferViews.emplace_back(3, m_instancedCrateMaterialCB.get());
+			crateRI.DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::BRICKS]->GetSRVHandle());
+		}
+	}
+
+
+
 
 
 	// Render Pass Layer: Alpha Test ----------------------------------------------------------------------
 	RenderPassLayer& alphaTestLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	alphaTestLayer.Name = "Alpha Test Layer";
+	alphaTestLayer.FrustumCull = true;
 
 	// PSO
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC alphaTestDesc = opaqueDesc;
@@ -277,7 +356,7 @@ void LandAndWavesScene::BuildLandAndWaterScene()
 	m_boxObject->SetWorldTransform(DirectX::XMMatrixTranslation(3.0f, 2.0f, -9.0f));
 	RenderItem* boxRI = m_boxObject->CreateRenderItem(&alphaTestLayer);
 
-	boxRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	boxRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& boxDT = boxRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WIRE_FENCE]->GetSRVHandle());
 	boxDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -365,7 +444,7 @@ void LandAndWavesScene::BuildLandAndWaterScene()
 	m_wavesObject->SetTextureTransform(DirectX::XMMatrixScaling(5.0f, 5.0f, 1.0f));
 	RenderItem* wavesRI = m_wavesObject->CreateRenderItem(&transparentLayer);
 
-	wavesRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	wavesRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& wavesDT = wavesRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WATER1]->GetSRVHandle());
 	wavesDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -444,6 +523,7 @@ void LandAndWavesScene::Update(const Timer& timer)
 	// IMPORTANT: Do all necessary updates/animation first, but then be sure to call Engine::Update()
 
 	UpdateCamera(timer);
+	ReportStreamedTextures(timer);
 
 	// Land And Water Scene Update --------------------------------------------------------------------
 	UpdateWavesVertices(timer);
@@ -454,6 +534,21 @@ void LandAndWavesScene::Update(const Timer& timer)
 	Engine::Update(timer);
 }
 
+void LandAndWavesScene::ReportStreamedTextures(const Timer& timer)
+{
+	// The descriptor tables were built with the SRV handles the textures had before they were resident (showing the
+	// white placeholder). Those handles are never rebuilt, so each texture showing up in the scene once it is logged
+	// here is what shows that the real SRV was written into the same slot
+	for (unsigned int iii = 0; iii < m_textures.size(); ++iii)
+	{
+		if (!m_textureArrived[iii] && TextureManager::IsResident(iii))
+		{
+			m_textureArrived[iii] = true;
+			LOG_INFO("Texture {} is resident after {:.2f}s (SRV handle unchanged)", iii, timer.TotalTime());
+		}
+	}
+}
+
 void LandAndWavesScene::UpdateCamera(const Timer& timer)
 {
 	PROFILE_FUNCTION();
@@ -473,6 +568,7 @@ void LandAndWavesScene::UpdateCamera(const Timer& timer)
 		m_camera.Strafe(10.0f * dt);
 
 	m_camera.UpdateViewMatrix();
+	Engine::SetCullingCamera(m_camera);
 }
 void LandAndWavesScene::UpdateWavesVertices(const Timer& timer)
 {
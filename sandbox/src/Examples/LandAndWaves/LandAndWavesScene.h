@@ -96,6 +96,8 @@ private:
 
 	// Textures
 	std::array<tiny::Texture*, (int)TEXTURE::Count> m_textures;
+	std::array<bool, (int)TEXTURE::Count> m_textureArrived{};
+	void ReportStreamedTextures(const tiny::Timer& timer);
 
 	// Land and Water Scene ------------------------------------------------------------------
 	// 
@@ -120,6 +122,11 @@ private:
 	// Box
 	std::unique_ptr<GameObject> m_boxObject = nullptr;
 
+	// Instanced crates
+	std::unique_ptr<tiny::Shader> m_instancedVS = nullptr;
+	std::unique_ptr<tiny::ConstantBufferT<BasicMaterial>> m_instancedCrateMaterialCB = nullptr;
+	std::vector<std::unique_ptr<tiny::ConstantBufferT<BasicObjectConstants>>> m_instancedCrateConstantsCBs;
+
 	// Waves
 	std::unique_ptr<GameObject> m_wavesObject = nullptr;
 	std::unique_ptr<Waves> m_waves;
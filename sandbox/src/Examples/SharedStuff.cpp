@@ -44,43 +44,38 @@ RenderItem* GameObject::CreateRenderItem(tiny::RenderPassLayer* layer)
 	// Keep track of all render items and which layer they belong to (will be used in the destructor)
 	m_allRenderItems.emplace_back(layer, &ri);
 
+	// Objects are static unless one of the Set* methods is called, so only update the render item when dirty
+	ri.SetUpdateMode(RenderItem::UpdateMode::WhenDirty);
+
+	// World transform is needed for frustum culling
+	ri.SetWorldTransform(m_objectConstants.World);
+
 	// Constant Buffer
 	auto& boxConstantsCBV = ri.ConstantBufferViews.emplace_back(1, m_constantsCB.get());
 	boxConstantsCBV.Update = [this](const Timer& timer, int frameIndex)
 	{
-		// Only update the cbuffer data if the constants have changed.
-		if (m_constantsNumFramesDirty > 0)
-		{
-			DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_objectConstants.World);
-			DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&m_objectConstants.TexTransform);
+		// Only called when the render item is dirty (i.e. the constants or the material have changed)
+		DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_objectConstants.World);
+		DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&m_objectConstants.TexTransform);
 
-			BasicObjectConstants boxConstants;
-			DirectX::XMStoreFloat4x4(&boxConstants.World, DirectX::XMMatrixTranspose(world));
-			DirectX::XMStoreFloat4x4(&boxConstants.TexTransform, DirectX::XMMatrixTranspose(texTransform));
+		BasicObjectConstants boxConstants;
+		DirectX::XMStoreFloat4x4(&boxConstants.World, DirectX::XMMatrixTranspose(world));
+		DirectX::XMStoreFloat4x4(&boxConstants.TexTransform, DirectX::XMMatrixTranspose(texTransform));
 
-			m_constantsCB->CopyData(frameIndex, boxConstants);
-
-			--m_constantsNumFramesDirty;
-		}
+		m_constantsCB->CopyData(frameIndex, boxConstants);
 	};
 
 	// Material Buffer
 	auto& boxMaterialCBV = ri.ConstantBufferViews.emplace_back(3, m_materialCB.get());
 	boxMaterialCBV.Update = [this](const Timer& timer, int frameIndex)
 	{
-		if (m_materialNumFramesDirty > 0)
-		{
-			// Must transpose the transform before loading it into the constant buffer
-			DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_material.MatTransform);
-
-			BasicMaterial mat = m_material;
-			DirectX::XMStoreFloat4x4(&mat.MatTransform, DirectX::XMMatrixTranspose(transform));
+		// Must transpose the transform before loading it into the constant buffer
+		DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_material.MatTransform);
 
-			m_materialCB->CopyData(frameIndex, mat);
+		BasicMaterial mat = m_material;
+		DirectX::XMStoreFloat4x4(&mat.MatTransform, DirectX::XMMatrixTranspose(transform));
 
-			// Next FrameResource need to be updated too.
-			--m_materialNumFramesDirty;
-		}
+		m_materialCB->CopyData(frameIndex, mat);
 	};
 
 	return &ri;
@@ -89,47 +84,49 @@ RenderItem* GameObject::CreateRenderItem(tiny::RenderPassLayer* layer)
 void GameObject::SetMaterialDiffuseAlbedo(const DirectX::XMFLOAT4& albedo) noexcept
 {
 	m_material.DiffuseAlbedo = albedo;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GameObject::SetMaterialFresnelR0(const DirectX::XMFLOAT3& fresnel) noexcept
 {
 	m_material.FresnelR0 = fresnel;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GameObject::SetMaterialRoughness(float roughness) noexcept
 {
 	m_material.Roughness = roughness;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GameObject::SetMaterialTransform(const DirectX::XMFLOAT4X4& transform) noexcept
 {
 	m_material.MatTransform = transform;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GameObject::SetMaterialTransform(const DirectX::XMMATRIX& transform) noexcept
 {
 	DirectX::XMStoreFloat4x4(&m_material.MatTransform, transform);
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GameObject::SetWorldTransform(const DirectX::XMFLOAT4X4& transform) noexcept
 {
 	m_objectConstants.World = transform;
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
+	UpdateRenderItemTransforms();
 }
 void GameObject::SetWorldTransform(const DirectX::XMMATRIX& transform) noexcept
 {
 	DirectX::XMStoreFloat4x4(&m_objectConstants.World, transform);
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
+	UpdateRenderItemTransforms();
 }
 void GameObject::SetTextureTransform(const DirectX::XMFLOAT4X4& transform) noexcept
 {
 	m_objectConstants.TexTransform = transform;
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GameObject::SetTextureTransform(const DirectX::XMMATRIX& transform) noexcept
 {
 	DirectX::XMStoreFloat4x4(&m_objectConstants.TexTransform, transform);
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 
 
@@ -152,46 +149,41 @@ RenderItem* GridGameObject::CreateRenderItem(tiny::RenderPassLayer* layer)
 	// Keep track of all render items and which layer they belong to (will be used in the destructor)
 	m_allRenderItems.emplace_back(layer, &ri);
 
+	// Objects are static unless one of the Set* methods is called, so only update the render item when dirty
+	ri.SetUpdateMode(RenderItem::UpdateMode::WhenDirty);
+
+	// World transform is needed for frustum culling
+	ri.SetWorldTransform(m_objectConstants.World);
+
 	// Constant Buffer
 	auto& gridConstantsCBV = ri.ConstantBufferViews.emplace_back(1, m_constantsCB.get());
 	gridConstantsCBV.Update = [this](const Timer& timer, int frameIndex)
 	{
-		// Only update the cbuffer data if the constants have changed.
-		if (m_constantsNumFramesDirty > 0)
-		{
-			DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_objectConstants.World);
-			DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&m_objectConstants.TexTransform);
+		// Only called when the render item is dirty (i.e. the constants or the material have changed)
+		DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&m_objectConstants.World);
+		DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&m_objectConstants.TexTransform);
 
-			GridObjectConstants gridConstants;
-			DirectX::XMStoreFloat4x4(&gridConstants.World, DirectX::XMMatrixTranspose(world));
-			DirectX::XMStoreFloat4x4(&gridConstants.TexTransform, DirectX::XMMatrixTranspose(texTransform));
+		GridObjectConstants gridConstants;
+		DirectX::XMStoreFloat4x4(&gridConstants.World, DirectX::XMMatrixTranspose(world));
+		DirectX::XMStoreFloat4x4(&gridConstants.TexTransform, DirectX::XMMatrixTranspose(texTransform));
 
-			gridConstants.DisplacementMapTexelSize = m_objectConstants.DisplacementMapTexelSize;
-			gridConstants.GridSpatialStep = m_objectConstants.GridSpatialStep;
+		gridConstants.DisplacementMapTexelSize = m_objectConstants.DisplacementMapTexelSize;
+		gridConstants.GridSpatialStep = m_objectConstants.GridSpatialStep;
 
-			m_constantsCB->CopyData(frameIndex, gridConstants);
-
-			--m_constantsNumFramesDirty;
-		}
+		m_constantsCB->CopyData(frameIndex, gridConstants);
 	};
 
 	// Material Buffer
 	auto& boxMaterialCBV = ri.ConstantBufferViews.emplace_back(3, m_materialCB.get());
 	boxMaterialCBV.Update = [this](const Timer& timer, int frameIndex)
 	{
-		if (m_materialNumFramesDirty > 0)
-		{
-			// Must transpose the transform before loading it into the constant buffer
-			DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_material.MatTransform);
-
-			BasicMaterial mat = m_material;
-			DirectX::XMStoreFloat4x4(&mat.MatTransform, DirectX::XMMatrixTranspose(transform));
+		// Must transpose the transform before loading it into the constant buffer
+		DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&m_material.MatTransform);
 
-			m_materialCB->CopyData(frameIndex, mat);
+		BasicMaterial mat = m_material;
+		DirectX::XMStoreFloat4x4(&mat.MatTransform, DirectX::XMMatrixTranspose(transform));
 
-			// Next FrameResource need to be updated too.
-			--m_materialNumFramesDirty;
-		}
+		m_materialCB->CopyData(frameIndex, mat);
 	};
 
 	return &ri;
@@ -200,57 +192,59 @@ RenderItem* GridGameObject::CreateRenderItem(tiny::RenderPassLayer* layer)
 void GridGameObject::SetMaterialDiffuseAlbedo(const DirectX::XMFLOAT4& albedo) noexcept
 {
 	m_material.DiffuseAlbedo = albedo;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetMaterialFresnelR0(const DirectX::XMFLOAT3& fresnel) noexcept
 {
 	m_material.FresnelR0 = fresnel;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetMaterialRoughness(float roughness) noexcept
 {
 	m_material.Roughness = roughness;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetMaterialTransform(const DirectX::XMFLOAT4X4& transform) noexcept
 {
 	m_material.MatTransform = transform;
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetMaterialTransform(const DirectX::XMMATRIX& transform) noexcept
 {
 	DirectX::XMStoreFloat4x4(&m_material.MatTransform, transform);
-	m_materialNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetWorldTransform(const DirectX::XMFLOAT4X4& transform) noexcept
 {
 	m_objectConstants.World = transform;
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
+	UpdateRenderItemTransforms();
 }
 void GridGameObject::SetWorldTransform(const DirectX::XMMATRIX& transform) noexcept
 {
 	DirectX::XMStoreFloat4x4(&m_objectConstants.World, transform);
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
+	UpdateRenderItemTransforms();
 }
 void GridGameObject::SetTextureTransform(const DirectX::XMFLOAT4X4& transform) noexcept
 {
 	m_objectConstants.TexTransform = transform;
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetTextureTransform(const DirectX::XMMATRIX& transform) noexcept
 {
 	DirectX::XMStoreFloat4x4(&m_objectConstants.TexTransform, transform);
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetDisplacementMapTexelSize(const DirectX::XMFLOAT2& size) noexcept
 {
 	m_objectConstants.DisplacementMapTexelSize = size;
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 void GridGameObject::SetGridSpatialStep(float step) noexcept
 {
 	m_objectConstants.GridSpatialStep = step;
-	m_constantsNumFramesDirty = gNumFrameResources;
+	MarkRenderItemsDirty();
 }
 
 }
\ No newline at end of file
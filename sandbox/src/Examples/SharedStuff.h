@@ -74,13 +74,23 @@ protected:
 		}
 	}
 
+	// The render items only update when dirty, so they must be told whenever the constants/material change
+	inline void MarkRenderItemsDirty() noexcept
+	{
+		for (auto& tup : m_allRenderItems)
+			std::get<1>(tup)->MarkDirty();
+	}
+	// The render items use the world transform to compute their bounds for frustum culling
+	inline void UpdateRenderItemTransforms() noexcept
+	{
+		for (auto& tup : m_allRenderItems)
+			std::get<1>(tup)->SetWorldTransform(m_objectConstants.World);
+	}
+
 	std::shared_ptr<tiny::DeviceResources> m_deviceResources;
 
 	_Constants m_objectConstants;
-	int m_constantsNumFramesDirty = tiny::gNumFrameResources;
-
 	_Material m_material;
-	int m_materialNumFramesDirty = tiny::gNumFrameResources;
 
 	std::unique_ptr<tiny::ConstantBufferT<_Constants>> m_constantsCB = nullptr;
 	std::unique_ptr<tiny::ConstantBufferT<_Material>> m_materialCB = nullptr;
@@ -108,7 +118,7 @@ public:
 	void SetTextureTransform(const DirectX::XMFLOAT4X4& transform) noexcept;
 	void SetTextureTransform(const DirectX::XMMATRIX& transform) noexcept;
 
-	ND inline DirectX::XMFLOAT4X4& GetMaterialTransform() noexcept { m_materialNumFramesDirty = tiny::gNumFrameResources; return m_material.MatTransform; }
+	ND inline DirectX::XMFLOAT4X4& GetMaterialTransform() noexcept { MarkRenderItemsDirty(); return m_material.MatTransform; }
 	ND inline const DirectX::XMFLOAT4X4& GetMaterialTransformConst() noexcept { return m_material.MatTransform; }
 
 };
@@ -133,7 +143,7 @@ public:
 	void SetDisplacementMapTexelSize(const DirectX::XMFLOAT2& size) noexcept;
 	void SetGridSpatialStep(float step) noexcept;
 
-	ND inline DirectX::XMFLOAT4X4& GetMaterialTransform() noexcept { m_materialNumFramesDirty = tiny::gNumFrameResources; return m_material.MatTransform; }
+	ND inline DirectX::XMFLOAT4X4& GetMaterialTransform() noexcept { MarkRenderItemsDirty(); return m_material.MatTransform; }
 	ND inline const DirectX::XMFLOAT4X4& GetMaterialTransformConst() noexcept { return m_material.MatTransform; }
 
 };
@@ -20,7 +20,7 @@ StencilExample::StencilExample(std::shared_ptr<DeviceResources> deviceResources)
 
 	Engine::Init(m_deviceResources);
 	DescriptorManager::Init(m_deviceResources);
-	TextureManager::Init(m_deviceResources);
+	TextureManager::Init(m_deviceResources, "texture-index.txt"); // Remembers texture hashes between runs
 
 
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Reset(m_deviceResources->GetCommandAllocator(), nullptr));
@@ -31,7 +31,9 @@ StencilExample::StencilExample(std::shared_ptr<DeviceResources> deviceResources)
 	LoadTextures();
 	BuildStencilExample();
 
-	// Execute the initialization commands.
+	// Submit the mesh/texture uploads that were staged while building the scene (the direct queue waits for them
+	// on the GPU), then execute the initialization commands.
+	Engine::SubmitPendingUploads();
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Close());
 	ID3D12CommandList* cmdsLists[] = { m_deviceResources->GetCommandList() };
 	m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
@@ -61,6 +63,8 @@ void StencilExample::LoadTextures()
 {
 	PROFILE_FUNCTION();
 
+	// Read every file in parallel and upload them in one batch. GetTexture() then just takes a reference
+	TextureManager::PreloadAll();
 	for (int iii = 0; iii < (int)TEXTURE::Count; ++iii)
 		m_textures[iii] = TextureManager::GetTexture(iii);
 }
@@ -194,6 +198,9 @@ void StencilExample::BuildMainRenderPass()
 	// Render Pass Layer: Opaque ----------------------------------------------------------------------
 	RenderPassLayer& opaqueLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	opaqueLayer.Name = "Opaque Layer";
+	opaqueLayer.SortRenderItems = true;
+	opaqueLayer.FrustumCull = true;
+	opaqueLayer.CompileDrawPackets = true;
 	opaqueLayer.RenderItems.reserve(3);
 
 	// PSO
@@ -317,7 +324,7 @@ void StencilExample::BuildMainRenderPass()
 	m_floorObject->SetMaterialFresnelR0(DirectX::XMFLOAT3(0.07f, 0.07f, 0.07f));
 	m_floorObject->SetMaterialRoughness(0.3f);
 	RenderItem* floorRI = m_floorObject->CreateRenderItem(&opaqueLayer);
-	floorRI->submeshIndex = 0;
+	floorRI->SetSubmeshIndex(0);
 
 	auto& floorDT = floorRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::CHECKBOARD]->GetSRVHandle());
 	floorDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) { }; // No update here because the texture is static
@@ -328,7 +335,7 @@ void StencilExample::BuildMainRenderPass()
 	m_wallObject->SetMaterialFresnelR0(DirectX::XMFLOAT3(0.05f, 0.05f, 0.05f));
 	m_wallObject->SetMaterialRoughness(0.25f);
 	RenderItem* wallRI = m_wallObject->CreateRenderItem(&opaqueLayer);
-	wallRI->submeshIndex = 1;
+	wallRI->SetSubmeshIndex(1);
 
 	auto& wallDT = wallRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::BRICKS3]->GetSRVHandle());
 	wallDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) {}; // No update here because the texture is static
@@ -340,7 +347,7 @@ void StencilExample::BuildMainRenderPass()
 	m_skullObject->SetMaterialRoughness(0.3f);
 	m_skullObject->SetWorldTransform(DirectX::XMMatrixRotationY(0.5f * MathHelper::Pi) * DirectX::XMMatrixScaling(0.45f, 0.45f, 0.45f) * DirectX::XMMatrixTranslation(0.0f, 1.0f, -5.0f));
 	RenderItem* skullRI = m_skullObject->CreateRenderItem(&opaqueLayer);
-	skullRI->submeshIndex = 2;
+	skullRI->SetSubmeshIndex(2);
 
 	auto& skullDT = skullRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WHITE1X1]->GetSRVHandle());
 	skullDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) {}; // No update here because the texture is static
@@ -435,7 +442,7 @@ void StencilExample::BuildMainRenderPass()
 	m_mirrorStencilObject->SetMaterialFresnelR0(DirectX::XMFLOAT3(0.1f, 0.1f, 0.1f));
 	m_mirrorStencilObject->SetMaterialRoughness(0.5f);
 	RenderItem* mirrorRI = m_mirrorStencilObject->CreateRenderItem(&mirrorLayer);
-	mirrorRI->submeshIndex = 0;
+	mirrorRI->SetSubmeshIndex(0);
 
 	auto& mirrorDT = mirrorRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::ICE]->GetSRVHandle());
 	mirrorDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) {}; // No update here because the texture is static
@@ -548,7 +555,7 @@ void StencilExample::BuildReflectedRenderPass()
 	m_reflectedSkullObject->SetWorldTransform(reflectedWorld);
 
 	RenderItem* skullRI = m_reflectedSkullObject->CreateRenderItem(&reflectedLayer);
-	skullRI->submeshIndex = 2;
+	skullRI->SetSubmeshIndex(2);
 
 	auto& skullDT = skullRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WHITE1X1]->GetSRVHandle());
 	skullDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) {}; // No update here because the texture is static
@@ -629,7 +636,7 @@ void StencilExample::BuildMirrorAndShadowRenderPass()
 	m_mirrorObject->SetMaterialRoughness(0.5f);
 
 	RenderItem* mirrorRI = m_mirrorObject->CreateRenderItem(&mirrorLayer);
-	mirrorRI->submeshIndex = 0;
+	mirrorRI->SetSubmeshIndex(0);
 
 	auto& mirrorDT = mirrorRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::ICE]->GetSRVHandle());
 	mirrorDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) {}; // No update here because the texture is static
@@ -717,7 +724,7 @@ void StencilExample::BuildMirrorAndShadowRenderPass()
 	m_shadowObject->SetWorldTransform(shadowWorld);
 
 	RenderItem* shadowRI = m_shadowObject->CreateRenderItem(&shadowLayer);
-	shadowRI->submeshIndex = 2;
+	shadowRI->SetSubmeshIndex(2);
 
 	auto& shadowDT = shadowRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::ICE]->GetSRVHandle());
 	shadowDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex) {}; // No update here because the texture is static
@@ -799,6 +806,7 @@ void StencilExample::UpdateCamera(const Timer& timer)
 		m_camera.Strafe(10.0f * dt);
 
 	m_camera.UpdateViewMatrix();
+	Engine::SetCullingCamera(m_camera);
 }
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> StencilExample::GetStaticSamplers()
 {
@@ -856,6 +864,26 @@ std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> StencilExample::GetStaticSample
 		linearWrap, linearClamp,
 		anisotropicWrap, anisotropicClamp };
 }
+void StencilExample::OnLButtonUpDown(bool isDown)
+{
+	m_lButtonDown = isDown;
+
+	if (isDown)
+		PickObject(m_lastMousePos.x, m_lastMousePos.y);
+}
+void StencilExample::PickObject(float x, float y)
+{
+	PROFILE_FUNCTION();
+
+	DirectX::XMVECTOR origin, direction;
+	m_camera.GetPickingRay(x, y, static_cast<float>(m_deviceResources->GetWidth()), static_cast<float>(m_deviceResources->GetHeight()), origin, direction);
+
+	// Only the opaque layer holds pickable objects (the other layers hold reflections/shadows of them)
+	float distance = 0.0f;
+	RenderItem* picked = m_mainRenderPass.RenderPassLayers[0].Pick(origin, direction, distance);
+	if (picked != nullptr)
+		LOG_INFO("Picked render item (submesh {}) at distance {}", picked->GetSubmeshIndex(), distance);
+}
 void StencilExample::OnMouseMove(float x, float y)
 {
 	if (m_lButtonDown)
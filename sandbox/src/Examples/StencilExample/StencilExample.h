@@ -82,7 +82,7 @@ public:
 
 	// Mouse/Keyboard Events
 	void OnMouseMove(float x, float y);
-	void OnLButtonUpDown(bool isDown) { m_lButtonDown = isDown; }
+	void OnLButtonUpDown(bool isDown);
 	void OnWKeyUpDown(bool isDown) noexcept { m_keyWIsDown = isDown; }
 	void OnAKeyUpDown(bool isDown) noexcept { m_keyAIsDown = isDown; }
 	void OnSKeyUpDown(bool isDown) noexcept { m_keySIsDown = isDown; }
@@ -97,6 +97,7 @@ private:
 	void BuildMirrorAndShadowRenderPass();
 	void LoadSkullGeometry(std::vector<stencilexample::Vertex>& vertices, std::vector<uint16_t>& indices);
 	void UpdateCamera(const tiny::Timer& timer);
+	void PickObject(float x, float y);
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
 	std::shared_ptr<tiny::DeviceResources> m_deviceResources;
@@ -13,7 +13,7 @@ TessellationExample::TessellationExample(std::shared_ptr<DeviceResources> device
 
 	Engine::Init(m_deviceResources);
 	DescriptorManager::Init(m_deviceResources);
-	TextureManager::Init(m_deviceResources);
+	TextureManager::Init(m_deviceResources, "texture-index.txt"); // Remembers texture hashes between runs
 
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Reset(m_deviceResources->GetCommandAllocator(), nullptr));
 
@@ -23,7 +23,9 @@ TessellationExample::TessellationExample(std::shared_ptr<DeviceResources> device
 	LoadTextures();
 	BuildScene();
 
-	// Execute the initialization commands.
+	// Submit the mesh/texture uploads that were staged while building the scene (the direct queue waits for them
+	// on the GPU), then execute the initialization commands.
+	Engine::SubmitPendingUploads();
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Close());
 	ID3D12CommandList* cmdsLists[] = { m_deviceResources->GetCommandList() };
 	m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
@@ -54,6 +56,8 @@ void TessellationExample::LoadTextures()
 {
 	PROFILE_FUNCTION();
 
+	// Read every file in parallel and upload them in one batch. GetTexture() then just takes a reference
+	TextureManager::PreloadAll();
 	for (int iii = 0; iii < (int)TEXTURE::Count; ++iii)
 		m_textures[iii] = TextureManager::GetTexture(iii);
 }
@@ -151,6 +155,7 @@ void TessellationExample::BuildScene()
 	// Render Pass Layer: Opaque ----------------------------------------------------------------------
 	RenderPassLayer& opaqueLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	opaqueLayer.Name = "Opaque Layer";
+	opaqueLayer.SortRenderItems = true;
 
 	// PSO
 	m_tessellationVS = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/TessellationBasicVS.cso");
@@ -222,7 +227,7 @@ void TessellationExample::BuildScene()
 
 	RenderItem* gridRI = m_gridObject->CreateRenderItem(&opaqueLayer);
 
-	gridRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	gridRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& gridDT = gridRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WHITE1X1]->GetSRVHandle());
 	gridDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -122,7 +122,7 @@ private:
 //	std::unique_ptr<tiny::Shader> m_wavesDisturbCS = nullptr;
 //	std::unique_ptr<tiny::Shader> m_wavesUpdateCS = nullptr;
 //	std::unique_ptr<tiny::ConstantBufferT<tessellationexample::WavesUpdateSettings>> m_waveUpdateSettingsCB = nullptr;
-//	int m_waveUpdateNumFramesDirty = tiny::gNumFrameResources;
+//	int m_waveUpdateNumFramesDirty = static_cast<int>(tiny::Engine::GetFrameResourceCount());
 //	std::unique_ptr<GridGameObject> m_wavesObject = nullptr;
 //	std::unique_ptr<tiny::ComputeLayer> m_wavesComputeLayerDisturb = nullptr;
 
@@ -13,7 +13,7 @@ TreeBillboardsScene::TreeBillboardsScene(std::shared_ptr<DeviceResources> device
 
 	Engine::Init(m_deviceResources);
 	DescriptorManager::Init(m_deviceResources);
-	TextureManager::Init(m_deviceResources);
+	TextureManager::Init(m_deviceResources, "texture-index.txt"); // Remembers texture hashes between runs
 
 
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Reset(m_deviceResources->GetCommandAllocator(), nullptr));
@@ -24,7 +24,9 @@ TreeBillboardsScene::TreeBillboardsScene(std::shared_ptr<DeviceResources> device
 	LoadTextures();
 	BuildLandAndWaterScene();
 
-	// Execute the initialization commands.
+	// Submit the mesh/texture uploads that were staged while building the scene (the direct queue waits for them
+	// on the GPU), then execute the initialization commands.
+	Engine::SubmitPendingUploads();
 	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Close());
 	ID3D12CommandList* cmdsLists[] = { m_deviceResources->GetCommandList() };
 	m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
@@ -55,6 +57,8 @@ void TreeBillboardsScene::LoadTextures()
 {
 	PROFILE_FUNCTION();
 
+	// Read every file in parallel and upload them in one batch. GetTexture() then just takes a reference
+	TextureManager::PreloadAll();
 	for (int iii = 0; iii < (int)TEXTURE::Count; ++iii)
 		m_textures[iii] = TextureManager::GetTexture(iii);
 }
@@ -152,6 +156,8 @@ void TreeBillboardsScene::BuildLandAndWaterScene()
 	// Render Pass Layer: Opaque ----------------------------------------------------------------------
 	RenderPassLayer& opaqueLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	opaqueLayer.Name = "Opaque Layer";
+	opaqueLayer.SortRenderItems = true;
+	opaqueLayer.FrustumCull = true;
 
 	// PSO
 	m_standardVS = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/LightingVS.cso");
@@ -223,7 +229,7 @@ void TreeBillboardsScene::BuildLandAndWaterScene()
 	m_gridObject->SetTextureTransform(DirectX::XMMatrixScaling(5.0f, 5.0f, 1.0f));
 	RenderItem* gridRI = m_gridObject->CreateRenderItem(&opaqueLayer);
 
-	gridRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	gridRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& gridDT = gridRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::GRASS]->GetSRVHandle());
 	gridDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -238,6 +244,7 @@ void TreeBillboardsScene::BuildLandAndWaterScene()
 	// Render Pass Layer: Alpha Test ----------------------------------------------------------------------
 	RenderPassLayer& alphaTestLayer = m_mainRenderPass.RenderPassLayers.emplace_back(m_deviceResources);
 	alphaTestLayer.Name = "Alpha Test Layer";
+	alphaTestLayer.FrustumCull = true;
 
 	// PSO
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC alphaTestDesc = opaqueDesc;
@@ -277,7 +284,7 @@ void TreeBillboardsScene::BuildLandAndWaterScene()
 	m_boxObject->SetWorldTransform(DirectX::XMMatrixTranslation(3.0f, 2.0f, -9.0f));
 	RenderItem* boxRI = m_boxObject->CreateRenderItem(&alphaTestLayer);
 
-	boxRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	boxRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& boxDT = boxRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WIRE_FENCE]->GetSRVHandle());
 	boxDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -372,7 +379,7 @@ void TreeBillboardsScene::BuildLandAndWaterScene()
 	m_treeSpritesObject->SetMaterialRoughness(0.125f);
 	RenderItem* treeSpritesRI = m_treeSpritesObject->CreateRenderItem(&treeSpritesLayer);
 
-	treeSpritesRI->submeshIndex = 0;
+	treeSpritesRI->SetSubmeshIndex(0);
 
 	auto& treeSpritesDT = treeSpritesRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::TREE_ARRAY_2]->GetSRVHandle());
 	treeSpritesDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -460,7 +467,7 @@ void TreeBillboardsScene::BuildLandAndWaterScene()
 	m_wavesObject->SetTextureTransform(DirectX::XMMatrixScaling(5.0f, 5.0f, 1.0f));
 	RenderItem* wavesRI = m_wavesObject->CreateRenderItem(&transparentLayer);
 
-	wavesRI->submeshIndex = 0; // Only using a single mesh, so automatically it is at index 0
+	wavesRI->SetSubmeshIndex(0); // Only using a single mesh, so automatically it is at index 0
 
 	auto& wavesDT = wavesRI->DescriptorTables.emplace_back(0, m_textures[(int)TEXTURE::WATER1]->GetSRVHandle());
 	wavesDT.Update = [](RootDescriptorTable* dt, const Timer& timer, int frameIndex)
@@ -507,6 +514,7 @@ void TreeBillboardsScene::UpdateCamera(const Timer& timer)
 		m_camera.Strafe(10.0f * dt);
 
 	m_camera.UpdateViewMatrix();
+	Engine::SetCullingCamera(m_camera);
 }
 void TreeBillboardsScene::UpdateWavesVertices(const Timer& timer)
 {
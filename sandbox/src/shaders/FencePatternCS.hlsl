@@ -0,0 +1,28 @@
+// Draws an animated fence pattern into mip 0 of a texture. The rest of the mip chain is filled in afterwards on the
+// GPU by the Engine's MipGenerator.
+cbuffer cbFenceSettings : register(b0)
+{
+    float gTotalTime;
+    uint gWidth;
+    uint gHeight;
+    float gFenceSettingsPad;
+};
+
+RWTexture2D<float4> gOutput : register(u0);
+
+[numthreads(16, 16, 1)]
+void FencePatternCS(int3 dispatchThreadID : SV_DispatchThreadID)
+{
+	// Out-of-bounds writes are a no-op, so there is no need to check the size
+    float2 uv = (dispatchThreadID.xy + 0.5f) / float2(gWidth, gHeight);
+
+	// One ring per cell, pulsing over time. Everything off the rings is transparent and gets clipped by the
+	// alpha tested pixel shader
+    float2 cell = frac(uv * 8.0f) - 0.5f;
+    float radius = 0.3f + 0.1f * sin(2.0f * gTotalTime + 6.2831853f * (uv.x + uv.y));
+    float alpha = abs(length(cell) - radius) < 0.06f ? 1.0f : 0.0f;
+
+    float3 color = 0.5f + 0.5f * cos(gTotalTime + 6.2831853f * uv.xyx + float3(0.0f, 2.0f, 4.0f));
+
+    gOutput[dispatchThreadID.xy] = float4(color, alpha);
+}
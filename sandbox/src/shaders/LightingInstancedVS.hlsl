@@ -0,0 +1,116 @@
+// Defaults for number of lights.
+#ifndef NUM_DIR_LIGHTS
+#define NUM_DIR_LIGHTS 3
+#endif
+
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 0
+#endif
+
+#ifndef NUM_SPOT_LIGHTS
+#define NUM_SPOT_LIGHTS 0
+#endif
+
+// Include structures and functions for lighting.
+#include "Lighting.hlsli"
+
+Texture2D gDiffuseMap : register(t0);
+
+SamplerState gsamPointWrap          : register(s0);
+SamplerState gsamPointClamp         : register(s1);
+SamplerState gsamLinearWrap         : register(s2);
+SamplerState gsamLinearClamp        : register(s3);
+SamplerState gsamAnisotropicWrap    : register(s4);
+SamplerState gsamAnisotropicClamp   : register(s5);
+
+// Per-object data for every instance in the draw. The Engine packs the data of each item's per-object constant
+// buffer into this buffer (see tiny::InstancingDesc), so the layout must match BasicObjectConstants exactly.
+struct InstanceData
+{
+    float4x4 World;
+    float4x4 TexTransform;
+};
+
+StructuredBuffer<InstanceData> gInstances : register(t1);
+
+// Constant data that varies per material.
+cbuffer cbPass : register(b1)
+{
+    float4x4 gView;
+    float4x4 gInvView;
+    float4x4 gProj;
+    float4x4 gInvProj;
+    float4x4 gViewProj;
+    float4x4 gInvViewProj;
+    float3 gEyePosW;
+    float cbPerObjectPad1;
+    float2 gRenderTargetSize;
+    float2 gInvRenderTargetSize;
+    float gNearZ;
+    float gFarZ;
+    float gTotalTime;
+    float gDeltaTime;
+    float4 gAmbientLight;
+    
+    // Allow application to change fog parameters once per frame.
+	// For example, we may only use fog for certain times of day.
+    float4 gFogColor;
+    float gFogStart;
+    float gFogRange;
+    float2 cbPerObjectPad2;
+
+    // Indices [0, NUM_DIR_LIGHTS) are directional lights;
+    // indices [NUM_DIR_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHTS) are point lights;
+    // indices [NUM_DIR_LIGHTS+NUM_POINT_LIGHTS, NUM_DIR_LIGHTS+NUM_POINT_LIGHT+NUM_SPOT_LIGHTS)
+    // are spot lights for a maximum of MaxLights per object.
+    Light gLights[MaxLights];
+};
+
+cbuffer cbMaterial : register(b2)
+{
+    float4 gDiffuseAlbedo;
+    float3 gFresnelR0;
+    float gRoughness;
+    float4x4 gMatTransform;
+};
+ 
+struct VertexIn
+{
+    float3 PosL : POSITION;
+    float3 NormalL : NORMAL;
+    float2 TexC : TEXCOORD;
+};
+
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float3 PosW : POSITION;
+    float3 NormalW : NORMAL;
+    float2 TexC : TEXCOORD;
+};
+
+VertexOut main(VertexIn vin, uint instanceID : SV_InstanceID)
+{
+    VertexOut vout = (VertexOut) 0.0f;
+
+    // The Engine always starts instanced draws at instance 0, so SV_InstanceID indexes the buffer directly
+    InstanceData instance = gInstances[instanceID];
+	
+    // Transform to world space.
+    float4 posW = mul(float4(vin.PosL, 1.0f), instance.World);
+    vout.PosW = posW.xyz;
+
+    // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
+    vout.NormalW = mul(vin.NormalL, (float3x3) instance.World);
+
+    // Transform to homogeneous clip space.
+    vout.PosH = mul(posW, gViewProj);
+	
+	// Output vertex attributes for interpolation across triangle.
+    float4 texC = mul(float4(vin.TexC, 0.0f, 1.0f), instance.TexTransform);
+    vout.TexC = mul(texC, gMatTransform).xy;
+	
+    return vout;
+}
+
+
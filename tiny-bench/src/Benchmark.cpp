@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <numeric>
+
+namespace bench
+{
+std::vector<BenchmarkInfo>& GetBenchmarks()
+{
+	// Function local so that it exists before the first registrar runs, regardless of static initialization order
+	static std::vector<BenchmarkInfo> benchmarks;
+	return benchmarks;
+}
+
+std::vector<std::filesystem::path> FindDDSFiles(const std::filesystem::path& path)
+{
+	std::vector<std::filesystem::path> files;
+	if (std::filesystem::is_directory(path))
+	{
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == ".dds")
+				files.push_back(entry.path());
+		}
+	}
+	else if (std::filesystem::is_regular_file(path))
+	{
+		files.push_back(path);
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+std::vector<std::wstring>& GetTextureFiles()
+{
+	static std::vector<std::wstring> files;
+	return files;
+}
+
+double Samples::Mean() const noexcept
+{
+	if (m_values.empty())
+		return 0.0;
+	return std::accumulate(m_values.begin(), m_values.end(), 0.0) / static_cast<double>(m_values.size());
+}
+double Samples::Min() const noexcept
+{
+	return m_values.empty() ? 0.0 : *std::min_element(m_values.begin(), m_values.end());
+}
+double Samples::Max() const noexcept
+{
+	return m_values.empty() ? 0.0 : *std::max_element(m_values.begin(), m_values.end());
+}
+double Samples::Percentile(double p) const noexcept
+{
+	if (m_values.empty())
+		return 0.0;
+
+	if (!m_sorted)
+	{
+		std::sort(m_values.begin(), m_values.end());
+		m_sorted = true;
+	}
+
+	size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(m_values.size())));
+	return m_values[tiny::MathHelper::Clamp<size_t>(rank, 1, m_values.size()) - 1];
+}
+
+void PrintHeader(std::string_view title)
+{
+	std::cout << std::format("\n== {} ==\n", title);
+}
+void PrintSamplesHeader(std::string_view unit)
+{
+	std::cout << std::format("{:<36}{:>12}{:>12}{:>12}{:>12}{:>12}\n", std::format("({})", unit), "mean", "min", "p50", "p99", "max");
+}
+void PrintSamples(std::string_view label, const Samples& samples)
+{
+	std::cout << std::format("{:<36}{:>12.2f}{:>12.2f}{:>12.2f}{:>12.2f}{:>12.2f}\n", label,
+		samples.Mean(), samples.Min(), samples.Percentile(50.0), samples.Percentile(99.0), samples.Max());
+}
+void PrintValue(std::string_view label, double value, std::string_view unit)
+{
+	std::cout << std::format("{:<36}{:>12.2f} {}\n", label, value, unit);
+}
+void PrintBytes(std::string_view label, UINT64 bytes)
+{
+	if (bytes >= 1024ull * 1024)
+		std::cout << std::format("{:<36}{:>12.2f} MB\n", label, static_cast<double>(bytes) / (1024.0 * 1024.0));
+	else
+		std::cout << std::format("{:<36}{:>12.2f} KB\n", label, static_cast<double>(bytes) / 1024.0);
+}
+
+std::vector<unsigned int> ItemCounts(const Options& options, std::initializer_list<unsigned int> defaults)
+{
+	if (options.Items > 0)
+		return { options.Items };
+	return defaults;
+}
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <tiny.h>
+
+namespace bench
+{
+// Command line options shared by every benchmark. Each benchmark documents which ones it reads
+struct Options
+{
+	unsigned int Frames = 600;		// Frames to measure (after WarmupFrames) for benchmarks that run the frame loop
+	unsigned int WarmupFrames = 30;
+	unsigned int Items = 0;			// 0 means the benchmark's own list of item counts
+	unsigned int Repetitions = 7;	// CPU-only benchmarks report the best of this many runs
+	std::string Path;				// Benchmarks that read files (i.e. dds, preload) take a file or directory here
+};
+
+using BenchmarkFunction = int(*)(const Options&);
+
+struct BenchmarkInfo
+{
+	const char* Name;
+	const char* Description;
+	BenchmarkFunction Run;
+};
+
+std::vector<BenchmarkInfo>& GetBenchmarks();
+
+// The sandbox's textures, relative to the tiny-bench project directory (where it runs from in Visual Studio)
+static constexpr const char* DefaultTexturePath = "../sandbox/src/textures";
+
+// 'path' itself if it is a file, otherwise every .dds file under it (sorted)
+ND std::vector<std::filesystem::path> FindDDSFiles(const std::filesystem::path& path);
+
+// What tiny-bench's GetTextureFilename()/GetTotalTextureCount() report to TextureManager. Empty unless a benchmark
+// fills it in, which has to happen before TextureManager::Init() because that is when the count is read
+std::vector<std::wstring>& GetTextureFiles();
+
+// Benchmarks register themselves from a static initializer (see TINY_BENCHMARK), so adding one is just adding a file
+struct BenchmarkRegistrar
+{
+	BenchmarkRegistrar(const char* name, const char* description, BenchmarkFunction run)
+	{
+		GetBenchmarks().push_back({ name, description, run });
+	}
+};
+
+#define TINY_BENCHMARK(name, description)																	\
+	static int CAT(Benchmark_, name)(const bench::Options& options);										\
+	static bench::BenchmarkRegistrar CAT(g_registrar_, name)(STRINGIFY(name), description, &CAT(Benchmark_, name));	\
+	static int CAT(Benchmark_, name)(const bench::Options& options)
+
+class Stopwatch
+{
+public:
+	Stopwatch() noexcept : m_start(std::chrono::steady_clock::now()) {}
+
+	inline void Restart() noexcept { m_start = std::chrono::steady_clock::now(); }
+	ND inline double ElapsedMicroseconds() const noexcept
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// Keeps every sample so that percentiles are exact (utility::Histogram only knows which bucket a sample fell in)
+class Samples
+{
+public:
+	inline void Add(double value) { m_values.push_back(value); m_sorted = false; }
+	inline void Clear() noexcept { m_values.clear(); }
+	inline void Reserve(size_t count) { m_values.reserve(count); }
+
+	ND inline size_t Count() const noexcept { return m_values.size(); }
+	ND double Mean() const noexcept;
+	ND double Min() const noexcept;
+	ND double Max() const noexcept;
+	ND double Percentile(double p) const noexcept; // 0 <= p <= 100, nearest rank
+
+private:
+	mutable std::vector<double> m_values;
+	mutable bool m_sorted = false;
+};
+
+// Reports are plain aligned text on stdout so that runs can be diffed/pasted into a PR as-is
+void PrintHeader(std::string_view title);
+void PrintSamplesHeader(std::string_view unit);
+void PrintSamples(std::string_view label, const Samples& samples);
+void PrintValue(std::string_view label, double value, std::string_view unit);
+void PrintBytes(std::string_view label, UINT64 bytes);
+
+// Item counts to run at: options.Items if it was given, otherwise 'defaults'
+ND std::vector<unsigned int> ItemCounts(const Options& options, std::initializer_list<unsigned int> defaults);
+}
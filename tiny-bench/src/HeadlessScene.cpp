@@ -0,0 +1,194 @@
+#include "HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+HeadlessScene::HeadlessScene(int height, int width) :
+	m_deviceResources(std::make_shared<DeviceResources>(height, width)),
+	m_renderPass()
+{
+	Engine::Init(m_deviceResources);
+	DescriptorManager::Init(m_deviceResources);
+
+	D3D12_VIEWPORT vp{};
+	vp.Width = static_cast<float>(width);
+	vp.Height = static_cast<float>(height);
+	vp.MinDepth = 0.0f;
+	vp.MaxDepth = 1.0f;
+	Engine::SetViewport(vp);
+	Engine::SetScissorRect({ 0, 0, width, height });
+
+	m_camera.SetLens(0.25f * MathHelper::Pi, m_deviceResources->AspectRatio(), 1.0f, 1000.0f);
+
+	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Reset(m_deviceResources->GetCommandAllocator(), nullptr));
+
+	BuildRenderPass();
+
+	Engine::SubmitPendingUploads();
+	GFX_THROW_INFO(m_deviceResources->GetCommandList()->Close());
+	ID3D12CommandList* cmdsLists[] = { m_deviceResources->GetCommandList() };
+	m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+	m_deviceResources->FlushCommandQueue();
+
+	m_timer.Reset();
+}
+HeadlessScene::~HeadlessScene() noexcept
+{
+	// The items' constant buffers are about to go away, so make sure no frame that reads them is still in flight
+	m_deviceResources->FlushCommandQueue();
+}
+
+void HeadlessScene::BuildRenderPass()
+{
+	m_renderPass.Name = "Headless Render Pass";
+
+	// Root Signature: [0] per-object constants, [1] per-pass constants
+	CD3DX12_ROOT_PARAMETER slotRootParameter[2];
+	slotRootParameter[0].InitAsConstantBufferView(0);
+	slotRootParameter[1].InitAsConstantBufferView(1);
+
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(2, slotRootParameter, 0, nullptr,
+		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	m_renderPass.RootSignature = std::make_shared<RootSignature>(m_deviceResources, rootSigDesc);
+
+	// Per-pass constants
+	m_passConstantsCB = std::make_unique<ConstantBufferT<PassConstants>>(m_deviceResources);
+
+	auto& passCBV = m_renderPass.ConstantBufferViews.emplace_back(1, m_passConstantsCB.get());
+	passCBV.Update = [this](const Timer& timer, int frameIndex)
+	{
+		PassConstants passConstants;
+		DirectX::XMMATRIX viewProj = DirectX::XMMatrixMultiply(m_camera.GetView(), m_camera.GetProj());
+		DirectX::XMStoreFloat4x4(&passConstants.ViewProj, DirectX::XMMatrixTranspose(viewProj));
+		m_passConstantsCB->CopyData(frameIndex, passConstants);
+	};
+
+	// Layer
+	RenderPassLayer& layer = m_renderPass.RenderPassLayers.emplace_back(m_deviceResources);
+	layer.Name = "Boxes";
+
+	m_vertexShader = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/BoxVS.cso");
+	m_pixelShader = std::make_unique<Shader>(m_deviceResources, "src/shaders/output/BoxPS.cso");
+
+	m_inputLayout = std::make_unique<InputLayout>(
+		std::vector<D3D12_INPUT_ELEMENT_DESC>{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		}
+	);
+
+	m_rasterizerState = std::make_unique<RasterizerState>();
+	m_blendState = std::make_unique<BlendState>();
+	m_depthStencilState = std::make_unique<DepthStencilState>();
+
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc;
+	ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
+	psoDesc.InputLayout = m_inputLayout->GetInputLayoutDesc();
+	psoDesc.pRootSignature = m_renderPass.RootSignature->Get();
+	psoDesc.VS = m_vertexShader->GetShaderByteCode();
+	psoDesc.PS = m_pixelShader->GetShaderByteCode();
+	psoDesc.RasterizerState = m_rasterizerState->GetRasterizerDesc();
+	psoDesc.BlendState = m_blendState->GetBlendDesc();
+	psoDesc.DepthStencilState = m_depthStencilState->GetDepthStencilDesc();
+	psoDesc.SampleMask = UINT_MAX;
+	psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+	psoDesc.NumRenderTargets = 1;
+	psoDesc.RTVFormats[0] = m_deviceResources->GetBackBufferFormat();
+	psoDesc.SampleDesc.Count = m_deviceResources->MsaaEnabled() ? 4 : 1;
+	psoDesc.SampleDesc.Quality = m_deviceResources->MsaaEnabled() ? (m_deviceResources->MsaaQuality() - 1) : 0;
+	psoDesc.DSVFormat = m_deviceResources->GetDepthStencilFormat();
+
+	layer.SetPSO(psoDesc);
+	layer.Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+	// Mesh
+	GeometryGenerator geoGen;
+	GeometryGenerator::MeshData box = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0);
+
+	std::vector<std::vector<BoxVertex>> allVertices(1);
+	for (const auto& vertex : box.Vertices)
+		allVertices[0].push_back({ vertex.Position });
+	std::vector<std::vector<std::uint16_t>> allIndices(1, box.GetIndices16());
+
+	layer.Meshes = std::make_shared<MeshGroupT<BoxVertex>>(m_deviceResources, allVertices, allIndices);
+}
+
+void HeadlessScene::Populate(unsigned int count, const ItemSettings& settings)
+{
+	RenderPassLayer& layer = GetLayer();
+
+	for (Object& object : m_objects)
+		layer.RemoveRenderItem(object.Item);
+	m_deviceResources->FlushCommandQueue();
+	m_objects.clear();
+	m_objects.reserve(count);
+
+	// Lay the boxes out on a square grid facing the camera, and back the camera up until the whole grid is in view
+	const unsigned int side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(count))));
+	const float spacing = 2.0f;
+	const float halfExtent = 0.5f * spacing * static_cast<float>(side);
+	m_camera.SetLens(0.25f * MathHelper::Pi, m_deviceResources->AspectRatio(), 1.0f, 10.0f + 4.0f * halfExtent);
+	m_camera.LookAt(DirectX::XMFLOAT3(0.0f, 0.0f, -3.0f * halfExtent - 2.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f));
+	m_camera.UpdateViewMatrix();
+
+	for (unsigned int iii = 0; iii < count; ++iii)
+	{
+		Object& object = m_objects.emplace_back();
+		object.ConstantsCB = std::make_unique<ConstantBufferT<ObjectConstants>>(m_deviceResources);
+
+		DirectX::XMFLOAT4X4 world;
+		DirectX::XMStoreFloat4x4(&world, DirectX::XMMatrixTranslation(
+			spacing * static_cast<float>(iii % side) - halfExtent,
+			spacing * static_cast<float>(iii / side) - halfExtent,
+			0.0f));
+
+		RenderItem& ri = layer.RenderItems.emplace_back();
+		object.Item = &ri;
+		ri.SetSubmeshIndex(0);
+		ri.ThreadSafeUpdate = settings.ThreadSafeUpdate;
+		ri.SetUpdateMode(settings.UpdateMode);
+		ri.SetWorldTransform(world);
+
+		auto& cbv = ri.ConstantBufferViews.emplace_back(0, object.ConstantsCB.get());
+		cbv.Update = [cb = object.ConstantsCB.get(), world, animate = settings.Animate, phase = static_cast<float>(iii)](const Timer& timer, int frameIndex)
+		{
+			DirectX::XMMATRIX transform = DirectX::XMLoadFloat4x4(&world);
+			if (animate)
+				transform = DirectX::XMMatrixMultiply(DirectX::XMMatrixRotationY(timer.TotalTime() + phase), transform);
+
+			ObjectConstants constants;
+			DirectX::XMStoreFloat4x4(&constants.World, DirectX::XMMatrixTranspose(transform));
+			cb->CopyData(frameIndex, constants);
+		};
+	}
+}
+
+FrameTimings HeadlessScene::RunFrame()
+{
+	FrameTimings timings;
+	Stopwatch frame;
+	Stopwatch phase;
+
+	m_timer.Tick();
+	Engine::SetCullingCamera(m_camera);
+	Engine::Update(m_timer);
+	timings.Update = phase.ElapsedMicroseconds();
+
+	phase.Restart();
+	Engine::Render();
+	timings.Render = phase.ElapsedMicroseconds();
+
+	phase.Restart();
+	Engine::Present();
+	timings.Present = phase.ElapsedMicroseconds();
+
+	timings.Total = frame.ElapsedMicroseconds();
+	return timings;
+}
+void HeadlessScene::RunFrames(unsigned int count)
+{
+	for (unsigned int iii = 0; iii < count; ++iii)
+		RunFrame();
+}
+}
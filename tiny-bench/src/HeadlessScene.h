@@ -0,0 +1,90 @@
+#pragma once
+#include "Benchmark.h"
+
+namespace bench
+{
+struct BoxVertex
+{
+	DirectX::XMFLOAT3 Pos;
+};
+
+struct ObjectConstants
+{
+	DirectX::XMFLOAT4X4 World = tiny::MathHelper::Identity4x4();
+};
+
+struct PassConstants
+{
+	DirectX::XMFLOAT4X4 ViewProj = tiny::MathHelper::Identity4x4();
+};
+
+// CPU time spent in each phase of a single frame (microseconds)
+struct FrameTimings
+{
+	double Update = 0.0;
+	double Render = 0.0;
+	double Present = 0.0;
+	double Total = 0.0;
+};
+
+struct ItemSettings
+{
+	tiny::RenderItem::UpdateMode UpdateMode = tiny::RenderItem::UpdateMode::EveryFrame;
+	bool ThreadSafeUpdate = true;	// Every item writes only its own constant buffer, so this is safe
+	bool Animate = false;			// Spin every box, so that Update() does some math instead of just a copy
+};
+
+// A grid of small boxes drawn by a single render pass with a single layer. Every box is its own render item with its
+// own per-object constant buffer, so the per-item cost of the Engine is what dominates the frame.
+// The scene runs on a headless DeviceResources (no window, no swap chain, WARP adapter), so the real
+// Update/Render/Present loop can be driven from a console process. Only one scene may exist at a time because it
+// initializes the Engine
+class HeadlessScene
+{
+public:
+	HeadlessScene(int height = 720, int width = 1280);
+	HeadlessScene(const HeadlessScene&) = delete;
+	HeadlessScene& operator=(const HeadlessScene&) = delete;
+	~HeadlessScene() noexcept;
+
+	// Replaces every item in the scene with 'count' new items
+	void Populate(unsigned int count, const ItemSettings& settings = {});
+	ND inline unsigned int GetItemCount() const noexcept { return static_cast<unsigned int>(m_objects.size()); }
+
+	FrameTimings RunFrame();
+	void RunFrames(unsigned int count);
+
+	ND inline tiny::RenderPassLayer& GetLayer() noexcept { return m_renderPass.RenderPassLayers[0]; }
+	ND inline std::vector<tiny::ConstantBufferT<ObjectConstants>*> GetConstantBuffers() const
+	{
+		std::vector<tiny::ConstantBufferT<ObjectConstants>*> buffers(m_objects.size());
+		for (size_t iii = 0; iii < m_objects.size(); ++iii)
+			buffers[iii] = m_objects[iii].ConstantsCB.get();
+		return buffers;
+	}
+	ND inline const std::shared_ptr<tiny::DeviceResources>& GetDeviceResources() const noexcept { return m_deviceResources; }
+
+private:
+	void BuildRenderPass();
+
+	std::shared_ptr<tiny::DeviceResources> m_deviceResources;
+	tiny::Timer m_timer;
+	tiny::Camera m_camera;
+
+	tiny::RenderPass m_renderPass;
+	std::unique_ptr<tiny::ConstantBufferT<PassConstants>> m_passConstantsCB = nullptr;
+	std::unique_ptr<tiny::Shader> m_vertexShader = nullptr;
+	std::unique_ptr<tiny::Shader> m_pixelShader = nullptr;
+	std::unique_ptr<tiny::InputLayout> m_inputLayout = nullptr;
+	std::unique_ptr<tiny::RasterizerState> m_rasterizerState = nullptr;
+	std::unique_ptr<tiny::BlendState> m_blendState = nullptr;
+	std::unique_ptr<tiny::DepthStencilState> m_depthStencilState = nullptr;
+
+	struct Object
+	{
+		std::unique_ptr<tiny::ConstantBufferT<ObjectConstants>> ConstantsCB = nullptr;
+		tiny::RenderItem* Item = nullptr;
+	};
+	std::vector<Object> m_objects;
+};
+}
@@ -0,0 +1,114 @@
+#include "Benchmark.h"
+
+#include <charconv>
+#include <iostream>
+
+// Required by tiny's Texture.h. Only benchmarks that load textures through TextureManager fill in the list (see
+// bench::GetTextureFiles()), so it is usually empty
+std::wstring GetTextureFilename(unsigned int index)
+{
+	return bench::GetTextureFiles()[index];
+}
+std::size_t GetTotalTextureCount()
+{
+	return bench::GetTextureFiles().size();
+}
+
+namespace
+{
+void PrintUsage()
+{
+	std::cout << "usage: tiny-bench <benchmark> [--frames N] [--warmup N] [--items N] [--repeat N] [--path P]\n"
+				 "       tiny-bench --list\n\n"
+				 "Benchmarks that draw run on a headless device (no window or swap chain) created on the WARP adapter,\n"
+				 "so no GPU is needed, but they do need Windows and D3D12. CPU timings are what they are meant to measure.\n";
+}
+void PrintBenchmarks()
+{
+	std::vector<bench::BenchmarkInfo> benchmarks = bench::GetBenchmarks();
+	std::sort(benchmarks.begin(), benchmarks.end(), [](const auto& lhs, const auto& rhs) { return std::string_view(lhs.Name) < std::string_view(rhs.Name); });
+	for (const bench::BenchmarkInfo& benchmark : benchmarks)
+		std::cout << std::format("  {:<18}{}\n", benchmark.Name, benchmark.Description);
+}
+bool ParseUnsigned(const char* text, unsigned int& value)
+{
+	std::string_view sv(text);
+	auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), value);
+	return ec == std::errc() && ptr == sv.data() + sv.size();
+}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::string_view name(argv[1]);
+	if (name == "--list")
+	{
+		PrintBenchmarks();
+		return 0;
+	}
+
+	bench::Options options;
+	for (int iii = 2; iii < argc; ++iii)
+	{
+		std::string_view arg(argv[iii]);
+		if (iii + 1 >= argc)
+		{
+			std::cerr << std::format("Missing value for '{}'\n", arg);
+			return 1;
+		}
+
+		const char* value = argv[++iii];
+		bool ok = true;
+		if (arg == "--frames")
+			ok = ParseUnsigned(value, options.Frames);
+		else if (arg == "--warmup")
+			ok = ParseUnsigned(value, options.WarmupFrames);
+		else if (arg == "--items")
+			ok = ParseUnsigned(value, options.Items);
+		else if (arg == "--repeat")
+			ok = ParseUnsigned(value, options.Repetitions) && options.Repetitions > 0;
+		else if (arg == "--path")
+			options.Path = value;
+		else
+		{
+			std::cerr << std::format("Unknown option '{}'\n", arg);
+			PrintUsage();
+			return 1;
+		}
+
+		if (!ok)
+		{
+			std::cerr << std::format("Invalid value '{}' for '{}'\n", value, arg);
+			return 1;
+		}
+	}
+
+	const auto& benchmarks = bench::GetBenchmarks();
+	auto benchmark = std::find_if(benchmarks.begin(), benchmarks.end(), [name](const bench::BenchmarkInfo& info) { return name == info.Name; });
+	if (benchmark == benchmarks.end())
+	{
+		std::cerr << std::format("Unknown benchmark '{}'. Available benchmarks:\n", name);
+		PrintBenchmarks();
+		return 1;
+	}
+
+	try
+	{
+		return benchmark->Run(options);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+	}
+	catch (...)
+	{
+		std::cerr << "Unknown exception\n";
+	}
+	return 1;
+}
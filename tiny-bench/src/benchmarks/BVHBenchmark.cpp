@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+#include "tiny/scene/BoundingVolumeHierarchy.h"
+
+#include <random>
+
+using namespace tiny;
+
+namespace bench
+{
+struct Box
+{
+	DirectX::BoundingBox Bounds;
+	int Proxy = BoundingVolumeHierarchy<Box>::NullNode;
+};
+
+// CPU only: frustum queries against N random boxes, brute force (what FrustumCull layers below
+// Engine::MinItemsForBVHCulling do) vs BoundingVolumeHierarchy::ForEachOutside (what larger layers do). Both must find
+// the same number of culled boxes, otherwise the benchmark fails
+TINY_BENCHMARK(bvh, "Frustum query time, brute force vs BVH, for N random boxes (--items, --repeat)")
+{
+	// The camera sits at the edge of the volume looking in, so roughly a quarter of the boxes are visible
+	const float halfExtent = 1000.0f;
+	Camera camera;
+	camera.SetLens(0.25f * MathHelper::Pi, 16.0f / 9.0f, 1.0f, 2.0f * halfExtent);
+	camera.LookAt(DirectX::XMFLOAT3(0.0f, 0.0f, -halfExtent), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f));
+	camera.UpdateViewMatrix();
+
+	DirectX::XMVECTOR planes[6];
+	camera.GetWorldFrustum().GetPlanes(&planes[0], &planes[1], &planes[2], &planes[3], &planes[4], &planes[5]);
+
+	std::mt19937 generator(1234);
+	std::uniform_real_distribution<float> position(-halfExtent, halfExtent);
+	std::uniform_real_distribution<float> extent(0.5f, 3.0f);
+
+	for (unsigned int count : ItemCounts(options, { 10000, 100000, 1000000 }))
+	{
+		std::vector<Box> boxes(count);
+		BoundingVolumeHierarchy<Box> bvh;
+
+		Stopwatch stopwatch;
+		for (Box& box : boxes)
+		{
+			box.Bounds.Center = { position(generator), position(generator), position(generator) };
+			box.Bounds.Extents = { extent(generator), extent(generator), extent(generator) };
+			box.Proxy = bvh.Insert(box.Bounds, &box);
+		}
+		const double insertTime = stopwatch.ElapsedMicroseconds();
+		const int insertHeight = bvh.GetHeight();
+
+		stopwatch.Restart();
+		bvh.Rebuild();
+		const double rebuildTime = stopwatch.ElapsedMicroseconds();
+
+		double bruteForce = DBL_MAX;
+		double tree = DBL_MAX;
+		size_t bruteForceCulled = 0;
+		size_t treeCulled = 0;
+		for (unsigned int rep = 0; rep < options.Repetitions; ++rep)
+		{
+			bruteForceCulled = 0;
+			stopwatch.Restart();
+			for (const Box& box : boxes)
+			{
+				if (box.Bounds.ContainedBy(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5]) == DirectX::DISJOINT)
+					++bruteForceCulled;
+			}
+			bruteForce = std::min(bruteForce, stopwatch.ElapsedMicroseconds());
+
+			treeCulled = 0;
+			stopwatch.Restart();
+			bvh.ForEachOutside(planes, [&treeCulled](Box*) { ++treeCulled; });
+			tree = std::min(tree, stopwatch.ElapsedMicroseconds());
+		}
+
+		if (bruteForceCulled != treeCulled)
+			throw std::runtime_error(std::format("BVH culled {} boxes, brute force culled {}", treeCulled, bruteForceCulled));
+
+		// Moving every 7th box is what refitting costs when a part of the scene is animated
+		stopwatch.Restart();
+		for (size_t iii = 0; iii < boxes.size(); iii += 7)
+		{
+			boxes[iii].Bounds.Center.x += 5.0f;
+			bvh.Refit(boxes[iii].Proxy, boxes[iii].Bounds);
+		}
+		const double refitTime = stopwatch.ElapsedMicroseconds();
+
+		PrintHeader(std::format("BVH frustum query: {} boxes, {} culled, best of {}", count, treeCulled, options.Repetitions));
+		PrintValue("Brute force query", bruteForce, "us");
+		PrintValue("BVH query", tree, "us");
+		PrintValue("Speedup", tree > 0.0 ? bruteForce / tree : 0.0, "x");
+		PrintValue("Incremental insert (all boxes)", insertTime, "us");
+		PrintValue("Rebuild", rebuildTime, "us");
+		PrintValue(std::format("Refit ({} boxes)", (boxes.size() + 6) / 7), refitTime, "us");
+		PrintValue("Tree height after inserts", insertHeight, "");
+		PrintValue("Tree height after rebuild", bvh.GetHeight(), "");
+	}
+	return 0;
+}
+}
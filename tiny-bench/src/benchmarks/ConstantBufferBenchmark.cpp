@@ -0,0 +1,88 @@
+#include "../HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+// Before the UploadRing, every ConstantBufferT created its own committed upload buffer holding one copy of the data
+// per frame resource. Creating that many committed resources is what this compares against. Committed resources are
+// 64KB aligned, so past this count the old layout is only estimated rather than actually allocated
+static constexpr unsigned int MaxCommittedBuffers = 10000;
+
+static double CreateCommittedBuffers(ID3D12Device* device, unsigned int count, UINT64 byteSize)
+{
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> buffers(count);
+	auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+
+	Stopwatch stopwatch;
+	for (auto& buffer : buffers)
+	{
+		GFX_THROW_INFO(
+			device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(buffer.GetAddressOf()))
+		);
+
+		// The old constant buffers stayed mapped for their whole lifetime
+		BYTE* mapped = nullptr;
+		GFX_THROW_INFO(buffer->Map(0, nullptr, reinterpret_cast<void**>(&mapped)));
+	}
+	return stopwatch.ElapsedMicroseconds();
+}
+
+TINY_BENCHMARK(constantbuffers, "Creation cost and memory footprint of N constant buffers, UploadRing vs one committed buffer each (--items, --repeat)")
+{
+	HeadlessScene scene;
+	ID3D12Device* device = scene.GetDeviceResources()->GetDevice();
+
+	const UINT64 elementByteSize = (sizeof(ObjectConstants) + 255) & ~255ull;
+	const UINT64 committedByteSize = elementByteSize * Engine::GetFrameResourceCount();
+	auto committedDesc = CD3DX12_RESOURCE_DESC::Buffer(committedByteSize);
+	const UINT64 committedFootprint = device->GetResourceAllocationInfo(0, 1, &committedDesc).SizeInBytes;
+
+	for (unsigned int count : ItemCounts(options, { 1000, 10000, 100000 }))
+	{
+		PrintHeader(std::format("Constant buffers: {} x {} bytes, {} frame resources", count, sizeof(ObjectConstants), Engine::GetFrameResourceCount()));
+
+		// Creation cost (best of N)
+		double ringCreate = DBL_MAX;
+		for (unsigned int rep = 0; rep < options.Repetitions; ++rep)
+		{
+			std::vector<std::unique_ptr<ConstantBufferT<ObjectConstants>>> buffers(count);
+			Stopwatch stopwatch;
+			for (auto& buffer : buffers)
+				buffer = std::make_unique<ConstantBufferT<ObjectConstants>>(scene.GetDeviceResources());
+			ringCreate = MathHelper::Min(ringCreate, stopwatch.ElapsedMicroseconds());
+		}
+
+		PrintValue("ConstantBufferT create (total)", ringCreate, "us");
+		PrintValue("ConstantBufferT create (per buffer)", ringCreate / count, "us");
+
+		if (count <= MaxCommittedBuffers)
+		{
+			double committedCreate = DBL_MAX;
+			for (unsigned int rep = 0; rep < options.Repetitions; ++rep)
+				committedCreate = MathHelper::Min(committedCreate, CreateCommittedBuffers(device, count, committedByteSize));
+
+			PrintValue("Committed buffer create (total)", committedCreate, "us");
+			PrintValue("Committed buffer create (per buffer)", committedCreate / count, "us");
+		}
+		else
+		{
+			PrintValue("Committed buffer create", 0.0, "(skipped, see MaxCommittedBuffers)");
+		}
+
+		// Footprint. The CPU copy is the only per-buffer cost now, the GPU side is however many UploadRing pages it
+		// takes to hold one frame's worth of data for every buffer (measured by actually drawing them)
+		scene.Populate(count);
+		scene.RunFrames(2 * Engine::GetFrameResourceCount());
+
+		PrintBytes("ConstantBufferT CPU bytes", static_cast<UINT64>(count) * (sizeof(ConstantBufferT<ObjectConstants>) + sizeof(ObjectConstants)));
+		PrintBytes("UploadRing capacity (all frames)", Engine::GetUploadRing().CapacityInBytes());
+		PrintBytes("UploadRing peak bytes per frame", Engine::GetUploadRing().PeakBytesPerFrame());
+		PrintBytes(count <= MaxCommittedBuffers ? "Committed buffers GPU bytes" : "Committed buffers GPU bytes (estimate)", static_cast<UINT64>(count) * committedFootprint);
+
+		scene.Populate(0);
+	}
+	return 0;
+}
+}
@@ -0,0 +1,72 @@
+#include "../Benchmark.h"
+#include "tiny/utils/DDSParser.h"
+
+#include <fstream>
+#include <iostream>
+
+using namespace tiny;
+
+namespace bench
+{
+static std::vector<uint8_t> ReadFile(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+		throw std::runtime_error(std::format("Failed to open '{}'", path.string()));
+
+	return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Only dds::Parse() is timed (header decoding, validation and building the subresource table). The files are read
+// into memory first, so the disk is not part of the measurement. MB/s is how much file data gets validated per second
+TINY_BENCHMARK(dds, "Parse every .dds file under --path (default: the sandbox textures) with dds::Parse() and report ns per file and MB/s (--repeat)")
+{
+	const std::filesystem::path path = options.Path.empty() ? DefaultTexturePath : options.Path;
+	const std::vector<std::filesystem::path> paths = FindDDSFiles(path);
+	if (paths.empty())
+		throw std::runtime_error(std::format("No .dds files found at '{}'", path.string()));
+
+	std::vector<std::vector<uint8_t>> files;
+	files.reserve(paths.size());
+	UINT64 totalBytes = 0;
+
+	PrintHeader(std::format("DDS parser: {} files from '{}'", paths.size(), path.string()));
+	for (const std::filesystem::path& filePath : paths)
+	{
+		std::vector<uint8_t>& file = files.emplace_back(ReadFile(filePath));
+		totalBytes += file.size();
+
+		dds::ParsedTexture texture;
+		dds::Result result = dds::Parse(file, texture);
+		std::cout << std::format("  {:<32}{:<10}{:>6}x{:<6} mips {:<3} array {:<5}{} bytes\n", filePath.filename().string(), dds::ToString(result),
+			texture.Desc.Width, texture.Desc.Height, texture.Desc.MipCount, texture.Desc.ArraySize, file.size());
+	}
+
+	// Parse the whole set enough times that one pass takes a measurable amount of time
+	const unsigned int passes = std::max(1u, static_cast<unsigned int>(20000 / files.size()));
+
+	dds::ParsedTexture texture;
+	size_t subresources = 0; // Keeps the parse from being optimized away
+	double best = DBL_MAX;
+	for (unsigned int rep = 0; rep < options.Repetitions; ++rep)
+	{
+		Stopwatch stopwatch;
+		for (unsigned int pass = 0; pass < passes; ++pass)
+		{
+			for (const std::vector<uint8_t>& file : files)
+			{
+				(void)dds::Parse(file, texture);
+				subresources += texture.Subresources.size();
+			}
+		}
+		best = std::min(best, stopwatch.ElapsedMicroseconds());
+	}
+
+	const double parses = static_cast<double>(passes) * static_cast<double>(files.size());
+	PrintBytes("File data", totalBytes);
+	PrintValue("Parse (per file)", 1000.0 * best / parses, "ns");
+	PrintValue("Throughput", static_cast<double>(totalBytes) * passes / best, "MB/s");
+	PrintValue("Subresources (all parses)", static_cast<double>(subresources), "");
+	return 0;
+}
+}
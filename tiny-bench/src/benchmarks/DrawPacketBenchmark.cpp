@@ -0,0 +1,62 @@
+#include "../HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+static Samples MeasureRecording(HeadlessScene& scene, const Options& options)
+{
+	scene.RunFrames(options.WarmupFrames);
+
+	Samples samples;
+	samples.Reserve(options.Frames);
+	for (unsigned int iii = 0; iii < options.Frames; ++iii)
+	{
+		scene.RunFrame();
+		samples.Add(static_cast<double>(Engine::GetRenderStats().RecordingMicroseconds));
+	}
+	return samples;
+}
+
+// The items are static (WhenDirty), which is the case draw packets are meant for. Both paths are measured with
+// parallel recording off and on, because replay changes how much work is left for the workers
+TINY_BENCHMARK(drawpackets, "Recording time of a compiled layer, item loop vs draw-packet replay (--items, --frames, --warmup)")
+{
+	HeadlessScene scene;
+	RenderPassLayer& layer = scene.GetLayer();
+	layer.CompileDrawPackets = true;
+
+	const bool parallelRecording = Engine::GetParallelRecording();
+	const bool drawPacketReplay = Engine::GetDrawPacketReplay();
+
+	for (unsigned int count : ItemCounts(options, { 10000, 100000 }))
+	{
+		scene.Populate(count, { .UpdateMode = RenderItem::UpdateMode::WhenDirty });
+
+		PrintHeader(std::format("Draw packets: {} static items, {} frames", count, options.Frames));
+		PrintSamplesHeader("us");
+		for (bool parallel : { false, true })
+		{
+			Engine::SetParallelRecording(parallel);
+
+			Engine::SetDrawPacketReplay(false);
+			Samples loop = MeasureRecording(scene, options);
+
+			Engine::SetDrawPacketReplay(true);
+			Samples replay = MeasureRecording(scene, options);
+
+			PrintSamples(parallel ? "Item loop (parallel)" : "Item loop (serial)", loop);
+			PrintSamples(parallel ? "Replay (parallel)" : "Replay (serial)", replay);
+		}
+
+		const Engine::RenderStats& stats = Engine::GetRenderStats();
+		PrintValue("Draw calls (last frame)", stats.DrawCalls, "");
+		PrintValue("Command lists (last frame)", stats.CommandLists, "");
+		PrintValue("Draw packet compiles (last frame)", stats.DrawPacketCompiles, "");
+	}
+
+	Engine::SetParallelRecording(parallelRecording);
+	Engine::SetDrawPacketReplay(drawPacketReplay);
+	return 0;
+}
+}
@@ -0,0 +1,85 @@
+#include "../HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+// FramePacer's histograms accumulate for the lifetime of the Engine, so a run is measured as the difference between
+// a copy taken before it and the histogram after it
+struct HistogramDelta
+{
+	HistogramDelta(const utility::Histogram& before, const utility::Histogram& after) :
+		After(after),
+		Counts(after.Counts()),
+		TotalCount(after.TotalCount() - before.TotalCount())
+	{
+		for (size_t iii = 0; iii < Counts.size(); ++iii)
+			Counts[iii] -= before.Count(iii);
+
+		const double sum = after.Mean() * static_cast<double>(after.TotalCount()) - before.Mean() * static_cast<double>(before.TotalCount());
+		Mean = TotalCount > 0 ? sum / static_cast<double>(TotalCount) : 0.0;
+	}
+
+	// Upper bound of the bucket holding the p-th percentile (see utility::Histogram::Percentile)
+	ND double Percentile(double p) const noexcept
+	{
+		const UINT64 target = static_cast<UINT64>(std::ceil(p / 100.0 * static_cast<double>(TotalCount)));
+		UINT64 seen = 0;
+		for (size_t iii = 0; iii < Counts.size(); ++iii)
+		{
+			seen += Counts[iii];
+			if (seen >= target)
+				return iii + 1 < Counts.size() ? After.UpperBound(iii) : After.Max();
+		}
+		return After.Max();
+	}
+
+	const utility::Histogram& After;
+	std::vector<UINT64> Counts;
+	UINT64 TotalCount = 0;
+	double Mean = 0.0;
+};
+
+// Throughput (frame time) vs latency for every supported number of frame resources. More frame resources let the CPU
+// run further ahead of the GPU, which should show up as less time stalled on the fence and more latency
+TINY_BENCHMARK(frameresources, "Frame time, CPU stall and frame latency for 1-4 frame resources (--items, --frames, --warmup)")
+{
+	HeadlessScene scene;
+	scene.Populate(options.Items > 0 ? options.Items : 10000, { .Animate = true });
+
+	const unsigned int frameResourceCount = Engine::GetFrameResourceCount();
+
+	for (unsigned int count = gMinFrameResources; count <= gMaxFrameResources; ++count)
+	{
+		Engine::SetFrameResourceCount(count);
+		scene.RunFrames(options.WarmupFrames);
+
+		const FramePacer& pacer = Engine::GetFramePacer();
+		const utility::Histogram latencyBefore = pacer.GetLatencyHistogram();
+
+		Samples frame, stall;
+		frame.Reserve(options.Frames);
+		stall.Reserve(options.Frames);
+		for (unsigned int iii = 0; iii < options.Frames; ++iii)
+		{
+			frame.Add(scene.RunFrame().Total);
+			stall.Add(static_cast<double>(pacer.GetFrameTimings().CPUStallMicroseconds));
+		}
+
+		HistogramDelta latency(latencyBefore, pacer.GetLatencyHistogram());
+
+		PrintHeader(std::format("Frame resources: {} ({} items, {} frames, max {} frames in flight)", count, scene.GetItemCount(), options.Frames, pacer.GetMaxFramesInFlight()));
+		PrintSamplesHeader("us");
+		PrintSamples("Frame (CPU)", frame);
+		PrintSamples("CPU stall on fence", stall);
+		PrintValue("Frames per second (mean)", frame.Mean() > 0.0 ? 1000000.0 / frame.Mean() : 0.0, "");
+		PrintValue("Latency mean", latency.Mean, "us");
+		PrintValue("Latency p50 (bucket upper bound)", latency.Percentile(50.0), "us");
+		PrintValue("Latency p99 (bucket upper bound)", latency.Percentile(99.0), "us");
+		PrintValue("Latency samples", static_cast<double>(latency.TotalCount), "");
+	}
+
+	Engine::SetFrameResourceCount(frameResourceCount);
+	return 0;
+}
+}
@@ -0,0 +1,38 @@
+#include "../HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+// The plain frame loop. Every item is animated, so Update() does real work each frame. Useful as a smoke test (any
+// D3D12 error throws and the process exits with a non-zero code) and as a baseline for the other benchmarks
+TINY_BENCHMARK(headless, "Run N frames of the frame loop without a window and report the CPU time of Update/Render/Present (--frames, --warmup, --items)")
+{
+	HeadlessScene scene;
+	scene.Populate(options.Items > 0 ? options.Items : 10000, { .Animate = true });
+	scene.RunFrames(options.WarmupFrames);
+
+	Samples update, render, present, total;
+	for (unsigned int iii = 0; iii < options.Frames; ++iii)
+	{
+		FrameTimings timings = scene.RunFrame();
+		update.Add(timings.Update);
+		render.Add(timings.Render);
+		present.Add(timings.Present);
+		total.Add(timings.Total);
+	}
+
+	PrintHeader(std::format("Headless frame loop: {} items, {} frames, {} frame resources", scene.GetItemCount(), options.Frames, Engine::GetFrameResourceCount()));
+	PrintSamplesHeader("us");
+	PrintSamples("Update", update);
+	PrintSamples("Render", render);
+	PrintSamples("Present", present);
+	PrintSamples("Frame", total);
+
+	const Engine::RenderStats& stats = Engine::GetRenderStats();
+	PrintValue("Draw calls (last frame)", stats.DrawCalls, "");
+	PrintValue("Command lists (last frame)", stats.CommandLists, "");
+	PrintBytes("Upload ring peak per frame", Engine::GetUploadRing().PeakBytesPerFrame());
+	return 0;
+}
+}
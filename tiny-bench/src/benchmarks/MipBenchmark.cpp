@@ -0,0 +1,98 @@
+#include "../Benchmark.h"
+#include "tiny/utils/BlockCompression.h"
+#include "tiny/utils/MipChain.h"
+
+#include <random>
+
+using namespace tiny;
+
+namespace bench
+{
+static constexpr uint32_t ImageSize = 1024;
+
+// Smooth gradients with some noise on top, so the filters and the block endpoint fits have real work to do (a flat
+// image would make every BC block trivial)
+static std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height)
+{
+	std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+	std::mt19937 generator(1234);
+	std::uniform_int_distribution<int> noise(-16, 16);
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			uint8_t* texel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+			texel[0] = static_cast<uint8_t>(std::clamp(static_cast<int>(255 * x / width) + noise(generator), 0, 255));
+			texel[1] = static_cast<uint8_t>(std::clamp(static_cast<int>(255 * y / height) + noise(generator), 0, 255));
+			texel[2] = static_cast<uint8_t>(std::clamp(static_cast<int>(((x ^ y) & 0xff)) + noise(generator), 0, 255));
+			texel[3] = 255;
+		}
+	}
+	return pixels;
+}
+
+// Best of 'repetitions' runs of 'function', in microseconds
+template<typename F>
+static double BestOf(unsigned int repetitions, F&& function)
+{
+	double best = DBL_MAX;
+	for (unsigned int rep = 0; rep < repetitions; ++rep)
+	{
+		Stopwatch stopwatch;
+		function();
+		best = std::min(best, stopwatch.ElapsedMicroseconds());
+	}
+	return best;
+}
+
+// Both are timed on a single thread over the same R8G8B8A8 image. MB/s is how much level 0 data gets processed per
+// second: for mips::Generate() that is the source of the whole chain, for bc::CompressBlockRows() the surface being
+// compressed
+TINY_BENCHMARK(mips, "Generate a full mip chain with mips::Generate() (Box and Kaiser) and compress a surface with bc::CompressBlockRows() (BC1, BC4 and BC5), and report ms and MB/s (--repeat)")
+{
+	const std::vector<uint8_t> pixels = MakeImage(ImageSize, ImageSize);
+	const size_t rowPitch = static_cast<size_t>(ImageSize) * 4;
+
+	PrintHeader(std::format("Mip chain + block compression: {}x{} R8G8B8A8 ({} levels, best of {})", ImageSize, ImageSize,
+		mips::FullMipCount(ImageSize, ImageSize), options.Repetitions));
+
+	size_t checksum = 0; // Keeps the work from being optimized away
+	for (mips::Filter filter : { mips::Filter::Box, mips::Filter::Kaiser })
+	{
+		for (DXGI_FORMAT format : { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB })
+		{
+			const double best = BestOf(options.Repetitions, [&]()
+			{
+				std::vector<mips::Level> levels = mips::Generate(format, pixels.data(), ImageSize, ImageSize, rowPitch, filter);
+				checksum += levels.back().Data[0];
+			});
+
+			const std::string label = std::format("Generate {}{}", filter == mips::Filter::Box ? "Box" : "Kaiser",
+				format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ? " sRGB" : "");
+			PrintValue(std::format("{} time", label), best / 1000.0, "ms");
+			PrintValue(std::format("{} throughput", label), static_cast<double>(pixels.size()) / best, "MB/s");
+		}
+	}
+
+	for (DXGI_FORMAT format : { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC5_UNORM })
+	{
+		const size_t blockRowPitch = bc::RowPitch(format, ImageSize);
+		const uint32_t blockRows = bc::BlockCount(ImageSize);
+		std::vector<uint8_t> blocks(blockRowPitch * blockRows);
+
+		const double best = BestOf(options.Repetitions, [&]()
+		{
+			bc::CompressBlockRows(format, pixels.data(), ImageSize, ImageSize, rowPitch, blocks.data(), blockRowPitch, 0, blockRows);
+			checksum += blocks.back();
+		});
+
+		const char* name = format == DXGI_FORMAT_BC1_UNORM ? "BC1" : format == DXGI_FORMAT_BC4_UNORM ? "BC4" : "BC5";
+		PrintValue(std::format("Compress {} time", name), best / 1000.0, "ms");
+		PrintValue(std::format("Compress {} throughput", name), static_cast<double>(pixels.size()) / best, "MB/s");
+	}
+
+	PrintValue("Checksum", static_cast<double>(checksum), "");
+	return 0;
+}
+}
@@ -0,0 +1,149 @@
+#include "../HeadlessScene.h"
+#include "tiny/utils/SlotMap.h"
+
+#include <numeric>
+#include <random>
+
+using namespace tiny;
+
+namespace bench
+{
+// The old registries did a std::find on every add (to skip duplicates) and every remove, so N items cost O(N^2).
+// Past this count a single run takes seconds, so the vector is skipped
+static constexpr unsigned int MaxVectorItems = 50000;
+
+struct RegistrationTimings
+{
+	double Add = DBL_MAX;
+	double Remove = DBL_MAX;
+};
+
+static RegistrationTimings TimeVector(const std::vector<int*>& values, const std::vector<int*>& removeOrder)
+{
+	RegistrationTimings timings;
+	std::vector<int*> registry;
+
+	Stopwatch stopwatch;
+	for (int* value : values)
+	{
+		if (std::find(registry.begin(), registry.end(), value) == registry.end())
+			registry.push_back(value);
+	}
+	timings.Add = stopwatch.ElapsedMicroseconds();
+
+	stopwatch.Restart();
+	for (int* value : removeOrder)
+	{
+		auto position = std::find(registry.begin(), registry.end(), value);
+		if (position != registry.end())
+			registry.erase(position);
+	}
+	timings.Remove = stopwatch.ElapsedMicroseconds();
+
+	TINY_ASSERT(registry.empty(), "Every value should have been removed");
+	return timings;
+}
+static RegistrationTimings TimeSlotMap(const std::vector<int*>& values, const std::vector<size_t>& removeOrder)
+{
+	RegistrationTimings timings;
+	utility::SlotMap<int> registry;
+	std::vector<utility::SlotMapHandle> handles(values.size());
+
+	Stopwatch stopwatch;
+	for (size_t iii = 0; iii < values.size(); ++iii)
+	{
+		// Mirrors the Engine, which keeps the handle in the item and skips the insert if it is already valid
+		if (!handles[iii].IsValid())
+			handles[iii] = registry.Insert(values[iii]);
+	}
+	timings.Add = stopwatch.ElapsedMicroseconds();
+
+	stopwatch.Restart();
+	for (size_t index : removeOrder)
+		registry.Remove(handles[index]);
+	timings.Remove = stopwatch.ElapsedMicroseconds();
+
+	TINY_ASSERT(registry.size() == 0, "Every value should have been removed");
+	return timings;
+}
+static RegistrationTimings TimeRenderItems(RenderPassLayer& layer, unsigned int count, const std::vector<size_t>& removeOrder)
+{
+	RegistrationTimings timings;
+	std::vector<RenderItem*> items(count);
+
+	Stopwatch stopwatch;
+	for (RenderItem*& item : items)
+		item = &layer.RenderItems.emplace_back(); // Registers the item with the Engine
+	timings.Add = stopwatch.ElapsedMicroseconds();
+
+	stopwatch.Restart();
+	for (size_t index : removeOrder)
+		layer.RemoveRenderItem(items[index]);	// Unregisters the item
+	timings.Remove = stopwatch.ElapsedMicroseconds();
+
+	return timings;
+}
+
+// Removal happens in a random order, because removing from the back is the one case the vector handles well
+TINY_BENCHMARK(registration, "Item registration cost: SlotMap vs vector + std::find, and RenderItem emplace/erase through the Engine (--items, --repeat)")
+{
+	HeadlessScene scene;
+	scene.Populate(0);
+	RenderPassLayer& layer = scene.GetLayer();
+
+	std::mt19937 generator(1234);
+
+	for (unsigned int count : ItemCounts(options, { 1000, 10000, 100000 }))
+	{
+		std::vector<int> storage(count);
+		std::vector<int*> values(count);
+		for (unsigned int iii = 0; iii < count; ++iii)
+			values[iii] = &storage[iii];
+
+		std::vector<size_t> removeOrder(count);
+		std::iota(removeOrder.begin(), removeOrder.end(), size_t{ 0 });
+		std::shuffle(removeOrder.begin(), removeOrder.end(), generator);
+
+		std::vector<int*> removeValues(count);
+		for (unsigned int iii = 0; iii < count; ++iii)
+			removeValues[iii] = values[removeOrder[iii]];
+
+		RegistrationTimings vector, slotMap, renderItems;
+		for (unsigned int rep = 0; rep < options.Repetitions; ++rep)
+		{
+			if (count <= MaxVectorItems)
+			{
+				RegistrationTimings t = TimeVector(values, removeValues);
+				vector.Add = std::min(vector.Add, t.Add);
+				vector.Remove = std::min(vector.Remove, t.Remove);
+			}
+
+			RegistrationTimings t = TimeSlotMap(values, removeOrder);
+			slotMap.Add = std::min(slotMap.Add, t.Add);
+			slotMap.Remove = std::min(slotMap.Remove, t.Remove);
+
+			t = TimeRenderItems(layer, count, removeOrder);
+			renderItems.Add = std::min(renderItems.Add, t.Add);
+			renderItems.Remove = std::min(renderItems.Remove, t.Remove);
+		}
+
+		PrintHeader(std::format("Registration: {} items, best of {}", count, options.Repetitions));
+		if (count <= MaxVectorItems)
+		{
+			PrintValue("vector + std::find add", vector.Add, "us");
+			PrintValue("vector + std::find remove", vector.Remove, "us");
+		}
+		else
+		{
+			PrintValue("vector + std::find", 0.0, "(skipped, see MaxVectorItems)");
+		}
+		PrintValue("SlotMap add", slotMap.Add, "us");
+		PrintValue("SlotMap remove", slotMap.Remove, "us");
+		PrintValue("RenderItem emplace_back", renderItems.Add, "us");
+		PrintValue("RenderItem remove", renderItems.Remove, "us");
+		PrintValue("RenderItem emplace_back (per item)", 1000.0 * renderItems.Add / count, "ns");
+		PrintValue("RenderItem remove (per item)", 1000.0 * renderItems.Remove / count, "ns");
+	}
+	return 0;
+}
+}
@@ -0,0 +1,108 @@
+#include "../HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+// Each mesh group holds the scene's box (so the items draw the same thing whichever one is bound) followed by this
+// many unused vertices, so that it is big enough for the budget to matter
+static constexpr unsigned int PaddingVertices = (4 * 1024 * 1024) / sizeof(BoxVertex);
+static constexpr unsigned int MeshGroupCount = 8;
+static constexpr unsigned int ResidentMeshGroups = 2;	// How many fit in the budget at once
+static constexpr unsigned int FramesPerMeshGroup = 8;	// Must be more than MinIdleFrames
+static constexpr UINT64 MinIdleFrames = 2;
+
+static std::shared_ptr<MeshGroupT<BoxVertex>> CreatePaddedBoxMesh(const std::shared_ptr<DeviceResources>& deviceResources)
+{
+	GeometryGenerator geoGen;
+	GeometryGenerator::MeshData box = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0);
+
+	std::vector<std::vector<BoxVertex>> allVertices(1);
+	allVertices[0].reserve(box.Vertices.size() + PaddingVertices);
+	for (const auto& vertex : box.Vertices)
+		allVertices[0].push_back({ vertex.Position });
+	allVertices[0].resize(box.Vertices.size() + PaddingVertices);
+
+	std::vector<std::vector<std::uint16_t>> allIndices(1, box.GetIndices16());
+	return std::make_shared<MeshGroupT<BoxVertex>>(deviceResources, allVertices, allIndices);
+}
+
+// The layer cycles through MeshGroupCount mesh groups, drawing each one for FramesPerMeshGroup frames, with a budget
+// that only leaves room for ResidentMeshGroups of them. Every mesh group that has gone idle gets evicted, and is
+// recreated (its CPU copy staged and uploaded again) the next time the layer draws it. Frames that recreate a mesh
+// group are reported separately from the ones that do not
+TINY_BENCHMARK(residency, "Force mesh group evictions with a memory budget and measure the frames that recreate them (--frames, --items)")
+{
+	HeadlessScene scene;
+	scene.Populate(options.Items > 0 ? options.Items : 1000);
+
+	RenderPassLayer& layer = scene.GetLayer();
+	const UINT64 meshBytesBefore = Engine::GetResidencyStats()[MemoryCategory::Mesh].CurrentBytes;
+	std::vector<std::shared_ptr<MeshGroupT<BoxVertex>>> meshGroups(MeshGroupCount);
+	for (auto& meshGroup : meshGroups)
+		meshGroup = CreatePaddedBoxMesh(scene.GetDeviceResources());
+	const UINT64 meshGroupBytes = (Engine::GetResidencyStats()[MemoryCategory::Mesh].CurrentBytes - meshBytesBefore) / MeshGroupCount;
+
+	layer.Meshes = meshGroups[0];
+	layer.InvalidateDrawPackets();
+
+	// Let every upload and the first round of staging page growth settle before measuring how much memory there is
+	Engine::SetMemoryBudget(0);
+	Engine::SetMinIdleFramesBeforeEviction(MinIdleFrames);
+	scene.RunFrames(options.WarmupFrames);
+
+	const ResidencyManager::Stats before = Engine::GetResidencyStats();
+	const UINT64 budget = before.Total.CurrentBytes - (MeshGroupCount - ResidentMeshGroups) * meshGroupBytes;
+	Engine::SetMemoryBudget(budget);
+
+	Samples steadyFrames, recreateFrames;
+	unsigned int recreated = 0;
+	const unsigned int frames = std::max(options.Frames, 2 * MeshGroupCount * FramesPerMeshGroup);
+	for (unsigned int iii = 0; iii < frames; ++iii)
+	{
+		bool recreates = false;
+		if (iii % FramesPerMeshGroup == 0)
+		{
+			auto& next = meshGroups[(iii / FramesPerMeshGroup) % MeshGroupCount];
+			recreates = !next->IsResident();
+			layer.Meshes = next;
+			layer.InvalidateDrawPackets();
+		}
+
+		const double frame = scene.RunFrame().Total;
+		if (recreates)
+		{
+			if (!layer.Meshes->IsResident())
+				throw std::runtime_error("An evicted mesh group was not recreated when it was drawn");
+
+			recreateFrames.Add(frame);
+			++recreated;
+		}
+		else
+		{
+			steadyFrames.Add(frame);
+		}
+	}
+
+	const ResidencyManager::Stats after = Engine::GetResidencyStats();
+	if (after.Evictions == before.Evictions || recreated == 0)
+		throw std::runtime_error(std::format("The budget did not force any evictions ({} evictions, {} recreated)", after.Evictions - before.Evictions, recreated));
+
+	// Put the Engine's settings back
+	Engine::SetMemoryBudget(0);
+	Engine::SetMinIdleFramesBeforeEviction(ResidencyManager::DefaultMinIdleFrames);
+
+	PrintHeader(std::format("Residency: {} mesh groups of {} cycling every {} frames, budget for {} ({} items, {} frames)",
+		MeshGroupCount, meshGroupBytes, FramesPerMeshGroup, ResidentMeshGroups, scene.GetItemCount(), frames));
+	PrintSamplesHeader("us");
+	PrintSamples("Frame (no recreation)", steadyFrames);
+	PrintSamples("Frame (recreates a mesh group)", recreateFrames);
+	PrintBytes("Budget", budget);
+	PrintBytes("Peak total", after.Total.PeakBytes);
+	PrintBytes("Mesh bytes (now)", after[MemoryCategory::Mesh].CurrentBytes);
+	PrintValue("Evictions", static_cast<double>(after.Evictions - before.Evictions), "");
+	PrintBytes("Evicted", after.EvictedBytes - before.EvictedBytes);
+	PrintValue("Mesh groups recreated", static_cast<double>(recreated), "");
+	return 0;
+}
+}
@@ -0,0 +1,102 @@
+#include "../HeadlessScene.h"
+
+using namespace tiny;
+
+namespace bench
+{
+struct LoadTimings
+{
+	double Load = 0.0;			// GetTexture() for every texture (after PreloadAll() when preloading)
+	double FirstFrame = 0.0;	// The frame that submits the staged uploads
+};
+
+// Startup the two ways the sandbox can do it: a GetTexture() per texture, each one reading/parsing its file on the
+// main thread, or PreloadAll() first and then the GetTexture() calls, which are all cache hits
+static LoadTimings LoadAll(HeadlessScene& scene, unsigned int count, bool preload)
+{
+	LoadTimings timings;
+	std::vector<Texture*> textures(count);
+
+	Stopwatch stopwatch;
+	if (preload)
+		TextureManager::PreloadAll();
+	for (unsigned int iii = 0; iii < count; ++iii)
+		textures[iii] = TextureManager::GetTexture(iii);
+	timings.Load = stopwatch.ElapsedMicroseconds();
+
+	timings.FirstFrame = scene.RunFrame().Total;
+	return timings;
+}
+
+// Releases every texture. The budget is 0, so each one is evicted as soon as it is released instead of staying
+// cached, and the frames let the Engine delete the resources and recycle their SRV slots. The next run starts with
+// nothing resident, so it cannot get cache hits from this one
+static void UnloadAll(HeadlessScene& scene, unsigned int count)
+{
+	for (unsigned int iii = 0; iii < count; ++iii)
+		TextureManager::ReleaseTexture(iii);
+	scene.RunFrames(Engine::GetFrameResourceCount() + 1);
+
+	if (TextureManager::GetStats().ResidentTextures != 0)
+		throw std::runtime_error(std::format("{} textures were still resident after releasing all of them", TextureManager::GetStats().ResidentTextures));
+}
+
+// Both ways are run --repeat times, alternating which one goes first. Every run starts from nothing resident (see
+// UnloadAll()). An untimed run first warms the OS file cache and fills in TextureManager's content index (kept in
+// memory, as there is no index file), so neither way pays for reading the disk or hashing the files when the other
+// one did not
+TINY_BENCHMARK(preload, "Load every .dds file under --path (default: the sandbox textures) through TextureManager with a GetTexture() loop vs PreloadAll() and report the time to load them (--repeat)")
+{
+	const std::filesystem::path path = options.Path.empty() ? DefaultTexturePath : options.Path;
+	const std::vector<std::filesystem::path> paths = FindDDSFiles(path);
+	if (paths.empty())
+		throw std::runtime_error(std::format("No .dds files found at '{}'", path.string()));
+
+	UINT64 totalBytes = 0;
+	for (const std::filesystem::path& filePath : paths)
+	{
+		GetTextureFiles().push_back(filePath.wstring());
+		totalBytes += std::filesystem::file_size(filePath);
+	}
+	const unsigned int count = static_cast<unsigned int>(paths.size());
+
+	HeadlessScene scene;
+	TextureManager::Init(scene.GetDeviceResources());
+	TextureManager::SetBudget(0);
+
+	LoadAll(scene, count, false);
+	UnloadAll(scene, count);
+
+	Samples loopLoad, loopFrame, preloadLoad, preloadFrame;
+	for (unsigned int rep = 0; rep < options.Repetitions; ++rep)
+	{
+		for (unsigned int order = 0; order < 2; ++order)
+		{
+			const bool preload = (rep + order) % 2 == 1;
+			const unsigned int cacheHitsBefore = TextureManager::GetStats().CacheHits;
+
+			const LoadTimings timings = LoadAll(scene, count, preload);
+
+			// Preloaded textures are resident but not referenced, so every GetTexture() after PreloadAll() is a cache
+			// hit. Without preloading, any cache hit means the previous run left something behind
+			const unsigned int cacheHits = TextureManager::GetStats().CacheHits - cacheHitsBefore;
+			if (cacheHits != (preload ? count : 0))
+				throw std::runtime_error(std::format("Expected {} cache hits, got {}", preload ? count : 0, cacheHits));
+
+			(preload ? preloadLoad : loopLoad).Add(timings.Load);
+			(preload ? preloadFrame : loopFrame).Add(timings.FirstFrame);
+			UnloadAll(scene, count);
+		}
+	}
+
+	PrintHeader(std::format("Texture loading: {} files from '{}' ({} runs each)", count, path.string(), options.Repetitions));
+	PrintSamplesHeader("us");
+	PrintSamples("GetTexture() loop", loopLoad);
+	PrintSamples("GetTexture() loop, first frame", loopFrame);
+	PrintSamples("PreloadAll() + GetTexture()", preloadLoad);
+	PrintSamples("PreloadAll(), first frame", preloadFrame);
+	PrintBytes("File data", totalBytes);
+	PrintValue("Speedup (median load)", loopLoad.Percentile(50.0) / preloadLoad.Percentile(50.0), "x");
+	return 0;
+}
+}
@@ -0,0 +1,53 @@
+#include "../HeadlessScene.h"
+
+#include <thread>
+
+using namespace tiny;
+
+namespace bench
+{
+static Samples MeasureUpdate(HeadlessScene& scene, const Options& options)
+{
+	scene.RunFrames(options.WarmupFrames);
+
+	Samples samples;
+	samples.Reserve(options.Frames);
+	for (unsigned int iii = 0; iii < options.Frames; ++iii)
+	{
+		scene.RunFrame();
+		samples.Add(static_cast<double>(Engine::GetUpdateStats().RenderItemUpdateMicroseconds));
+	}
+	return samples;
+}
+
+// Every item is animated and flagged ThreadSafeUpdate, so this is the best case for the parallel path. The time
+// reported is UpdateStats::RenderItemUpdateMicroseconds, i.e. only the render item loop, not the rest of Update()
+TINY_BENCHMARK(update, "Render item update time with parallel update off vs on (--items, --frames, --warmup)")
+{
+	HeadlessScene scene;
+	const bool parallelUpdate = Engine::GetParallelUpdate();
+
+	for (unsigned int count : ItemCounts(options, { 10000, 50000, 200000 }))
+	{
+		scene.Populate(count, { .ThreadSafeUpdate = true, .Animate = true });
+
+		Engine::SetParallelUpdate(false);
+		Samples serial = MeasureUpdate(scene, options);
+
+		Engine::SetParallelUpdate(true);
+		Samples parallel = MeasureUpdate(scene, options);
+		const Engine::UpdateStats& stats = Engine::GetUpdateStats();
+
+		PrintHeader(std::format("Render item update: {} items, {} frames, {} hardware threads", count, options.Frames, std::thread::hardware_concurrency()));
+		PrintSamplesHeader("us");
+		PrintSamples("Serial", serial);
+		PrintSamples("Parallel", parallel);
+		PrintValue("Speedup (mean)", parallel.Mean() > 0.0 ? serial.Mean() / parallel.Mean() : 0.0, "x");
+		PrintValue("Items updated in parallel", stats.ItemsUpdatedInParallel, "");
+		PrintValue("Items updated serially", stats.ItemsUpdatedSerially, "");
+	}
+
+	Engine::SetParallelUpdate(parallelUpdate);
+	return 0;
+}
+}
@@ -0,0 +1,10 @@
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float3 PosL : POSITION;
+};
+
+float4 main(VertexOut pin) : SV_Target
+{
+    return float4(pin.PosL + 0.5f, 1.0f);
+}
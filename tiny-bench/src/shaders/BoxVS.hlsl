@@ -0,0 +1,34 @@
+cbuffer cbPerObject : register(b0)
+{
+    float4x4 gWorld;
+};
+
+cbuffer cbPass : register(b1)
+{
+    float4x4 gViewProj;
+};
+
+struct VertexIn
+{
+    float3 PosL : POSITION;
+};
+
+struct VertexOut
+{
+    float4 PosH : SV_POSITION;
+    float3 PosL : POSITION;
+};
+
+VertexOut main(VertexIn vin)
+{
+    VertexOut vout;
+	
+	// Transform to homogeneous clip space.
+    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    vout.PosH = mul(posW, gViewProj);
+	
+	// The pixel shader colors the box by its local position
+    vout.PosL = vin.PosL;
+    
+    return vout;
+}
@@ -0,0 +1,67 @@
+#include "Test.h"
+
+#include <iostream>
+
+// Required by tiny's Texture.h. The tests do not load textures through TextureManager, so there are none
+std::wstring GetTextureFilename(unsigned int index)
+{
+	return L"";
+}
+std::size_t GetTotalTextureCount()
+{
+	return 0;
+}
+
+// usage: tiny-test [filter] [--path P]
+// Runs every test whose name contains 'filter' (all of them if it is omitted). The exit code is the number of
+// failed tests, so 0 means everything passed
+int main(int argc, char** argv)
+{
+	std::string_view filter = "";
+	for (int iii = 1; iii < argc; ++iii)
+	{
+		const std::string_view arg = argv[iii];
+		if (arg == "--path")
+		{
+			if (iii + 1 >= argc)
+			{
+				std::cerr << std::format("Missing value for '{}'\n", arg);
+				return 1;
+			}
+			test::GetOptions().Path = argv[++iii];
+		}
+		else
+			filter = arg;
+	}
+
+	std::vector<test::TestInfo> tests = test::GetTests();
+	std::sort(tests.begin(), tests.end(), [](const auto& lhs, const auto& rhs) { return std::string_view(lhs.Name) < std::string_view(rhs.Name); });
+
+	int run = 0;
+	int failed = 0;
+	for (const test::TestInfo& info : tests)
+	{
+		if (std::string_view(info.Name).find(filter) == std::string_view::npos)
+			continue;
+
+		++run;
+		try
+		{
+			info.Run();
+			std::cout << std::format("[  OK  ] {}\n", info.Name);
+		}
+		catch (const test::CheckFailure& failure)
+		{
+			++failed;
+			std::cout << std::format("[ FAIL ] {}\n         {}({}): CHECK({})\n", info.Name, failure.File, failure.Line, failure.Expression);
+		}
+		catch (const std::exception& e)
+		{
+			++failed;
+			std::cout << std::format("[ FAIL ] {}\n         exception: {}\n", info.Name, e.what());
+		}
+	}
+
+	std::cout << std::format("\n{} of {} tests passed\n", run - failed, run);
+	return failed;
+}
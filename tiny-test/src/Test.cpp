@@ -0,0 +1,17 @@
+#include "Test.h"
+
+namespace test
+{
+std::vector<TestInfo>& GetTests()
+{
+	// Function local so that it exists before the first registrar runs, regardless of static initialization order
+	static std::vector<TestInfo> tests;
+	return tests;
+}
+
+Options& GetOptions()
+{
+	static Options options;
+	return options;
+}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <tiny.h>
+
+namespace test
+{
+// A failed CHECK throws, so the rest of the test is skipped and the runner moves on to the next test
+struct CheckFailure
+{
+	const char* Expression;
+	const char* File;
+	int Line;
+};
+
+using TestFunction = void(*)();
+
+struct TestInfo
+{
+	const char* Name;
+	TestFunction Run;
+};
+
+std::vector<TestInfo>& GetTests();
+
+// Set from the command line by Main.cpp
+struct Options
+{
+	std::string Path;	// Tests that read files (i.e. the dds tests) look here. Empty means their default
+};
+
+Options& GetOptions();
+
+// Tests register themselves from a static initializer (see TINY_TEST), so adding one is just adding a file
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, TestFunction run)
+	{
+		GetTests().push_back({ name, run });
+	}
+};
+}
+
+#define TINY_TEST(name)																		\
+	static void CAT(Test_, name)();																\
+	static test::TestRegistrar CAT(g_registrar_, name)(STRINGIFY(name), &CAT(Test_, name));	\
+	static void CAT(Test_, name)()
+
+// Unlike TINY_ASSERT, this is active in Release too (tests are meant to be run in both configurations)
+#define CHECK(x) do { if (!(x)) throw test::CheckFailure{ #x, __FILE__, __LINE__ }; } while (0)
@@ -0,0 +1,147 @@
+#include "../Test.h"
+#include "tiny/utils/BuddyAllocator.h"
+
+#include <random>
+
+using tiny::utility::BuddyAllocator;
+
+namespace
+{
+constexpr UINT64 MinBlockSize = 64 * 1024;
+constexpr unsigned int MaxOrder = 10;
+
+bool Overlaps(const BuddyAllocator& allocator, const BuddyAllocator::Block& lhs, const BuddyAllocator::Block& rhs)
+{
+	return lhs.Offset < rhs.Offset + allocator.BlockSize(rhs.Order) && rhs.Offset < lhs.Offset + allocator.BlockSize(lhs.Order);
+}
+}
+
+TINY_TEST(BuddyAllocator_OrderFor)
+{
+	BuddyAllocator allocator(MinBlockSize, MaxOrder);
+
+	CHECK(allocator.Capacity() == MinBlockSize << MaxOrder);
+	CHECK(allocator.OrderFor(1) == 0);
+	CHECK(allocator.OrderFor(MinBlockSize) == 0);
+	CHECK(allocator.OrderFor(MinBlockSize + 1) == 1);
+	CHECK(allocator.OrderFor(4 * MinBlockSize) == 2);
+	CHECK(allocator.OrderFor(allocator.Capacity()) == MaxOrder);
+	CHECK(allocator.OrderFor(allocator.Capacity() + 1) > MaxOrder);
+}
+
+TINY_TEST(BuddyAllocator_SplitsFromLowestOffset)
+{
+	BuddyAllocator allocator(MinBlockSize, MaxOrder);
+
+	// The first allocation splits the whole space down to order 0 and takes offset 0. The free upper halves are
+	// then reused (lowest offset first) before anything else is split
+	std::optional<BuddyAllocator::Block> a = allocator.Allocate(1);
+	CHECK(a.has_value() && a->Offset == 0 && a->Order == 0);
+
+	std::optional<BuddyAllocator::Block> b = allocator.Allocate(MinBlockSize + 1);
+	CHECK(b.has_value() && b->Offset == 2 * MinBlockSize && b->Order == 1);
+
+	std::optional<BuddyAllocator::Block> c = allocator.Allocate(MinBlockSize);
+	CHECK(c.has_value() && c->Offset == MinBlockSize && c->Order == 0);
+
+	CHECK(allocator.AllocatedBytes() == 4 * MinBlockSize);
+	CHECK(allocator.FreeBytes() == allocator.Capacity() - 4 * MinBlockSize);
+	CHECK(allocator.LargestFreeBlock() == allocator.Capacity() / 2);
+
+	allocator.Free(*a);
+	allocator.Free(*b);
+	allocator.Free(*c);
+}
+
+TINY_TEST(BuddyAllocator_FreeMergesBuddies)
+{
+	BuddyAllocator allocator(MinBlockSize, MaxOrder);
+
+	std::vector<BuddyAllocator::Block> blocks;
+	for (int iii = 0; iii < 4; ++iii)
+	{
+		std::optional<BuddyAllocator::Block> block = allocator.Allocate(MinBlockSize);
+		CHECK(block.has_value());
+		blocks.push_back(*block);
+	}
+
+	// Blocks 0 and 2 are not buddies, so freeing them must not merge anything
+	allocator.Free(blocks[0]);
+	allocator.Free(blocks[2]);
+	CHECK(allocator.LargestFreeBlock() == allocator.Capacity() / 2);
+	std::optional<BuddyAllocator::Block> pair = allocator.Allocate(2 * MinBlockSize);
+	CHECK(pair.has_value() && pair->Offset == 4 * MinBlockSize);
+	allocator.Free(*pair);
+
+	// Freeing their buddies merges everything back into a single block, in any order
+	allocator.Free(blocks[3]);
+	allocator.Free(blocks[1]);
+	CHECK(allocator.Empty());
+	CHECK(allocator.LargestFreeBlock() == allocator.Capacity());
+}
+
+TINY_TEST(BuddyAllocator_FullAndOversized)
+{
+	BuddyAllocator allocator(MinBlockSize, MaxOrder);
+
+	CHECK(!allocator.Allocate(allocator.Capacity() + 1).has_value());
+
+	std::optional<BuddyAllocator::Block> whole = allocator.Allocate(allocator.Capacity());
+	CHECK(whole.has_value() && whole->Offset == 0 && whole->Order == MaxOrder);
+	CHECK(allocator.FreeBytes() == 0);
+	CHECK(allocator.LargestFreeBlock() == 0);
+	CHECK(!allocator.Allocate(1).has_value());
+
+	allocator.Free(*whole);
+	CHECK(allocator.Empty());
+}
+
+// Random allocations and frees: live blocks never overlap, are aligned to their size, and add up to AllocatedBytes().
+// Once everything is freed, the space must have merged back into one block
+TINY_TEST(BuddyAllocator_RandomStress)
+{
+	BuddyAllocator allocator(MinBlockSize, MaxOrder);
+	std::mt19937 generator(1);
+	std::uniform_int_distribution<UINT64> size(1, 4 * 1024 * 1024);
+
+	std::vector<BuddyAllocator::Block> live;
+	for (int iii = 0; iii < 20000; ++iii)
+	{
+		if (live.empty() || generator() % 2 == 0)
+		{
+			const UINT64 byteSize = size(generator);
+			std::optional<BuddyAllocator::Block> block = allocator.Allocate(byteSize);
+			if (!block.has_value())
+			{
+				// Only acceptable if no free block is large enough
+				CHECK(allocator.LargestFreeBlock() < allocator.BlockSize(allocator.OrderFor(byteSize)));
+				continue;
+			}
+
+			CHECK(block->Offset % allocator.BlockSize(block->Order) == 0);
+			CHECK(block->Offset + allocator.BlockSize(block->Order) <= allocator.Capacity());
+			for (const BuddyAllocator::Block& other : live)
+				CHECK(!Overlaps(allocator, *block, other));
+
+			live.push_back(*block);
+		}
+		else
+		{
+			size_t index = generator() % live.size();
+			allocator.Free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		UINT64 liveBytes = 0;
+		for (const BuddyAllocator::Block& block : live)
+			liveBytes += allocator.BlockSize(block.Order);
+		CHECK(liveBytes == allocator.AllocatedBytes());
+	}
+
+	for (const BuddyAllocator::Block& block : live)
+		allocator.Free(block);
+
+	CHECK(allocator.Empty());
+	CHECK(allocator.LargestFreeBlock() == allocator.Capacity());
+}
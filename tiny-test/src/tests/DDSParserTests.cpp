@@ -0,0 +1,312 @@
+#include "../Test.h"
+#include "tiny/utils/DDSParser.h"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+
+using namespace tiny::dds;
+
+namespace
+{
+// Builds a small, valid DDS file in memory so the tests do not depend on any file on disk. The pixel data is filled
+// with a pattern, which the parser never looks at
+struct FileSettings
+{
+	uint32_t Width = 8;
+	uint32_t Height = 8;
+	uint32_t Depth = 1;				// > 1 makes a volume texture
+	uint32_t MipCount = 1;
+	uint32_t ArraySize = 1;			// Only written with a DX10 header
+	bool CubeMap = false;
+	bool DX10Header = false;
+	DXGI_FORMAT Format = DXGI_FORMAT_R8G8B8A8_UNORM; // Legacy headers support R8G8B8A8_UNORM and BC1_UNORM here
+};
+
+std::vector<uint8_t> MakeFile(const FileSettings& settings)
+{
+	DDS_HEADER header = {};
+	header.size = sizeof(DDS_HEADER);
+	header.flags = DDS_HEIGHT | DDS_WIDTH | (settings.Depth > 1 ? DDS_HEADER_FLAGS_VOLUME : 0);
+	header.width = settings.Width;
+	header.height = settings.Height;
+	header.depth = settings.Depth;
+	header.mipMapCount = settings.MipCount;
+	header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+
+	DDS_HEADER_DXT10 dx10 = {};
+	uint32_t arraySize = settings.CubeMap ? 6 : 1;
+	if (settings.DX10Header)
+	{
+		header.ddspf.flags = DDS_FOURCC;
+		header.ddspf.fourCC = MakeFourCC('D', 'X', '1', '0');
+		dx10.dxgiFormat = settings.Format;
+		dx10.resourceDimension = static_cast<uint32_t>(settings.Depth > 1 ? Dimension::Texture3D : Dimension::Texture2D);
+		dx10.miscFlag = settings.CubeMap ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+		dx10.arraySize = settings.ArraySize;
+		arraySize = settings.ArraySize * (settings.CubeMap ? 6 : 1);
+	}
+	else if (settings.Format == DXGI_FORMAT_BC1_UNORM)
+	{
+		header.ddspf.flags = DDS_FOURCC;
+		header.ddspf.fourCC = MakeFourCC('D', 'X', 'T', '1');
+	}
+	else
+	{
+		header.ddspf.flags = DDS_RGB;
+		header.ddspf.RGBBitCount = 32;
+		header.ddspf.RBitMask = 0x000000ff;
+		header.ddspf.GBitMask = 0x0000ff00;
+		header.ddspf.BBitMask = 0x00ff0000;
+		header.ddspf.ABitMask = 0xff000000;
+	}
+	if (settings.CubeMap && !settings.DX10Header)
+		header.caps2 = DDS_CUBEMAP_ALLFACES;
+
+	size_t dataSize = 0;
+	for (uint32_t slice = 0; slice < arraySize; ++slice)
+	{
+		for (uint32_t mip = 0; mip < std::max(settings.MipCount, 1u); ++mip)
+		{
+			size_t numBytes = 0;
+			GetSurfaceInfo(std::max(settings.Width >> mip, 1u), std::max(settings.Height >> mip, 1u), settings.Format, &numBytes, nullptr, nullptr);
+			dataSize += numBytes * std::max(settings.Depth >> mip, 1u);
+		}
+	}
+
+	std::vector<uint8_t> file(sizeof(uint32_t) + sizeof(DDS_HEADER) + (settings.DX10Header ? sizeof(DDS_HEADER_DXT10) : 0) + dataSize);
+	uint8_t* out = file.data();
+	std::memcpy(out, &DDS_MAGIC, sizeof(uint32_t));
+	out += sizeof(uint32_t);
+	std::memcpy(out, &header, sizeof(DDS_HEADER));
+	out += sizeof(DDS_HEADER);
+	if (settings.DX10Header)
+	{
+		std::memcpy(out, &dx10, sizeof(DDS_HEADER_DXT10));
+		out += sizeof(DDS_HEADER_DXT10);
+	}
+	for (size_t iii = 0; out + iii < file.data() + file.size(); ++iii)
+		out[iii] = static_cast<uint8_t>(iii * 31);
+
+	return file;
+}
+
+// One of each kind of file the parser handles differently
+std::vector<std::vector<uint8_t>> MakeSyntheticFiles()
+{
+	return {
+		MakeFile({ .Width = 16, .Height = 8, .MipCount = 5 }),
+		MakeFile({ .Width = 16, .Height = 16, .MipCount = 3, .Format = DXGI_FORMAT_BC1_UNORM }),
+		MakeFile({ .Width = 8, .Height = 8, .MipCount = 2, .CubeMap = true, .Format = DXGI_FORMAT_BC1_UNORM }),
+		MakeFile({ .Width = 8, .Height = 4, .MipCount = 4, .ArraySize = 3, .DX10Header = true, .Format = DXGI_FORMAT_BC7_UNORM }),
+		MakeFile({ .Width = 8, .Height = 8, .Depth = 4, .MipCount = 4, .DX10Header = true }),
+	};
+}
+
+// The sandbox's textures, relative to the tiny-test project directory (where it runs from in Visual Studio). Same
+// default as the dds benchmark, and --path overrides it the same way
+static constexpr const char* DefaultTexturePath = "../sandbox/src/textures";
+
+// Every .dds file under the texture path, or nothing if it does not exist (i.e. the tests run without the assets)
+std::vector<std::vector<uint8_t>> ReadTextureFiles()
+{
+	const std::filesystem::path path = test::GetOptions().Path.empty() ? DefaultTexturePath : test::GetOptions().Path;
+
+	std::vector<std::filesystem::path> paths;
+	if (std::filesystem::is_directory(path))
+	{
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+		{
+			if (entry.is_regular_file() && entry.path().extension() == ".dds")
+				paths.push_back(entry.path());
+		}
+	}
+	else if (std::filesystem::is_regular_file(path))
+	{
+		paths.push_back(path);
+	}
+	std::sort(paths.begin(), paths.end());
+
+	std::vector<std::vector<uint8_t>> files;
+	for (const std::filesystem::path& filePath : paths)
+	{
+		std::ifstream file(filePath, std::ios::binary);
+		CHECK(file);
+		files.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+	return files;
+}
+
+// The synthetic files, plus the real textures when they are available. Real files come with whatever formats, mip
+// counts and sizes the content pipeline actually produced, which the synthetic ones only approximate
+std::vector<std::vector<uint8_t>> MakeSeedFiles()
+{
+	std::vector<std::vector<uint8_t>> seeds = MakeSyntheticFiles();
+	for (std::vector<uint8_t>& file : ReadTextureFiles())
+		seeds.push_back(std::move(file));
+	return seeds;
+}
+
+// What has to hold for every file the parser accepts, whatever its header says
+void CheckInvariants(const ParsedTexture& texture, size_t fileSize)
+{
+	CHECK(!texture.Subresources.empty());
+	CHECK(texture.Subresources.size() == static_cast<size_t>(texture.Desc.MipCount) * texture.Desc.ArraySize);
+	CHECK(texture.Desc.MipCount <= MaxMipLevels);
+	for (const Subresource& subresource : texture.Subresources)
+	{
+		CHECK(subresource.Offset <= fileSize);
+		CHECK(subresource.ByteSize <= fileSize - subresource.Offset);
+	}
+}
+}
+
+TINY_TEST(DDSParser_ParsesSeedFiles)
+{
+	for (const std::vector<uint8_t>& file : MakeSeedFiles())
+	{
+		ParsedTexture texture;
+		CHECK(Parse(file, texture) == Result::Ok);
+		CheckInvariants(texture, file.size());
+
+		// Subresources are tightly packed, and the last one ends at the end of the file
+		for (size_t iii = 1; iii < texture.Subresources.size(); ++iii)
+			CHECK(texture.Subresources[iii].Offset == texture.Subresources[iii - 1].Offset + texture.Subresources[iii - 1].ByteSize);
+		CHECK(texture.Subresources.back().Offset + texture.Subresources.back().ByteSize == file.size());
+	}
+}
+
+TINY_TEST(DDSParser_Desc)
+{
+	ParsedTexture texture;
+
+	std::vector<uint8_t> file = MakeFile({ .Width = 16, .Height = 8, .MipCount = 5 });
+	CHECK(Parse(file, texture) == Result::Ok);
+	CHECK(texture.Desc.ResourceDimension == Dimension::Texture2D);
+	CHECK(texture.Desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM);
+	CHECK(texture.Desc.Width == 16 && texture.Desc.Height == 8 && texture.Desc.Depth == 1);
+	CHECK(texture.Desc.MipCount == 5 && texture.Desc.ArraySize == 1);
+	CHECK(texture.Subresources[0].Offset == sizeof(uint32_t) + sizeof(DDS_HEADER));
+	CHECK(texture.Subresources[0].RowPitch == 16 * 4 && texture.Subresources[0].SlicePitch == 16 * 8 * 4);
+
+	file = MakeFile({ .Width = 8, .Height = 8, .MipCount = 2, .CubeMap = true, .Format = DXGI_FORMAT_BC1_UNORM });
+	CHECK(Parse(file, texture) == Result::Ok);
+	CHECK(texture.Desc.IsCubeMap && texture.Desc.ArraySize == 6);
+	CHECK(texture.Desc.Format == DXGI_FORMAT_BC1_UNORM);
+	CHECK(texture.Subresources[0].RowPitch == 2 * 8); // Two 8 byte BC1 blocks per row of blocks
+
+	file = MakeFile({ .Width = 8, .Height = 8, .Depth = 4, .MipCount = 4, .DX10Header = true });
+	CHECK(Parse(file, texture) == Result::Ok);
+	CHECK(texture.Desc.ResourceDimension == Dimension::Texture3D && texture.Desc.Depth == 4);
+	CHECK(texture.Subresources[0].ByteSize == 4 * texture.Subresources[0].SlicePitch);
+	CHECK(texture.Subresources[2].ByteSize == texture.Subresources[2].SlicePitch); // Depth 1 from mip 2 on
+}
+
+TINY_TEST(DDSParser_MaxSizeSkipsMips)
+{
+	std::vector<uint8_t> file = MakeFile({ .Width = 16, .Height = 16, .MipCount = 5 });
+
+	ParsedTexture texture;
+	CHECK(Parse(file, texture, 4) == Result::Ok);
+	CHECK(texture.Desc.SkippedMips == 2);
+	CHECK(texture.Desc.MipCount == 3);
+	CHECK(texture.Desc.Width == 4 && texture.Desc.Height == 4);
+	CheckInvariants(texture, file.size());
+}
+
+TINY_TEST(DDSParser_RejectsTruncatedFiles)
+{
+	// Every prefix of a valid file is missing part of a header or part of the last subresource. Only the synthetic
+	// files: they cover the same header layouts, and trying every prefix of a real texture takes far too long
+	for (const std::vector<uint8_t>& file : MakeSyntheticFiles())
+	{
+		for (size_t size = 0; size < file.size(); ++size)
+		{
+			ParsedTexture texture;
+			CHECK(Parse(std::span<const uint8_t>(file.data(), size), texture) != Result::Ok);
+		}
+	}
+}
+
+TINY_TEST(DDSParser_RejectsBadHeaders)
+{
+	ParsedTexture texture;
+	std::vector<uint8_t> file = MakeFile({});
+	DDS_HEADER* header = reinterpret_cast<DDS_HEADER*>(file.data() + sizeof(uint32_t));
+
+	file[0] = 'X';
+	CHECK(Parse(file, texture) == Result::BadMagic);
+	file[0] = 'D';
+
+	header->size = 0;
+	CHECK(Parse(file, texture) == Result::BadHeader);
+	header->size = sizeof(DDS_HEADER);
+
+	header->width = 0;
+	CHECK(Parse(file, texture) == Result::InvalidData);
+	header->width = MaxTexture2DDimension + 1;
+	CHECK(Parse(file, texture) == Result::TooLarge);
+	header->width = 8;
+
+	header->mipMapCount = 5; // 8x8 only has 4
+	CHECK(Parse(file, texture) == Result::InvalidData);
+	header->mipMapCount = MaxMipLevels + 1;
+	CHECK(Parse(file, texture) == Result::TooLarge);
+	header->mipMapCount = 1;
+
+	header->ddspf.RGBBitCount = 24;
+	CHECK(Parse(file, texture) == Result::UnsupportedFormat);
+	header->ddspf.RGBBitCount = 32;
+
+	CHECK(Parse(file, texture) == Result::Ok);
+}
+
+// Mutates the headers of the seed files at random (and truncates half of them), and checks that the parser never
+// accepts a file whose subresources do not fit in it. Run it under AddressSanitizer (/fsanitize=address) to also
+// catch reads outside of the file: every file goes into a buffer of exactly its size first. Only the headers are
+// copied into it, since the parser never reads the pixel data and copying whole real textures would dominate the run
+TINY_TEST(DDSParser_Fuzz)
+{
+	constexpr unsigned int Iterations = 200000;
+	constexpr size_t HeaderBytes = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10) + 16;
+
+	const std::vector<std::vector<uint8_t>> seeds = MakeSeedFiles();
+	std::mt19937_64 generator(1234); // Fixed seed, so a failure can be reproduced
+	unsigned int accepted = 0;
+
+	for (unsigned int iii = 0; iii < Iterations; ++iii)
+	{
+		const std::vector<uint8_t>& seed = seeds[generator() % seeds.size()];
+
+		std::array<uint8_t, HeaderBytes> header = {};
+		const size_t headerSize = std::min(seed.size(), HeaderBytes);
+		std::memcpy(header.data(), seed.data(), headerSize);
+
+		const unsigned int mutations = 1 + generator() % 8;
+		for (unsigned int mutation = 0; mutation < mutations; ++mutation)
+		{
+			const size_t position = generator() % headerSize;
+			switch (generator() % 3)
+			{
+			case 0: header[position] = static_cast<uint8_t>(generator()); break;
+			case 1: header[position] ^= static_cast<uint8_t>(1u << (generator() % 8)); break;
+			default: header[position] = (generator() & 1) ? 0xff : 0x00; break;
+			}
+		}
+		const size_t size = (generator() % 2) ? generator() % (seed.size() + 1) : seed.size();
+
+		std::unique_ptr<uint8_t[]> exact(new uint8_t[size]);
+		std::memcpy(exact.get(), header.data(), std::min(size, headerSize));
+
+		ParsedTexture texture;
+		if (Parse(std::span<const uint8_t>(exact.get(), size), texture) == Result::Ok)
+		{
+			CheckInvariants(texture, size);
+			++accepted;
+		}
+	}
+
+	// Single bit flips in unused header fields leave plenty of files valid. If none are, the mutations are not
+	// getting past the first checks and the test is not exercising much
+	CHECK(accepted > 0 && accepted < Iterations);
+}
@@ -0,0 +1,198 @@
+#include "../Test.h"
+#include "tiny/rendering/FramePacer.h"
+
+using tiny::FrameFence;
+using tiny::FramePacer;
+
+namespace
+{
+// Stands in for the GPU. The fence only moves when the test says so: either the test completes values directly (the
+// GPU is ahead of the CPU), or a Wait() completes the value it was asked for after WaitMicroseconds (the CPU has to
+// stall on the GPU). Every Wait() is recorded so the test can check what the pacer waited on
+class ScriptedFence : public FrameFence
+{
+public:
+	struct WaitCall
+	{
+		UINT64 Value;
+		unsigned int Slot;
+	};
+
+	ND UINT64 GetCompletedValue() const override { return Completed; }
+	void Wait(UINT64 value, unsigned int slot) override
+	{
+		Waits.push_back({ value, slot });
+
+		// Spin rather than sleep so that the stall is close to exactly WaitMicroseconds
+		const auto end = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(WaitMicroseconds);
+		while (std::chrono::high_resolution_clock::now() < end)
+			std::this_thread::yield();
+
+		Completed = std::max(Completed, value);
+	}
+
+	UINT64 Completed = 0;
+	long long WaitMicroseconds = 0;
+	std::vector<WaitCall> Waits;
+};
+
+struct PacerFixture
+{
+	PacerFixture(unsigned int frameResourceCount) :
+		Fence(new ScriptedFence()),
+		Pacer(std::unique_ptr<FrameFence>(Fence), frameResourceCount),
+		FrameResourceCount(frameResourceCount)
+	{}
+
+	// Runs a frame the same way the Engine does: frame N uses frame resource N % count and signals fence value N + 1.
+	// If 'gpuKeepsUp', the GPU finishes the frame as soon as it is submitted
+	void RunFrame(bool gpuKeepsUp)
+	{
+		Pacer.BeginFrame(static_cast<unsigned int>(Frame % FrameResourceCount));
+		Pacer.EndFrame(Frame + 1);
+		if (gpuKeepsUp)
+			Fence->Completed = Frame + 1;
+		++Frame;
+	}
+
+	ScriptedFence* Fence; // Owned by the pacer
+	FramePacer Pacer;
+	unsigned int FrameResourceCount;
+	UINT64 Frame = 0;
+};
+
+// Number of samples in buckets that only hold values above 'value'
+UINT64 CountAbove(const tiny::utility::Histogram& histogram, double value)
+{
+	UINT64 count = 0;
+	for (size_t bucket = 1; bucket < histogram.BucketCount(); ++bucket)
+	{
+		if (histogram.UpperBound(bucket - 1) >= value)
+			count += histogram.Count(bucket);
+	}
+	return count;
+}
+}
+
+TINY_TEST(FramePacer_WaitsForOldestFrameInFlight)
+{
+	PacerFixture fixture(3);
+
+	// The GPU never gets ahead, so once three frames are in flight every frame waits on the one submitted three
+	// frames earlier, which used the same frame resource (and so the same wait slot)
+	for (int iii = 0; iii < 9; ++iii)
+	{
+		CHECK(fixture.Pacer.RequiredFenceValue() == (fixture.Frame < 3 ? 0 : fixture.Frame - 2));
+		fixture.RunFrame(false);
+	}
+
+	CHECK(fixture.Fence->Waits.size() == 6);
+	for (size_t iii = 0; iii < fixture.Fence->Waits.size(); ++iii)
+	{
+		CHECK(fixture.Fence->Waits[iii].Value == iii + 1);
+		CHECK(fixture.Fence->Waits[iii].Slot == iii % 3);
+	}
+}
+
+TINY_TEST(FramePacer_OneFrameInFlight)
+{
+	// With one frame in flight, every frame waits for the previous one, while the slots still follow the frame resources
+	PacerFixture fixture(3);
+	fixture.Pacer.SetMaxFramesInFlight(1);
+	for (int iii = 0; iii < 6; ++iii)
+		fixture.RunFrame(false);
+
+	CHECK(fixture.Fence->Waits.size() == 5);
+	for (size_t iii = 0; iii < fixture.Fence->Waits.size(); ++iii)
+	{
+		CHECK(fixture.Fence->Waits[iii].Value == iii + 1);
+		CHECK(fixture.Fence->Waits[iii].Slot == (iii + 1) % 3);
+	}
+
+	// A single frame resource is the same, but always reuses slot 0
+	PacerFixture single(1);
+	for (int iii = 0; iii < 4; ++iii)
+		single.RunFrame(false);
+
+	CHECK(single.Fence->Waits.size() == 3);
+	for (size_t iii = 0; iii < single.Fence->Waits.size(); ++iii)
+		CHECK(single.Fence->Waits[iii].Value == iii + 1 && single.Fence->Waits[iii].Slot == 0);
+
+	// Max frames in flight is clamped to the number of frame resources
+	single.Pacer.SetMaxFramesInFlight(4);
+	CHECK(single.Pacer.GetMaxFramesInFlight() == 1);
+}
+
+TINY_TEST(FramePacer_NoWaitWhenGPUIsAhead)
+{
+	PacerFixture fixture(3);
+	for (int iii = 0; iii < 10; ++iii)
+		fixture.RunFrame(true);
+
+	// There is always a value to check once the pipeline is full, but it is already complete
+	CHECK(fixture.Pacer.RequiredFenceValue() == 8);
+	CHECK(fixture.Fence->Waits.empty());
+
+	// Every frame before the current one was complete when the next BeginFrame() looked
+	CHECK(fixture.Pacer.FramesSubmitted() == 10);
+	CHECK(fixture.Pacer.GetLatencyHistogram().TotalCount() == 9);
+}
+
+TINY_TEST(FramePacer_HoldsTargetFrameRate)
+{
+	constexpr double frameRate = 200.0; // 5ms per frame
+	constexpr long long periodMicroseconds = 5000;
+	constexpr int frames = 6;
+
+	PacerFixture fixture(3);
+	fixture.Pacer.SetTargetFrameRate(frameRate);
+	CHECK(fixture.Pacer.GetTargetFrameRate() == frameRate);
+
+	for (int iii = 0; iii < frames; ++iii)
+	{
+		fixture.RunFrame(true);
+
+		// The first frame has nothing to be paced against. After that, the CPU does no work between frames, so the
+		// pacer has to sleep for (almost) the whole period. Timings are rounded down to whole microseconds
+		const FramePacer::FrameTimings& timings = fixture.Pacer.GetFrameTimings();
+		if (iii == 0)
+		{
+			CHECK(timings.FrameMicroseconds == 0);
+			CHECK(timings.PacingSleepMicroseconds < 1000);
+		}
+		else
+		{
+			CHECK(timings.FrameMicroseconds >= periodMicroseconds - 1);
+			CHECK(timings.PacingSleepMicroseconds >= periodMicroseconds / 2);
+		}
+	}
+
+	CHECK(fixture.Pacer.GetFrameTimeHistogram().TotalCount() == frames - 1);
+	CHECK(CountAbove(fixture.Pacer.GetFrameTimeHistogram(), 4000.0) == frames - 1);
+
+	// Turning the target off stops the sleeping
+	fixture.Pacer.SetTargetFrameRate(0.0);
+	fixture.RunFrame(true);
+	CHECK(fixture.Pacer.GetFrameTimings().PacingSleepMicroseconds < periodMicroseconds / 2);
+}
+
+TINY_TEST(FramePacer_CPUStallHistogram)
+{
+	// The first two frames fill the pipeline (no stall). After that, the GPU falls behind and every wait takes 3ms
+	PacerFixture fixture(2);
+	fixture.Fence->WaitMicroseconds = 3000;
+	for (int iii = 0; iii < 8; ++iii)
+	{
+		fixture.RunFrame(false);
+
+		const long long stall = fixture.Pacer.GetFrameTimings().CPUStallMicroseconds;
+		CHECK(iii < 2 ? stall < 2000 : stall >= 3000);
+	}
+
+	// One sample per frame: the waits land above the 2ms bucket boundary, the frames that did not wait below it
+	const tiny::utility::Histogram& stalls = fixture.Pacer.GetCPUStallHistogram();
+	CHECK(stalls.TotalCount() == 8);
+	CHECK(CountAbove(stalls, 2000.0) == 6);
+	CHECK(stalls.Max() >= 3000.0);
+	CHECK(fixture.Fence->Waits.size() == 6);
+}
@@ -0,0 +1,77 @@
+#include "../Test.h"
+#include "tiny/utils/ResidencyTracker.h"
+
+using tiny::utility::ResidencyTracker;
+
+TINY_TEST(ResidencyTracker_Usage)
+{
+	ResidencyTracker tracker(2);
+
+	tracker.AddAllocation(0, 100);
+	tracker.AddAllocation(1, 50);
+	tracker.RemoveAllocation(0, 100);
+
+	CHECK(tracker.GetUsage(0).CurrentBytes == 0 && tracker.GetUsage(0).PeakBytes == 100 && tracker.GetUsage(0).Allocations == 0);
+	CHECK(tracker.GetUsage(1).CurrentBytes == 50 && tracker.GetUsage(1).Allocations == 1);
+	CHECK(tracker.GetTotalUsage().CurrentBytes == 50 && tracker.GetTotalUsage().PeakBytes == 150);
+}
+
+TINY_TEST(ResidencyTracker_EvictsLeastRecentlyUsed)
+{
+	ResidencyTracker tracker(1);
+
+	const ResidencyTracker::Handle a = tracker.Register(10);
+	const ResidencyTracker::Handle b = tracker.Register(20);
+	const ResidencyTracker::Handle c = tracker.Register(30);
+
+	// Nothing is evictable until it is marked as such
+	CHECK(!tracker.LeastRecentlyUsed(UINT64_MAX).has_value());
+
+	tracker.SetEvictable(a, true, 1);
+	tracker.SetEvictable(b, true, 2);
+	tracker.SetEvictable(c, true, 3);
+	CHECK(tracker.EvictableCount() == 3 && tracker.EvictableBytes() == 60);
+	CHECK(tracker.LeastRecentlyUsed(UINT64_MAX) == a);
+
+	// Using 'a' again makes 'b' the oldest
+	tracker.Touch(a, 4);
+	CHECK(tracker.LeastRecentlyUsed(UINT64_MAX) == b);
+
+	// Entries used after the idle cutoff are never returned, even when they are the oldest
+	CHECK(!tracker.LeastRecentlyUsed(1).has_value());
+	CHECK(tracker.LeastRecentlyUsed(2) == b);
+
+	// Evicting is the owner's job: it takes the entry off the list (and puts it back once its data is recreated)
+	tracker.SetEvictable(b, false, 5);
+	CHECK(tracker.LeastRecentlyUsed(UINT64_MAX) == c);
+	CHECK(tracker.EvictableCount() == 2 && tracker.EvictableBytes() == 40);
+
+	tracker.SetEvictable(b, true, 6);
+	CHECK(tracker.LeastRecentlyUsed(UINT64_MAX) == c);
+	tracker.Touch(c, 7);
+	CHECK(tracker.LeastRecentlyUsed(UINT64_MAX) == a);
+}
+
+TINY_TEST(ResidencyTracker_UnregisterReusesHandles)
+{
+	ResidencyTracker tracker(1);
+
+	const ResidencyTracker::Handle a = tracker.Register(10);
+	const ResidencyTracker::Handle b = tracker.Register(20);
+	tracker.SetEvictable(a, true, 1);
+	tracker.SetEvictable(b, true, 2);
+
+	tracker.Unregister(a);
+	CHECK(!tracker.IsRegistered(a));
+	CHECK(tracker.RegisteredCount() == 1 && tracker.EvictableCount() == 1 && tracker.EvictableBytes() == 20);
+	CHECK(tracker.LeastRecentlyUsed(UINT64_MAX) == b);
+
+	// A new entry takes the free handle, and starts out not evictable with its own size
+	const ResidencyTracker::Handle c = tracker.Register(5);
+	CHECK(c == a);
+	CHECK(!tracker.IsEvictable(c) && tracker.GetByteSize(c) == 5);
+
+	tracker.SetEvictable(c, true, 3);
+	tracker.SetByteSize(c, 15);
+	CHECK(tracker.EvictableBytes() == 35);
+}
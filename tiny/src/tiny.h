@@ -24,6 +24,7 @@
 #include "tiny/rendering/RootSignature.h"
 #include "tiny/rendering/Shader.h"
 #include "tiny/rendering/Texture.h"
+#include "tiny/rendering/UploadRing.h"
 
 #include "tiny/utils/Constants.h"
 #include "tiny/utils/Timer.h"
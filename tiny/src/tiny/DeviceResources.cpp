@@ -9,7 +9,11 @@ using Microsoft::WRL::ComPtr;
 namespace tiny
 {
 #if defined(_DEBUG)
-	DxgiInfoManager DeviceResources::m_infoManager = DxgiInfoManager();
+DxgiInfoManager& DeviceResources::GetInfoManager() noexcept
+{
+	thread_local DxgiInfoManager infoManager;
+	return infoManager;
+}
 #endif
 
 DeviceResources::DeviceResources() :
@@ -38,6 +42,20 @@ DeviceResources::DeviceResources(HWND hWnd, int height, int width) :
 	CreateSwapChain();
     OnResize(m_height, m_width);
 }
+DeviceResources::DeviceResources(int height, int width) :
+	m_hWnd(0),
+	m_headless(true),
+	m_height(height),
+	m_width(width)
+{
+	PROFILE_SCOPE("DeviceResources(int height, int width)");
+
+	CreateDevice();
+	CreateCommandObjects();
+	CreateRtvAndDsvDescriptorHeaps();
+	CreateSwapChain();
+	OnResize(m_height, m_width); // When headless, OnResize is responsible for creating the back buffers
+}
 
 void DeviceResources::Set4xMsaaState(bool value)
 {
@@ -63,16 +81,22 @@ void DeviceResources::CreateDevice()
 
 	GFX_THROW_INFO(CreateDXGIFactory1(IID_PPV_ARGS(&m_dxgiFactory)));
 
-	// Try to create hardware device.
-	HRESULT hardwareResult = D3D12CreateDevice(
-		nullptr,             // default adapter
-		D3D_FEATURE_LEVEL_11_0,
-		IID_PPV_ARGS(&m_d3dDevice));
+	// Try to create hardware device. When headless, skip straight to the WARP device so we never
+	// depend on there being a GPU on the machine
+	HRESULT hardwareResult = E_FAIL;
+	if (!m_headless)
+	{
+		hardwareResult = D3D12CreateDevice(
+			nullptr,             // default adapter
+			D3D_FEATURE_LEVEL_11_0,
+			IID_PPV_ARGS(&m_d3dDevice));
+	}
 
 	// Fallback to WARP device.
 	if (FAILED(hardwareResult))
 	{
-		LOG_CORE_WARN("{}", "Failed to create D3D12 device. Attempting to fallback to WARP device...");
+		if (!m_headless)
+			LOG_CORE_WARN("{}", "Failed to create D3D12 device. Attempting to fallback to WARP device...");
 
 		ComPtr<IDXGIAdapter> pWarpAdapter;
 		GFX_THROW_INFO(m_dxgiFactory->EnumWarpAdapter(IID_PPV_ARGS(&pWarpAdapter)));
@@ -174,6 +198,10 @@ void DeviceResources::CreateSwapChain()
 	// Release the previous swapchain we will be recreating.
 	m_swapChain.Reset();
 
+	// When headless, there is no swapchain to create. The back buffers will be (re)created in OnResize()
+	if (m_headless)
+		return;
+
 	// If we are using an HWND create the SwapChainDesc for a specific window
 	// otherwise we are creating it for composition (UWP)
 	if (m_hWnd != 0)
@@ -237,6 +265,51 @@ void DeviceResources::CreateSwapChain()
 }
 
 
+void DeviceResources::CreateHeadlessBackBuffers()
+{
+	TINY_CORE_ASSERT(m_headless, "Should only be creating headless back buffers when running headless");
+
+	D3D12_RESOURCE_DESC backBufferDesc;
+	backBufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+	backBufferDesc.Alignment = 0;
+	backBufferDesc.Width = m_width;
+	backBufferDesc.Height = m_height;
+	backBufferDesc.DepthOrArraySize = 1;
+	backBufferDesc.MipLevels = 1;
+	backBufferDesc.Format = m_backBufferFormat;
+	backBufferDesc.SampleDesc.Count = m_4xMsaaState ? 4 : 1;
+	backBufferDesc.SampleDesc.Quality = m_4xMsaaState ? (m_4xMsaaQuality - 1) : 0;
+	backBufferDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	backBufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+	D3D12_CLEAR_VALUE optClear;
+	optClear.Format = m_backBufferFormat;
+	optClear.Color[0] = 0.0f;
+	optClear.Color[1] = 0.0f;
+	optClear.Color[2] = 0.0f;
+	optClear.Color[3] = 1.0f;
+
+	// NOTE: The buffers are created in the PRESENT state (which is the same as COMMON) because the Engine
+	//       expects the back buffer to be transitioned PRESENT -> RENDER_TARGET -> PRESENT each frame
+	auto _p = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
+	for (UINT i = 0; i < SwapChainBufferCount; i++)
+	{
+		GFX_THROW_INFO(
+			m_d3dDevice->CreateCommittedResource(
+				&_p,
+				D3D12_HEAP_FLAG_NONE,
+				&backBufferDesc,
+				D3D12_RESOURCE_STATE_PRESENT,
+				&optClear,
+				IID_PPV_ARGS(m_swapChainBuffer[i].GetAddressOf())
+			)
+		);
+		m_d3dDevice->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
+		rtvHeapHandle.Offset(1, m_rtvDescriptorSize);
+	}
+}
+
 void DeviceResources::FlushCommandQueue()
 {
 	// Advance the fence value to mark commands up to this fence point.
@@ -281,7 +354,7 @@ D3D12_CPU_DESCRIPTOR_HANDLE DeviceResources::DepthStencilView() const noexcept
 void DeviceResources::OnResize(int height, int width)
 {
 	TINY_CORE_ASSERT(m_d3dDevice != nullptr, "device is null");
-	TINY_CORE_ASSERT(m_swapChain != nullptr, "swapchain is null");
+	TINY_CORE_ASSERT(m_headless || m_swapChain != nullptr, "swapchain is null");
 	TINY_CORE_ASSERT(m_directCmdListAlloc != nullptr, "command list allocator is null");
 
 	m_height = height;
@@ -297,25 +370,33 @@ void DeviceResources::OnResize(int height, int width)
 		m_swapChainBuffer[i].Reset();
 	m_depthStencilBuffer.Reset();
 
-	// Resize the swap chain.
-	GFX_THROW_INFO(
-		m_swapChain->ResizeBuffers(
-			SwapChainBufferCount,
-			m_width, 
-			m_height,
-			m_backBufferFormat,
-			DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH
-		)
-	);
-
 	m_currBackBuffer = 0;
 
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
-	for (UINT i = 0; i < SwapChainBufferCount; i++)
+	if (m_headless)
 	{
-		GFX_THROW_INFO(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));
-		m_d3dDevice->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
-		rtvHeapHandle.Offset(1, m_rtvDescriptorSize);
+		// No swap chain, so just recreate the offscreen back buffers at the new size
+		CreateHeadlessBackBuffers();
+	}
+	else
+	{
+		// Resize the swap chain.
+		GFX_THROW_INFO(
+			m_swapChain->ResizeBuffers(
+				SwapChainBufferCount,
+				m_width, 
+				m_height,
+				m_backBufferFormat,
+				DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH
+			)
+		);
+
+		CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
+		for (UINT i = 0; i < SwapChainBufferCount; i++)
+		{
+			GFX_THROW_INFO(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));
+			m_d3dDevice->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
+			rtvHeapHandle.Offset(1, m_rtvDescriptorSize);
+		}
 	}
 
 	// Create the depth/stencil buffer and view.
@@ -457,8 +538,9 @@ void DeviceResources::Present()
 {
 	PROFILE_SCOPE("m_swapChain->Present()");
 
-	// swap the back and front buffers
-	GFX_THROW_INFO(m_swapChain->Present(0, 0));
+	// swap the back and front buffers (when headless, there is nothing to present, so just cycle the back buffer index)
+	if (!m_headless)
+		GFX_THROW_INFO(m_swapChain->Present(0, 0));
 	m_currBackBuffer = (m_currBackBuffer + 1) % SwapChainBufferCount;
 
 	// Wait until frame commands are complete.  This waiting is inefficient and is
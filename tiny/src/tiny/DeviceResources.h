@@ -14,6 +14,7 @@ class TINY_API DeviceResources
 public:
 	DeviceResources(); // Constructor to use in UWP when we don't have an HWND
 	DeviceResources(HWND hWnd, int height, int width); // Constructor to use when building for Win32 and we do have an HWND
+	DeviceResources(int height, int width); // Constructor to use when running headless (no window, no swap chain, WARP adapter)
 	DeviceResources(const DeviceResources&) = delete;
 	DeviceResources& operator=(const DeviceResources&) = delete;
 
@@ -33,6 +34,7 @@ public:
 	ND inline bool MsaaEnabled() const noexcept { return m_4xMsaaState; }
 	ND inline UINT MsaaQuality() const noexcept { return m_4xMsaaQuality; }
 	ND inline IDXGISwapChain1* GetSwapChain() const noexcept { return m_swapChain.Get(); }
+	ND inline bool IsHeadless() const noexcept { return m_headless; }
 
 	ND ID3D12Resource* CurrentBackBuffer() const noexcept;
 	ND D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView() const noexcept;
@@ -57,6 +59,7 @@ private:
 	void CreateDevice();
 	void CreateCommandObjects();
 	void CreateSwapChain();
+	void CreateHeadlessBackBuffers();
 	void CreateRtvAndDsvDescriptorHeaps();
 
 
@@ -67,6 +70,12 @@ private:
 
 	HWND m_hWnd;
 
+	// When headless, there is no swap chain. Instead, the "back buffers" are plain committed render targets
+	// that are cycled through in Present(). The device is always created on the WARP adapter so that the
+	// full frame loop can be run on Windows machines without a GPU (see tiny-bench). It still needs D3D12, so
+	// this does NOT make the library run on other platforms
+	bool m_headless = false;
+
 	int m_height;
 	int m_width;
 
@@ -104,9 +113,8 @@ private:
 
 #if defined(_DEBUG)
 public:
-	ND inline static DxgiInfoManager& GetInfoManager() noexcept { return m_infoManager; }
-private:
-	static DxgiInfoManager m_infoManager;
+	// Each thread gets its own info manager because commands may be recorded on several threads at once
+	ND static DxgiInfoManager& GetInfoManager() noexcept;
 #endif
 };
 #pragma warning( pop )
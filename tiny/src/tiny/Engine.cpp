@@ -4,8 +4,10 @@
 #include "rendering/RenderPass.h"
 #include "rendering/RenderPassLayer.h"
 #include "rendering/RenderItem.h"
+#include "rendering/DrawPacketStream.h"
 #include "rendering/MeshGroup.h"
 #include "rendering/Texture.h"
+#include "scene/Camera.h"
 #include "tiny/utils/Profile.h"
 
 
@@ -16,13 +18,35 @@ void Engine::InitImpl(std::shared_ptr<DeviceResources> deviceResources)
 	TINY_CORE_ASSERT(!m_initialized, "Engine has already been initialized");
 	TINY_CORE_ASSERT(deviceResources != nullptr, "No device resources");
 	m_deviceResources = deviceResources;
+	m_mainThreadID = std::this_thread::get_id();
 
-	// Initialize all fence values to 0
-	std::fill(std::begin(m_fences), std::end(m_fences), 0);
+	// Frame pacing (also responsible for waiting until a frame resource is no longer in use by the GPU)
+	// The fence gets a wait event for the largest possible count so it never has to be recreated
+	m_framePacer = std::make_unique<FramePacer>(std::make_unique<D3D12FrameFence>(m_deviceResources, gMaxFrameResources), m_frameResourceCount);
 
 	// Initialize allocators
+	CreateCommandAllocators();
+	m_residencyManager = std::make_unique<ResidencyManager>(m_deviceResources); // Before anything that creates resources
+	m_memoryAllocator = std::make_unique<GpuMemoryAllocator>(m_deviceResources);
+	m_uploadScheduler = std::make_unique<UploadScheduler>(m_deviceResources);
+
+	// Initialize the upload ring used for all constant buffer data
+	m_uploadRing = std::make_unique<UploadRing>(m_deviceResources, m_frameResourceCount);
+
+	// Initialize the pool of additional command lists used when recording in parallel
+	m_commandListPool = std::make_unique<CommandListPool>(m_deviceResources, m_frameResourceCount);
+
+	m_retireBuckets.resize(m_frameResourceCount);
+
+	m_initialized = true;
+}
+void Engine::CreateCommandAllocators()
+{
+	// Only creates the allocators that do not exist yet, so existing ones (and their memory) are kept when growing
 	auto device = m_deviceResources->GetDevice();
-	for (unsigned int iii = 0; iii < gNumFrameResources; ++iii)
+	const size_t existing = m_allocators.size();
+	m_allocators.resize(m_frameResourceCount);
+	for (size_t iii = existing; iii < m_allocators.size(); ++iii)
 	{
 		GFX_THROW_INFO(
 			device->CreateCommandAllocator(
@@ -31,8 +55,41 @@ void Engine::InitImpl(std::shared_ptr<DeviceResources> deviceResources)
 			)
 		);
 	}
+}
+void Engine::SetFrameResourceCountImpl(unsigned int count)
+{
+	TINY_CORE_ASSERT(count >= gMinFrameResources && count <= gMaxFrameResources, "Frame resource count is out of range");
+	count = MathHelper::Clamp(count, gMinFrameResources, gMaxFrameResources);
 
-	m_initialized = true;
+	if (count == m_frameResourceCount)
+		return;
+
+	if (!m_initialized)
+	{
+		m_frameResourceCount = count;
+		return;
+	}
+
+	PROFILE_FUNCTION();
+
+	// Every per-frame container is about to be resized, so nothing may still be in flight
+	m_deviceResources->FlushCommandQueue();
+
+	m_frameResourceCount = count;
+	CreateCommandAllocators();
+	m_framePacer->SetFrameResourceCount(count);
+	m_uploadRing->SetFrameResourceCount(count);
+	m_commandListPool->SetFrameResourceCount(count);
+
+	// The GPU is idle, so everything waiting to be deleted can go now
+	ReleaseRetiredResources();
+	m_retireBuckets.resize(count);
+
+	for (DynamicMeshGroup* mesh : m_dynamicMeshes)
+		mesh->SetFrameResourceCount(count);
+
+	// Update() advances the index before using it, so the next frame starts at frame resource 0
+	m_currentFrameIndex = static_cast<int>(count) - 1;
 }
 void Engine::UpdateImpl(const Timer& timer)
 {
@@ -40,31 +97,32 @@ void Engine::UpdateImpl(const Timer& timer)
 	TINY_CORE_ASSERT(m_initialized, "Engine has not been initialized");
 
 	// Cycle through the circular frame resource array.
-	m_currentFrameIndex = (m_currentFrameIndex + 1) % gNumFrameResources;
+	m_currentFrameIndex = (m_currentFrameIndex + 1) % static_cast<int>(m_frameResourceCount);
 
-	// Has the GPU finished processing the commands of the current frame?
-	// If not, wait until the GPU has completed commands up to this fence point.
-	UINT64 currentFence = m_fences[m_currentFrameIndex];
-	{
-		PROFILE_SCOPE("Waiting for GPU to update fence");
-
-		if (currentFence != 0 && m_deviceResources->GetFence()->GetCompletedValue() < currentFence)
-		{
-			HANDLE eventHandle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
-			GFX_THROW_INFO(
-				m_deviceResources->GetFence()->SetEventOnCompletion(currentFence, eventHandle)
-			);
+	// Has the GPU finished processing the commands of the current frame? If not, wait until it has (the pacer may
+	// also wait for more recent frames and/or sleep to hold the target frame rate)
+	m_framePacer->BeginFrame(m_currentFrameIndex);
 
-			TINY_CORE_ASSERT(eventHandle != NULL, "Handle should not be null");
-			WaitForSingleObject(eventHandle, INFINITE);
-			CloseHandle(eventHandle);
-		}
-	}
+	// The GPU is done with the current frame resource, so its section of the upload ring can be recycled
+	m_uploadRing->Reset(m_currentFrameIndex);
+	m_commandListPool->Reset(m_currentFrameIndex);
+	m_uploadScheduler->ResetFrameStats();
+	++m_frameNumber;
 
-	// Cleanup resources that were passed to DelayedDelete()
+	// Release resources that were passed to DelayedDelete() the last time this frame resource was used
 	CleanupResources();
 
+	// Move streamed textures along (dispatch file reads, submit their uploads, swap out placeholders) and evict
+	// cached textures if we are over budget
+	TextureManager::Update();
+
+	// Evict the meshes/cached textures that have been idle the longest if we are over the memory budget. Memory that
+	// is already waiting to be deleted is not counted, otherwise more would be evicted every frame until the GPU is
+	// done with it
+	m_residencyManager->EnforceBudget(m_frameNumber, m_deletionStats.BytesPending);
+
 	// Update dynamic data
+	m_updateStats = {};
 	UpdateRenderItems(timer);
 	UpdateComputeItems(timer);
 	UpdateRenderPasses(timer);
@@ -82,7 +140,20 @@ void Engine::RenderImpl()
 	TINY_CORE_ASSERT(m_initialized, "Engine has not been initialized");
 	TINY_CORE_ASSERT(m_renderPasses.size() > 0, "No render passes");
 
-	auto commandList = m_deviceResources->GetCommandList();
+	// The DeviceResources command list has already been reset (and may hold compute work from the Update phase), so it
+	// is always the first list to be submitted. Additional lists are only acquired if a layer is recorded in parallel
+	m_recordingContexts.clear();
+	m_submissionOrder.clear();
+
+	RecordingContext* context = &m_recordingContexts.emplace_back();
+	context->CommandList = m_deviceResources->GetCommandList();
+	m_submissionOrder.push_back(context->CommandList);
+
+	auto commandList = context->CommandList;
+
+	// Culling must be finished before any recording starts because the draw paths (including the worker threads)
+	// only read the culled state
+	CullRenderItems(context->Stats);
 
 	{
 		PROFILE_SCOPE("SetViewport/ScissorRects");
@@ -118,6 +189,11 @@ void Engine::RenderImpl()
 		);
 	}
 
+	// Worker tasks for any layers that are recorded in parallel. The main thread keeps recording the rest of the
+	// frame while the workers run
+	concurrency::task_group recordingTasks;
+	auto recordingStart = std::chrono::high_resolution_clock::now();
+
 	for (RenderPass* pass : m_renderPasses)
 	{
 		PROFILE_SCOPE(pass->Name.c_str());
@@ -129,28 +205,22 @@ void Engine::RenderImpl()
 		// Before attempting to perform any rendering, first perform all compute operations
 		for (const ComputeLayer& layer : pass->ComputeLayers)
 		{
-			RunComputeLayer(layer, nullptr); // NOTE: Pass nullptr for the timer, because we do not have access to the timer during the Rendering phase
+			RunComputeLayer(layer, context->CommandList, nullptr); // NOTE: Pass nullptr for the timer, because we do not have access to the timer during the Rendering phase
 		}
 
 
 
 		// Pre-Work method - possibly for transitioning resources or anything necessary
-		if (!pass->PreWork(pass, commandList))
+		if (!pass->PreWork(pass, context->CommandList))
 			continue;
 
-		// Set only a single root signature per RenderPass
-		GFX_THROW_INFO_ONLY(commandList->SetGraphicsRootSignature(pass->RootSignature->Get()));
-
-		// Bind any per-pass constant buffer views
 		for (const RootConstantBufferView& cbv : pass->ConstantBufferViews)
-		{
-			GFX_THROW_INFO_ONLY(
-				commandList->SetGraphicsRootConstantBufferView(cbv.RootParameterIndex, cbv.ConstantBuffer->GetGPUVirtualAddress(m_currentFrameIndex))
-			);
-		}
+			cbv.ConstantBuffer->Upload(m_frameNumber);
+
+		BeginPass(*context, pass);
 
 		// Render the render layers for the pass
-		for (const RenderPassLayer& layer : pass->RenderPassLayers)
+		for (RenderPassLayer& layer : pass->RenderPassLayers)
 		{
 			PROFILE_SCOPE(layer.Name.c_str());
 
@@ -158,42 +228,26 @@ void Engine::RenderImpl()
 			TINY_CORE_ASSERT(layer.PipelineState != nullptr, "Layer has no pipeline state");
 			TINY_CORE_ASSERT(layer.Meshes != nullptr, "Layer has no mesh group");
 
-			// PSO / Pre-Work / MeshGroup / Primitive Topology
-			GFX_THROW_INFO_ONLY(commandList->SetPipelineState(layer.PipelineState.Get()));
-			
-			if (!layer.PreWork(layer, commandList))		// Pre-Work method (example usage: setting stencil value)
-				continue;
+			// Recreates the mesh's buffers if they were evicted (the upload is submitted before the frame executes)
+			layer.Meshes->MarkUsed();
 
-			layer.Meshes->Bind(commandList);
-			GFX_THROW_INFO_ONLY(commandList->IASetPrimitiveTopology(layer.Topology));
+			// Compiled layers resolve this frame's addresses/visibility up front, so recording only reads the stream
+			if (UsesDrawPackets(layer))
+				RefreshDrawPackets(layer, context->Stats);
 
-			MeshGroup* meshGroup = layer.Meshes.get();
-
-			for (const RenderItem& item : layer.RenderItems)
+			// Instanced layers only issue a handful of draws, so there is nothing to be gained by splitting them up. Layers
+			// with a PreWork are kept on the main thread so that PreWork runs exactly once, in the list that draws the layer
+			if (m_parallelRecording && !layer.InstanceRenderItems && !layer.PreWork && layer.RenderItems.size() >= 2 * ItemsPerRecordingChunk)
 			{
-				// Tables and CBV's ARE allowed to be empty
-				for (const RootDescriptorTable& table : item.DescriptorTables)
-				{
-					GFX_THROW_INFO_ONLY(
-						commandList->SetGraphicsRootDescriptorTable(table.Index(), table.DescriptorHandle)
-					);
-				}
-
-				for (const RootConstantBufferView& cbv : item.ConstantBufferViews)
-				{
-					GFX_THROW_INFO_ONLY(
-						commandList->SetGraphicsRootConstantBufferView(cbv.RootParameterIndex, cbv.ConstantBuffer->GetGPUVirtualAddress(m_currentFrameIndex))
-					);
-				}
-
-				SubmeshGeometry mesh = meshGroup->GetSubmesh(item.submeshIndex);
-				GFX_THROW_INFO_ONLY(
-					commandList->DrawIndexedInstanced(mesh.IndexCount, 1, mesh.StartIndexLocation, mesh.BaseVertexLocation, 0)
-				);
+				RecordLayerInParallel(context, pass, layer, recordingTasks);
+			}
+			else if (BeginLayer(*context, layer))
+			{
+				RecordLayer(*context, layer);
 			}
 		}
 
-		pass->PostWork(pass, commandList);
+		pass->PostWork(pass, context->CommandList);
 	}
 
 	{
@@ -204,24 +258,574 @@ void Engine::RenderImpl()
 			D3D12_RESOURCE_STATE_RENDER_TARGET,
 			D3D12_RESOURCE_STATE_PRESENT
 		);
-		GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(1, &_b2));
+		GFX_THROW_INFO_ONLY(context->CommandList->ResourceBarrier(1, &_b2));
 	}
 
 	// Done recording commands.
 	{
 		PROFILE_SCOPE("commandList->Close()");
-		GFX_THROW_INFO(commandList->Close());
+		GFX_THROW_INFO(context->CommandList->Close());
+	}
+
+	// Wait for the workers to finish (they close their own command lists). Any exception thrown on a worker is rethrown here
+	{
+		PROFILE_SCOPE("Wait for recording tasks");
+		recordingTasks.wait();
 	}
 
-	// Add the command list to the queue for execution.
+	m_renderStats = {};
+	for (const RecordingContext& rc : m_recordingContexts)
+		m_renderStats += rc.Stats;
+	m_renderStats.CommandLists = static_cast<unsigned int>(m_submissionOrder.size());
+	m_renderStats.RecordingMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - recordingStart).count();
+
+	// Anything staged during this frame (including by the Update phase) is copied on the copy queue. The direct queue
+	// only waits (on the GPU) for copies that have not already finished
+	SubmitPendingUploads();
+
+	// Add the command lists to the queue for execution. They are submitted in the order they were acquired so
+	// that the GPU sees exactly the same sequence of commands as if the frame had been recorded into a single list
 	{
 		PROFILE_SCOPE("commandQueue->ExecuteCommandLists()");
-		ID3D12CommandList* cmdsLists[] = { commandList };
 		GFX_THROW_INFO_ONLY(
-			m_deviceResources->GetCommandQueue()->ExecuteCommandLists(_countof(cmdsLists), cmdsLists)
+			m_deviceResources->GetCommandQueue()->ExecuteCommandLists(static_cast<UINT>(m_submissionOrder.size()), m_submissionOrder.data())
 		);
 	}
 }
+void Engine::SetCullingCamera(const Camera& camera) noexcept
+{
+	Engine& engine = Get();
+	engine.m_cullingFrustum = camera.GetWorldFrustum();
+	engine.m_hasCullingFrustum = true;
+}
+void Engine::CullRenderItems(RenderStats& stats)
+{
+	PROFILE_FUNCTION();
+
+	// Keep the BVHs up to date even if there is no frustum (they are also used for picking)
+	ApplyBoundsUpdates();
+
+	if (!m_hasCullingFrustum)
+		return;
+
+	// Extract the planes once per frame. Testing a box against them is then just a couple of SIMD dot products per plane
+	DirectX::XMVECTOR planes[6];
+	m_cullingFrustum.GetPlanes(&planes[0], &planes[1], &planes[2], &planes[3], &planes[4], &planes[5]);
+
+	for (RenderPass* pass : m_renderPasses)
+	{
+		for (RenderPassLayer& layer : pass->RenderPassLayers)
+		{
+			if (!layer.FrustumCull)
+				continue;
+
+			// Large layers: only the subtrees that straddle the frustum are tested, and items in subtrees that are
+			// entirely outside are marked culled without being tested
+			if (layer.RenderItems.size() >= MinItemsForBVHCulling)
+			{
+				SyncLayerBVH(layer);
+				stats.ItemsTestedForCulling += static_cast<unsigned int>(layer.m_bvh->size());
+				layer.m_bvh->ForEachOutside(planes, [this, &stats](RenderItem* item)
+					{
+						item->m_culledOnFrame = m_frameNumber;
+						++stats.ItemsCulled;
+					}
+				);
+				continue;
+			}
+
+			const MeshGroup* meshGroup = layer.Meshes.get();
+			for (RenderItem& item : layer.RenderItems)
+			{
+				if (!item.m_hasWorldTransform)
+					continue;
+
+				// SetWorldTransform() and SetSubmeshIndex() both mark the bounds dirty
+				if (item.m_worldBoundsDirty) UNLIKELY
+				{
+					item.m_worldBounds = item.ComputeWorldBounds(meshGroup);
+					item.m_worldBoundsDirty = false;
+				}
+
+				++stats.ItemsTestedForCulling;
+				if (item.m_worldBounds.ContainedBy(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5]) == DirectX::DISJOINT)
+				{
+					item.m_culledOnFrame = m_frameNumber;
+					++stats.ItemsCulled;
+				}
+			}
+		}
+	}
+}
+void Engine::ApplyBoundsUpdates()
+{
+	if (m_pendingBoundsUpdates.size() == 0)
+		return;
+
+	PROFILE_FUNCTION();
+
+	for (RenderItem* item : m_pendingBoundsUpdates)
+	{
+		item->m_boundsUpdateHandle = {};
+		if (item->m_bvh == nullptr) UNLIKELY
+			continue;
+
+		const bool inTree = item->m_bvhProxy != BoundingVolumeHierarchy<RenderItem>::NullNode;
+		if (!item->m_hasWorldTransform)
+		{
+			if (inTree)
+				item->m_bvh->Remove(item->m_bvhProxy);
+			item->m_bvhProxy = BoundingVolumeHierarchy<RenderItem>::NullNode;
+			continue;
+		}
+
+		item->m_worldBounds = item->ComputeWorldBounds(item->m_bvhMeshGroup);
+		item->m_worldBoundsDirty = false;
+
+		if (inTree)
+			item->m_bvh->Refit(item->m_bvhProxy, item->m_worldBounds);
+		else
+			item->m_bvhProxy = item->m_bvh->Insert(item->m_worldBounds, item);
+	}
+	m_pendingBoundsUpdates.clear();
+}
+void Engine::SyncLayerBVH(RenderPassLayer& layer)
+{
+	// Items only need to be visited when items have been added to the layer since the last sync (erased items leave the
+	// BVH on their own). After that, transform/submesh changes reach the BVH through the bounds update queue
+	if (layer.m_bvh != nullptr && layer.m_bvhSyncedInsertions == layer.RenderItems.InsertionCount())
+		return;
+
+	PROFILE_FUNCTION();
+
+	const bool firstBuild = layer.m_bvh == nullptr;
+	if (firstBuild)
+		layer.m_bvh = std::make_unique<BoundingVolumeHierarchy<RenderItem>>();
+
+	const MeshGroup* meshGroup = layer.Meshes.get();
+	for (RenderItem& item : layer.RenderItems)
+	{
+		if (item.m_bvh != nullptr)
+			continue;
+
+		item.m_bvh = layer.m_bvh.get();
+		item.m_bvhMeshGroup = meshGroup;
+		if (item.m_hasWorldTransform)
+		{
+			item.m_worldBounds = item.ComputeWorldBounds(meshGroup);
+			item.m_worldBoundsDirty = false;
+			item.m_bvhProxy = layer.m_bvh->Insert(item.m_worldBounds, &item);
+		}
+	}
+	layer.m_bvhSyncedInsertions = layer.RenderItems.InsertionCount();
+
+	// Incremental insertion produces a worse tree than a top-down build, so build the initial tree from scratch
+	if (firstBuild)
+		layer.m_bvh->Rebuild();
+}
+Engine::RecordingContext& Engine::AcquireRecordingContext()
+{
+	RecordingContext& context = m_recordingContexts.emplace_back();
+	context.CommandList = m_commandListPool->Acquire();
+	m_submissionOrder.push_back(context.CommandList);
+	return context;
+}
+void Engine::PrepareCommandList(ID3D12GraphicsCommandList* commandList)
+{
+	// A command list does not inherit any state from the list that was submitted before it
+	ID3D12DescriptorHeap* descriptorHeaps[] = { DescriptorManager::GetRawHeapPointer() };
+	GFX_THROW_INFO_ONLY(commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps));
+	GFX_THROW_INFO_ONLY(commandList->RSSetViewports(1, &m_viewport));
+	GFX_THROW_INFO_ONLY(commandList->RSSetScissorRects(1, &m_scissorRect));
+
+	auto currentBackBufferView = m_deviceResources->CurrentBackBufferView();
+	auto depthStencilView = m_deviceResources->DepthStencilView();
+	GFX_THROW_INFO_ONLY(
+		commandList->OMSetRenderTargets(1, &currentBackBufferView, true, &depthStencilView)
+	);
+}
+void Engine::BeginPass(RecordingContext& context, RenderPass* pass)
+{
+	// Set only a single root signature per RenderPass (this invalidates all previously bound root arguments)
+	GFX_THROW_INFO_ONLY(context.CommandList->SetGraphicsRootSignature(pass->RootSignature->Get()));
+	context.Bindings.Reset();
+
+	// Bind any per-pass constant buffer views
+	for (const RootConstantBufferView& cbv : pass->ConstantBufferViews)
+		BindConstantBufferView(context, cbv);
+}
+bool Engine::BeginLayer(RecordingContext& context, const RenderPassLayer& layer)
+{
+	// PSO / Pre-Work / MeshGroup / Primitive Topology
+	if (layer.PipelineState.Get() != context.Bindings.PipelineState)
+	{
+		GFX_THROW_INFO_ONLY(context.CommandList->SetPipelineState(layer.PipelineState.Get()));
+		context.Bindings.PipelineState = layer.PipelineState.Get();
+		++context.Stats.PipelineStateBinds;
+	}
+	else
+	{
+		++context.Stats.RedundantBindsSkipped;
+	}
+
+	if (layer.PreWork && !layer.PreWork(layer, context.CommandList))	// Pre-Work method (example usage: setting stencil value)
+		return false;
+
+	layer.Meshes->Bind(context.CommandList);
+	GFX_THROW_INFO_ONLY(context.CommandList->IASetPrimitiveTopology(layer.Topology));
+	return true;
+}
+void Engine::RecordLayer(RecordingContext& context, RenderPassLayer& layer)
+{
+	MeshGroup* meshGroup = layer.Meshes.get();
+
+	// Compiled layers have already uploaded their constant buffers in RefreshDrawPackets()
+	if (!UsesDrawPackets(layer))
+		UploadConstantBuffers(layer);
+
+	if (UsesDrawPackets(layer))
+	{
+		ReplayDrawPackets(context, layer.m_drawPackets, 0, layer.m_drawPackets.CommandCount());
+	}
+	else if (layer.InstanceRenderItems)
+	{
+		DrawRenderItemsInstanced(context, layer, meshGroup);
+	}
+	else if (layer.SortRenderItems)
+	{
+		for (const DrawSortKey& dsk : layer.GetDrawOrder())
+			DrawRenderItem(context, layer.RenderItems[dsk.ItemIndex], meshGroup);
+	}
+	else
+	{
+		for (const RenderItem& item : layer.RenderItems)
+			DrawRenderItem(context, item, meshGroup);
+	}
+}
+void Engine::UploadConstantBuffers(const RenderPassLayer& layer)
+{
+	// Culled items are never bound, and the per-object data of instanced items is packed straight from the CPU copy
+	// (see DrawRenderItemsInstanced()), so neither needs space in the upload ring
+	for (const RenderItem& item : layer.RenderItems)
+	{
+		if (item.m_culledOnFrame == m_frameNumber)
+			continue;
+
+		for (const RootConstantBufferView& cbv : item.ConstantBufferViews)
+		{
+			if (!layer.InstanceRenderItems || cbv.RootParameterIndex != layer.Instancing.PerObjectRootParameterIndex)
+				cbv.ConstantBuffer->Upload(m_frameNumber);
+		}
+	}
+}
+void Engine::RecordLayerInParallel(RecordingContext*& context, RenderPass* pass, RenderPassLayer& layer, concurrency::task_group& tasks)
+{
+	PROFILE_FUNCTION();
+	TINY_CORE_ASSERT(!layer.PreWork, "Layers with a PreWork must be recorded on the main thread");
+
+	// Anything that mutates shared state must happen here on the main thread before the workers start:
+	//    - GetDrawOrder() may re-sort the layer
+	//    - Upload() copies dirty constant buffers into the upload ring. Once that is done, the workers only ever read
+	//      the cached address (constant buffers may be shared between items in different chunks)
+	// Compiled layers have already done both of these in RefreshDrawPackets(), and are chunked by the stream instead
+	const DrawPacketStream* packets = UsesDrawPackets(layer) ? &layer.m_drawPackets : nullptr;
+	const std::vector<DrawSortKey>* drawOrder = nullptr;
+	if (packets == nullptr)
+	{
+		drawOrder = layer.SortRenderItems ? &layer.GetDrawOrder() : nullptr;
+		UploadConstantBuffers(layer);
+	}
+
+	// The current list must come before the chunks in the submission order. We are done with it, so close it now
+	GFX_THROW_INFO(context->CommandList->Close());
+
+	const size_t itemCount = layer.RenderItems.size();
+	const size_t chunkCount = packets != nullptr ? packets->ChunkCount() : (itemCount + ItemsPerRecordingChunk - 1) / ItemsPerRecordingChunk;
+	for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+	{
+		// [begin, end) is a range of items, or a range of commands for a compiled layer
+		size_t begin = chunk * ItemsPerRecordingChunk;
+		size_t end = std::min<size_t>(begin + ItemsPerRecordingChunk, itemCount);
+		if (packets != nullptr)
+		{
+			begin = packets->m_chunkStarts[chunk];
+			end = chunk + 1 < chunkCount ? packets->m_chunkStarts[chunk + 1] : packets->CommandCount();
+		}
+		RecordingContext& chunkContext = AcquireRecordingContext();
+
+		tasks.run([this, &chunkContext, pass, &layer, packets, drawOrder, begin, end]()
+			{
+				PROFILE_SCOPE(layer.Name.c_str());
+
+				// Each chunk must rebuild all of the state that would have been inherited had it been recorded into
+				// the same list (layers recorded in parallel never have a PreWork, so there is nothing else to replay)
+				PrepareCommandList(chunkContext.CommandList);
+				BeginPass(chunkContext, pass);
+				if (BeginLayer(chunkContext, layer))
+				{
+					if (packets != nullptr)
+					{
+						ReplayDrawPackets(chunkContext, *packets, begin, end);
+					}
+					else
+					{
+						MeshGroup* meshGroup = layer.Meshes.get();
+						for (size_t iii = begin; iii < end; ++iii)
+						{
+							unsigned int index = drawOrder != nullptr ? (*drawOrder)[iii].ItemIndex : static_cast<unsigned int>(iii);
+							DrawRenderItem(chunkContext, layer.RenderItems[index], meshGroup);
+						}
+					}
+				}
+
+				GFX_THROW_INFO(chunkContext.CommandList->Close());
+			}
+		);
+	}
+
+	// Everything after this layer is recorded on the main thread into a new list that is submitted after the chunks
+	context = &AcquireRecordingContext();
+	PrepareCommandList(context->CommandList);
+	BeginPass(*context, pass);
+}
+void Engine::DrawRenderItem(RecordingContext& context, const RenderItem& item, const MeshGroup* meshGroup)
+{
+	if (item.m_culledOnFrame == m_frameNumber)
+		return;
+
+	// Tables and CBV's ARE allowed to be empty
+	for (const RootDescriptorTable& table : item.DescriptorTables)
+		BindDescriptorTable(context, table);
+
+	for (const RootConstantBufferView& cbv : item.ConstantBufferViews)
+		BindConstantBufferView(context, cbv);
+
+	const SubmeshGeometry& mesh = meshGroup->GetSubmesh(item.m_submeshIndex);
+	GFX_THROW_INFO_ONLY(
+		context.CommandList->DrawIndexedInstanced(mesh.IndexCount, 1, mesh.StartIndexLocation, mesh.BaseVertexLocation, 0)
+	);
+	++context.Stats.DrawCalls;
+	++context.Stats.InstancesDrawn;
+}
+void Engine::DrawRenderItemsInstanced(RecordingContext& context, RenderPassLayer& layer, const MeshGroup* meshGroup)
+{
+	const InstancingDesc& desc = layer.Instancing;
+	const std::vector<DrawSortKey>& drawOrder = layer.GetDrawOrder();
+
+	size_t groupStart = 0;
+	while (groupStart < drawOrder.size())
+	{
+		// Culled items are simply left out of the group they would have belonged to
+		if (layer.RenderItems[drawOrder[groupStart].ItemIndex].m_culledOnFrame == m_frameNumber)
+		{
+			++groupStart;
+			continue;
+		}
+
+		const RenderItem& first = layer.RenderItems[drawOrder[groupStart].ItemIndex];
+		const RootConstantBufferView* firstPerObject = first.FindConstantBufferView(desc.PerObjectRootParameterIndex);
+		TINY_CORE_ASSERT(firstPerObject != nullptr, "Instanced render item does not have a per-object constant buffer view");
+		const UINT stride = firstPerObject->ConstantBuffer->GetDataByteSize();
+
+		// Items that can be instanced together will have the same sort key, so they are always contiguous. However, keys
+		// are only a hash, so we still need to verify each item actually matches
+		size_t groupEnd = groupStart + 1;
+		while (groupEnd < drawOrder.size() &&
+			drawOrder[groupEnd].Key == drawOrder[groupStart].Key &&
+			first.CanInstanceWith(layer.RenderItems[drawOrder[groupEnd].ItemIndex], desc.PerObjectRootParameterIndex))
+		{
+			++groupEnd;
+		}
+		UINT instanceCount = 0;
+		for (size_t iii = groupStart; iii < groupEnd; ++iii)
+		{
+			if (layer.RenderItems[drawOrder[iii].ItemIndex].m_culledOnFrame != m_frameNumber)
+				++instanceCount;
+		}
+
+		// Pack the per-object data for the group into the upload ring. Each item's Update() has already been called
+		// this frame, so the CPU copy of its constant buffer is up to date
+		UploadRing::Allocation allocation = m_uploadRing->Allocate(static_cast<UINT64>(stride) * instanceCount, 16);
+		BYTE* dest = allocation.CPU;
+		for (size_t iii = groupStart; iii < groupEnd; ++iii)
+		{
+			const RenderItem& item = layer.RenderItems[drawOrder[iii].ItemIndex];
+			if (item.m_culledOnFrame == m_frameNumber)
+				continue;
+
+			const RootConstantBufferView* perObject = item.FindConstantBufferView(desc.PerObjectRootParameterIndex);
+			TINY_CORE_ASSERT(perObject->ConstantBuffer->GetDataByteSize() == stride, "All instances in a group must have the same per-object data size");
+			memcpy(dest, perObject->ConstantBuffer->GetCPUData(), stride);
+			dest += stride;
+		}
+
+		// Shared state
+		for (const RootDescriptorTable& table : first.DescriptorTables)
+			BindDescriptorTable(context, table);
+
+		for (const RootConstantBufferView& cbv : first.ConstantBufferViews)
+		{
+			if (cbv.RootParameterIndex != desc.PerObjectRootParameterIndex)
+				BindConstantBufferView(context, cbv);
+		}
+
+		GFX_THROW_INFO_ONLY(
+			context.CommandList->SetGraphicsRootShaderResourceView(desc.InstanceBufferRootParameterIndex, allocation.GPU)
+		);
+
+		const SubmeshGeometry& mesh = meshGroup->GetSubmesh(first.m_submeshIndex);
+		GFX_THROW_INFO_ONLY(
+			context.CommandList->DrawIndexedInstanced(mesh.IndexCount, instanceCount, mesh.StartIndexLocation, mesh.BaseVertexLocation, 0)
+		);
+		++context.Stats.DrawCalls;
+		context.Stats.InstancesDrawn += instanceCount;
+
+		groupStart = groupEnd;
+	}
+}
+bool Engine::UsesDrawPackets(const RenderPassLayer& layer) const noexcept
+{
+	return m_drawPacketReplay && layer.CompileDrawPackets && !layer.InstanceRenderItems;
+}
+void Engine::RefreshDrawPackets(RenderPassLayer& layer, RenderStats& stats)
+{
+	PROFILE_FUNCTION();
+
+	// Items that were added since the last compile are not in the stream, even if as many were erased in the meantime.
+	// Items invalidate the stream themselves when they are replaced or their submesh changes
+	DrawPacketStream& stream = layer.m_drawPackets;
+	if (!stream.IsValid() || stream.InsertionCount() != layer.RenderItems.InsertionCount() || stream.ItemCount() != layer.RenderItems.size()) UNLIKELY
+	{
+		stream.Compile(layer, ItemsPerRecordingChunk);
+		++stats.DrawPacketCompiles;
+	}
+
+	// Write this frame's values into the stream. Culled items are only flagged (their constant buffers are not uploaded)
+	DrawPacketStream::Command* commands = stream.m_commands.data();
+	const DrawPacketStream::Source* sources = stream.m_sources.data();
+	const size_t commandCount = stream.m_commands.size();
+
+	size_t iii = 0;
+	while (iii < commandCount)
+	{
+		TINY_CORE_ASSERT(commands[iii].Type == DrawPacketStream::CommandType::Item, "Expected an item header");
+
+		const size_t itemEnd = iii + 1 + commands[iii].Arg;
+		const bool visible = sources[iii].Item->m_culledOnFrame != m_frameNumber;
+		commands[iii].Value = visible ? 1 : 0;
+
+		if (visible) LIKELY
+		{
+			for (++iii; iii < itemEnd; ++iii)
+			{
+				if (commands[iii].Type == DrawPacketStream::CommandType::ConstantBufferView)
+				{
+					sources[iii].ConstantBuffer->Upload(m_frameNumber);
+					commands[iii].Value = sources[iii].ConstantBuffer->GetGPUVirtualAddress(m_currentFrameIndex);
+				}
+				else if (commands[iii].Type == DrawPacketStream::CommandType::DescriptorTable)
+					commands[iii].Value = sources[iii].DescriptorTable->DescriptorHandle.ptr;
+			}
+		}
+		iii = itemEnd;
+	}
+}
+void Engine::ReplayDrawPackets(RecordingContext& context, const DrawPacketStream& stream, size_t begin, size_t end)
+{
+	TINY_CORE_ASSERT(end <= stream.CommandCount(), "Replay range is out of bounds");
+
+	ID3D12GraphicsCommandList* commandList = context.CommandList;
+	const DrawPacketStream::Command* commands = stream.m_commands.data();
+
+	size_t iii = begin;
+	while (iii < end)
+	{
+		const DrawPacketStream::Command& command = commands[iii];
+		switch (command.Type)
+		{
+		case DrawPacketStream::CommandType::Item:
+			// Skip the entire item if it was culled
+			iii += command.Value != 0 ? 1 : 1 + command.Arg;
+			continue;
+
+		case DrawPacketStream::CommandType::DescriptorTable:
+		{
+			TINY_CORE_ASSERT(command.Arg < RootBindingCache::MaxRootParameters, "Root parameter index is too large");
+			UINT64& bound = context.Bindings.DescriptorTables[command.Arg];
+			if (bound == command.Value)
+			{
+				++context.Stats.RedundantBindsSkipped;
+				break;
+			}
+			GFX_THROW_INFO_ONLY(
+				commandList->SetGraphicsRootDescriptorTable(command.Arg, D3D12_GPU_DESCRIPTOR_HANDLE{ command.Value })
+			);
+			bound = command.Value;
+			++context.Stats.DescriptorTableBinds;
+			break;
+		}
+		case DrawPacketStream::CommandType::ConstantBufferView:
+		{
+			TINY_CORE_ASSERT(command.Arg < RootBindingCache::MaxRootParameters, "Root parameter index is too large");
+			D3D12_GPU_VIRTUAL_ADDRESS& bound = context.Bindings.ConstantBufferViews[command.Arg];
+			if (bound == command.Value)
+			{
+				++context.Stats.RedundantBindsSkipped;
+				break;
+			}
+			GFX_THROW_INFO_ONLY(
+				commandList->SetGraphicsRootConstantBufferView(command.Arg, command.Value)
+			);
+			bound = command.Value;
+			++context.Stats.ConstantBufferViewBinds;
+			break;
+		}
+		case DrawPacketStream::CommandType::Draw:
+			GFX_THROW_INFO_ONLY(
+				commandList->DrawIndexedInstanced(command.Arg, 1, command.Draw.StartIndexLocation, command.Draw.BaseVertexLocation, 0)
+			);
+			++context.Stats.DrawCalls;
+			++context.Stats.InstancesDrawn;
+			break;
+		}
+		++iii;
+	}
+}
+void Engine::BindDescriptorTable(RecordingContext& context, const RootDescriptorTable& table)
+{
+	TINY_CORE_ASSERT(table.Index() < RootBindingCache::MaxRootParameters, "Root parameter index is too large");
+
+	UINT64& bound = context.Bindings.DescriptorTables[table.Index()];
+	if (bound == table.DescriptorHandle.ptr)
+	{
+		++context.Stats.RedundantBindsSkipped;
+		return;
+	}
+
+	GFX_THROW_INFO_ONLY(
+		context.CommandList->SetGraphicsRootDescriptorTable(table.Index(), table.DescriptorHandle)
+	);
+	bound = table.DescriptorHandle.ptr;
+	++context.Stats.DescriptorTableBinds;
+}
+void Engine::BindConstantBufferView(RecordingContext& context, const RootConstantBufferView& cbv)
+{
+	TINY_CORE_ASSERT(cbv.RootParameterIndex < RootBindingCache::MaxRootParameters, "Root parameter index is too large");
+
+	D3D12_GPU_VIRTUAL_ADDRESS address = cbv.ConstantBuffer->GetGPUVirtualAddress(m_currentFrameIndex);
+	D3D12_GPU_VIRTUAL_ADDRESS& bound = context.Bindings.ConstantBufferViews[cbv.RootParameterIndex];
+	if (bound == address)
+	{
+		++context.Stats.RedundantBindsSkipped;
+		return;
+	}
+
+	GFX_THROW_INFO_ONLY(
+		context.CommandList->SetGraphicsRootConstantBufferView(cbv.RootParameterIndex, address)
+	);
+	bound = address;
+	++context.Stats.ConstantBufferViewBinds;
+}
 void Engine::PresentImpl()
 {
 	PROFILE_FUNCTION();
@@ -229,30 +833,83 @@ void Engine::PresentImpl()
 	
 	m_deviceResources->Present();
 
-	m_fences[m_currentFrameIndex] = m_deviceResources->GetCurrentFenceValue();
+	UINT64 fenceValue = m_deviceResources->GetCurrentFenceValue();
 
 	// Add an instruction to the command queue to set a new fence point. 
 	// Because we are on the GPU timeline, the new fence point won't be 
 	// set until the GPU finishes processing all the commands prior to this Signal().
 	GFX_THROW_INFO(
-		m_deviceResources->GetCommandQueue()->Signal(m_deviceResources->GetFence(), m_fences[m_currentFrameIndex])
+		m_deviceResources->GetCommandQueue()->Signal(m_deviceResources->GetFence(), fenceValue)
 	);
+	m_framePacer->EndFrame(fenceValue);
+}
+UploadTicket Engine::SubmitPendingUploads()
+{
+	Engine& engine = Get();
+	TINY_CORE_ASSERT(engine.m_initialized, "Engine has not been initialized");
+
+	// Copies that SubmitUploadsAsync() submitted along with streamed textures are waited on as well. Fence values only
+	// increase, so waiting for a new submission covers them
+	UploadTicket ticket = engine.m_unwaitedUploadTicket;
+	if (engine.m_uploadScheduler->HasPendingUploads())
+		ticket = engine.m_uploadScheduler->Submit();
+	else if (ticket.FenceValue == 0)
+		return engine.m_uploadScheduler->LastSubmitted();
+
+	engine.m_uploadScheduler->WaitOnQueue(engine.m_deviceResources->GetCommandQueue(), ticket);
+	engine.m_hasUnwaitedUploads = false;
+	engine.m_unwaitedUploadTicket = {};
+	return ticket;
+}
+UploadTicket Engine::SubmitUploadsAsync()
+{
+	Engine& engine = Get();
+	TINY_CORE_ASSERT(engine.m_initialized, "Engine has not been initialized");
+
+	UploadTicket ticket = engine.m_uploadScheduler->Submit();
+	if (engine.m_hasUnwaitedUploads)
+	{
+		engine.m_unwaitedUploadTicket = ticket;
+		engine.m_hasUnwaitedUploads = false;
+	}
+	return ticket;
+}
+
+MipGenerator& Engine::GetMipGenerator()
+{
+	TINY_CORE_ASSERT(m_initialized, "Engine has not been initialized");
+
+	if (m_mipGenerator == nullptr) UNLIKELY
+		m_mipGenerator = std::make_unique<MipGenerator>(m_deviceResources);
+	return *m_mipGenerator;
 }
 void Engine::CleanupResources() noexcept
 {
 	PROFILE_FUNCTION();
 
-	if (m_resourcesToDelete.size() > 0)
-	{
-		UINT64 completedFence = m_deviceResources->GetFence()->GetCompletedValue();
+	// NOTE: This must only be called once the fence for the current frame resource has been waited on. Everything in
+	//       the bucket was retired while this frame resource was last in use, so it is all safe to release
+	RetireBucket& bucket = m_retireBuckets[m_currentFrameIndex];
 
-		// Erase all elements for which the completed fence is at or beyond the fence value in the tuple
-		std::erase_if(m_resourcesToDelete, [&completedFence](const std::tuple<UINT64, Microsoft::WRL::ComPtr<ID3D12Resource>>& tup)
-			{
-				return completedFence >= std::get<0>(tup);
-			}
-		);
+	m_deletionStats.BytesReleasedThisFrame = bucket.Bytes;
+	m_deletionStats.ResourcesReleasedThisFrame = static_cast<unsigned int>(bucket.Resources.size());
+	m_deletionStats.BytesPending -= bucket.Bytes;
+	m_deletionStats.ResourcesPending -= static_cast<unsigned int>(bucket.Resources.size());
+
+	// clear() keeps the capacity, so retiring resources does not allocate in the steady state
+	bucket.Resources.clear();
+	bucket.Bytes = 0;
+}
+void Engine::ReleaseRetiredResources() noexcept
+{
+	// NOTE: Only valid while the GPU is idle
+	for (RetireBucket& bucket : m_retireBuckets)
+	{
+		bucket.Resources.clear();
+		bucket.Bytes = 0;
 	}
+	m_deletionStats.BytesPending = 0;
+	m_deletionStats.ResourcesPending = 0;
 }
 void Engine::ResetCommandAllocatorAndCommandList()
 {
@@ -291,13 +948,11 @@ void Engine::RunComputeLayerUpdates(const Timer& timer)
 {
 	for (ComputeLayer* layer : m_computeLayersUpdateOnly)
 	{
-		RunComputeLayer(*layer, &timer);
+		RunComputeLayer(*layer, m_deviceResources->GetCommandList(), &timer);
 	}
 }
-void Engine::RunComputeLayer(const ComputeLayer& layer, const Timer* timer)
+void Engine::RunComputeLayer(const ComputeLayer& layer, ID3D12GraphicsCommandList* commandList, const Timer* timer)
 {
-	auto commandList = m_deviceResources->GetCommandList();
-
 	PROFILE_SCOPE(layer.Name.c_str());
 
 	TINY_CORE_ASSERT(layer.ComputeItems.size() > 0, "Compute layer has no compute items");
@@ -309,6 +964,13 @@ void Engine::RunComputeLayer(const ComputeLayer& layer, const Timer* timer)
 	if (!layer.PreWork(layer, commandList, timer, m_currentFrameIndex))
 		return;
 
+	// Upload after the PreWork, which may have changed the data (see the waves disturb layer in the sandbox)
+	for (const ComputeItem& item : layer.ComputeItems)
+	{
+		for (const RootConstantBufferView& cbv : item.ConstantBufferViews)
+			cbv.ConstantBuffer->Upload(m_frameNumber);
+	}
+
 	// Root Signature / PSO
 	GFX_THROW_INFO_ONLY(commandList->SetComputeRootSignature(layer.RootSignature->Get()));
 	GFX_THROW_INFO_ONLY(commandList->SetPipelineState(layer.PipelineState.Get()));
@@ -340,20 +1002,89 @@ void Engine::UpdateRenderItems(const Timer& timer)
 {
 	PROFILE_FUNCTION();
 
-	for (RenderItem* item : m_allRenderItems)
+	auto start = std::chrono::high_resolution_clock::now();
+	UpdateItems(m_allRenderItems.Values(), timer);
+
+	// Only visit the WhenDirty items that have been marked dirty. Copy the list out first because Update() functions
+	// are allowed to mark other items dirty
+	if (m_dirtyRenderItems.size() > 0)
 	{
-		TINY_CORE_ASSERT(item != nullptr, "RenderItem should never be nullptr");
-		item->Update(timer, m_currentFrameIndex);
+		m_dirtyRenderItemsScratch.assign(m_dirtyRenderItems.begin(), m_dirtyRenderItems.end());
+		UpdateItems(m_dirtyRenderItemsScratch, timer);
+		m_updateStats.DirtyRenderItemsUpdated = static_cast<unsigned int>(m_dirtyRenderItemsScratch.size());
+
+		// Anything that no longer needs updating comes off the list. NOTE: Calling MarkDirty() on one of these items
+		// during Update() only raises its frame count (it is still dirty), so it is also handled here. An item that was
+		// switched to EveryFrame during Update() has already been moved to the other list and has no count to decrement
+		for (RenderItem* item : m_dirtyRenderItemsScratch)
+		{
+			if (item->m_updateMode != RenderItem::UpdateMode::WhenDirty || item->m_numFramesDirty == 0)
+				continue;
+
+			if (--item->m_numFramesDirty == 0)
+				RemoveRenderItemImpl(item);
+		}
 	}
+
+	m_updateStats.RenderItemUpdateMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
 }
 void Engine::UpdateComputeItems(const Timer& timer)
 {
 	PROFILE_FUNCTION();
 
-	for (ComputeItem* item : m_allComputeItems)
+	auto start = std::chrono::high_resolution_clock::now();
+	UpdateItems(m_allComputeItems.Values(), timer);
+	m_updateStats.ComputeItemUpdateMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+template<typename T>
+void Engine::UpdateItems(const std::vector<T*>& items, const Timer& timer)
+{
+	// Not worth the overhead of scheduling tasks for a small number of items
+	if (!m_parallelUpdate || items.size() < 2 * ItemsPerUpdateChunk)
+	{
+		for (T* item : items)
+		{
+			TINY_CORE_ASSERT(item != nullptr, "Item should never be nullptr");
+			item->Update(timer, m_currentFrameIndex);
+		}
+		m_updateStats.ItemsUpdatedSerially += static_cast<unsigned int>(items.size());
+		return;
+	}
+
+	// parallel_for hands out chunks to the PPL scheduler, which work-steals between threads, so chunks with
+	// expensive items do not hold up the rest of the update
+	const size_t chunkCount = (items.size() + ItemsPerUpdateChunk - 1) / ItemsPerUpdateChunk;
+	std::atomic<unsigned int> parallelCount = 0;
+	m_updatingInParallel = true;
+	concurrency::parallel_for(size_t(0), chunkCount, [this, &items, &timer, &parallelCount](size_t chunk)
+		{
+			const size_t begin = chunk * ItemsPerUpdateChunk;
+			const size_t end = std::min<size_t>(begin + ItemsPerUpdateChunk, items.size());
+			unsigned int count = 0;
+			for (size_t iii = begin; iii < end; ++iii)
+			{
+				TINY_CORE_ASSERT(items[iii] != nullptr, "Item should never be nullptr");
+				if (items[iii]->ThreadSafeUpdate)
+				{
+					items[iii]->Update(timer, m_currentFrameIndex);
+					++count;
+				}
+			}
+			parallelCount += count;
+		}
+	);
+	m_updatingInParallel = false;
+	m_updateStats.ItemsUpdatedInParallel += parallelCount;
+
+	// Items that are not thread safe are updated afterwards on this thread. NOTE: This means they are no longer
+	// updated in registration order relative to the thread safe items
+	for (T* item : items)
 	{
-		TINY_CORE_ASSERT(item != nullptr, "RenderItem should never be nullptr");
-		item->Update(timer, m_currentFrameIndex);
+		if (!item->ThreadSafeUpdate)
+		{
+			item->Update(timer, m_currentFrameIndex);
+			++m_updateStats.ItemsUpdatedSerially;
+		}
 	}
 }
 void Engine::UpdateRenderPasses(const Timer& timer)
@@ -379,9 +1110,23 @@ void Engine::UpdateDynamicMeshes(const Timer& timer)
 
 void Engine::DelayedDeleteImpl(Microsoft::WRL::ComPtr<ID3D12Resource> resource) noexcept
 {
-	// store a ComPtr to the resource as well as the maximum fence value for the GPU where
-	// the resource might still be referenced
-	m_resourcesToDelete.emplace_back(m_fences[m_currentFrameIndex], resource);
+	if (resource == nullptr)
+		return;
+
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "Engine has not been initialized");
+
+	// The resource may be referenced by any frame up to and including the current one. The current frame resource's
+	// fence is signaled at the end of this frame, and its bucket is not released until Update() has waited on that
+	// fence (or, if called between Present() and Update(), the fence that was just signaled)
+	D3D12_RESOURCE_DESC desc = resource->GetDesc();
+	UINT64 bytes = m_deviceResources->GetDevice()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+
+	RetireBucket& bucket = m_retireBuckets[m_currentFrameIndex];
+	bucket.Resources.push_back(std::move(resource));
+	bucket.Bytes += bytes;
+
+	m_deletionStats.BytesPending += bytes;
+	++m_deletionStats.ResourcesPending;
 }
 
 
@@ -396,46 +1141,79 @@ void Engine::AddRenderItemImpl(RenderItem* item) noexcept
 {
 	// The reason for holding a list of render items is strictly so we can call RenderItem::Update()
 	// Therefore, we do NOT want duplicate render items, which is possible if a render item is shared
-	// across render passes
-	std::vector<RenderItem*>::iterator position = std::find(m_allRenderItems.begin(), m_allRenderItems.end(), item);
-	if (position == m_allRenderItems.end())
-		m_allRenderItems.push_back(item);
+	// across render passes. The item's handle tells us whether it is already registered
+	TINY_CORE_ASSERT(CanModifyItemLists(), "Render items can only be registered/marked dirty on the main thread, and not from a ThreadSafeUpdate Update()");
+	if (item->m_engineHandle.IsValid())
+		return;
+
+	utility::SlotMap<RenderItem>& items = item->m_updateMode == RenderItem::UpdateMode::EveryFrame ? m_allRenderItems : m_dirtyRenderItems;
+	item->m_engineHandle = items.Insert(item);
 }
 void Engine::RemoveRenderItemImpl(RenderItem* item) noexcept
 {
-	std::vector<RenderItem*>::iterator position = std::find(m_allRenderItems.begin(), m_allRenderItems.end(), item);
-	if (position != m_allRenderItems.end())
-		m_allRenderItems.erase(position);
+	TINY_CORE_ASSERT(CanModifyItemLists(), "Render items can only be unregistered on the main thread, and not from a ThreadSafeUpdate Update()");
+	if (!item->m_engineHandle.IsValid())
+		return;
+
+	utility::SlotMap<RenderItem>& items = item->m_updateMode == RenderItem::UpdateMode::EveryFrame ? m_allRenderItems : m_dirtyRenderItems;
+	items.Remove(item->m_engineHandle);
+	item->m_engineHandle = {};
+}
+void Engine::ReplaceRenderItemImpl(RenderItem* item) noexcept
+{
+	utility::SlotMap<RenderItem>& items = item->m_updateMode == RenderItem::UpdateMode::EveryFrame ? m_allRenderItems : m_dirtyRenderItems;
+	items.Replace(item->m_engineHandle, item);
 }
 void Engine::AddComputeItemImpl(ComputeItem* item) noexcept
 {
 	// The reason for holding a list of compute items is strictly so we can call ComputeItem::Update()
 	// Therefore, we do NOT want duplicate compute items, which is possible if a compute item is shared
 	// across render passes
-	std::vector<ComputeItem*>::iterator position = std::find(m_allComputeItems.begin(), m_allComputeItems.end(), item);
-	if (position == m_allComputeItems.end())
-		m_allComputeItems.push_back(item);
+	if (!item->m_engineHandle.IsValid())
+		item->m_engineHandle = m_allComputeItems.Insert(item);
 }
 void Engine::RemoveComputeItemImpl(ComputeItem* item) noexcept
 {
-	std::vector<ComputeItem*>::iterator position = std::find(m_allComputeItems.begin(), m_allComputeItems.end(), item);
-	if (position != m_allComputeItems.end())
-		m_allComputeItems.erase(position);
+	if (!item->m_engineHandle.IsValid())
+		return;
+
+	m_allComputeItems.Remove(item->m_engineHandle);
+	item->m_engineHandle = {};
+}
+void Engine::ReplaceComputeItemImpl(ComputeItem* item) noexcept
+{
+	m_allComputeItems.Replace(item->m_engineHandle, item);
 }
 void Engine::AddDynamicMeshGroupImpl(DynamicMeshGroup* mesh) noexcept
 {
 	// The reason for holding a list of dynamic meshes is strictly so we can call DynamicMeshGroup::Update()
 	// Therefore, we do NOT want duplicate dynamic meshes, which is possible if the mesh is shared across
 	// render passes
-	std::vector<DynamicMeshGroup*>::iterator position = std::find(m_dynamicMeshes.begin(), m_dynamicMeshes.end(), mesh);
-	if (position == m_dynamicMeshes.end())
-		m_dynamicMeshes.push_back(mesh);
+	if (!mesh->m_engineHandle.IsValid())
+		mesh->m_engineHandle = m_dynamicMeshes.Insert(mesh);
 }
 void Engine::RemoveDynamicMeshGroupImpl(DynamicMeshGroup* mesh) noexcept
 {
-	std::vector<DynamicMeshGroup*>::iterator position = std::find(m_dynamicMeshes.begin(), m_dynamicMeshes.end(), mesh); 
-	if (position != m_dynamicMeshes.end())
-		m_dynamicMeshes.erase(position);
+	if (!mesh->m_engineHandle.IsValid())
+		return;
+
+	m_dynamicMeshes.Remove(mesh->m_engineHandle);
+	mesh->m_engineHandle = {};
+}
+void Engine::QueueBoundsUpdateImpl(RenderItem* item) noexcept
+{
+	TINY_CORE_ASSERT(CanModifyItemLists(), "Transform/submesh changes to items in a BVH can only be made on the main thread, and not from a ThreadSafeUpdate Update()");
+	if (!item->m_boundsUpdateHandle.IsValid())
+		item->m_boundsUpdateHandle = m_pendingBoundsUpdates.Insert(item);
+}
+void Engine::RemoveBoundsUpdateImpl(RenderItem* item) noexcept
+{
+	m_pendingBoundsUpdates.Remove(item->m_boundsUpdateHandle);
+	item->m_boundsUpdateHandle = {};
+}
+void Engine::ReplaceBoundsUpdateImpl(RenderItem* item) noexcept
+{
+	m_pendingBoundsUpdates.Replace(item->m_boundsUpdateHandle, item);
 }
 void Engine::AddComputeUpdateLayerImpl(ComputeLayer* layer) noexcept
 {
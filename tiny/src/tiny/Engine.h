@@ -3,25 +3,100 @@
 #include "tiny/Core.h"
 #include "tiny/Log.h"
 #include "tiny/DeviceResources.h"
+#include "tiny/rendering/CommandListPool.h"
+#include "tiny/rendering/FramePacer.h"
+#include "tiny/rendering/GpuMemoryAllocator.h"
+#include "tiny/rendering/MipGenerator.h"
+#include "tiny/rendering/ResidencyManager.h"
+#include "tiny/rendering/UploadScheduler.h"
+#include "tiny/rendering/UploadRing.h"
+#include "tiny/utils/SlotMap.h"
 #include "tiny/utils/Timer.h"
 
 
 
 namespace tiny
 {
+class Camera;
 class ConstantBuffer;
 class RenderPass;
 class RenderItem;
+class RenderPassLayer;
 class ComputeItem;
 class ComputeLayer;
 class MeshGroup;
 class DynamicMeshGroup;
 class Texture;
+class TextureVector;
 class TextureManager;
+class RootDescriptorTable;
+class RootConstantBufferView;
+class DrawPacketStream;
 
 class Engine
 {
 public:
+	// Counters for the commands recorded during the most recent call to Render()
+	struct RenderStats
+	{
+		unsigned int DrawCalls = 0;
+		unsigned int InstancesDrawn = 0;
+		unsigned int PipelineStateBinds = 0;
+		unsigned int DescriptorTableBinds = 0;
+		unsigned int ConstantBufferViewBinds = 0;
+		unsigned int RedundantBindsSkipped = 0; // Binds that were not issued because the same value was already bound
+		unsigned int CommandLists = 0;			// Number of command lists submitted for the frame
+		unsigned int ItemsCulled = 0;			// Items in FrustumCull layers that were outside of the frustum
+		unsigned int ItemsTestedForCulling = 0;
+		unsigned int DrawPacketCompiles = 0;	// Layers whose DrawPacketStream had to be (re)compiled
+		long long RecordingMicroseconds = 0;	// Time spent recording the frame (after culling), including waiting on workers
+
+		inline RenderStats& operator+=(const RenderStats& rhs) noexcept
+		{
+			DrawCalls += rhs.DrawCalls;
+			InstancesDrawn += rhs.InstancesDrawn;
+			PipelineStateBinds += rhs.PipelineStateBinds;
+			DescriptorTableBinds += rhs.DescriptorTableBinds;
+			ConstantBufferViewBinds += rhs.ConstantBufferViewBinds;
+			RedundantBindsSkipped += rhs.RedundantBindsSkipped;
+			CommandLists += rhs.CommandLists;
+			ItemsCulled += rhs.ItemsCulled;
+			ItemsTestedForCulling += rhs.ItemsTestedForCulling;
+			DrawPacketCompiles += rhs.DrawPacketCompiles;
+			RecordingMicroseconds += rhs.RecordingMicroseconds;
+			return *this;
+		}
+	};
+
+	// Counters and timings for the most recent call to Update()
+	struct UpdateStats
+	{
+		unsigned int ItemsUpdatedInParallel = 0;
+		unsigned int ItemsUpdatedSerially = 0;
+		unsigned int DirtyRenderItemsUpdated = 0;	// WhenDirty items updated this frame (included in the counts above)
+		long long RenderItemUpdateMicroseconds = 0;
+		long long ComputeItemUpdateMicroseconds = 0;
+	};
+
+	// Counters for the resources passed to DelayedDelete() that the GPU may still be referencing
+	struct DeletionStats
+	{
+		UINT64 BytesPending = 0;
+		unsigned int ResourcesPending = 0;
+		UINT64 BytesReleasedThisFrame = 0;			// Released at the start of the most recent call to Update()
+		unsigned int ResourcesReleasedThisFrame = 0;
+	};
+
+	// When parallel update is enabled, render/compute items are updated in chunks of this size on the PPL scheduler
+	static constexpr size_t ItemsPerUpdateChunk = 256;
+
+	// Layers with at least this many items (times 2) are split into chunks of this size, and each chunk is recorded
+	// into its own command list on a worker thread. Instanced layers and layers with a PreWork are never split
+	static constexpr size_t ItemsPerRecordingChunk = 1024;
+
+	// FrustumCull layers with at least this many items are culled by querying a BVH instead of testing every item
+	static constexpr size_t MinItemsForBVHCulling = 1024;
+
 	// NOTE: ONLY these methods should be public because these are the only ones that the client 
 	//       needs to actually call. Every other method can be private because we make all of the
 	//       render classes friends of Engine
@@ -32,6 +107,53 @@ public:
 	static inline void SetViewport(const D3D12_VIEWPORT& vp) noexcept { Get().SetViewportImpl(vp); }
 	static inline void SetScissorRect(const D3D12_RECT& rect) noexcept { Get().SetScissorRectImpl(rect); }
 	ND static inline int GetCurrentFrameIndex() noexcept { return Get().GetCurrentFrameIndexImpl(); }
+	ND static inline const UploadRing& GetUploadRing() noexcept { return *Get().m_uploadRing; }
+	ND static inline const RenderStats& GetRenderStats() noexcept { return Get().m_renderStats; }
+	ND static inline const DeletionStats& GetDeletionStats() noexcept { return Get().m_deletionStats; }
+	ND static inline const FramePacer& GetFramePacer() noexcept { return *Get().m_framePacer; }
+	ND static inline GpuMemoryAllocator::Stats GetMemoryStats() { return Get().m_memoryAllocator->GetStats(); }
+	ND static inline const GpuMemoryAllocator& GetMemoryAllocator() noexcept { return *Get().m_memoryAllocator; }
+	ND static inline const StagingUploader::Stats& GetUploadStats() noexcept { return Get().m_uploadScheduler->GetStaging().GetStats(); }
+
+	// GPU memory used by each category of resource created through the Engine. With a budget set (0 means none),
+	// meshes and cached textures that have been idle the longest are evicted at the start of Update() until the
+	// usage fits, and are recreated the next time they are drawn/requested (see ResidencyManager)
+	ND static inline ResidencyManager::Stats GetResidencyStats() { return Get().m_residencyManager->GetStats(); }
+	static inline void SetMemoryBudget(UINT64 bytes) noexcept { Get().m_residencyManager->SetBudget(bytes); }
+	ND static inline UINT64 GetMemoryBudget() noexcept { return Get().m_residencyManager->GetBudget(); }
+	// How many frames a mesh/cached texture must go unused before it may be evicted
+	static inline void SetMinIdleFramesBeforeEviction(UINT64 frames) noexcept { Get().m_residencyManager->SetMinIdleFrames(frames); }
+
+	// Mesh and texture data is staged when the MeshGroup/Texture is created and submitted to the copy queue in one
+	// batch right before the frame's command lists are executed (the direct queue waits on the GPU for the copies).
+	// Anything created outside of the frame (i.e. during initialization) must be submitted by calling this before
+	// the direct command lists that use it are executed. The returned ticket can be polled with IsUploadComplete().
+	// If nothing is pending (and SubmitUploadsAsync() did not submit anything the direct queue has to wait for), nothing
+	// waits and the ticket of the most recent submission is returned
+	static UploadTicket SubmitPendingUploads();
+	ND static inline bool IsUploadComplete(UploadTicket ticket) { return Get().m_uploadScheduler->IsComplete(ticket); }
+	static inline void SetTargetFrameRate(double framesPerSecond) noexcept { Get().m_framePacer->SetTargetFrameRate(framesPerSecond); }
+	static inline void SetMaxFramesInFlight(unsigned int count) noexcept { Get().m_framePacer->SetMaxFramesInFlight(count); }
+
+	// Number of frame resources (i.e. how many frames the CPU may get ahead of the GPU). Must be in
+	// [gMinFrameResources, gMaxFrameResources]. Changing it after Init() flushes the GPU, so it must only be called
+	// between frames (i.e. not between Update() and Present())
+	static inline void SetFrameResourceCount(unsigned int count) { Get().SetFrameResourceCountImpl(count); }
+	ND static inline unsigned int GetFrameResourceCount() noexcept { return Get().m_frameResourceCount; }
+	static inline void SetParallelRecording(bool enabled) noexcept { Get().m_parallelRecording = enabled; }
+	ND static inline bool GetParallelRecording() noexcept { return Get().m_parallelRecording; }
+	ND static inline const UpdateStats& GetUpdateStats() noexcept { return Get().m_updateStats; }
+	static inline void SetParallelUpdate(bool enabled) noexcept { Get().m_parallelUpdate = enabled; }
+	ND static inline bool GetParallelUpdate() noexcept { return Get().m_parallelUpdate; }
+
+	// When disabled, layers with RenderPassLayer::CompileDrawPackets set are recorded item by item like every other
+	// layer (useful for comparing the two paths via RenderStats::RecordingMicroseconds)
+	static inline void SetDrawPacketReplay(bool enabled) noexcept { Get().m_drawPacketReplay = enabled; }
+	ND static inline bool GetDrawPacketReplay() noexcept { return Get().m_drawPacketReplay; }
+
+	// Frustum used to cull layers that have RenderPassLayer::FrustumCull enabled. Call this every frame once the
+	// camera's view matrix is up to date. Nothing is culled until this has been called
+	static void SetCullingCamera(const Camera& camera) noexcept;
 
 	static inline void AddComputeUpdateLayer(ComputeLayer* layer) noexcept { Get().AddComputeUpdateLayerImpl(layer); }
 
@@ -53,7 +175,55 @@ private:
 	inline void SetViewportImpl(const D3D12_VIEWPORT& vp) noexcept { m_viewport = vp; }
 	inline void SetScissorRectImpl(const D3D12_RECT& rect) noexcept { m_scissorRect = rect; }
 	ND inline int GetCurrentFrameIndexImpl() const noexcept { return m_currentFrameIndex; }
+	void SetFrameResourceCountImpl(unsigned int count);
+	void CreateCommandAllocators();
+	void ReleaseRetiredResources() noexcept;
+
+
+	ND static inline UINT64 GetFrameNumber() noexcept { return Get().m_frameNumber; }
+	ND static inline UploadRing::Allocation AllocateUpload(UINT64 byteSize) { return Get().m_uploadRing->Allocate(byteSize); }
+
+	// All buffers/textures owned by render classes should be created through here (see GpuMemoryAllocator). The
+	// resource's memory is counted against 'category' until it is destroyed
+	ND static inline Microsoft::WRL::ComPtr<ID3D12Resource> CreateResource(MemoryCategory category, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue = nullptr)
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource = Get().m_memoryAllocator->CreateResource(heapType, desc, initialState, clearValue);
+		Get().m_residencyManager->Track(resource.Get(), category);
+		return resource;
+	}
+	// For resources that are not created by CreateResource()
+	static inline void TrackResource(ID3D12Resource* resource, MemoryCategory category) { Get().m_residencyManager->Track(resource, category); }
+
+	// See ResidencyManager. Main thread only
+	ND static inline ResidencyManager::Handle RegisterEvictable(UINT64 byteSize, std::function<void()> evict) { return Get().m_residencyManager->Register(byteSize, std::move(evict)); }
+	static inline void UnregisterEvictable(ResidencyManager::Handle handle) noexcept { Get().m_residencyManager->Unregister(handle); }
+	static inline void SetEvictable(ResidencyManager::Handle handle, bool evictable) noexcept { Get().m_residencyManager->SetEvictable(handle, evictable, Get().m_frameNumber); }
+	static inline void TouchEvictable(ResidencyManager::Handle handle) noexcept { Get().m_residencyManager->Touch(handle, Get().m_frameNumber); }
+	// 'destination' must be in the COMMON state, and is back in the COMMON state once the copy has completed
+	static inline void StageBufferUpload(Microsoft::WRL::ComPtr<ID3D12Resource> destination, const void* data, UINT64 byteSize)
+	{
+		Get().m_uploadScheduler->StageBuffer(std::move(destination), 0, data, byteSize);
+		Get().m_hasUnwaitedUploads = true;
+	}
+	static inline void StageTextureUpload(Microsoft::WRL::ComPtr<ID3D12Resource> destination, const D3D12_SUBRESOURCE_DATA* subresources, UINT subresourceCount)
+	{
+		Get().m_uploadScheduler->StageTexture(std::move(destination), subresources, 0, subresourceCount);
+		Get().m_hasUnwaitedUploads = true;
+	}
+	// Same as StageTextureUpload(), for a texture that is not read until the ticket of the submission it goes out in
+	// has completed (i.e. streamed textures, see TextureManager). The direct queue never waits for these copies
+	static inline void StageStreamedTextureUpload(Microsoft::WRL::ComPtr<ID3D12Resource> destination, const D3D12_SUBRESOURCE_DATA* subresources, UINT subresourceCount)
+	{
+		Get().m_uploadScheduler->StageTexture(std::move(destination), subresources, 0, subresourceCount);
+	}
+	// Submits everything staged so far without making the direct queue wait. If that includes copies that were not
+	// staged with StageStreamedTextureUpload(), the next SubmitPendingUploads() makes the direct queue wait for them
+	ND static UploadTicket SubmitUploadsAsync();
 
+	// See MipGenerator (created the first time a texture generates its mips)
+	static inline void GenerateMips(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource, std::span<const unsigned int> mipUAVs) { Get().GetMipGenerator().Generate(commandList, resource, mipUAVs); }
+	ND static inline bool SupportsGPUMipGeneration(DXGI_FORMAT format) { return Get().GetMipGenerator().SupportsFormat(format); }
+	ND MipGenerator& GetMipGenerator();
 
 	void CleanupResources() noexcept;
 	static inline void DelayedDelete(Microsoft::WRL::ComPtr<ID3D12Resource> resource) noexcept { Get().DelayedDeleteImpl(resource); }
@@ -64,8 +234,13 @@ private:
 	static inline void RemoveRenderPass(RenderPass* pass) noexcept { Get().RemoveRenderPassImpl(pass); }
 	static inline void AddRenderItem(RenderItem* item) noexcept { Get().AddRenderItemImpl(item); }
 	static inline void RemoveRenderItem(RenderItem* item) noexcept { Get().RemoveRenderItemImpl(item); }
+	static inline void ReplaceRenderItem(RenderItem* item) noexcept { Get().ReplaceRenderItemImpl(item); }
 	static inline void AddComputeItem(ComputeItem* item) noexcept { Get().AddComputeItemImpl(item); }
 	static inline void RemoveComputeItem(ComputeItem* item) noexcept { Get().RemoveComputeItemImpl(item); }
+	static inline void ReplaceComputeItem(ComputeItem* item) noexcept { Get().ReplaceComputeItemImpl(item); }
+	static inline void QueueBoundsUpdate(RenderItem* item) noexcept { Get().QueueBoundsUpdateImpl(item); }
+	static inline void RemoveBoundsUpdate(RenderItem* item) noexcept { Get().RemoveBoundsUpdateImpl(item); }
+	static inline void ReplaceBoundsUpdate(RenderItem* item) noexcept { Get().ReplaceBoundsUpdateImpl(item); }
 	static inline void AddDynamicMeshGroup(DynamicMeshGroup* mesh) noexcept { Get().AddDynamicMeshGroupImpl(mesh); }
 	static inline void RemoveDynamicMeshGroup(DynamicMeshGroup* mesh) noexcept { Get().RemoveDynamicMeshGroupImpl(mesh); }
 	
@@ -73,8 +248,13 @@ private:
 	void RemoveRenderPassImpl(RenderPass* pass) noexcept;
 	void AddRenderItemImpl(RenderItem* item) noexcept;
 	void RemoveRenderItemImpl(RenderItem* item) noexcept;
+	void ReplaceRenderItemImpl(RenderItem* item) noexcept;
 	void AddComputeItemImpl(ComputeItem* item) noexcept;
 	void RemoveComputeItemImpl(ComputeItem* item) noexcept;
+	void ReplaceComputeItemImpl(ComputeItem* item) noexcept;
+	void QueueBoundsUpdateImpl(RenderItem* item) noexcept;
+	void RemoveBoundsUpdateImpl(RenderItem* item) noexcept;
+	void ReplaceBoundsUpdateImpl(RenderItem* item) noexcept;
 	void AddDynamicMeshGroupImpl(DynamicMeshGroup* mesh) noexcept;
 	void RemoveDynamicMeshGroupImpl(DynamicMeshGroup* mesh) noexcept;
 
@@ -87,31 +267,137 @@ private:
 	void UpdateRenderItems(const Timer& timer);
 	void UpdateComputeItems(const Timer& timer);
 	void UpdateRenderPasses(const Timer& timer);
+	template<typename T>
+	void UpdateItems(const std::vector<T*>& items, const Timer& timer);
 	void UpdateDynamicMeshes(const Timer& timer);
 	void RunComputeLayerUpdates(const Timer& timer);
-	void RunComputeLayer(const ComputeLayer& layer, const Timer* timer);
+	void RunComputeLayer(const ComputeLayer& layer, ID3D12GraphicsCommandList* commandList, const Timer* timer);
+
+	// Tracks what is currently bound to each graphics root parameter so that redundant binds can be skipped.
+	// Must be reset any time the root signature is set because that invalidates all root arguments
+	struct RootBindingCache
+	{
+		static constexpr unsigned int MaxRootParameters = 64;
+		ID3D12PipelineState* PipelineState = nullptr;
+		std::array<UINT64, MaxRootParameters> DescriptorTables = {};
+		std::array<D3D12_GPU_VIRTUAL_ADDRESS, MaxRootParameters> ConstantBufferViews = {};
+
+		inline void Reset() noexcept
+		{
+			PipelineState = nullptr;
+			DescriptorTables.fill(0);
+			ConstantBufferViews.fill(0);
+		}
+	};
+
+	// Everything needed to record into a single command list. Each thread records into its own context, so the
+	// binding cache and the stats never need to be synchronized
+	struct RecordingContext
+	{
+		ID3D12GraphicsCommandList* CommandList = nullptr;
+		RootBindingCache Bindings;
+		RenderStats Stats;
+	};
+
+	// Render methods
+	void CullRenderItems(RenderStats& stats);
+	void ApplyBoundsUpdates();
+	void SyncLayerBVH(RenderPassLayer& layer);
+	ND RecordingContext& AcquireRecordingContext();
+	void PrepareCommandList(ID3D12GraphicsCommandList* commandList);
+	void BeginPass(RecordingContext& context, RenderPass* pass);
+	ND bool BeginLayer(RecordingContext& context, const RenderPassLayer& layer);
+	void RecordLayer(RecordingContext& context, RenderPassLayer& layer);
+	void UploadConstantBuffers(const RenderPassLayer& layer);
+	void RecordLayerInParallel(RecordingContext*& context, RenderPass* pass, RenderPassLayer& layer, concurrency::task_group& tasks);
+	void DrawRenderItem(RecordingContext& context, const RenderItem& item, const MeshGroup* meshGroup);
+	void DrawRenderItemsInstanced(RecordingContext& context, RenderPassLayer& layer, const MeshGroup* meshGroup);
+	ND bool UsesDrawPackets(const RenderPassLayer& layer) const noexcept;
+	void RefreshDrawPackets(RenderPassLayer& layer, RenderStats& stats);
+	void ReplayDrawPackets(RecordingContext& context, const DrawPacketStream& stream, size_t begin, size_t end);
+	void BindDescriptorTable(RecordingContext& context, const RootDescriptorTable& table);
+	void BindConstantBufferView(RecordingContext& context, const RootConstantBufferView& cbv);
 
 private:
 	std::shared_ptr<DeviceResources> m_deviceResources = nullptr;
 	bool m_initialized = false;
 
 	// Rendering resources
-	std::array<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>, gNumFrameResources> m_allocators;
+	unsigned int m_frameResourceCount = gDefaultFrameResources;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_allocators;
 	int m_currentFrameIndex = 0;
 	D3D12_VIEWPORT m_viewport = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f }; // Dummy values
 	D3D12_RECT m_scissorRect = { 0, 0, 1, 1 }; // Dummy values
-	std::array<UINT64, gNumFrameResources> m_fences = {};
+	std::unique_ptr<FramePacer> m_framePacer = nullptr; // Waits on the fence for each frame resource before it is reused
+	UINT64 m_frameNumber = 0; // Monotonically increasing count of frames (incremented every Update)
 
-	// Resources that can be deleted once they are no longer referenced by the GPU
-	std::vector<std::tuple<UINT64, Microsoft::WRL::ComPtr<ID3D12Resource>>> m_resourcesToDelete;
+	// Sub-allocates placed resources out of large heaps
+	std::unique_ptr<GpuMemoryAllocator> m_memoryAllocator = nullptr;
+
+	// Accounts for the memory of every resource created through the Engine and evicts idle data when over budget
+	std::unique_ptr<ResidencyManager> m_residencyManager = nullptr;
+
+	// Copy queue used for all mesh/texture data uploads
+	std::unique_ptr<UploadScheduler> m_uploadScheduler = nullptr;
+	// Copies the direct queue has to wait for: whether any are staged, and the most recent submission that included
+	// some without waiting for them (see SubmitUploadsAsync())
+	bool m_hasUnwaitedUploads = false;
+	UploadTicket m_unwaitedUploadTicket;
+
+	// Per-frame linear allocator for constant buffer data
+	std::unique_ptr<UploadRing> m_uploadRing = nullptr;
+
+	// Compute shader that fills in texture mips. Created the first time it is needed
+	std::unique_ptr<MipGenerator> m_mipGenerator = nullptr;
+
+	// Command lists (beyond the one owned by DeviceResources) used to record the frame, as well as the order in which
+	// they must be submitted. Contexts are stored in a deque so that references remain valid while workers record
+	std::unique_ptr<CommandListPool> m_commandListPool = nullptr;
+	std::deque<RecordingContext> m_recordingContexts;
+	std::vector<ID3D12CommandList*> m_submissionOrder;
+	bool m_parallelRecording = true;
+	bool m_drawPacketReplay = true;
+
+	// Frustum culling
+	DirectX::BoundingFrustum m_cullingFrustum;
+	bool m_hasCullingFrustum = false;
+	utility::SlotMap<RenderItem> m_pendingBoundsUpdates; // Items in a BVH whose world transform changed
+
+	// Render state tracking
+	RenderStats m_renderStats;
+
+	// Update state tracking
+	UpdateStats m_updateStats;
+	bool m_parallelUpdate = true;
+	bool m_updatingInParallel = false; // True while UpdateItems() runs Update() on worker threads
+
+	// The Engine's item lists are not synchronized, so they can only be changed from the thread that called Init(), and
+	// not while Update() functions are running in parallel (see RenderItem::ThreadSafeUpdate)
+	std::thread::id m_mainThreadID;
+	ND inline bool CanModifyItemLists() const noexcept { return std::this_thread::get_id() == m_mainThreadID && !m_updatingInParallel; }
+
+	// Resources that can be deleted once they are no longer referenced by the GPU. They are bucketed by the frame
+	// resource that was current when they were retired, so once Update() has waited on that frame resource's fence,
+	// the whole bucket is released without looking at any other pending resources
+	struct RetireBucket
+	{
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> Resources;
+		UINT64 Bytes = 0;
+	};
+	std::vector<RetireBucket> m_retireBuckets;
+	DeletionStats m_deletionStats;
 
 	// Render passes that will be looped over during rendering
 	std::vector<RenderPass*> m_renderPasses;
 
 	// Data that will be looped over during Update
-	std::vector<RenderItem*> m_allRenderItems;
-	std::vector<ComputeItem*> m_allComputeItems;
-	std::vector<DynamicMeshGroup*> m_dynamicMeshes;
+	// Registries only exist so we can call Update(), so they are unordered. Each object holds its own handle, which
+	// makes adding, removing and moving an object O(1)
+	utility::SlotMap<RenderItem> m_allRenderItems;		// Only render items that are updated every frame
+	utility::SlotMap<RenderItem> m_dirtyRenderItems;	// Render items that are updated only when dirty and currently are
+	std::vector<RenderItem*> m_dirtyRenderItemsScratch;
+	utility::SlotMap<ComputeItem> m_allComputeItems;
+	utility::SlotMap<DynamicMeshGroup> m_dynamicMeshes;
 	std::vector<ComputeLayer*> m_computeLayersUpdateOnly;
 
 
@@ -125,6 +411,9 @@ private:
 	friend DynamicMeshGroup;
 	template<typename> friend class DynamicMeshGroupT;
 	friend Texture;
+	friend TextureVector;
 	friend TextureManager;
+	friend UploadRing;
+	friend StagingUploader;
 };
 }
\ No newline at end of file
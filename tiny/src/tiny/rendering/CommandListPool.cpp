@@ -0,0 +1,81 @@
+#include "tiny-pch.h"
+#include "CommandListPool.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+CommandListPool::CommandListPool(std::shared_ptr<DeviceResources> deviceResources, unsigned int frameResourceCount) :
+	m_deviceResources(deviceResources),
+	m_pools(frameResourceCount)
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+	TINY_CORE_ASSERT(frameResourceCount > 0, "Must have at least 1 frame resource");
+}
+
+ID3D12GraphicsCommandList* CommandListPool::Acquire()
+{
+	FramePool& pool = m_pools[m_currentFrameIndex];
+
+	if (pool.NextEntry < pool.Entries.size()) LIKELY
+	{
+		// The allocator was already reset in Reset(), so the list just needs to start recording into it
+		Entry& entry = pool.Entries[pool.NextEntry++];
+		GFX_THROW_INFO(entry.CommandList->Reset(entry.Allocator.Get(), nullptr));
+		return entry.CommandList.Get();
+	}
+
+	PROFILE_SCOPE("CommandListPool: Create Command List");
+
+	// Out of lists for this frame resource, so grow the pool. A newly created command list is already open
+	Entry& entry = pool.Entries.emplace_back();
+	auto device = m_deviceResources->GetDevice();
+	GFX_THROW_INFO(
+		device->CreateCommandAllocator(
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			IID_PPV_ARGS(entry.Allocator.GetAddressOf())
+		)
+	);
+	GFX_THROW_INFO(
+		device->CreateCommandList(
+			0,
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			entry.Allocator.Get(),
+			nullptr,
+			IID_PPV_ARGS(entry.CommandList.GetAddressOf())
+		)
+	);
+
+	++pool.NextEntry;
+	++m_listCount;
+
+	return entry.CommandList.Get();
+}
+
+void CommandListPool::Reset(unsigned int frameIndex)
+{
+	TINY_CORE_ASSERT(frameIndex < m_pools.size(), "Frame index is larger than expected");
+
+	m_currentFrameIndex = frameIndex;
+
+	// Only the allocators that were actually used need to be reset. All of their lists must have been closed
+	FramePool& pool = m_pools[m_currentFrameIndex];
+	for (unsigned int iii = 0; iii < pool.NextEntry; ++iii)
+	{
+		GFX_THROW_INFO(pool.Entries[iii].Allocator->Reset());
+	}
+	pool.NextEntry = 0;
+}
+
+void CommandListPool::SetFrameResourceCount(unsigned int frameResourceCount) noexcept
+{
+	TINY_CORE_ASSERT(frameResourceCount > 0, "Must have at least 1 frame resource");
+
+	for (size_t iii = frameResourceCount; iii < m_pools.size(); ++iii)
+		m_listCount -= static_cast<unsigned int>(m_pools[iii].Entries.size());
+
+	m_pools.resize(frameResourceCount);
+	m_currentFrameIndex = 0;
+}
+
+}
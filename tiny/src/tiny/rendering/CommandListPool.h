@@ -0,0 +1,54 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+#include "tiny/utils/Constants.h"
+
+namespace tiny
+{
+// CommandListPool owns a growable set of direct command lists for each frame resource. Every list has its own
+// allocator, so lists acquired from the pool may be recorded on different threads at the same time. All of the
+// allocators for a frame resource are reset together (via Reset()) once the Engine has waited on that frame's fence.
+class CommandListPool
+{
+public:
+	CommandListPool(std::shared_ptr<DeviceResources> deviceResources, unsigned int frameResourceCount);
+	~CommandListPool() noexcept {}
+
+	// Returns a command list that is open and ready for recording. NOTE: Acquire() itself is NOT thread safe, so all
+	// lists must be acquired on the main thread before they are handed off to worker threads
+	ND ID3D12GraphicsCommandList* Acquire();
+
+	// Must ONLY be called once the GPU has finished with all command lists that were acquired for the frame resource
+	void Reset(unsigned int frameIndex);
+
+	// Must ONLY be called while the GPU is idle. Lists belonging to frame resources that no longer exist are released
+	void SetFrameResourceCount(unsigned int frameResourceCount) noexcept;
+
+	// Stats
+	ND inline unsigned int ListsAcquiredThisFrame() const noexcept { return m_pools[m_currentFrameIndex].NextEntry; }
+	ND inline unsigned int ListCount() const noexcept { return m_listCount; }
+
+private:
+	CommandListPool(const CommandListPool&) = delete;
+	CommandListPool& operator=(const CommandListPool&) = delete;
+
+	struct Entry
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator = nullptr;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> CommandList = nullptr;
+	};
+	struct FramePool
+	{
+		std::vector<Entry> Entries;
+		unsigned int NextEntry = 0;
+	};
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+
+	std::vector<FramePool> m_pools; // One per frame resource
+	unsigned int m_currentFrameIndex = 0;
+	unsigned int m_listCount = 0;
+};
+}
@@ -6,6 +6,7 @@
 #include "ConstantBuffer.h"
 #include "RootConstantBufferView.h"
 #include "RootDescriptorTable.h"
+#include "tiny/utils/SlotMap.h"
 #include "tiny/utils/Timer.h"
 
 namespace tiny
@@ -20,22 +21,29 @@ public:
 	}
 	// Because we are storing Compute Items in a vector, it is possible that even when using emplace_back, the vector
 	// may need to grow, and therefore, need to move the contents of all of the compute items. So we must implement
-	// move operations. However, moving the object causes the 'this' pointer to change, so we must update the Engine
+	// move operations. However, moving the object causes the 'this' pointer to change, so we must update the Engine.
+	// We take over rhs's handle and just swap the pointer (see RenderItem)
 	ComputeItem(ComputeItem&& rhs) noexcept :
 		ConstantBufferViews(std::move(rhs.ConstantBufferViews)),
 		DescriptorTables(std::move(rhs.DescriptorTables)),
 		ThreadGroupCountX(rhs.ThreadGroupCountX),
 		ThreadGroupCountY(rhs.ThreadGroupCountY),
-		ThreadGroupCountZ(rhs.ThreadGroupCountZ)
+		ThreadGroupCountZ(rhs.ThreadGroupCountZ),
+		ThreadSafeUpdate(rhs.ThreadSafeUpdate),
+		m_engineHandle(rhs.m_engineHandle)
 	{
-		// I don't think we need to explicitly call RemoveRenderItem on the rhs object because its destructor should do that
-		Engine::AddComputeItem(this);
+		// rhs no longer owns the handle, so its destructor will not unregister anything
+		rhs.m_engineHandle = {};
+		if (m_engineHandle.IsValid())
+			Engine::ReplaceComputeItem(this);
+		else
+			Engine::AddComputeItem(this);
 	}
 	ComputeItem& operator=(ComputeItem&& rhs) noexcept
 	{
 		LOG_CORE_WARN("{}", "ComputeItem Move Assignment operator called, but this method has not been tested. Make sure updates to the Engine are correct. NOTE: I have tested the Move Constructor, so I believe the Move Assignment operator should be fine...");
 
-		// I don't think we need to explicitly call RemoveRenderItem on the rhs object because its destructor should do that
+		// We are already registered, so there is nothing to do with rhs's handle. rhs's destructor will remove it
 		Engine::AddComputeItem(this);
 
 		ConstantBufferViews = std::move(rhs.ConstantBufferViews);
@@ -43,6 +51,7 @@ public:
 		ThreadGroupCountX = rhs.ThreadGroupCountX;
 		ThreadGroupCountY = rhs.ThreadGroupCountY;
 		ThreadGroupCountZ = rhs.ThreadGroupCountZ;
+		ThreadSafeUpdate = rhs.ThreadSafeUpdate;
 
 		return *this;
 	}
@@ -73,8 +82,17 @@ public:
 	unsigned int ThreadGroupCountY = 1;
 	unsigned int ThreadGroupCountZ = 1;
 
+	// Set to true if Update() may be called on a worker thread at the same time as Update() for other items
+	// (see RenderItem::ThreadSafeUpdate)
+	bool ThreadSafeUpdate = false;
+
 private:
 	ComputeItem(const ComputeItem&) = delete;
 	ComputeItem& operator=(const ComputeItem&) = delete;
+
+	// Handle into the Engine's compute item list
+	utility::SlotMapHandle m_engineHandle = {};
+
+	friend class Engine;
 };
 }
\ No newline at end of file
@@ -5,33 +5,55 @@
 #include "tiny/DeviceResources.h"
 #include "tiny/utils/Constants.h"
 #include "tiny/Engine.h"
+#include "UploadRing.h"
 
 namespace tiny
 {
+// NOTE: A ConstantBuffer does NOT own a GPU resource. The most recent data is kept in a CPU-side copy and, the
+//       first time the buffer is used in a frame (or after the data has changed), the Engine copies it into its
+//       per-frame UploadRing with Upload(). This way, the data the GPU reads for a frame can never be overwritten by
+//       the CPU while that frame is in flight, and thousands of constant buffers only cost a handful of upload heaps.
+//
+//       Upload() allocates from the UploadRing, so it is only ever called on the main thread, after the last CopyData()
+//       that should be visible to the draw/dispatch (i.e. after any PreWork). GetGPUVirtualAddress() only reads, so
+//       it is safe to call from the threads that record in parallel.
 class ConstantBuffer
 {
 public:
-	ConstantBuffer(std::shared_ptr<DeviceResources> deviceResources) :
-		m_deviceResources(deviceResources)
+	ConstantBuffer(std::shared_ptr<DeviceResources> deviceResources, UINT dataByteSize) :
+		m_deviceResources(deviceResources),
+		m_cpuData(dataByteSize, 0)
 	{
 		TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
 	}
-	~ConstantBuffer()
-	{
-		if (m_uploadBuffer != nullptr)
-			m_uploadBuffer->Unmap(0, nullptr);
-
-		m_mappedData = nullptr;
+	~ConstantBuffer() noexcept {}
 
-		// Upload buffer might still be in use by the GPU, so do a delayed delete
-		Engine::DelayedDelete(m_uploadBuffer);
+	// Copies the data into the UploadRing if it has changed, or has not been uploaded yet during frame 'frameNumber'
+	inline void Upload(UINT64 frameNumber)
+	{
+		if (m_dirty || m_lastUploadFrameNumber != frameNumber)
+		{
+			UploadRing::Allocation allocation = Engine::AllocateUpload(m_elementByteSize);
+			memcpy(allocation.CPU, m_cpuData.data(), m_cpuData.size());
+
+			m_gpuAddress = allocation.GPU;
+			m_lastUploadFrameNumber = frameNumber;
+			m_dirty = false;
+		}
 	}
 
-	ND inline D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(unsigned int frameIndex) noexcept
+	// NOTE: frameIndex is no longer needed to locate the data (the UploadRing handles per-frame storage), but it is
+	//       kept so that call sites don't need to know how the data is stored
+	ND inline D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(unsigned int frameIndex) const noexcept
 	{
-		return m_uploadBuffer->GetGPUVirtualAddress() + static_cast<UINT64>(frameIndex) * m_elementByteSize;
+		TINY_CORE_ASSERT(!m_dirty && m_lastUploadFrameNumber == Engine::GetFrameNumber(), "Constant buffer has not been uploaded since it last changed (see Upload())");
+		return m_gpuAddress;
 	}
 
+	// Direct access to the CPU copy of the data (used by the Engine to pack per-object data for instanced draws)
+	ND inline const BYTE* GetCPUData() const noexcept { return m_cpuData.data(); }
+	ND inline UINT GetDataByteSize() const noexcept { return static_cast<UINT>(m_cpuData.size()); }
+
 
 protected:
 	ConstantBuffer(const ConstantBuffer& rhs) = delete;
@@ -40,8 +62,11 @@ protected:
 
 	std::shared_ptr<DeviceResources> m_deviceResources;
 
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_uploadBuffer;
-	BYTE* m_mappedData = nullptr;
+	// CPU copy of the most recent data, as well as where (and when) it was last copied into the UploadRing
+	std::vector<BYTE> m_cpuData;
+	D3D12_GPU_VIRTUAL_ADDRESS m_gpuAddress = 0;
+	UINT64 m_lastUploadFrameNumber = UINT64_MAX;
+	bool m_dirty = true;
 
 	// Constant buffers must be a multiple of the minimum hardware
 	// allocation size (usually 256 bytes).  So round up to nearest
@@ -62,38 +87,16 @@ class ConstantBufferT : public ConstantBuffer
 {
 public:
 	ConstantBufferT(std::shared_ptr<DeviceResources> deviceResources) :
-		ConstantBuffer(deviceResources)
+		ConstantBuffer(deviceResources, static_cast<UINT>(sizeof(T)))
 	{
 		m_elementByteSize = (sizeof(T) + 255) & ~255;
-
-		// Need to create the buffer in an upload heap so the CPU can regularly send new data to it
-		auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-
-		// Create a buffer that will hold one element for each frame resource
-		auto desc = CD3DX12_RESOURCE_DESC::Buffer(static_cast<UINT64>(m_elementByteSize) * gNumFrameResources);		
-
-		GFX_THROW_INFO(
-			m_deviceResources->GetDevice()->CreateCommittedResource(
-				&props,
-				D3D12_HEAP_FLAG_NONE,
-				&desc,
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr,
-				IID_PPV_ARGS(&m_uploadBuffer)
-			)
-		);
-
-		GFX_THROW_INFO(
-			m_uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedData))
-		);
-
-		// We do not need to unmap until we are done with the resource. However, we must not write to
-		// the resource while it is in use by the GPU (so we must use synchronization techniques).
 	}
 
+	// Only updates the CPU copy. The data is copied into the UploadRing the next time the Engine uploads the buffer
 	inline void CopyData(unsigned int frameIndex, const T& data) noexcept
 	{
-		memcpy(&m_mappedData[frameIndex * m_elementByteSize], &data, sizeof(T));
+		memcpy(m_cpuData.data(), &data, sizeof(T));
+		m_dirty = true;
 	}
 
 private:
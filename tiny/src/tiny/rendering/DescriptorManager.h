@@ -25,6 +25,9 @@ public:
 	static unsigned int EmplaceBackConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc) { return Get().EmplaceBackConstantBufferViewImpl(desc); }
 	static unsigned int EmplaceBackUnorderedAccessView(ID3D12Resource* pResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc) { return Get().EmplaceBackUnorderedAccessViewImpl(pResource, desc); }
 
+	static unsigned int EmplaceBackCopy(unsigned int sourceIndex) { return Get().EmplaceBackCopyImpl(sourceIndex); }
+	static void CopyAt(unsigned int destinationIndex, unsigned int sourceIndex) noexcept { Get().CopyAtImpl(destinationIndex, sourceIndex); }
+
 	static void ReleaseAt(unsigned int index) noexcept { Get().ReleaseAtImpl(index); }
 
 private:
@@ -56,6 +59,9 @@ private:
 	unsigned int EmplaceBackConstantBufferViewImpl(const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc) { return m_descriptorVector->EmplaceBackConstantBufferView(desc); }
 	unsigned int EmplaceBackUnorderedAccessViewImpl(ID3D12Resource* pResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc) { return m_descriptorVector->EmplaceBackUnorderedAccessView(pResource, desc); }
 
+	unsigned int EmplaceBackCopyImpl(unsigned int sourceIndex) { return m_descriptorVector->EmplaceBackCopy(sourceIndex); }
+	void CopyAtImpl(unsigned int destinationIndex, unsigned int sourceIndex) noexcept { m_descriptorVector->CopyAt(destinationIndex, sourceIndex); }
+
 	void ReleaseAtImpl(unsigned int index) noexcept { m_descriptorVector->ReleaseAt(index); }
 
 
@@ -184,6 +184,25 @@ unsigned int DescriptorVector::EmplaceBackUnorderedAccessView(ID3D12Resource* pR
     return indexIntoHeap;
 }
 
+unsigned int DescriptorVector::EmplaceBackCopy(unsigned int sourceIndex)
+{
+    // Get the next available index into the heap and increase the capacity if necessary (the source descriptor is
+    // copied to the new heaps along with everything else)
+    unsigned int indexIntoHeap = GetNextIndexAndEnsureCapacity();
+    CopyAt(indexIntoHeap, sourceIndex);
+    return indexIntoHeap;
+}
+void DescriptorVector::CopyAt(unsigned int destinationIndex, unsigned int sourceIndex) noexcept
+{
+    TINY_CORE_ASSERT(destinationIndex < m_capacity, "Destination index is too large");
+    TINY_CORE_ASSERT(sourceIndex < m_capacity, "Source index is too large");
+
+    // Only the copyable heap can be used as the source of a copy
+    auto device = m_deviceResources->GetDevice();
+    device->CopyDescriptorsSimple(1, GetCPUCopyableHandleAt(destinationIndex), GetCPUCopyableHandleAt(sourceIndex), m_type);
+    device->CopyDescriptorsSimple(1, GetCPUHandleAt(destinationIndex), GetCPUCopyableHandleAt(sourceIndex), m_type);
+}
+
 void DescriptorVector::ReleaseAt(unsigned int index) noexcept
 {
     TINY_CORE_ASSERT(index < m_capacity, "Index is too large");
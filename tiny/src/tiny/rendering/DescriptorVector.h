@@ -55,6 +55,9 @@ public:
     unsigned int EmplaceBackShaderResourceView(ID3D12Resource* pResource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc);
     unsigned int EmplaceBackConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC* desc);
     unsigned int EmplaceBackUnorderedAccessView(ID3D12Resource* pResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc);
+    // Copies the descriptor at 'sourceIndex' into a new slot, or over the descriptor at 'destinationIndex' (in both heaps)
+    unsigned int EmplaceBackCopy(unsigned int sourceIndex);
+    void CopyAt(unsigned int destinationIndex, unsigned int sourceIndex) noexcept;
 
     void ReleaseAt(unsigned int index) noexcept;
 
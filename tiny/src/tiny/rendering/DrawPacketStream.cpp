@@ -0,0 +1,64 @@
+#include "tiny-pch.h"
+#include "DrawPacketStream.h"
+#include "RenderPassLayer.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+void DrawPacketStream::Compile(RenderPassLayer& layer, size_t itemsPerChunk)
+{
+	PROFILE_FUNCTION();
+
+	TINY_CORE_ASSERT(layer.Meshes != nullptr, "Layer has no mesh group");
+	TINY_CORE_ASSERT(itemsPerChunk > 0, "Chunks must contain at least 1 item");
+
+	m_commands.clear();
+	m_sources.clear();
+	m_chunkStarts.clear();
+	m_itemCount = layer.RenderItems.size();
+	m_insertionCount = layer.RenderItems.InsertionCount();
+
+	const MeshGroup* meshGroup = layer.Meshes.get();
+	const std::vector<DrawSortKey>* drawOrder = layer.SortRenderItems ? &layer.GetDrawOrder() : nullptr;
+
+	for (size_t iii = 0; iii < m_itemCount; ++iii)
+	{
+		if (iii % itemsPerChunk == 0)
+			m_chunkStarts.push_back(m_commands.size());
+
+		RenderItem& item = layer.RenderItems[drawOrder != nullptr ? (*drawOrder)[iii].ItemIndex : iii];
+		item.m_drawPackets = this; // So that the item can invalidate the stream when it is replaced or its submesh changes
+
+		// Item header (the command count is filled in once the item's commands have been added)
+		const size_t header = m_commands.size();
+		m_commands.push_back({ CommandType::Item, 0, { 1 } });
+		m_sources.push_back({ .Item = &item });
+
+		for (const RootDescriptorTable& table : item.DescriptorTables)
+		{
+			m_commands.push_back({ CommandType::DescriptorTable, table.Index(), { table.DescriptorHandle.ptr } });
+			m_sources.push_back({ .DescriptorTable = &table });
+		}
+
+		for (const RootConstantBufferView& cbv : item.ConstantBufferViews)
+		{
+			m_commands.push_back({ CommandType::ConstantBufferView, cbv.RootParameterIndex, { 0 } });
+			m_sources.push_back({ .ConstantBuffer = cbv.ConstantBuffer });
+		}
+
+		const SubmeshGeometry& mesh = meshGroup->GetSubmesh(item.GetSubmeshIndex());
+		Command& draw = m_commands.emplace_back();
+		draw.Type = CommandType::Draw;
+		draw.Arg = mesh.IndexCount;
+		draw.Draw.StartIndexLocation = mesh.StartIndexLocation;
+		draw.Draw.BaseVertexLocation = mesh.BaseVertexLocation;
+		m_sources.push_back({ .Item = nullptr });
+
+		m_commands[header].Arg = static_cast<UINT>(m_commands.size() - header - 1);
+	}
+
+	m_valid = true;
+}
+
+}
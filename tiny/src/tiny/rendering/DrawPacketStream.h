@@ -0,0 +1,93 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+
+namespace tiny
+{
+class RenderItem;
+class RenderPassLayer;
+class ConstantBuffer;
+class RootDescriptorTable;
+
+// DrawPacketStream is a RenderPassLayer compiled into a flat array of small POD commands. Each item becomes an Item
+// header, followed by one command per root argument it binds, followed by its Draw. Recording the layer is then a
+// single linear scan over the array instead of chasing RenderItem -> vector -> RootConstantBufferView -> ConstantBuffer
+// for every draw.
+//
+// Constant buffers are copied into the UploadRing each frame, so their addresses (and any descriptor handles changed
+// by an Update function) are not known at compile time. The Engine refreshes those values in one pass over the
+// stream before recording (see Engine::RefreshDrawPackets). The stream only needs to be recompiled when the layer's
+// items change structurally: items are added (see InsertionCount()), removed or replaced, an item's submesh changes
+// (those invalidate the stream themselves), or RenderPassLayer::InvalidateDrawPackets is called.
+class DrawPacketStream
+{
+public:
+	enum class CommandType : UINT
+	{
+		Item,
+		DescriptorTable,
+		ConstantBufferView,
+		Draw
+	};
+
+	// 16 bytes. The meaning of Arg depends on the type:
+	//     Item:               number of commands that follow for the item (so a culled item can be skipped in one step)
+	//     DescriptorTable:    root parameter index
+	//     ConstantBufferView: root parameter index
+	//     Draw:               index count
+	struct Command
+	{
+		CommandType Type;
+		UINT Arg;
+		union
+		{
+			UINT64 Value;	// Item: non-zero if visible this frame | DescriptorTable: descriptor handle | ConstantBufferView: GPU address
+			struct
+			{
+				UINT StartIndexLocation;
+				INT  BaseVertexLocation;
+			} Draw;
+		};
+	};
+	static_assert(sizeof(Command) == 16);
+
+	DrawPacketStream() noexcept = default;
+	DrawPacketStream(DrawPacketStream&&) noexcept = default;
+	DrawPacketStream& operator=(DrawPacketStream&&) noexcept = default;
+	~DrawPacketStream() noexcept {}
+
+	// Rebuilds the stream from the layer's items (in GetDrawOrder() order if the layer sorts its items). A new chunk is
+	// started every itemsPerChunk items so that the stream can be recorded in parallel
+	void Compile(RenderPassLayer& layer, size_t itemsPerChunk);
+
+	inline void Invalidate() noexcept { m_valid = false; }
+	ND inline bool IsValid() const noexcept { return m_valid; }
+
+	ND inline size_t ItemCount() const noexcept { return m_itemCount; }
+	ND inline UINT64 InsertionCount() const noexcept { return m_insertionCount; } // The layer's RenderItems.InsertionCount() when compiled
+	ND inline size_t CommandCount() const noexcept { return m_commands.size(); }
+	ND inline size_t ChunkCount() const noexcept { return m_chunkStarts.size(); }
+
+private:
+	DrawPacketStream(const DrawPacketStream&) = delete;
+	DrawPacketStream& operator=(const DrawPacketStream&) = delete;
+
+	// Where the per-frame values of the stream come from. Only read by the refresh pass, never during replay
+	union Source
+	{
+		const RenderItem* Item;
+		const RootDescriptorTable* DescriptorTable;
+		ConstantBuffer* ConstantBuffer;
+	};
+
+	std::vector<Command> m_commands;
+	std::vector<Source> m_sources;		// Parallel to m_commands (unused for Draw commands)
+	std::vector<size_t> m_chunkStarts;	// Index of the first command of each chunk
+	size_t m_itemCount = 0;
+	UINT64 m_insertionCount = 0;
+	bool m_valid = false;
+
+	friend class Engine;
+};
+}
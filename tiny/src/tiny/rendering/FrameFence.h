@@ -0,0 +1,74 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+
+namespace tiny
+{
+// FrameFence is the only view the FramePacer has of the GPU: a monotonically increasing value that can be polled
+// and waited on. Keeping it this small means the pacing logic can be driven by a simulated fence (for example, one
+// that completes values on a scripted schedule) instead of a real queue.
+class FrameFence
+{
+public:
+	virtual ~FrameFence() noexcept {}
+
+	ND virtual UINT64 GetCompletedValue() const = 0;
+
+	// Blocks until the fence has reached 'value'. 'slot' selects which of the fence's reusable wait objects to use
+	// (the FramePacer passes the frame resource index)
+	virtual void Wait(UINT64 value, unsigned int slot) = 0;
+};
+
+// FrameFence over an ID3D12Fence. One Win32 event is created per slot up front and reused for every wait, instead
+// of creating and destroying an event each time the CPU has to wait
+class D3D12FrameFence : public FrameFence
+{
+public:
+	D3D12FrameFence(std::shared_ptr<DeviceResources> deviceResources, unsigned int slotCount) :
+		m_deviceResources(deviceResources),
+		m_events(slotCount, nullptr)
+	{
+		TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+		TINY_CORE_ASSERT(slotCount > 0, "Must have at least 1 slot");
+
+		for (HANDLE& event : m_events)
+		{
+			event = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+			TINY_CORE_ASSERT(event != NULL, "Failed to create fence event");
+		}
+	}
+	~D3D12FrameFence() noexcept override
+	{
+		for (HANDLE event : m_events)
+		{
+			if (event != NULL)
+				CloseHandle(event);
+		}
+	}
+
+	ND inline UINT64 GetCompletedValue() const override { return m_deviceResources->GetFence()->GetCompletedValue(); }
+
+	void Wait(UINT64 value, unsigned int slot) override
+	{
+		TINY_CORE_ASSERT(slot < m_events.size(), "Slot is out of range");
+
+		if (GetCompletedValue() >= value)
+			return;
+
+		// Auto-reset event: the wait consumes the signal, so the event is ready to be reused immediately
+		GFX_THROW_INFO(
+			m_deviceResources->GetFence()->SetEventOnCompletion(value, m_events[slot])
+		);
+		WaitForSingleObject(m_events[slot], INFINITE);
+	}
+
+private:
+	D3D12FrameFence(const D3D12FrameFence&) = delete;
+	D3D12FrameFence& operator=(const D3D12FrameFence&) = delete;
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	std::vector<HANDLE> m_events;
+};
+}
@@ -0,0 +1,144 @@
+#include "tiny-pch.h"
+#include "FramePacer.h"
+#include "tiny/utils/Profile.h"
+
+#include <thread>
+
+
+namespace tiny
+{
+FramePacer::FramePacer(std::unique_ptr<FrameFence> fence, unsigned int frameResourceCount) :
+	m_fence(std::move(fence)),
+	m_frameResourceCount(frameResourceCount),
+	m_maxFramesInFlight(frameResourceCount),
+	m_submittedFrames(frameResourceCount)
+{
+	TINY_CORE_ASSERT(m_fence != nullptr, "No fence");
+	TINY_CORE_ASSERT(m_frameResourceCount > 0, "Must have at least 1 frame resource");
+
+	PROFILE_REGISTER_HISTOGRAM("CPU stall (us)", &m_cpuStallHistogram);
+	PROFILE_REGISTER_HISTOGRAM("Pacing sleep (us)", &m_pacingSleepHistogram);
+	PROFILE_REGISTER_HISTOGRAM("Frame time (us)", &m_frameTimeHistogram);
+	PROFILE_REGISTER_HISTOGRAM("Frame latency (us)", &m_latencyHistogram);
+}
+FramePacer::~FramePacer() noexcept
+{
+	PROFILE_UNREGISTER_HISTOGRAM(&m_cpuStallHistogram);
+	PROFILE_UNREGISTER_HISTOGRAM(&m_pacingSleepHistogram);
+	PROFILE_UNREGISTER_HISTOGRAM(&m_frameTimeHistogram);
+	PROFILE_UNREGISTER_HISTOGRAM(&m_latencyHistogram);
+}
+
+UINT64 FramePacer::RequiredFenceValue() const noexcept
+{
+	// Only MaxFramesInFlight - 1 frames may still be executing once the new one starts, so the frame submitted
+	// MaxFramesInFlight frames ago must be complete. Fence values only ever increase, so every frame before it is as well
+	if (m_framesSubmitted < m_maxFramesInFlight)
+		return 0;
+
+	return m_submittedFrames[(m_framesSubmitted - m_maxFramesInFlight) % m_frameResourceCount].FenceValue;
+}
+
+void FramePacer::BeginFrame(unsigned int frameIndex)
+{
+	PROFILE_FUNCTION();
+
+	TINY_CORE_ASSERT(frameIndex < m_frameResourceCount, "Frame index is larger than expected");
+
+	auto stallStart = std::chrono::high_resolution_clock::now();
+	{
+		PROFILE_SCOPE("Waiting for GPU to update fence");
+
+		UINT64 value = RequiredFenceValue();
+		if (value != 0 && m_fence->GetCompletedValue() < value)
+			m_fence->Wait(value, frameIndex);
+	}
+	auto stallEnd = std::chrono::high_resolution_clock::now();
+	m_timings.CPUStallMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(stallEnd - stallStart).count();
+	RecordCompletedFrames(stallEnd);
+
+	HoldTargetFrameRate();
+	auto frameStart = std::chrono::high_resolution_clock::now();
+	m_timings.PacingSleepMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(frameStart - stallEnd).count();
+
+	m_timings.FrameMicroseconds = m_firstFrame ? 0 : std::chrono::duration_cast<std::chrono::microseconds>(frameStart - m_lastFrameStart).count();
+	m_lastFrameStart = frameStart;
+
+	m_cpuStallHistogram.Add(static_cast<double>(m_timings.CPUStallMicroseconds));
+	m_pacingSleepHistogram.Add(static_cast<double>(m_timings.PacingSleepMicroseconds));
+	if (!m_firstFrame)
+		m_frameTimeHistogram.Add(static_cast<double>(m_timings.FrameMicroseconds));
+	m_firstFrame = false;
+
+	PROFILE_COUNTER("CPU stall (us)", static_cast<double>(m_timings.CPUStallMicroseconds));
+	PROFILE_COUNTER("Frame time (us)", static_cast<double>(m_timings.FrameMicroseconds));
+}
+void FramePacer::EndFrame(UINT64 signaledFenceValue) noexcept
+{
+	SubmittedFrame& frame = m_submittedFrames[m_framesSubmitted % m_frameResourceCount];
+	frame.FenceValue = signaledFenceValue;
+	frame.Start = m_lastFrameStart;
+	++m_framesSubmitted;
+}
+void FramePacer::RecordCompletedFrames(std::chrono::high_resolution_clock::time_point now)
+{
+	// The ring only holds the last m_frameResourceCount frames. Older ones are always complete by now (see
+	// RequiredFenceValue), but their completion time was never observed, so they are skipped
+	if (m_framesSubmitted - m_framesCompleted > m_frameResourceCount)
+		m_framesCompleted = m_framesSubmitted - m_frameResourceCount;
+
+	UINT64 completedValue = m_fence->GetCompletedValue();
+	while (m_framesCompleted < m_framesSubmitted)
+	{
+		const SubmittedFrame& frame = m_submittedFrames[m_framesCompleted % m_frameResourceCount];
+		if (frame.FenceValue > completedValue)
+			break;
+
+		m_latencyHistogram.Add(static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(now - frame.Start).count()));
+		++m_framesCompleted;
+	}
+}
+void FramePacer::SetFrameResourceCount(unsigned int frameResourceCount) noexcept
+{
+	TINY_CORE_ASSERT(frameResourceCount > 0, "Must have at least 1 frame resource");
+
+	m_maxFramesInFlight = m_maxFramesInFlight == m_frameResourceCount ? frameResourceCount : MathHelper::Min(m_maxFramesInFlight, frameResourceCount);
+	m_frameResourceCount = frameResourceCount;
+
+	// The GPU is idle, so the history is no longer needed (a fence value of 0 never has to be waited on)
+	m_submittedFrames.assign(m_frameResourceCount, {});
+	m_framesCompleted = m_framesSubmitted;
+}
+
+void FramePacer::HoldTargetFrameRate()
+{
+	if (m_targetFrameRate <= 0.0 || m_firstFrame)
+		return;
+
+	PROFILE_FUNCTION();
+
+	const auto period = std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(1.0 / m_targetFrameRate));
+	const auto deadline = m_lastFrameStart + period;
+
+	// Sleep is only accurate to around a millisecond (often worse), so sleep until just before the deadline and then
+	// yield until it arrives
+	constexpr auto spinThreshold = std::chrono::microseconds(1500);
+	auto now = std::chrono::high_resolution_clock::now();
+	if (deadline - now > spinThreshold)
+		std::this_thread::sleep_for(deadline - now - spinThreshold);
+
+	while (std::chrono::high_resolution_clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::SetTargetFrameRate(double framesPerSecond) noexcept
+{
+	TINY_CORE_ASSERT(framesPerSecond >= 0.0, "Target frame rate cannot be negative");
+	m_targetFrameRate = MathHelper::Max(framesPerSecond, 0.0);
+}
+void FramePacer::SetMaxFramesInFlight(unsigned int count) noexcept
+{
+	m_maxFramesInFlight = MathHelper::Clamp(count, 1u, m_frameResourceCount);
+}
+
+}
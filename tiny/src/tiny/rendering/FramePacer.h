@@ -0,0 +1,93 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "FrameFence.h"
+#include "tiny/utils/Histogram.h"
+
+namespace tiny
+{
+// FramePacer decides when the CPU may start a new frame. BeginFrame() blocks until:
+//     1. No more than MaxFramesInFlight - 1 previously submitted frames are still executing on the GPU. This is never
+//        more than the number of frame resources, so it also guarantees the frame resource about to be reused is free
+//     2. The target frame time (if any) has elapsed since the previous frame started
+// How long the CPU stalled on the GPU, how long it slept to hold the target rate, the frame time, and the frame latency
+// are all recorded in histograms (which are registered with the profiler). Stall and frame time are also written as
+// profiler counters.
+//
+// Frame latency is measured from the start of a frame (i.e. when input for the frame is sampled) to the first
+// BeginFrame() that sees the frame's fence completed. Completion is only observed once per frame, so this is an upper
+// bound that is at most one frame time too large.
+class FramePacer
+{
+public:
+	// Timings (in microseconds) for the most recent call to BeginFrame()
+	struct FrameTimings
+	{
+		long long CPUStallMicroseconds = 0;		// Time spent waiting on the fence
+		long long PacingSleepMicroseconds = 0;	// Time spent holding the target frame rate
+		long long FrameMicroseconds = 0;		// Time since the previous frame started
+	};
+
+	FramePacer(std::unique_ptr<FrameFence> fence, unsigned int frameResourceCount);
+	~FramePacer() noexcept;
+
+	// Call at the start of a frame, before the CPU touches anything owned by frame resource 'frameIndex'
+	void BeginFrame(unsigned int frameIndex);
+	// Call once the fence value for the frame has been signaled on the queue
+	void EndFrame(UINT64 signaledFenceValue) noexcept;
+
+	// Must ONLY be called while the GPU is idle (so no previously submitted frame needs to be waited on). If the max
+	// frames in flight was equal to the old count, it follows the new count, otherwise it is clamped to it
+	void SetFrameResourceCount(unsigned int frameResourceCount) noexcept;
+	ND inline unsigned int GetFrameResourceCount() const noexcept { return m_frameResourceCount; }
+
+	// 0 (the default) means as fast as possible
+	void SetTargetFrameRate(double framesPerSecond) noexcept;
+	ND inline double GetTargetFrameRate() const noexcept { return m_targetFrameRate; }
+
+	// Clamped to [1, frameResourceCount]. Fewer frames in flight lowers latency at the cost of CPU/GPU overlap
+	void SetMaxFramesInFlight(unsigned int count) noexcept;
+	ND inline unsigned int GetMaxFramesInFlight() const noexcept { return m_maxFramesInFlight; }
+
+	ND inline const FrameTimings& GetFrameTimings() const noexcept { return m_timings; }
+	ND inline const utility::Histogram& GetCPUStallHistogram() const noexcept { return m_cpuStallHistogram; }
+	ND inline const utility::Histogram& GetFrameTimeHistogram() const noexcept { return m_frameTimeHistogram; }
+	ND inline const utility::Histogram& GetLatencyHistogram() const noexcept { return m_latencyHistogram; }
+	ND inline UINT64 FramesSubmitted() const noexcept { return m_framesSubmitted; }
+
+	// The value BeginFrame() must wait for before the next frame may start (0 if there is nothing to wait for)
+	ND UINT64 RequiredFenceValue() const noexcept;
+
+private:
+	FramePacer(const FramePacer&) = delete;
+	FramePacer& operator=(const FramePacer&) = delete;
+
+	void HoldTargetFrameRate();
+	void RecordCompletedFrames(std::chrono::high_resolution_clock::time_point now);
+
+	std::unique_ptr<FrameFence> m_fence;
+	unsigned int m_frameResourceCount;
+	unsigned int m_maxFramesInFlight;
+	double m_targetFrameRate = 0.0;
+
+	// Fence values and start times of the most recently submitted frames (ring buffers indexed by frame number)
+	struct SubmittedFrame
+	{
+		UINT64 FenceValue = 0;
+		std::chrono::high_resolution_clock::time_point Start = {};
+	};
+	std::vector<SubmittedFrame> m_submittedFrames;
+	UINT64 m_framesSubmitted = 0;
+	UINT64 m_framesCompleted = 0; // Frames whose completion has been observed (for the latency histogram)
+
+	std::chrono::high_resolution_clock::time_point m_lastFrameStart = {};
+	bool m_firstFrame = true;
+
+	FrameTimings m_timings;
+	utility::Histogram m_cpuStallHistogram;
+	utility::Histogram m_pacingSleepHistogram;
+	utility::Histogram m_frameTimeHistogram;
+	utility::Histogram m_latencyHistogram;
+};
+}
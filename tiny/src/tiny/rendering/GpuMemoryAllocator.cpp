@@ -0,0 +1,315 @@
+#include "tiny-pch.h"
+#include "GpuMemoryAllocator.h"
+#include "tiny/utils/BuddyAllocator.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+// Pool ========================================================================================================
+// A set of heaps that all share the same heap type and heap flags
+struct GpuMemoryAllocator::Pool
+{
+	struct Heap
+	{
+		Microsoft::WRL::ComPtr<ID3D12Heap> Resource = nullptr;
+		std::unique_ptr<utility::BuddyAllocator> Allocator = nullptr;
+		UINT64 RequestedBytes = 0;
+		unsigned int PlacedResources = 0;
+	};
+	struct Placement
+	{
+		ID3D12Heap* Heap = nullptr;
+		size_t HeapIndex = 0;
+		utility::BuddyAllocator::Block Block;
+	};
+
+	Pool(std::shared_ptr<DeviceResources> deviceResources, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags, UINT64 heapSize) :
+		m_deviceResources(deviceResources),
+		m_heapType(heapType),
+		m_heapFlags(heapFlags),
+		m_heapSize(heapSize),
+		m_maxOrder(0)
+	{
+		TINY_CORE_ASSERT(m_heapSize >= MinBlockSize, "Heap size must be at least the min block size");
+		while ((MinBlockSize << (m_maxOrder + 1)) <= m_heapSize)
+			++m_maxOrder;
+		TINY_CORE_ASSERT((MinBlockSize << m_maxOrder) == m_heapSize, "Heap size must be a power of 2 multiple of the min block size");
+	}
+
+	ND std::optional<Placement> Allocate(UINT64 byteSize)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Heaps are searched in creation order, which keeps new allocations packed into the oldest heaps and gives
+		// the newer ones a chance to empty out and be released
+		for (size_t iii = 0; iii < m_heaps.size(); ++iii)
+		{
+			Heap& heap = m_heaps[iii];
+			if (heap.Resource == nullptr)
+				continue;
+
+			if (std::optional<utility::BuddyAllocator::Block> block = heap.Allocator->Allocate(byteSize))
+				return Place(iii, *block, byteSize);
+		}
+
+		// Nothing fits, so create a new heap (reusing the slot of one that was released, if possible)
+		size_t index = 0;
+		while (index < m_heaps.size() && m_heaps[index].Resource != nullptr)
+			++index;
+		if (index == m_heaps.size())
+			m_heaps.emplace_back();
+
+		D3D12_HEAP_DESC desc = {};
+		desc.SizeInBytes = m_heapSize;
+		desc.Properties = CD3DX12_HEAP_PROPERTIES(m_heapType);
+		desc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		desc.Flags = m_heapFlags;
+
+		Heap& heap = m_heaps[index];
+		GFX_THROW_INFO(
+			m_deviceResources->GetDevice()->CreateHeap(&desc, IID_PPV_ARGS(heap.Resource.ReleaseAndGetAddressOf()))
+		);
+		heap.Allocator = std::make_unique<utility::BuddyAllocator>(MinBlockSize, m_maxOrder);
+		heap.RequestedBytes = 0;
+		heap.PlacedResources = 0;
+
+		std::optional<utility::BuddyAllocator::Block> block = heap.Allocator->Allocate(byteSize);
+		TINY_CORE_ASSERT(block.has_value(), "A new heap should always have room for an allocation no larger than the heap");
+		return Place(index, *block, byteSize);
+	}
+	void Free(size_t heapIndex, const utility::BuddyAllocator::Block& block, UINT64 byteSize) noexcept
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Heap& heap = m_heaps[heapIndex];
+		TINY_CORE_ASSERT(heap.Resource != nullptr, "Freeing a block from a heap that has been released");
+
+		heap.Allocator->Free(block);
+		heap.RequestedBytes -= byteSize;
+		--heap.PlacedResources;
+
+		// Keep one heap around even if it is empty so that creating and destroying a single resource does not create
+		// and destroy a heap every time
+		if (heap.Allocator->Empty() && LiveHeapCount() > 1)
+		{
+			heap.Resource = nullptr;
+			heap.Allocator = nullptr;
+		}
+	}
+	void AccumulateStats(GpuMemoryAllocator::Stats& stats) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (const Heap& heap : m_heaps)
+		{
+			if (heap.Resource == nullptr)
+				continue;
+
+			stats.HeapBytes += heap.Allocator->Capacity();
+			stats.AllocatedBytes += heap.Allocator->AllocatedBytes();
+			stats.RequestedBytes += heap.RequestedBytes;
+			stats.LargestFreeBlock = MathHelper::Max(stats.LargestFreeBlock, heap.Allocator->LargestFreeBlock());
+			++stats.HeapCount;
+			stats.PlacedResources += heap.PlacedResources;
+		}
+	}
+
+private:
+	ND Placement Place(size_t heapIndex, const utility::BuddyAllocator::Block& block, UINT64 byteSize) noexcept
+	{
+		Heap& heap = m_heaps[heapIndex];
+		heap.RequestedBytes += byteSize;
+		++heap.PlacedResources;
+		return { heap.Resource.Get(), heapIndex, block };
+	}
+	ND unsigned int LiveHeapCount() const noexcept
+	{
+		return static_cast<unsigned int>(std::count_if(m_heaps.begin(), m_heaps.end(), [](const Heap& heap) { return heap.Resource != nullptr; }));
+	}
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	D3D12_HEAP_TYPE m_heapType;
+	D3D12_HEAP_FLAGS m_heapFlags;
+	UINT64 m_heapSize;
+	unsigned int m_maxOrder;
+
+	mutable std::mutex m_mutex;
+	std::vector<Heap> m_heaps; // Released heaps leave an empty slot so heap indices held by live blocks stay valid
+};
+
+// PlacementRelease ============================================================================================
+// Attached to every placed resource as private data. D3D12 releases private data interfaces when the resource is
+// destroyed, which is what returns the block to its heap
+class PlacementRelease final : public IUnknown
+{
+public:
+	PlacementRelease(std::shared_ptr<GpuMemoryAllocator::Pool> pool, size_t heapIndex, const utility::BuddyAllocator::Block& block, UINT64 byteSize) noexcept :
+		m_pool(std::move(pool)),
+		m_heapIndex(heapIndex),
+		m_block(block),
+		m_byteSize(byteSize)
+	{}
+	~PlacementRelease() noexcept
+	{
+		m_pool->Free(m_heapIndex, m_block, m_byteSize);
+	}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+	{
+		if (object == nullptr)
+			return E_POINTER;
+
+		if (riid == __uuidof(IUnknown))
+		{
+			*object = static_cast<IUnknown*>(this);
+			AddRef();
+			return S_OK;
+		}
+
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refCount; }
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		ULONG count = --m_refCount;
+		if (count == 0)
+			delete this;
+		return count;
+	}
+
+private:
+	std::atomic<ULONG> m_refCount = 1;
+	std::shared_ptr<GpuMemoryAllocator::Pool> m_pool;
+	size_t m_heapIndex;
+	utility::BuddyAllocator::Block m_block;
+	UINT64 m_byteSize;
+};
+
+// {6E0F5B43-2D8A-4C41-9B7E-3A1D2F6C8E95}
+static constexpr GUID PlacementReleaseGuid = { 0x6e0f5b43, 0x2d8a, 0x4c41, { 0x9b, 0x7e, 0x3a, 0x1d, 0x2f, 0x6c, 0x8e, 0x95 } };
+
+
+// GpuMemoryAllocator ==========================================================================================
+GpuMemoryAllocator::GpuMemoryAllocator(std::shared_ptr<DeviceResources> deviceResources, UINT64 heapSize) :
+	m_deviceResources(deviceResources),
+	m_heapSize(heapSize)
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+
+	m_defaultBuffers = std::make_shared<Pool>(m_deviceResources, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, m_heapSize);
+	m_uploadBuffers = std::make_shared<Pool>(m_deviceResources, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, m_heapSize);
+	m_defaultTextures = std::make_shared<Pool>(m_deviceResources, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, m_heapSize);
+
+	PROFILE_REGISTER_HISTOGRAM("GPU allocation (us)", &m_allocationTimeHistogram);
+}
+GpuMemoryAllocator::~GpuMemoryAllocator() noexcept
+{
+	PROFILE_UNREGISTER_HISTOGRAM(&m_allocationTimeHistogram);
+}
+
+std::shared_ptr<GpuMemoryAllocator::Pool> GpuMemoryAllocator::SelectPool(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc) const noexcept
+{
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+	{
+		switch (heapType)
+		{
+		case D3D12_HEAP_TYPE_DEFAULT: return m_defaultBuffers;
+		case D3D12_HEAP_TYPE_UPLOAD:  return m_uploadBuffers;
+		default: return nullptr;
+		}
+	}
+
+	if (heapType == D3D12_HEAP_TYPE_DEFAULT && (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)) == 0)
+		return m_defaultTextures;
+
+	return nullptr;
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> GpuMemoryAllocator::CreateResource(D3D12_HEAP_TYPE heapType,
+																		  const D3D12_RESOURCE_DESC& desc,
+																		  D3D12_RESOURCE_STATES initialState,
+																		  const D3D12_CLEAR_VALUE* clearValue)
+{
+	PROFILE_FUNCTION();
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
+	auto device = m_deviceResources->GetDevice();
+	D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &desc);
+
+	std::shared_ptr<Pool> pool = SelectPool(heapType, desc);
+	if (pool != nullptr && info.Alignment <= MinBlockSize && info.SizeInBytes <= m_heapSize)
+	{
+		std::optional<Pool::Placement> placement = pool->Allocate(info.SizeInBytes);
+		TINY_CORE_ASSERT(placement.has_value(), "Pool failed to allocate a block that fits in a heap");
+
+		// Owns the block from here on, so it is returned to the heap if creating the resource fails
+		Microsoft::WRL::ComPtr<IUnknown> release;
+		release.Attach(new PlacementRelease(pool, placement->HeapIndex, placement->Block, info.SizeInBytes));
+
+		GFX_THROW_INFO(
+			device->CreatePlacedResource(
+				placement->Heap,
+				placement->Block.Offset,
+				&desc,
+				initialState,
+				clearValue,
+				IID_PPV_ARGS(resource.GetAddressOf())
+			)
+		);
+		GFX_THROW_INFO(resource->SetPrivateDataInterface(PlacementReleaseGuid, release.Get()));
+	}
+	else
+	{
+		resource = CreateCommitted(heapType, desc, initialState, clearValue);
+	}
+
+	auto end = std::chrono::high_resolution_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(m_statsMutex);
+		m_allocationTimeHistogram.Add(static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()));
+	}
+
+	return resource;
+}
+Microsoft::WRL::ComPtr<ID3D12Resource> GpuMemoryAllocator::CreateCommitted(D3D12_HEAP_TYPE heapType,
+																		   const D3D12_RESOURCE_DESC& desc,
+																		   D3D12_RESOURCE_STATES initialState,
+																		   const D3D12_CLEAR_VALUE* clearValue)
+{
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
+
+	auto props = CD3DX12_HEAP_PROPERTIES(heapType);
+	GFX_THROW_INFO(
+		m_deviceResources->GetDevice()->CreateCommittedResource(
+			&props,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			initialState,
+			clearValue,
+			IID_PPV_ARGS(resource.GetAddressOf())
+		)
+	);
+
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	++m_committedFallbacks;
+
+	return resource;
+}
+
+GpuMemoryAllocator::Stats GpuMemoryAllocator::GetStats() const
+{
+	Stats stats;
+	m_defaultBuffers->AccumulateStats(stats);
+	m_uploadBuffers->AccumulateStats(stats);
+	m_defaultTextures->AccumulateStats(stats);
+
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	stats.CommittedFallbacks = m_committedFallbacks;
+	return stats;
+}
+
+}
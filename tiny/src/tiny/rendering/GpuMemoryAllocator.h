@@ -0,0 +1,85 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+#include "tiny/utils/Histogram.h"
+
+namespace tiny
+{
+// GpuMemoryAllocator creates resources as placed resources inside a small number of large ID3D12Heaps instead of
+// giving every resource its own implicit heap (which is what CreateCommittedResource does). Each heap is
+// sub-allocated with a utility::BuddyAllocator.
+//
+// The caller gets back a plain ID3D12Resource, so nothing about how resources are held or released changes
+// (including Engine::DelayedDelete). The block a resource occupies is attached to the resource as private data and
+// returned to its heap when the resource itself is destroyed. Heaps are kept alive by the blocks that reference
+// them, so the allocator may be destroyed before the last of its resources.
+//
+// Resources that don't fit the placed path fall back to committed resources: render targets/depth stencils (which
+// benefit from dedicated allocations), anything larger than a heap, and anything with an alignment above 64KB
+// (i.e. MSAA textures).
+class GpuMemoryAllocator
+{
+public:
+	struct Stats
+	{
+		UINT64 HeapBytes = 0;			// Total size of all heaps
+		UINT64 AllocatedBytes = 0;		// Bytes handed out in blocks (block sizes are rounded up to a power of 2)
+		UINT64 RequestedBytes = 0;		// Bytes the placed resources actually require
+		UINT64 LargestFreeBlock = 0;	// Largest single block available without creating a new heap
+		unsigned int HeapCount = 0;
+		unsigned int PlacedResources = 0;
+		unsigned int CommittedFallbacks = 0;	// Resources created with CreateCommittedResource instead (since startup)
+
+		// Portion of the allocated bytes lost to rounding blocks up
+		ND inline double InternalFragmentation() const noexcept { return AllocatedBytes > 0 ? 1.0 - static_cast<double>(RequestedBytes) / static_cast<double>(AllocatedBytes) : 0.0; }
+		// Portion of the free bytes not usable by the largest possible allocation (0 means all free space is contiguous)
+		ND inline double ExternalFragmentation() const noexcept
+		{
+			UINT64 freeBytes = HeapBytes - AllocatedBytes;
+			return freeBytes > 0 ? 1.0 - static_cast<double>(LargestFreeBlock) / static_cast<double>(freeBytes) : 0.0;
+		}
+	};
+
+	static constexpr UINT64 DefaultHeapSize = 64 * 1024 * 1024; // 64MB
+	static constexpr UINT64 MinBlockSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT; // 64KB
+
+	GpuMemoryAllocator(std::shared_ptr<DeviceResources> deviceResources, UINT64 heapSize = DefaultHeapSize);
+	~GpuMemoryAllocator() noexcept;
+
+	// Thread safe
+	ND Microsoft::WRL::ComPtr<ID3D12Resource> CreateResource(D3D12_HEAP_TYPE heapType,
+															 const D3D12_RESOURCE_DESC& desc,
+															 D3D12_RESOURCE_STATES initialState,
+															 const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+	ND Stats GetStats() const;
+	// Time (in microseconds) spent in CreateResource()
+	ND inline const utility::Histogram& GetAllocationTimeHistogram() const noexcept { return m_allocationTimeHistogram; }
+
+	struct Pool; // Defined in the .cpp
+
+private:
+	GpuMemoryAllocator(const GpuMemoryAllocator&) = delete;
+	GpuMemoryAllocator& operator=(const GpuMemoryAllocator&) = delete;
+
+	ND std::shared_ptr<Pool> SelectPool(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc) const noexcept;
+	ND Microsoft::WRL::ComPtr<ID3D12Resource> CreateCommitted(D3D12_HEAP_TYPE heapType,
+															  const D3D12_RESOURCE_DESC& desc,
+															  D3D12_RESOURCE_STATES initialState,
+															  const D3D12_CLEAR_VALUE* clearValue);
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	UINT64 m_heapSize;
+
+	// Tier 1 heaps may only hold one category of resource, so each category gets its own pool
+	std::shared_ptr<Pool> m_defaultBuffers;
+	std::shared_ptr<Pool> m_uploadBuffers;
+	std::shared_ptr<Pool> m_defaultTextures;
+
+	mutable std::mutex m_statsMutex;
+	unsigned int m_committedFallbacks = 0;
+	utility::Histogram m_allocationTimeHistogram;
+};
+}
@@ -13,10 +13,19 @@ MeshGroup::MeshGroup(MeshGroup&& rhs) noexcept :
 	m_indexBufferGPU(rhs.m_indexBufferGPU),
 	m_vertexBufferView(rhs.m_vertexBufferView),
 	m_indexBufferView(rhs.m_indexBufferView),
-	m_submeshes(std::move(rhs.m_submeshes))
+	m_submeshes(std::move(rhs.m_submeshes)),
+	m_resident(rhs.m_resident)
 {
 	LOG_CORE_WARN("{}", "MeshGroup Move Constructor called, but this method has not been tested. Make sure this call was intentional and, if so, that the constructor works as expected");
 
+	// The eviction callback points at the object that registered it, so register again for this object
+	if (rhs.m_residencyHandle != ResidencyManager::InvalidHandle)
+	{
+		Engine::UnregisterEvictable(rhs.m_residencyHandle);
+		rhs.m_residencyHandle = ResidencyManager::InvalidHandle;
+		RegisterEvictable();
+	}
+
 	// Set the "moved from" flag on the rhs object so that it knows not to call DelayedDelete on GPU resources
 	rhs.m_movedFrom = true;
 }
@@ -30,6 +39,20 @@ MeshGroup& MeshGroup::operator=(MeshGroup&& rhs) noexcept
 	m_vertexBufferView = rhs.m_vertexBufferView;
 	m_indexBufferView = rhs.m_indexBufferView;
 	m_submeshes = std::move(rhs.m_submeshes);
+	m_resident = rhs.m_resident;
+
+	// The eviction callback points at the object that registered it, so register again for this object
+	if (m_residencyHandle != ResidencyManager::InvalidHandle)
+	{
+		Engine::UnregisterEvictable(m_residencyHandle);
+		m_residencyHandle = ResidencyManager::InvalidHandle;
+	}
+	if (rhs.m_residencyHandle != ResidencyManager::InvalidHandle)
+	{
+		Engine::UnregisterEvictable(rhs.m_residencyHandle);
+		rhs.m_residencyHandle = ResidencyManager::InvalidHandle;
+		RegisterEvictable();
+	}
 
 	// Set the "moved from" flag on the rhs object so that it knows not to call DelayedDelete on GPU resources
 	rhs.m_movedFrom = true;
@@ -38,89 +61,48 @@ MeshGroup& MeshGroup::operator=(MeshGroup&& rhs) noexcept
 }
 Microsoft::WRL::ComPtr<ID3D12Resource> MeshGroup::CreateDefaultBuffer(const void* initData, UINT64 byteSize) const
 {
-	Microsoft::WRL::ComPtr<ID3D12Resource> defaultBuffer = nullptr;
-	Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer = nullptr;
-
 	// Create the actual default buffer resource.
-	auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
 	auto desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
-	GFX_THROW_INFO(
-		m_deviceResources->GetDevice()->CreateCommittedResource(
-			&props,
-			D3D12_HEAP_FLAG_NONE,
-			&desc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(defaultBuffer.GetAddressOf())
-		)
-	);
-
-	// In order to copy CPU memory data into our default buffer, we need to create an intermediate upload heap. 
-	auto props2 = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	auto desc2 = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
-	GFX_THROW_INFO(
-		m_deviceResources->GetDevice()->CreateCommittedResource(
-			&props2,
-			D3D12_HEAP_FLAG_NONE,
-			&desc2,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(uploadBuffer.GetAddressOf())
-		)
-	);
-
-	// Describe the data we want to copy into the default buffer.
-	D3D12_SUBRESOURCE_DATA subResourceData = {};
-	subResourceData.pData = initData;
-	subResourceData.RowPitch = byteSize;
-	subResourceData.SlicePitch = subResourceData.RowPitch;
-
-	// Schedule to copy the data to the default buffer resource. At a high level, the helper function UpdateSubresources
-	// will copy the CPU memory into the intermediate upload heap. Then, using ID3D12CommandList::CopySubresourceRegion,
-	// the intermediate upload heap data will be copied to mBuffer.
-	auto commandList = m_deviceResources->GetCommandList();
-
-	auto _b = CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST);
-	commandList->ResourceBarrier(1, &_b);
-
-	UpdateSubresources<1>(commandList, defaultBuffer.Get(), uploadBuffer.Get(), 0, 0, 1, &subResourceData);
-
-	auto _b2 = CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ);
-	commandList->ResourceBarrier(1, &_b2);
+	Microsoft::WRL::ComPtr<ID3D12Resource> defaultBuffer = Engine::CreateResource(MemoryCategory::Mesh, D3D12_HEAP_TYPE_DEFAULT, desc, D3D12_RESOURCE_STATE_COMMON);
 
-	// MUST delete the upload buffer AFTER it is done being referenced by the GPU
-	Engine::DelayedDelete(uploadBuffer);
+	// The data is copied into the Engine's shared staging pages right away, and the copy into the default buffer is
+	// submitted to the copy queue (in one batch with every other pending upload) the next time the Engine submits
+	// uploads. The buffer stays in the COMMON state and is implicitly promoted when it is first read
+	Engine::StageBufferUpload(defaultBuffer, initData, byteSize);
 
-	// Note: uploadBuffer has to be kept alive after the above function calls because
-	// the command list has not been executed yet that performs the actual copy.
-	// The caller can Release the uploadBuffer after it knows the copy has been executed.
 	return defaultBuffer;
 }
+void MeshGroup::RegisterEvictable()
+{
+	// Ask the device for the size of each buffer because placed buffers are rounded up to the placement alignment
+	ID3D12Device* device = m_deviceResources->GetDevice();
+	auto vertexDesc = CD3DX12_RESOURCE_DESC::Buffer(m_vertexBufferView.SizeInBytes);
+	auto indexDesc = CD3DX12_RESOURCE_DESC::Buffer(m_indexBufferView.SizeInBytes);
+	const UINT64 byteSize = device->GetResourceAllocationInfo(0, 1, &vertexDesc).SizeInBytes + device->GetResourceAllocationInfo(0, 1, &indexDesc).SizeInBytes;
+
+	m_residencyHandle = Engine::RegisterEvictable(byteSize, [this]() { Evict(); });
+	if (m_resident)
+		Engine::SetEvictable(m_residencyHandle, true);
+}
+void MeshGroup::Evict() noexcept
+{
+	// Frames in flight may still be reading the buffers. The views are left as they are because nothing binds them
+	// until MarkUsed() has recreated the buffers
+	Engine::DelayedDelete(m_vertexBufferGPU);
+	Engine::DelayedDelete(m_indexBufferGPU);
+	m_vertexBufferGPU = nullptr;
+	m_indexBufferGPU = nullptr;
+	m_resident = false;
+}
 
 //
 // DynamicMesh ======================================================================================================
 //
-Microsoft::WRL::ComPtr<ID3D12Resource> DynamicMeshGroup::CreateUploadBuffer(UINT64 totalBufferSize) const
+Microsoft::WRL::ComPtr<ID3D12Resource> DynamicMeshGroup::CreateUploadBuffer(UINT64 totalBufferSize, unsigned int copies) const
 {
-	Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
-
-	// Need to create the buffer in an upload heap so the CPU can regularly send new data to it
-	auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-
-	// Create a buffer that will hold an entire buffer per frame resource
-	auto desc = CD3DX12_RESOURCE_DESC::Buffer(totalBufferSize * gNumFrameResources);
-
-	GFX_THROW_INFO(
-		m_deviceResources->GetDevice()->CreateCommittedResource(
-			&props,
-			D3D12_HEAP_FLAG_NONE,
-			&desc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&uploadBuffer)
-		)
-	);
-
-	return uploadBuffer;
+	// Create a buffer that will hold an entire buffer per frame resource. It lives in an upload heap so the CPU can
+	// regularly send new data to it
+	auto desc = CD3DX12_RESOURCE_DESC::Buffer(totalBufferSize * copies);
+	return Engine::CreateResource(MemoryCategory::DynamicMesh, D3D12_HEAP_TYPE_UPLOAD, desc, D3D12_RESOURCE_STATE_GENERIC_READ);
 }
 }
\ No newline at end of file
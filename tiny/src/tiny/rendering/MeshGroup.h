@@ -20,7 +20,7 @@ struct SubmeshGeometry
 	UINT StartIndexLocation = 0;
 	INT  BaseVertexLocation = 0;
 
-	// Bounding box of the geometry defined by this submesh. 
+	// Bounding box of the geometry defined by this submesh (in the mesh's local space).
 	DirectX::BoundingBox Bounds;
 };
 
@@ -42,6 +42,7 @@ public:
 	}
 
 	ND inline const SubmeshGeometry& GetSubmesh(unsigned int index) const noexcept { return m_submeshes[index]; }
+	ND inline bool IsResident() const noexcept { return m_resident; }
 
 protected:
 	ND Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(const void* initData, UINT64 byteSize) const;
@@ -52,11 +53,38 @@ protected:
 		// intentially deleted, then the resources are no longer necessary and should be delayed deleted
 		if (!m_movedFrom)
 		{
+			if (m_residencyHandle != ResidencyManager::InvalidHandle)
+				Engine::UnregisterEvictable(m_residencyHandle);
+
 			Engine::DelayedDelete(m_vertexBufferGPU);
 			Engine::DelayedDelete(m_indexBufferGPU);
 		}
 	}
 
+	// Eviction (see ResidencyManager). Only mesh groups that can recreate their buffers register themselves (i.e.
+	// MeshGroupT, which keeps a CPU copy of its data). Evicted buffers are recreated the next time the mesh is drawn
+	virtual void MakeResident() {}
+	void RegisterEvictable();
+	void Evict() noexcept;
+
+	// Called by the Engine (on the main thread) for every mesh group it is about to draw
+	inline void MarkUsed()
+	{
+		if (m_residencyHandle == ResidencyManager::InvalidHandle) LIKELY
+			return;
+
+		if (!m_resident) UNLIKELY
+		{
+			MakeResident();
+			m_resident = true;
+			Engine::SetEvictable(m_residencyHandle, true);
+		}
+		else
+		{
+			Engine::TouchEvictable(m_residencyHandle);
+		}
+	}
+
 	std::shared_ptr<DeviceResources> m_deviceResources;
 
 	Microsoft::WRL::ComPtr<ID3D12Resource> m_vertexBufferGPU = nullptr;
@@ -69,12 +97,17 @@ protected:
 
 	std::vector<SubmeshGeometry> m_submeshes;
 
+	ResidencyManager::Handle m_residencyHandle = ResidencyManager::InvalidHandle;
+	bool m_resident = true;
+
 	bool m_movedFrom = false;
 
 private:
 	// There is too much state to worry about copying, so just delete copy operations until we find a good use case
 	MeshGroup(const MeshGroup&) noexcept = delete;
 	MeshGroup& operator=(const MeshGroup&) noexcept = delete;
+
+	friend class Engine;
 };
 
 
@@ -108,12 +141,24 @@ public:
 	}
 	virtual ~MeshGroupT() noexcept override { CleanUp(); }
 
+protected:
+	void MakeResident() override
+	{
+		// Create the vertex and index buffers with the data from the system memory copies
+		m_vertexBufferGPU = CreateDefaultBuffer(m_vertices.data(), m_vertexBufferView.SizeInBytes);
+		m_indexBufferGPU = CreateDefaultBuffer(m_indices.data(), m_indexBufferView.SizeInBytes);
+
+		// Get the buffer locations
+		m_vertexBufferView.BufferLocation = m_vertexBufferGPU->GetGPUVirtualAddress();
+		m_indexBufferView.BufferLocation = m_indexBufferGPU->GetGPUVirtualAddress();
+	}
+
 private:
 	// There is too much state to worry about copying, so just delete copy operations until we find a good use case
 	MeshGroupT(const MeshGroupT&) noexcept = delete;
 	MeshGroupT& operator=(const MeshGroupT&) noexcept = delete;
 
-	// System memory copies. 
+	// System memory copies (also used to recreate the GPU buffers after they have been evicted)
 	std::vector<T> m_vertices;
 	std::vector<std::uint16_t> m_indices;
 };
@@ -126,6 +171,7 @@ MeshGroupT<T>::MeshGroupT(std::shared_ptr<DeviceResources> deviceResources,
 {
 	TINY_CORE_ASSERT(vertices.size() > 0, "No vertices to add");
 	TINY_CORE_ASSERT(vertices.size() == indices.size(), "There must be a 1:1 correspondence between the number of vertex lists and index lists");
+	static_assert(sizeof(T) >= sizeof(DirectX::XMFLOAT3), "Submesh bounds are computed from the first 3 floats of each vertex, so the vertex type must begin with its position");
 
 	// Compute the total number of vertices and indices
 	size_t totalVertices = 0;
@@ -147,6 +193,11 @@ MeshGroupT<T>::MeshGroupT(std::shared_ptr<DeviceResources> deviceResources,
 		submesh.IndexCount = (UINT)indices[iii].size();
 		submesh.StartIndexLocation = (UINT)m_indices.size(); 
 		submesh.BaseVertexLocation = (INT)m_vertices.size();
+
+		// NOTE: The vertex position is assumed to be the first member of T (see static_assert above)
+		if (vertices[iii].size() > 0)
+			DirectX::BoundingBox::CreateFromPoints(submesh.Bounds, vertices[iii].size(), reinterpret_cast<const DirectX::XMFLOAT3*>(vertices[iii].data()), sizeof(T));
+
 		m_submeshes.push_back(submesh);
 
 		// Add the vertices and indices
@@ -163,12 +214,8 @@ MeshGroupT<T>::MeshGroupT(std::shared_ptr<DeviceResources> deviceResources,
 	m_indexBufferView.SizeInBytes = static_cast<UINT>(m_indices.size()) * sizeof(std::uint16_t);
 
 	// Create the vertex and index buffers with the initial data
-	m_vertexBufferGPU = CreateDefaultBuffer(m_vertices.data(), m_vertexBufferView.SizeInBytes);
-	m_indexBufferGPU = CreateDefaultBuffer(m_indices.data(), m_indexBufferView.SizeInBytes);
-
-	// Get the buffer locations
-	m_vertexBufferView.BufferLocation = m_vertexBufferGPU->GetGPUVirtualAddress();
-	m_indexBufferView.BufferLocation = m_indexBufferGPU->GetGPUVirtualAddress();
+	MeshGroupT::MakeResident();
+	RegisterEvictable();
 }
 
 //
@@ -198,7 +245,7 @@ public:
 	virtual ~DynamicMeshGroup() noexcept override {}
 	inline void Update(int frameIndex) noexcept
 	{
-		// For dynamic meshes, we keep gNumFrameResources copies of the vertex/index buffer in a single, continuous buffer
+		// For dynamic meshes, we keep one copy of the vertex/index buffer per frame resource in a single, continuous buffer
 		// All we need to do every time Update() is called, is to update the vertex/index buffer views to point at the correct
 		// starting location for the next buffer we want to use
 		m_vertexBufferView.BufferLocation = m_vertexBufferGPU->GetGPUVirtualAddress() + static_cast<UINT64>(frameIndex) * m_vertexBufferView.SizeInBytes;
@@ -206,12 +253,21 @@ public:
 	}
 
 protected:
-	ND Microsoft::WRL::ComPtr<ID3D12Resource> CreateUploadBuffer(UINT64 totalBufferSize) const;
+	ND Microsoft::WRL::ComPtr<ID3D12Resource> CreateUploadBuffer(UINT64 totalBufferSize, unsigned int copies) const;
+
+	// Called by the Engine (only while the GPU is idle) when the number of frame resources changes
+	virtual void SetFrameResourceCount(unsigned int frameResourceCount) = 0;
 
 private:
 	// There is too much state to worry about copying, so just delete copy operations until we find a good use case
 	DynamicMeshGroup(const DynamicMeshGroup&) = delete;
 	DynamicMeshGroup& operator=(const DynamicMeshGroup&) = delete;
+
+	// Handle into the Engine's dynamic mesh list. It is intentionally NOT moved - a moved-to mesh registers itself
+	// and the moved-from mesh unregisters in its destructor
+	utility::SlotMapHandle m_engineHandle = {};
+
+	friend class Engine;
 };
 
 
@@ -248,30 +304,13 @@ public:
 		m_indexBufferView.Format = DXGI_FORMAT_R16_UINT; 
 		m_indexBufferView.SizeInBytes = static_cast<UINT>(m_indices.size()) * sizeof(std::uint16_t); 
 
-		// Create the vertex and index buffers as UPLOAD buffers (so there will be gNumFrameResources copies of the vertex/index buffers)
-		m_vertexBufferGPU = CreateUploadBuffer(m_vertexBufferView.SizeInBytes); 
-		m_indexBufferGPU = CreateUploadBuffer(m_indexBufferView.SizeInBytes);
-
-		// Map the vertex and index buffers
-		GFX_THROW_INFO(m_vertexBufferGPU->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedVertexData)));
-		GFX_THROW_INFO(m_indexBufferGPU->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedIndexData)));
-
-		// Copy the data into all slots of the upload buffers (We do all slots because creation of the dynamic buffer
-		// may occur at any point, not necessarily just at program start up, so we can't just assume we are on frame index 0)
-		for (unsigned int iii = 0; iii < gNumFrameResources; ++iii)
-		{
-			memcpy(&m_mappedVertexData[iii * m_vertexBufferView.SizeInBytes], m_vertices.data(), m_vertexBufferView.SizeInBytes);
-			memcpy(&m_mappedIndexData[iii * m_indexBufferView.SizeInBytes], m_indices.data(), m_indexBufferView.SizeInBytes);
-		}
-
-		// Set the buffer locations as the start of the Upload buffers. This will later be changed each frame when Update() is called
-		m_vertexBufferView.BufferLocation = m_vertexBufferGPU->GetGPUVirtualAddress();
-		m_indexBufferView.BufferLocation = m_indexBufferGPU->GetGPUVirtualAddress();
+		CreateBuffers(Engine::GetFrameResourceCount());
 	}
 	DynamicMeshGroupT(DynamicMeshGroupT&& rhs) noexcept :
 		DynamicMeshGroup(std::move(rhs)),
 		m_vertices(std::move(rhs.m_vertices)),
-		m_indices(std::move(rhs.m_indices))
+		m_indices(std::move(rhs.m_indices)),
+		m_frameCopies(rhs.m_frameCopies)
 	{
 		LOG_CORE_WARN("{}", "DynamicMeshGroupT Move Constructor called, but this method has not been tested. Make sure this call was intentional and, if so, that the function works as expected");
 		// Specifically, see this SO post above calling std::move(rhs) but then proceding to use the rhs object: https://stackoverflow.com/questions/22977230/move-constructors-in-inheritance-hierarchy
@@ -294,6 +333,7 @@ public:
 		DynamicMeshGroup::operator=(std::move(rhs));
 		m_vertices = std::move(rhs.m_vertices);
 		m_indices = std::move(rhs.m_indices);
+		m_frameCopies = rhs.m_frameCopies;
 
 		// Map the vertex and index buffers
 		GFX_THROW_INFO(m_vertexBufferGPU->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedVertexData)));
@@ -304,13 +344,7 @@ public:
 	virtual ~DynamicMeshGroupT() noexcept override 
 	{ 
 		Engine::RemoveDynamicMeshGroup(this);
-
-		if (m_vertexBufferGPU != nullptr)
-			m_vertexBufferGPU->Unmap(0, nullptr);
-
-		if (m_indexBufferGPU != nullptr)
-			m_indexBufferGPU->Unmap(0, nullptr);
-
+		UnmapBuffers();
 		CleanUp();
 	}
 
@@ -331,29 +365,75 @@ public:
 
 	inline void UploadVertices(unsigned int frameIndex) noexcept
 	{
-		TINY_CORE_ASSERT(frameIndex < gNumFrameResources, "Frame index is larger than expected");
+		TINY_CORE_ASSERT(frameIndex < m_frameCopies, "Frame index is larger than expected");
 		memcpy(&m_mappedVertexData[frameIndex * m_vertexBufferView.SizeInBytes], m_vertices.data(), m_vertexBufferView.SizeInBytes);
 	}
 	inline void UploadIndices(unsigned int frameIndex) noexcept
 	{
-		TINY_CORE_ASSERT(frameIndex < gNumFrameResources, "Frame index is larger than expected");
+		TINY_CORE_ASSERT(frameIndex < m_frameCopies, "Frame index is larger than expected");
 		memcpy(&m_mappedIndexData[frameIndex * m_indexBufferView.SizeInBytes], m_indices.data(), m_indexBufferView.SizeInBytes);
 	}
 
 	ND inline std::vector<T>& GetVertices() noexcept { return m_vertices; }
 	ND inline std::vector<std::uint16_t>& GetIndices() noexcept { return m_indices; }
 
+protected:
+	void SetFrameResourceCount(unsigned int frameResourceCount) override
+	{
+		if (frameResourceCount == m_frameCopies)
+			return;
+
+		// The GPU is idle, so the old buffers can be released right away. Every copy is refilled from the CPU copy,
+		// which means any data that was only uploaded for specific frame indices is replaced by the most recent data
+		UnmapBuffers();
+		CreateBuffers(frameResourceCount);
+	}
+
 private:
 	// There is too much state to worry about copying, so just delete copy operations until we find a good use case
 	DynamicMeshGroupT(const DynamicMeshGroupT&) = delete;
 	DynamicMeshGroupT& operator=(const DynamicMeshGroupT&) = delete;
 
+	void CreateBuffers(unsigned int frameCopies)
+	{
+		m_frameCopies = frameCopies;
+
+		// Create the vertex and index buffers as UPLOAD buffers (so there will be one copy of the vertex/index buffers per frame resource)
+		m_vertexBufferGPU = CreateUploadBuffer(m_vertexBufferView.SizeInBytes, m_frameCopies); 
+		m_indexBufferGPU = CreateUploadBuffer(m_indexBufferView.SizeInBytes, m_frameCopies);
+
+		// Map the vertex and index buffers
+		GFX_THROW_INFO(m_vertexBufferGPU->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedVertexData)));
+		GFX_THROW_INFO(m_indexBufferGPU->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedIndexData)));
+
+		// Copy the data into all slots of the upload buffers (We do all slots because creation of the dynamic buffer
+		// may occur at any point, not necessarily just at program start up, so we can't just assume we are on frame index 0)
+		for (unsigned int iii = 0; iii < m_frameCopies; ++iii)
+		{
+			memcpy(&m_mappedVertexData[iii * m_vertexBufferView.SizeInBytes], m_vertices.data(), m_vertexBufferView.SizeInBytes);
+			memcpy(&m_mappedIndexData[iii * m_indexBufferView.SizeInBytes], m_indices.data(), m_indexBufferView.SizeInBytes);
+		}
+
+		// Set the buffer locations as the start of the Upload buffers. This will later be changed each frame when Update() is called
+		m_vertexBufferView.BufferLocation = m_vertexBufferGPU->GetGPUVirtualAddress();
+		m_indexBufferView.BufferLocation = m_indexBufferGPU->GetGPUVirtualAddress();
+	}
+	inline void UnmapBuffers() noexcept
+	{
+		if (m_vertexBufferGPU != nullptr)
+			m_vertexBufferGPU->Unmap(0, nullptr);
+
+		if (m_indexBufferGPU != nullptr)
+			m_indexBufferGPU->Unmap(0, nullptr);
+	}
+
 	// System memory copies. 
 	std::vector<T> m_vertices;
 	std::vector<std::uint16_t> m_indices;
 
 	BYTE* m_mappedVertexData = nullptr;
 	BYTE* m_mappedIndexData = nullptr;
+	unsigned int m_frameCopies = 0;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "tiny-pch.h"
+#include "MipGenerator.h"
+#include "tiny/rendering/DescriptorManager.h"
+#include "tiny/rendering/RootSignature.h"
+#include "tiny/utils/Profile.h"
+
+namespace tiny
+{
+// Each thread writes one destination texel. The texel covers 'scale' source texels in each direction (2, or a bit
+// more when the source size is odd), and each source texel it touches is weighted by how much of it is covered.
+// TEXEL is float for single channel formats (typed UAV loads of R32_FLOAT must be declared as a single component)
+static constexpr char MipGeneratorShader[] = R"(
+cbuffer Constants : register(b0)
+{
+	uint2 SourceSize;
+	uint2 DestinationSize;
+};
+
+RWTexture2D<TEXEL> Source : register(u0);
+RWTexture2D<TEXEL> Destination : register(u1);
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+	if (id.x >= DestinationSize.x || id.y >= DestinationSize.y)
+		return;
+
+	// Edges computed from integer products, so they only round once (scale * id loses precision on large mips)
+	float2 scale = float2(SourceSize) / float2(DestinationSize);
+	float2 start = float2(id.xy * SourceSize) / float2(DestinationSize);
+	float2 end = float2((id.xy + 1) * SourceSize) / float2(DestinationSize);
+	int2 first = int2(floor(start));
+	int2 last = min(int2(ceil(end)), int2(SourceSize)) - 1;
+
+	TEXEL sum = 0;
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		float weightY = min(y + 1.0f, end.y) - max(float(y), start.y);
+		for (int x = first.x; x <= last.x; ++x)
+		{
+			float weightX = min(x + 1.0f, end.x) - max(float(x), start.x);
+			sum += Source[int2(x, y)] * (weightX * weightY);
+		}
+	}
+	Destination[id.xy] = sum / (scale.x * scale.y);
+}
+)";
+
+static constexpr UINT ThreadGroupSize = 8;
+
+ND static bool IsSingleChannel(DXGI_FORMAT format) noexcept
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_SNORM:
+		return true;
+	default:
+		return false;
+	}
+}
+
+MipGenerator::MipGenerator(std::shared_ptr<DeviceResources> deviceResources) :
+	m_deviceResources(deviceResources)
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+
+	// b0: source/destination sizes, u0: source mip, u1: destination mip
+	CD3DX12_DESCRIPTOR_RANGE sourceRange(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0);
+	CD3DX12_DESCRIPTOR_RANGE destinationRange(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 1);
+
+	CD3DX12_ROOT_PARAMETER parameters[3];
+	parameters[0].InitAsConstants(4, 0);
+	parameters[1].InitAsDescriptorTable(1, &sourceRange);
+	parameters[2].InitAsDescriptorTable(1, &destinationRange);
+
+	CD3DX12_ROOT_SIGNATURE_DESC desc(_countof(parameters), parameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
+	m_rootSignature = std::make_shared<RootSignature>(m_deviceResources, desc);
+}
+
+bool MipGenerator::SupportsFormat(DXGI_FORMAT format) const
+{
+	D3D12_FEATURE_DATA_FORMAT_SUPPORT support = { format, D3D12_FORMAT_SUPPORT1_NONE, D3D12_FORMAT_SUPPORT2_NONE };
+	if (FAILED(m_deviceResources->GetDevice()->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT, &support, sizeof(support))))
+		return false;
+
+	const D3D12_FORMAT_SUPPORT2 required = D3D12_FORMAT_SUPPORT2_UAV_TYPED_LOAD | D3D12_FORMAT_SUPPORT2_UAV_TYPED_STORE;
+	return (support.Support2 & required) == required;
+}
+
+ID3D12PipelineState* MipGenerator::GetPipelineState(DXGI_FORMAT format)
+{
+	const bool singleChannel = IsSingleChannel(format);
+	Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState = singleChannel ? m_singleChannelPipelineState : m_fourChannelPipelineState;
+	if (pipelineState != nullptr) LIKELY
+		return pipelineState.Get();
+
+	PROFILE_FUNCTION();
+
+	const D3D_SHADER_MACRO defines[] = { { "TEXEL", singleChannel ? "float" : "float4" }, { nullptr, nullptr } };
+
+#if defined(_DEBUG)
+	const UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+	const UINT compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+	Microsoft::WRL::ComPtr<ID3DBlob> shader = nullptr;
+	Microsoft::WRL::ComPtr<ID3DBlob> errors = nullptr;
+	HRESULT hr = D3DCompile(MipGeneratorShader, sizeof(MipGeneratorShader) - 1, "MipGenerator", defines, nullptr, "main", "cs_5_1",
+							compileFlags, 0, shader.GetAddressOf(), errors.GetAddressOf());
+
+	if (errors != nullptr)
+	{
+		LOG_CORE_ERROR("MipGenerator: D3DCompile() failed with message: {}", static_cast<const char*>(errors->GetBufferPointer()));
+	}
+	if (FAILED(hr))
+		throw tiny::DeviceResourcesException(__LINE__, __FILE__, hr);
+
+	D3D12_COMPUTE_PIPELINE_STATE_DESC desc = {};
+	desc.pRootSignature = m_rootSignature->Get();
+	desc.CS = { shader->GetBufferPointer(), shader->GetBufferSize() };
+	desc.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+
+	GFX_THROW_INFO(
+		m_deviceResources->GetDevice()->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState))
+	);
+	return pipelineState.Get();
+}
+
+void MipGenerator::Generate(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource, std::span<const unsigned int> mipUAVs)
+{
+	PROFILE_FUNCTION();
+
+	TINY_CORE_ASSERT(commandList != nullptr, "No command list");
+	TINY_CORE_ASSERT(resource != nullptr, "No resource");
+
+	const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+	TINY_CORE_ASSERT(desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D && desc.DepthOrArraySize == 1, "MipGenerator only supports 2D textures with a single array slice");
+	TINY_CORE_ASSERT(desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, "MipGenerator needs a texture that allows unordered access");
+	TINY_CORE_ASSERT(mipUAVs.size() == desc.MipLevels, "Need a UAV for every mip");
+
+	if (desc.MipLevels <= 1)
+		return;
+
+	ID3D12PipelineState* pipelineState = GetPipelineState(desc.Format);
+
+	// The heap may not be set yet if this is recorded outside of the frame (i.e. during initialization)
+	ID3D12DescriptorHeap* descriptorHeaps[] = { DescriptorManager::GetRawHeapPointer() };
+	GFX_THROW_INFO_ONLY(commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps));
+	GFX_THROW_INFO_ONLY(commandList->SetComputeRootSignature(m_rootSignature->Get()));
+	GFX_THROW_INFO_ONLY(commandList->SetPipelineState(pipelineState));
+
+	UINT sourceWidth = static_cast<UINT>(desc.Width);
+	UINT sourceHeight = desc.Height;
+	for (UINT16 mip = 1; mip < desc.MipLevels; ++mip)
+	{
+		const UINT destinationWidth = MathHelper::Max(1u, sourceWidth >> 1);
+		const UINT destinationHeight = MathHelper::Max(1u, sourceHeight >> 1);
+
+		const UINT constants[4] = { sourceWidth, sourceHeight, destinationWidth, destinationHeight };
+		GFX_THROW_INFO_ONLY(commandList->SetComputeRoot32BitConstants(0, _countof(constants), constants, 0));
+		GFX_THROW_INFO_ONLY(commandList->SetComputeRootDescriptorTable(1, DescriptorManager::GetGPUHandleAt(mipUAVs[mip - 1])));
+		GFX_THROW_INFO_ONLY(commandList->SetComputeRootDescriptorTable(2, DescriptorManager::GetGPUHandleAt(mipUAVs[mip])));
+		GFX_THROW_INFO_ONLY(commandList->Dispatch((destinationWidth + ThreadGroupSize - 1) / ThreadGroupSize, (destinationHeight + ThreadGroupSize - 1) / ThreadGroupSize, 1));
+
+		// The next dispatch reads what this one wrote
+		CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(resource);
+		GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(1, &barrier));
+
+		sourceWidth = destinationWidth;
+		sourceHeight = destinationHeight;
+	}
+}
+}
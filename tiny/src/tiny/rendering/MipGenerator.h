@@ -0,0 +1,45 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+
+namespace tiny
+{
+class RootSignature;
+
+// MipGenerator fills in the mips of a 2D texture on the GPU. One dispatch per mip reads the mip above it and writes
+// an area weighted box filtered copy (the same filter as mips::Filter::Box on the CPU, so odd sizes don't drop the
+// last row/column). Use it for textures whose mip 0 is rendered or computed on the GPU. Static textures are better
+// off having their chain built on the CPU (see mips::Generate() and TextureVector::EmplaceBackFromPixels()).
+//
+// Both mips are accessed through UAVs, so the texture must have been created with
+// D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, and its format must support typed UAV loads and stores (see
+// SupportsFormat(): R32_FLOAT always does, formats like R8G8B8A8_UNORM need TypedUAVLoadAdditionalFormats). sRGB
+// formats can't be UAVs at all.
+//
+// The shader is compiled the first time it is needed (one variant for single channel formats, one for the rest)
+class MipGenerator
+{
+public:
+	MipGenerator(std::shared_ptr<DeviceResources> deviceResources);
+
+	ND bool SupportsFormat(DXGI_FORMAT format) const;
+
+	// Records the dispatches into 'commandList', which is left with the generator's compute root signature and
+	// pipeline state. 'mipUAVs' holds the index of a UAV (see DescriptorManager) for every mip of 'resource', which
+	// must be in the UNORDERED_ACCESS state
+	void Generate(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource, std::span<const unsigned int> mipUAVs);
+
+private:
+	MipGenerator(const MipGenerator&) = delete;
+	MipGenerator& operator=(const MipGenerator&) = delete;
+
+	ND ID3D12PipelineState* GetPipelineState(DXGI_FORMAT format);
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	std::shared_ptr<RootSignature> m_rootSignature;
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> m_singleChannelPipelineState = nullptr;
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> m_fourChannelPipelineState = nullptr;
+};
+}
@@ -4,6 +4,10 @@
 #include "ConstantBuffer.h"
 #include "RootConstantBufferView.h"
 #include "RootDescriptorTable.h"
+#include "MeshGroup.h"
+#include "DrawPacketStream.h"
+#include "tiny/scene/BoundingVolumeHierarchy.h"
+#include "tiny/utils/SlotMap.h"
 #include "tiny/utils/Timer.h"
 
 namespace tiny
@@ -11,6 +15,15 @@ namespace tiny
 class RenderItem
 {
 public:
+	// EveryFrame: Update() is called every frame (default)
+	// WhenDirty:  Update() is only called for the number of frames passed to the most recent MarkDirty() call. This
+	//             is meant for static objects, so that they cost nothing per frame until something changes
+	enum class UpdateMode
+	{
+		EveryFrame,
+		WhenDirty
+	};
+
 	RenderItem() noexcept
 	{
 		// Register the RenderItem with the Engine (used by the Engine to call RenderItem::Update)
@@ -18,33 +31,140 @@ public:
 	}
 	// Because we are storing render items in a vector, it is possible that even when using emplace_back, the vector
 	// may need to grow, and therefore, need to move the contents of all of the render items. So we must implement
-	// move operations. However, moving the object causes the 'this' pointer to change, so we must update the Engine
+	// move operations. However, moving the object causes the 'this' pointer to change, so we must update the Engine.
+	// Rather than unregistering rhs and registering this, we take over rhs's handle and just swap the pointer (O(1))
 	RenderItem(RenderItem&& rhs) noexcept :
 		ConstantBufferViews(std::move(rhs.ConstantBufferViews)),
 		DescriptorTables(std::move(rhs.DescriptorTables)),
-		submeshIndex(rhs.submeshIndex)
+		ThreadSafeUpdate(rhs.ThreadSafeUpdate),
+		m_updateMode(rhs.m_updateMode),
+		m_numFramesDirty(rhs.m_numFramesDirty),
+		m_engineHandle(rhs.m_engineHandle),
+		m_submeshIndex(rhs.m_submeshIndex)
 	{
-		// I don't think we need to explicitly call RemoveRenderItem on the rhs object because its destructor should do that
-		Engine::AddRenderItem(this);
+		// rhs no longer owns the handle, so its destructor will not unregister anything
+		rhs.m_engineHandle = {};
+		if (m_engineHandle.IsValid())
+			Engine::ReplaceRenderItem(this);
+
+		TakeCullingState(rhs);
+
+		// rhs's stream points into the vectors we just took
+		rhs.InvalidateDrawPackets();
 	}
 	RenderItem& operator=(RenderItem&& rhs) noexcept
 	{
 		LOG_CORE_WARN("{}", "RenderItem Move Assignment operator called, but this method has not been tested. Make sure updates to the Engine are correct. NOTE: I have tested the Move Constructor, so I believe the Move Assignment operator should be fine...");
 
-		// I don't think we need to explicitly call RemoveRenderItem on the rhs object because its destructor should do that
-		Engine::AddRenderItem(this);
-
 		ConstantBufferViews = std::move(rhs.ConstantBufferViews);
 		DescriptorTables = std::move(rhs.DescriptorTables);
-		submeshIndex = rhs.submeshIndex;
+		ThreadSafeUpdate = rhs.ThreadSafeUpdate;
+		m_submeshIndex = rhs.m_submeshIndex;
+
+		// Both streams point into vectors that just changed hands. We stay in our layer's stream (which will be recompiled)
+		InvalidateDrawPackets();
+		rhs.InvalidateDrawPackets();
+
+		LeaveCullingStructures();
+		TakeCullingState(rhs);
+
+		// Drop our own registration and take over rhs's (see move constructor)
+		UnregisterWithEngine();
+		m_updateMode = rhs.m_updateMode;
+		m_numFramesDirty = rhs.m_numFramesDirty;
+		m_engineHandle = rhs.m_engineHandle;
+		rhs.m_engineHandle = {};
+		if (m_engineHandle.IsValid())
+			Engine::ReplaceRenderItem(this);
 
 		return *this;
 	}
 	~RenderItem() noexcept
 	{
 		// Unregister the RenderItem with the Engine
-		Engine::RemoveRenderItem(this);
+		UnregisterWithEngine();
+		LeaveCullingStructures();
+	}
+
+	void SetUpdateMode(UpdateMode mode) noexcept
+	{
+		if (mode == m_updateMode)
+			return;
+
+		UnregisterWithEngine();
+		m_updateMode = mode;
+
+		// When switching to WhenDirty, we don't know whether the item has been updated yet, so schedule an update
+		m_numFramesDirty = m_updateMode == UpdateMode::WhenDirty ? 1 : 0;
+		RegisterWithEngine();
+	}
+	ND inline UpdateMode GetUpdateMode() const noexcept { return m_updateMode; }
+
+	// Schedules Update() to be called for the next numFrames frames. Does nothing if the item is updated every frame.
+	// A single frame is enough for constant buffers, because their CPU copy is re-uploaded every frame it is bound.
+	// Only Update() functions that write per-frame resources themselves need one frame per frame resource
+	// NOTE: Must only be called from the main thread (never from an Update() that has ThreadSafeUpdate set)
+	void MarkDirty(unsigned int numFrames = 1) noexcept
+	{
+		if (m_updateMode == UpdateMode::EveryFrame)
+			return;
+
+		m_numFramesDirty = MathHelper::Max(m_numFramesDirty, numFrames);
+		if (m_numFramesDirty > 0)
+			Engine::AddRenderItem(this); // no-op if the item is already on the dirty list
 	}
+	ND inline bool IsDirty() const noexcept { return m_numFramesDirty > 0; }
+
+	// The object's world transform. The Engine uses it to derive the world space bounds of the item's submesh when the
+	// item's layer has frustum culling enabled (see RenderPassLayer::FrustumCull). Items without a world transform are
+	// never culled
+	// NOTE: Must only be called from the main thread (never from an Update() that has ThreadSafeUpdate set)
+	inline void SetWorldTransform(const DirectX::XMFLOAT4X4& world) noexcept
+	{
+		m_world = world;
+		m_hasWorldTransform = true;
+		m_worldBoundsDirty = true;
+
+		// Items in a BVH must have their leaf refit, which the Engine does in bulk before culling
+		if (m_bvh != nullptr)
+			Engine::QueueBoundsUpdate(this);
+	}
+	inline void ClearWorldTransform() noexcept
+	{
+		m_hasWorldTransform = false;
+		if (m_bvh != nullptr)
+			Engine::QueueBoundsUpdate(this);
+	}
+	ND inline bool HasWorldTransform() const noexcept { return m_hasWorldTransform; }
+
+	// The PSO will hold and bind the mesh-group for all of the render items it will render.
+	// Here, we just need to keep track of which submesh index the render item references
+	// NOTE: The submesh determines the item's bounds, so changing it is handled like a transform change. Layers that
+	//       compile draw packets have their stream recompiled, because the draw arguments are baked into it. Must only
+	//       be called from the main thread (never from an Update() that has ThreadSafeUpdate set)
+	inline void SetSubmeshIndex(unsigned int index) noexcept
+	{
+		if (index == m_submeshIndex)
+			return;
+
+		m_submeshIndex = index;
+		m_worldBoundsDirty = true;
+		if (m_bvh != nullptr)
+			Engine::QueueBoundsUpdate(this);
+		InvalidateDrawPackets();
+	}
+	ND inline unsigned int GetSubmeshIndex() const noexcept { return m_submeshIndex; }
+
+	ND inline const DirectX::BoundingBox& GetWorldBounds() const noexcept { return m_worldBounds; }
+	ND inline DirectX::BoundingBox ComputeWorldBounds(const MeshGroup* meshGroup) const noexcept
+	{
+		DirectX::BoundingBox bounds;
+		meshGroup->GetSubmesh(m_submeshIndex).Bounds.Transform(bounds, DirectX::XMLoadFloat4x4(&m_world));
+		return bounds;
+	}
+
+	// True if the item was culled for the current frame (only valid once Render() has started)
+	ND inline bool IsCulled() const noexcept { return m_culledOnFrame == Engine::GetFrameNumber(); }
 
 	void Update(const Timer& timer, int frameIndex)
 	{
@@ -56,19 +176,172 @@ public:
 			dt.Update(&dt, timer, frameIndex);
 	}
 
+	// 64-bit key used to sort render items within a RenderPassLayer so that items which bind the same state are drawn
+	// back-to-back. The PSO and MeshGroup are fixed for a layer, so the key only needs to capture the per-item state.
+	// Layout: [63..24] hash of the descriptor table handles | [23..0] submesh index
+	// If the layer is instanced, pass the root parameter index of the per-object constant buffer. All other constant
+	// buffers are then included in the hash because items can only share an instanced draw if they share those buffers
+	ND inline UINT64 SortKey(UINT perObjectRootParameterIndex = UINT_MAX) const noexcept
+	{
+		// FNV-1a over the descriptor table handles
+		UINT64 hash = 14695981039346656037ull;
+		for (const RootDescriptorTable& dt : DescriptorTables)
+		{
+			hash ^= dt.DescriptorHandle.ptr;
+			hash *= 1099511628211ull;
+		}
+
+		if (perObjectRootParameterIndex != UINT_MAX)
+		{
+			for (const RootConstantBufferView& cbv : ConstantBufferViews)
+			{
+				if (cbv.RootParameterIndex == perObjectRootParameterIndex)
+					continue;
+				hash ^= reinterpret_cast<UINT64>(cbv.ConstantBuffer);
+				hash *= 1099511628211ull;
+			}
+		}
+
+		return (hash << 24) | (static_cast<UINT64>(m_submeshIndex) & 0xFFFFFF);
+	}
+
+	// Returns true if both items can be drawn with a single instanced draw call, i.e. everything other than the
+	// per-object constant buffer is identical
+	ND inline bool CanInstanceWith(const RenderItem& rhs, UINT perObjectRootParameterIndex) const noexcept
+	{
+		if (m_submeshIndex != rhs.m_submeshIndex ||
+			DescriptorTables.size() != rhs.DescriptorTables.size() ||
+			ConstantBufferViews.size() != rhs.ConstantBufferViews.size())
+			return false;
+
+		for (unsigned int iii = 0; iii < DescriptorTables.size(); ++iii)
+		{
+			if (DescriptorTables[iii].Index() != rhs.DescriptorTables[iii].Index() ||
+				DescriptorTables[iii].DescriptorHandle.ptr != rhs.DescriptorTables[iii].DescriptorHandle.ptr)
+				return false;
+		}
+
+		for (unsigned int iii = 0; iii < ConstantBufferViews.size(); ++iii)
+		{
+			const RootConstantBufferView& lhsCBV = ConstantBufferViews[iii];
+			const RootConstantBufferView& rhsCBV = rhs.ConstantBufferViews[iii];
+			if (lhsCBV.RootParameterIndex != rhsCBV.RootParameterIndex)
+				return false;
+			if (lhsCBV.RootParameterIndex != perObjectRootParameterIndex && lhsCBV.ConstantBuffer != rhsCBV.ConstantBuffer)
+				return false;
+		}
+
+		return true;
+	}
+
+	ND inline const RootConstantBufferView* FindConstantBufferView(UINT rootParameterIndex) const noexcept
+	{
+		for (const RootConstantBufferView& cbv : ConstantBufferViews)
+		{
+			if (cbv.RootParameterIndex == rootParameterIndex)
+				return &cbv;
+		}
+		return nullptr;
+	}
+
 	// 0+ constant buffer views for per-item constants
 	std::vector<RootConstantBufferView> ConstantBufferViews;
 
 	// 0+ descriptor tables for per-item resources
 	std::vector<RootDescriptorTable> DescriptorTables;
 
-	// The PSO will hold and bind the mesh-group for all of the render items it will render.
-	// Here, we just need to keep track of which submesh index the render item references
-	unsigned int submeshIndex = 0;
+	// Set to true if Update() may be called on a worker thread at the same time as Update() for other items. This is
+	// only safe if none of the Update functions write to data that another item also reads or writes during Update
+	// (for example, a constant buffer shared by multiple items).
+	// NOTE: A thread safe Update() must not call MarkDirty(), SetUpdateMode(), SetWorldTransform(),
+	//       ClearWorldTransform() or SetSubmeshIndex() on any item (including its own). Those change the Engine's item
+	//       lists and bounds update queue, which are not synchronized (the Engine asserts if they are called while
+	//       items are being updated in parallel). Leave ThreadSafeUpdate off for items whose Update() needs them
+	bool ThreadSafeUpdate = false;
 
 private:
 	RenderItem(const RenderItem&) = delete;
 	RenderItem& operator=(const RenderItem&) = delete;
+
+	// EveryFrame items live in the Engine's update list. WhenDirty items are only known to the Engine while dirty
+	inline void RegisterWithEngine() noexcept
+	{
+		if (m_updateMode == UpdateMode::EveryFrame || m_numFramesDirty > 0)
+			Engine::AddRenderItem(this);
+	}
+	inline void UnregisterWithEngine() noexcept
+	{
+		if (m_engineHandle.IsValid())
+			Engine::RemoveRenderItem(this);
+	}
+
+	UpdateMode m_updateMode = UpdateMode::EveryFrame;
+	unsigned int m_numFramesDirty = 0;
+
+	// Handle into whichever Engine list (every frame or dirty) currently holds this item. Invalid if the item is not registered
+	utility::SlotMapHandle m_engineHandle = {};
+
+	// Moves rhs's culling state (including its place in any BVH/update queue) to this item
+	void TakeCullingState(RenderItem& rhs) noexcept
+	{
+		m_world = rhs.m_world;
+		m_worldBounds = rhs.m_worldBounds;
+		m_hasWorldTransform = rhs.m_hasWorldTransform;
+		m_worldBoundsDirty = rhs.m_worldBoundsDirty;
+		m_culledOnFrame = rhs.m_culledOnFrame;
+
+		m_bvh = rhs.m_bvh;
+		m_bvhMeshGroup = rhs.m_bvhMeshGroup;
+		m_bvhProxy = rhs.m_bvhProxy;
+		m_boundsUpdateHandle = rhs.m_boundsUpdateHandle;
+		rhs.m_bvh = nullptr;
+		rhs.m_bvhProxy = BoundingVolumeHierarchy<RenderItem>::NullNode;
+		rhs.m_boundsUpdateHandle = {};
+
+		if (m_bvh != nullptr && m_bvhProxy != BoundingVolumeHierarchy<RenderItem>::NullNode)
+			m_bvh->SetValue(m_bvhProxy, this);
+		if (m_boundsUpdateHandle.IsValid())
+			Engine::ReplaceBoundsUpdate(this);
+	}
+	inline void LeaveCullingStructures() noexcept
+	{
+		if (m_bvh != nullptr && m_bvhProxy != BoundingVolumeHierarchy<RenderItem>::NullNode)
+			m_bvh->Remove(m_bvhProxy);
+		m_bvh = nullptr;
+		m_bvhProxy = BoundingVolumeHierarchy<RenderItem>::NullNode;
+
+		if (m_boundsUpdateHandle.IsValid())
+			Engine::RemoveBoundsUpdate(this);
+	}
+
+	unsigned int m_submeshIndex = 0;
+
+	// The stream of the layer this item was last compiled into (see RenderPassLayer::CompileDrawPackets), or nullptr
+	DrawPacketStream* m_drawPackets = nullptr;
+	inline void InvalidateDrawPackets() noexcept
+	{
+		if (m_drawPackets != nullptr)
+			m_drawPackets->Invalidate();
+	}
+
+	// Frustum culling. The world bounds are recomputed lazily (by the Engine) because the submesh may not be known when
+	// the transform is set. m_culledOnFrame means the culled flag never has to be reset, it simply goes stale
+	DirectX::XMFLOAT4X4 m_world = MathHelper::Identity4x4();
+	DirectX::BoundingBox m_worldBounds;
+	bool m_hasWorldTransform = false;
+	bool m_worldBoundsDirty = true;
+	UINT64 m_culledOnFrame = UINT64_MAX;
+
+	// Set once the item's layer is large enough to be culled with a BVH (see Engine::MinItemsForBVHCulling). The proxy
+	// is NullNode while the item has no world transform
+	BoundingVolumeHierarchy<RenderItem>* m_bvh = nullptr;
+	const MeshGroup* m_bvhMeshGroup = nullptr;
+	int m_bvhProxy = BoundingVolumeHierarchy<RenderItem>::NullNode;
+	utility::SlotMapHandle m_boundsUpdateHandle = {};
+
+	friend class Engine;
+	friend class RenderPassLayer;
+	friend class DrawPacketStream;
 };
 
 }
\ No newline at end of file
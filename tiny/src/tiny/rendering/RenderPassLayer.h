@@ -5,10 +5,28 @@
 #include "tiny/DeviceResources.h"
 #include "RenderItem.h"
 #include "MeshGroup.h"
+#include "DrawPacketStream.h"
+#include "tiny/utils/StableVector.h"
 
 
 namespace tiny
 {
+struct DrawSortKey
+{
+	UINT64 Key = 0;
+	unsigned int ItemIndex = 0;
+};
+
+// Describes how a layer collapses its render items into instanced draws. Items that reference the same submesh,
+// descriptor tables, and (non per-object) constant buffers are drawn with a single DrawIndexedInstanced call. The
+// data of each item's per-object constant buffer is packed into a structured buffer that is bound as a root SRV, so
+// the vertex shader must read its per-object data from that buffer using SV_InstanceID
+struct InstancingDesc
+{
+	UINT PerObjectRootParameterIndex = 0;		// Root parameter of the per-object CBV (this CBV is NOT bound when instancing)
+	UINT InstanceBufferRootParameterIndex = 0;	// Root parameter (root SRV) that receives the packed per-object data
+};
+
 class RenderPassLayer
 {
 public:
@@ -24,19 +42,47 @@ public:
 		PipelineState(rhs.PipelineState),
 		Topology(rhs.Topology),
 		Meshes(std::move(rhs.Meshes)),
-		Name(std::move(rhs.Name))
-	{}
+		SortRenderItems(rhs.SortRenderItems),
+		InstanceRenderItems(rhs.InstanceRenderItems),
+		Instancing(rhs.Instancing),
+		FrustumCull(rhs.FrustumCull),
+		CompileDrawPackets(rhs.CompileDrawPackets),
+		Name(std::move(rhs.Name)),
+		m_drawOrder(std::move(rhs.m_drawOrder)),
+		m_drawPackets(std::move(rhs.m_drawPackets)),
+		m_bvh(std::move(rhs.m_bvh)),
+		m_bvhSyncedInsertions(rhs.m_bvhSyncedInsertions)
+	{
+		DetachDrawPackets();
+	}
 	RenderPassLayer& operator=(RenderPassLayer&& rhs) noexcept
 	{
 		m_deviceResources = rhs.m_deviceResources;
-		RenderItems = std::move(rhs.RenderItems);
 		PipelineState = rhs.PipelineState;
 		Topology = rhs.Topology;
 		Meshes = std::move(rhs.Meshes);
+		SortRenderItems = rhs.SortRenderItems;
+		InstanceRenderItems = rhs.InstanceRenderItems;
+		Instancing = rhs.Instancing;
+		FrustumCull = rhs.FrustumCull;
+		CompileDrawPackets = rhs.CompileDrawPackets;
 		Name = std::move(rhs.Name);
+		m_drawOrder = std::move(rhs.m_drawOrder);
+		m_drawPackets = std::move(rhs.m_drawPackets);
+
+		// Our items must leave our BVH before it is replaced
+		RenderItems.clear();
+		m_bvh = std::move(rhs.m_bvh);
+		m_bvhSyncedInsertions = rhs.m_bvhSyncedInsertions;
+		RenderItems = std::move(rhs.RenderItems);
+		DetachDrawPackets();
 		return *this;
 	}
-	~RenderPassLayer() noexcept {}
+	~RenderPassLayer() noexcept
+	{
+		// Render items remove themselves from the BVH when destroyed, so they must go before the BVH does
+		RenderItems.clear();
+	}
 
 
 	inline void SetPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
@@ -46,29 +92,111 @@ public:
 		);
 	}
 
+	// O(1), but the last render item takes the removed item's place in the draw order (see StableVector::erase)
 	void RemoveRenderItem(RenderItem* ri)
 	{
 		if (ri != nullptr) LIKELY
 		{
-			for (unsigned int iii = 0; iii < RenderItems.size(); ++iii)
+			RenderItems.erase(ri);
+			m_drawPackets.Invalidate();
+		}
+	}
+
+	// Returns the item (with a world transform) whose world bounds are closest along the ray, or nullptr if nothing is
+	// hit. 'direction' must be normalized. Uses the layer's BVH if it has one (see Engine::MinItemsForBVHCulling), in
+	// which case the bounds are as of the most recent call to Engine::Render()
+	ND RenderItem* Pick(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float& distance)
+	{
+		if (m_bvh != nullptr)
+			return m_bvh->RayCast(origin, direction, distance);
+
+		RenderItem* closest = nullptr;
+		distance = FLT_MAX;
+		for (RenderItem& item : RenderItems)
+		{
+			float d = 0.0f;
+			if (item.HasWorldTransform() && item.ComputeWorldBounds(Meshes.get()).Intersects(origin, direction, d))
 			{
-				if (&RenderItems[iii] == ri) UNLIKELY
+				d = MathHelper::Max(d, 0.0f);
+				if (d < distance)
 				{
-					RenderItems.erase(RenderItems.begin() + iii);
-					break;
+					distance = d;
+					closest = &item;
 				}
 			}
 		}
+		return closest;
+	}
+
+	// Forces the layer's draw packets (see CompileDrawPackets) to be recompiled before the layer is next recorded. Adding,
+	// removing or replacing (move assigning) items and changing an item's submesh index are detected automatically, but
+	// this must be called after changing the number/order of an item's constant buffer views or descriptor tables, or
+	// after changing Meshes
+	inline void InvalidateDrawPackets() noexcept { m_drawPackets.Invalidate(); }
+
+	// Rebuilds the layer's BVH from scratch. Transform changes only refit the BVH, so it is worth calling this after
+	// many items have moved a long way
+	inline void RebuildBVH()
+	{
+		if (m_bvh != nullptr)
+			m_bvh->Rebuild();
+	}
+
+	// Returns the render items (by index) sorted by RenderItem::SortKey(). The previous frame's order is kept around and
+	// the keys are refreshed each call, so a full sort only happens when the order actually changes.
+	const std::vector<DrawSortKey>& GetDrawOrder()
+	{
+		// If items were added/removed, start over from the insertion order
+		if (m_drawOrder.size() != RenderItems.size())
+		{
+			m_drawOrder.resize(RenderItems.size());
+			for (unsigned int iii = 0; iii < m_drawOrder.size(); ++iii)
+				m_drawOrder[iii].ItemIndex = iii;
+		}
+
+		// Descriptor tables may be changed during Update, so the keys must be refreshed every frame
+		UINT perObjectRootParameterIndex = InstanceRenderItems ? Instancing.PerObjectRootParameterIndex : UINT_MAX;
+		for (DrawSortKey& dsk : m_drawOrder)
+			dsk.Key = RenderItems[dsk.ItemIndex].SortKey(perObjectRootParameterIndex);
+
+		auto compare = [](const DrawSortKey& lhs, const DrawSortKey& rhs) { return lhs.Key < rhs.Key; };
+		if (!std::is_sorted(m_drawOrder.begin(), m_drawOrder.end(), compare)) UNLIKELY
+			std::stable_sort(m_drawOrder.begin(), m_drawOrder.end(), compare);
+
+		return m_drawOrder;
 	}
 
 	// PreWork needs to return a bool: false -> signals early exit (i.e. do not make a Draw call for this layer)
-	std::function<bool(const RenderPassLayer&, ID3D12GraphicsCommandList*)> PreWork = [](const RenderPassLayer&, ID3D12GraphicsCommandList*) { return true; };
+	// PreWork is optional. When set, it is called once per frame on the main thread, and the layer is always recorded
+	// into that same command list. This means a layer with a PreWork is never recorded in parallel (see
+	// Engine::SetParallelRecording), because any state PreWork sets would not carry over to the worker command lists
+	std::function<bool(const RenderPassLayer&, ID3D12GraphicsCommandList*)> PreWork = nullptr;
 
-	std::vector<RenderItem> RenderItems;
+	// Render items are stored in pages that never move, so RenderItem pointers/references stay valid as items are added
+	utility::StableVector<RenderItem> RenderItems;
 	Microsoft::WRL::ComPtr<ID3D12PipelineState> PipelineState;
 	D3D12_PRIMITIVE_TOPOLOGY Topology;
 	std::shared_ptr<MeshGroup> Meshes; // shared_ptr because it is possible (if not likely) that different layers will want to reference the same mesh
 
+	// When true, the Engine draws the items in GetDrawOrder() order instead of insertion order. Leave this false for
+	// layers where draw order matters (i.e. blending)
+	bool SortRenderItems = false;
+
+	// When true, the Engine groups the items (see InstancingDesc) and issues one instanced draw per group. This implies
+	// sorting, so the same draw order caveats apply
+	bool InstanceRenderItems = false;
+	InstancingDesc Instancing;
+
+	// When true, items with a world transform (see RenderItem::SetWorldTransform) are tested against the camera passed to
+	// Engine::SetCullingCamera and are not drawn if they are outside of the frustum. Leave this false for layers whose
+	// shaders move geometry beyond its submesh bounds (i.e. displacement, tessellation, geometry shader expansion)
+	bool FrustumCull = false;
+
+	// When true, the Engine compiles the items into a DrawPacketStream and records the layer by replaying it. Worth it
+	// for large, mostly static layers. The draw order of a sorted layer is only captured when the stream is compiled,
+	// and instanced layers ignore this flag
+	bool CompileDrawPackets = false;
+
 	// Name (for debug/profiling purposes)
 	std::string Name = "Unnamed RenderPassLayer";
 
@@ -78,5 +206,25 @@ private:
 	RenderPassLayer& operator=(const RenderPassLayer&) noexcept = delete;
 
 	std::shared_ptr<DeviceResources> m_deviceResources;
+
+	std::vector<DrawSortKey> m_drawOrder;
+	DrawPacketStream m_drawPackets;
+
+	// Items point at the stream they were compiled into, which moves with the layer. They are re-attached the next
+	// time the stream is compiled
+	inline void DetachDrawPackets() noexcept
+	{
+		for (RenderItem& item : RenderItems)
+			item.m_drawPackets = nullptr;
+		m_drawPackets.Invalidate();
+	}
+
+	// Only created (by the Engine) once a FrustumCull layer reaches Engine::MinItemsForBVHCulling items. unique_ptr so
+	// that the items' pointers to it survive the layer being moved
+	// NOTE: Items record the layer's MeshGroup when they join the BVH, so do not change Meshes after that point
+	std::unique_ptr<BoundingVolumeHierarchy<RenderItem>> m_bvh = nullptr;
+	UINT64 m_bvhSyncedInsertions = 0; // RenderItems.InsertionCount() as of the last time new items were added to the BVH
+
+	friend class Engine;
 };
 }
\ No newline at end of file
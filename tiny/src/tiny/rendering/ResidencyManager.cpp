@@ -0,0 +1,195 @@
+#include "tiny-pch.h"
+#include "ResidencyManager.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+// Ledger ======================================================================================================
+// The tracker is shared by the main thread (LRU) and whichever thread creates or destroys a tracked resource (usage)
+struct ResidencyManager::Ledger
+{
+	Ledger() :
+		Tracker(static_cast<unsigned int>(MemoryCategory::Count))
+	{}
+
+	mutable std::mutex Mutex;
+	utility::ResidencyTracker Tracker;
+};
+
+// AllocationRecord ============================================================================================
+// Attached to every tracked resource as private data. D3D12 releases private data interfaces when the resource is
+// destroyed, which is what removes the resource from the usage
+class AllocationRecord final : public IUnknown
+{
+public:
+	AllocationRecord(std::shared_ptr<ResidencyManager::Ledger> ledger, MemoryCategory category, UINT64 byteSize) noexcept :
+		m_ledger(std::move(ledger)),
+		m_category(category),
+		m_byteSize(byteSize)
+	{
+		std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+		m_ledger->Tracker.AddAllocation(static_cast<unsigned int>(m_category), m_byteSize);
+	}
+	~AllocationRecord() noexcept
+	{
+		std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+		m_ledger->Tracker.RemoveAllocation(static_cast<unsigned int>(m_category), m_byteSize);
+	}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+	{
+		if (object == nullptr)
+			return E_POINTER;
+
+		if (riid == __uuidof(IUnknown))
+		{
+			*object = static_cast<IUnknown*>(this);
+			AddRef();
+			return S_OK;
+		}
+
+		*object = nullptr;
+		return E_NOINTERFACE;
+	}
+	ULONG STDMETHODCALLTYPE AddRef() override { return ++m_refCount; }
+	ULONG STDMETHODCALLTYPE Release() override
+	{
+		ULONG count = --m_refCount;
+		if (count == 0)
+			delete this;
+		return count;
+	}
+
+private:
+	std::atomic<ULONG> m_refCount = 1;
+	std::shared_ptr<ResidencyManager::Ledger> m_ledger;
+	MemoryCategory m_category;
+	UINT64 m_byteSize;
+};
+
+// {A3C41E7D-58B2-4F0A-8E6D-91B7C2D45F18}
+static constexpr GUID AllocationRecordGuid = { 0xa3c41e7d, 0x58b2, 0x4f0a, { 0x8e, 0x6d, 0x91, 0xb7, 0xc2, 0xd4, 0x5f, 0x18 } };
+
+
+// ResidencyManager ============================================================================================
+ResidencyManager::ResidencyManager(std::shared_ptr<DeviceResources> deviceResources) :
+	m_deviceResources(deviceResources),
+	m_ledger(std::make_shared<Ledger>())
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+}
+
+void ResidencyManager::Track(ID3D12Resource* resource, MemoryCategory category)
+{
+	TINY_CORE_ASSERT(resource != nullptr, "Cannot track a null resource");
+	TINY_CORE_ASSERT(category < MemoryCategory::Count, "Invalid memory category");
+
+	D3D12_RESOURCE_DESC desc = resource->GetDesc();
+	const UINT64 byteSize = m_deviceResources->GetDevice()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+
+	Microsoft::WRL::ComPtr<IUnknown> record;
+	record.Attach(new AllocationRecord(m_ledger, category, byteSize));
+	GFX_THROW_INFO(resource->SetPrivateDataInterface(AllocationRecordGuid, record.Get()));
+}
+
+ResidencyManager::Handle ResidencyManager::Register(UINT64 byteSize, std::function<void()> evict)
+{
+	TINY_CORE_ASSERT(evict != nullptr, "Evictable entries need an eviction callback");
+
+	Handle handle;
+	{
+		std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+		handle = m_ledger->Tracker.Register(byteSize);
+	}
+
+	if (handle >= m_evictCallbacks.size())
+		m_evictCallbacks.resize(static_cast<size_t>(handle) + 1);
+	m_evictCallbacks[handle] = std::move(evict);
+	return handle;
+}
+void ResidencyManager::Unregister(Handle handle) noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+		m_ledger->Tracker.Unregister(handle);
+	}
+	m_evictCallbacks[handle] = nullptr;
+}
+void ResidencyManager::SetEvictable(Handle handle, bool evictable, UINT64 frameNumber) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+	m_ledger->Tracker.SetEvictable(handle, evictable, frameNumber);
+}
+void ResidencyManager::Touch(Handle handle, UINT64 frameNumber) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+	m_ledger->Tracker.Touch(handle, frameNumber);
+}
+
+void ResidencyManager::EnforceBudget(UINT64 frameNumber, UINT64 bytesPendingDeletion)
+{
+	// Nothing is evicted until it has been idle for a while, so meshes that are drawn every few frames (or textures
+	// that are released and requested again right away) don't bounce in and out of memory
+	if (m_budgetInBytes == 0 || frameNumber < m_minIdleFrames)
+		return;
+
+	const UINT64 lastIdleFrame = frameNumber - m_minIdleFrames;
+
+	UINT64 residentBytes;
+	{
+		std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+		residentBytes = m_ledger->Tracker.GetTotalUsage().CurrentBytes;
+	}
+	residentBytes = residentBytes > bytesPendingDeletion ? residentBytes - bytesPendingDeletion : 0;
+
+	if (residentBytes <= m_budgetInBytes)
+		return;
+
+	PROFILE_FUNCTION();
+
+	while (residentBytes > m_budgetInBytes)
+	{
+		Handle victim;
+		UINT64 byteSize;
+		{
+			std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+			std::optional<Handle> lru = m_ledger->Tracker.LeastRecentlyUsed(lastIdleFrame);
+			if (!lru.has_value())
+				break;
+
+			victim = *lru;
+			byteSize = m_ledger->Tracker.GetByteSize(victim);
+
+			// Taken off the list before the owner is called, so the owner may unregister it
+			m_ledger->Tracker.SetEvictable(victim, false, frameNumber);
+		}
+
+		// The callback may register/unregister entries, so it is called without holding a reference into the vector
+		std::function<void()> evict = m_evictCallbacks[victim];
+		evict();
+
+		residentBytes -= MathHelper::Min(residentBytes, byteSize);
+		++m_evictions;
+		m_evictedBytes += byteSize;
+	}
+}
+
+ResidencyManager::Stats ResidencyManager::GetStats() const
+{
+	Stats stats;
+	stats.BudgetBytes = m_budgetInBytes;
+	stats.Evictions = m_evictions;
+	stats.EvictedBytes = m_evictedBytes;
+
+	std::lock_guard<std::mutex> lock(m_ledger->Mutex);
+	const utility::ResidencyTracker& tracker = m_ledger->Tracker;
+	for (unsigned int iii = 0; iii < tracker.CategoryCount(); ++iii)
+		stats.Categories[iii] = tracker.GetUsage(iii);
+	stats.Total = tracker.GetTotalUsage();
+	stats.EvictableBytes = tracker.EvictableBytes();
+	stats.EvictableCount = tracker.EvictableCount();
+	return stats;
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+#include "tiny/utils/ResidencyTracker.h"
+
+namespace tiny
+{
+enum class MemoryCategory : unsigned int
+{
+	Texture,		// Textures loaded by the TextureManager
+	TextureVector,
+	Mesh,			// MeshGroupT vertex/index buffers
+	DynamicMesh,	// DynamicMeshGroupT upload buffers
+	ConstantBuffer,	// UploadRing pages (where the data of every ConstantBufferT is written)
+	Upload,			// Staging pages and temporary upload buffers
+	Count
+};
+
+// ResidencyManager keeps track of how much GPU memory the Engine's resources use, and keeps that under a budget.
+//
+// Accounting: every resource passed to Track() is counted against its category until the resource is destroyed
+// (the same private data trick GpuMemoryAllocator uses to return placed blocks), so nothing needs to be released
+// explicitly, and resources waiting in Engine::DelayedDelete() are still counted.
+//
+// Budget: owners of memory that can be given back and recreated later (cached textures, meshes that keep a CPU copy
+// of their data) register an eviction callback. While an entry is evictable it sits on an LRU list (see
+// utility::ResidencyTracker). EnforceBudget() evicts the least recently used entries, as long as they have been idle
+// for at least MinIdleFrames, until the memory that is not already waiting to be deleted fits in the budget. The
+// owner recreates its data (and makes the entry evictable again) the next time it is used.
+//
+// Track() is thread safe. Everything else must only be called on the main thread
+class ResidencyManager
+{
+public:
+	using Handle = utility::ResidencyTracker::Handle;
+	static constexpr Handle InvalidHandle = utility::ResidencyTracker::InvalidHandle;
+
+	struct Stats
+	{
+		std::array<utility::ResidencyTracker::Usage, static_cast<size_t>(MemoryCategory::Count)> Categories = {};
+		utility::ResidencyTracker::Usage Total;
+		UINT64 BudgetBytes = 0;			// 0 means there is no budget
+		UINT64 EvictableBytes = 0;		// Memory that could be evicted right now (ignoring how recently it was used)
+		unsigned int EvictableCount = 0;
+		unsigned int Evictions = 0;		// Totals since startup
+		UINT64 EvictedBytes = 0;
+
+		ND inline const utility::ResidencyTracker::Usage& operator[](MemoryCategory category) const noexcept { return Categories[static_cast<size_t>(category)]; }
+	};
+
+	static constexpr UINT64 DefaultMinIdleFrames = 30;
+
+	ResidencyManager(std::shared_ptr<DeviceResources> deviceResources);
+
+	// Thread safe
+	void Track(ID3D12Resource* resource, MemoryCategory category);
+
+	// 'evict' must release the memory (i.e. via Engine::DelayedDelete()). By the time it is called, the entry is no
+	// longer evictable
+	ND Handle Register(UINT64 byteSize, std::function<void()> evict);
+	void Unregister(Handle handle) noexcept;
+	void SetEvictable(Handle handle, bool evictable, UINT64 frameNumber) noexcept;
+	void Touch(Handle handle, UINT64 frameNumber) noexcept;
+
+	// 'bytesPendingDeletion' is memory that has already been released but is still counted because the GPU may be
+	// using it (see Engine::DeletionStats)
+	void EnforceBudget(UINT64 frameNumber, UINT64 bytesPendingDeletion);
+
+	inline void SetBudget(UINT64 bytes) noexcept { m_budgetInBytes = bytes; }
+	ND inline UINT64 GetBudget() const noexcept { return m_budgetInBytes; }
+	inline void SetMinIdleFrames(UINT64 frames) noexcept { m_minIdleFrames = frames; }
+	ND inline UINT64 GetMinIdleFrames() const noexcept { return m_minIdleFrames; }
+	ND Stats GetStats() const;
+
+	struct Ledger; // Defined in the .cpp
+
+private:
+	ResidencyManager(const ResidencyManager&) = delete;
+	ResidencyManager& operator=(const ResidencyManager&) = delete;
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+
+	// Shared with the record attached to every tracked resource, so resources may outlive the manager
+	std::shared_ptr<Ledger> m_ledger;
+
+	std::vector<std::function<void()>> m_evictCallbacks; // Indexed by handle
+	UINT64 m_budgetInBytes = 0;
+	UINT64 m_minIdleFrames = DefaultMinIdleFrames;
+	unsigned int m_evictions = 0;
+	UINT64 m_evictedBytes = 0;
+};
+}
@@ -0,0 +1,210 @@
+#include "tiny-pch.h"
+#include "StagingUploader.h"
+#include "tiny/Engine.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+StagingUploader::StagingUploader(std::shared_ptr<DeviceResources> deviceResources, Microsoft::WRL::ComPtr<ID3D12Fence> fence, UINT64 pageSize) :
+	m_deviceResources(deviceResources),
+	m_fence(fence),
+	m_pageSize(pageSize)
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+	TINY_CORE_ASSERT(m_fence != nullptr, "No fence");
+	TINY_CORE_ASSERT(m_pageSize > 0, "Page size must be greater than 0");
+}
+StagingUploader::~StagingUploader() noexcept
+{
+	// Pages are persistently mapped, so unmap them before the resources are released
+	for (Page& page : m_pages)
+	{
+		if (page.Resource != nullptr)
+			page.Resource->Unmap(0, nullptr);
+	}
+}
+
+bool StagingUploader::IsReusable(const Page& page, UINT64 completedFenceValue) const noexcept
+{
+	return page.PendingCopies == 0 && !page.Recorded && page.FenceValue <= completedFenceValue;
+}
+
+size_t StagingUploader::AcquirePage(UINT64 byteSize)
+{
+	// Reuse a page the GPU is done with, if one is large enough
+	UINT64 completedFenceValue = m_fence->GetCompletedValue();
+	for (size_t iii = 0; iii < m_pages.size(); ++iii)
+	{
+		Page& page = m_pages[iii];
+		if (page.Size >= byteSize && IsReusable(page, completedFenceValue))
+		{
+			page.Offset = 0;
+			page.Destinations.clear();
+			return iii;
+		}
+	}
+
+	PROFILE_FUNCTION();
+
+	// Otherwise create a new one (oversized uploads get a page of their own)
+	Page& page = m_pages.emplace_back();
+	page.Size = MathHelper::Max(m_pageSize, byteSize);
+
+	auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto desc = CD3DX12_RESOURCE_DESC::Buffer(page.Size);
+	GFX_THROW_INFO(
+		m_deviceResources->GetDevice()->CreateCommittedResource(
+			&props,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&page.Resource)
+		)
+	);
+
+	// Never unmapped until the uploader is destroyed. Writes only ever go to pages the GPU is not reading from
+	GFX_THROW_INFO(
+		page.Resource->Map(0, nullptr, reinterpret_cast<void**>(&page.CPU))
+	);
+
+	Engine::TrackResource(page.Resource.Get(), MemoryCategory::Upload);
+
+	m_capacityInBytes += page.Size;
+	++m_stats.PagesCreated;
+
+	return m_pages.size() - 1;
+}
+StagingUploader::StagingAllocation StagingUploader::Allocate(UINT64 byteSize, UINT64 alignment)
+{
+	TINY_CORE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of 2");
+
+	// Page resources are 64KB aligned, so an offset of 0 satisfies any alignment
+	if (m_pages.empty() || ((m_pages[m_currentPage].Offset + alignment - 1) & ~(alignment - 1)) + byteSize > m_pages[m_currentPage].Size)
+		m_currentPage = AcquirePage(byteSize);
+
+	Page& page = m_pages[m_currentPage];
+	UINT64 offset = (page.Offset + alignment - 1) & ~(alignment - 1);
+	page.Offset = offset + byteSize;
+	++page.PendingCopies;
+
+	return { m_currentPage, offset };
+}
+
+void StagingUploader::StageBuffer(Microsoft::WRL::ComPtr<ID3D12Resource> destination, UINT64 destinationOffset, const void* data, UINT64 byteSize)
+{
+	TINY_CORE_ASSERT(destination != nullptr, "No destination resource");
+	TINY_CORE_ASSERT(data != nullptr, "No data to upload");
+	TINY_CORE_ASSERT(byteSize > 0, "Cannot upload 0 bytes");
+
+	// Keep copies 16 byte aligned within a page
+	StagingAllocation allocation = Allocate(byteSize, 16);
+	memcpy(m_pages[allocation.PageIndex].CPU + allocation.Offset, data, byteSize);
+
+	PendingCopy& copy = m_pendingCopies.emplace_back();
+	copy.Destination = std::move(destination);
+	copy.PageIndex = allocation.PageIndex;
+	copy.ByteSize = byteSize;
+	copy.DestinationOffset = destinationOffset;
+	copy.SourceOffset = allocation.Offset;
+}
+void StagingUploader::StageTexture(Microsoft::WRL::ComPtr<ID3D12Resource> destination, const D3D12_SUBRESOURCE_DATA* subresources, UINT firstSubresource, UINT subresourceCount)
+{
+	TINY_CORE_ASSERT(destination != nullptr, "No destination resource");
+	TINY_CORE_ASSERT(subresources != nullptr, "No data to upload");
+	TINY_CORE_ASSERT(subresourceCount > 0, "Cannot upload 0 subresources");
+
+	// Lay the subresources out the way the copy engine expects them (each row padded to the row pitch alignment)
+	const size_t firstFootprint = m_footprints.size();
+	m_footprints.resize(firstFootprint + subresourceCount);
+	m_numRows.resize(subresourceCount);
+	m_rowSizes.resize(subresourceCount);
+
+	D3D12_RESOURCE_DESC desc = destination->GetDesc();
+	UINT64 byteSize = 0;
+	m_deviceResources->GetDevice()->GetCopyableFootprints(&desc, firstSubresource, subresourceCount, 0,
+		&m_footprints[firstFootprint], m_numRows.data(), m_rowSizes.data(), &byteSize);
+
+	StagingAllocation allocation = Allocate(byteSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	BYTE* base = m_pages[allocation.PageIndex].CPU + allocation.Offset;
+
+	for (UINT iii = 0; iii < subresourceCount; ++iii)
+	{
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = m_footprints[firstFootprint + iii];
+		D3D12_MEMCPY_DEST dest = { base + footprint.Offset, footprint.Footprint.RowPitch, static_cast<SIZE_T>(footprint.Footprint.RowPitch) * m_numRows[iii] };
+		MemcpySubresource(&dest, &subresources[iii], static_cast<SIZE_T>(m_rowSizes[iii]), m_numRows[iii], footprint.Footprint.Depth);
+
+		// Make the footprint relative to the start of the page so it can be used directly when recording
+		footprint.Offset += allocation.Offset;
+	}
+
+	PendingCopy& copy = m_pendingCopies.emplace_back();
+	copy.Destination = std::move(destination);
+	copy.PageIndex = allocation.PageIndex;
+	copy.ByteSize = byteSize;
+	copy.FirstSubresource = firstSubresource;
+	copy.SubresourceCount = subresourceCount;
+	copy.FirstFootprint = firstFootprint;
+}
+
+void StagingUploader::RecordPendingCopies(ID3D12GraphicsCommandList* commandList)
+{
+	if (m_pendingCopies.empty())
+		return;
+
+	PROFILE_FUNCTION();
+
+	// Drop the destination references held by pages the GPU has finished with
+	UINT64 completedFenceValue = m_fence->GetCompletedValue();
+	for (Page& page : m_pages)
+	{
+		if (IsReusable(page, completedFenceValue))
+			page.Destinations.clear();
+	}
+
+	for (PendingCopy& copy : m_pendingCopies)
+	{
+		Page& page = m_pages[copy.PageIndex];
+
+		if (copy.SubresourceCount == 0)
+		{
+			GFX_THROW_INFO_ONLY(
+				commandList->CopyBufferRegion(copy.Destination.Get(), copy.DestinationOffset, page.Resource.Get(), copy.SourceOffset, copy.ByteSize)
+			);
+			++m_stats.CopiesRecorded;
+		}
+		else
+		{
+			for (UINT iii = 0; iii < copy.SubresourceCount; ++iii)
+			{
+				CD3DX12_TEXTURE_COPY_LOCATION dest(copy.Destination.Get(), copy.FirstSubresource + iii);
+				CD3DX12_TEXTURE_COPY_LOCATION source(page.Resource.Get(), m_footprints[copy.FirstFootprint + iii]);
+				GFX_THROW_INFO_ONLY(commandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr));
+			}
+			m_stats.CopiesRecorded += copy.SubresourceCount;
+		}
+
+		--page.PendingCopies;
+		page.Recorded = true;
+		page.Destinations.push_back(std::move(copy.Destination));
+		m_stats.BytesUploaded += copy.ByteSize;
+	}
+
+	m_pendingCopies.clear();
+	m_footprints.clear();
+}
+
+void StagingUploader::OnSubmitted(UINT64 fenceValue) noexcept
+{
+	for (Page& page : m_pages)
+	{
+		if (page.Recorded)
+		{
+			page.FenceValue = fenceValue;
+			page.Recorded = false;
+		}
+	}
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+
+namespace tiny
+{
+// StagingUploader batches CPU -> DEFAULT heap copies for the copy queue. Stage*() copies the data into a large,
+// persistently mapped UPLOAD page right away and remembers the copy. RecordPendingCopies() then records every pending
+// copy into a single command list.
+//
+// No barriers are recorded. Destinations must be in the COMMON state: the copy queue implicitly promotes them to
+// COPY_DEST and they decay back to COMMON once the submission completes, after which the direct queue can implicitly
+// promote them to a read state.
+//
+// Pages are reused in place (instead of being destroyed and recreated) once the GPU has finished with them. A page
+// remembers the fence value of the last submission that read from it, and a page that still has copies waiting to
+// be recorded or submitted is never reused.
+class StagingUploader
+{
+public:
+	// Counters since the last call to ResetFrameStats() (i.e. for the current frame when owned by the Engine)
+	struct Stats
+	{
+		UINT64 BytesUploaded = 0;		// Bytes recorded to be copied to the GPU
+		unsigned int CopiesRecorded = 0;	// Buffer copies plus texture subresource copies
+		unsigned int PagesCreated = 0;
+	};
+
+	static constexpr UINT64 DefaultPageSize = 4 * 1024 * 1024; // 4MB
+
+	// 'fence' is the fence signaled by the queue the copies are submitted to
+	StagingUploader(std::shared_ptr<DeviceResources> deviceResources, Microsoft::WRL::ComPtr<ID3D12Fence> fence, UINT64 pageSize = DefaultPageSize);
+	~StagingUploader() noexcept;
+
+	void StageBuffer(Microsoft::WRL::ComPtr<ID3D12Resource> destination, UINT64 destinationOffset, const void* data, UINT64 byteSize);
+	void StageTexture(Microsoft::WRL::ComPtr<ID3D12Resource> destination, const D3D12_SUBRESOURCE_DATA* subresources, UINT firstSubresource, UINT subresourceCount);
+
+	// The command list must be submitted before the next call to OnSubmitted()
+	void RecordPendingCopies(ID3D12GraphicsCommandList* commandList);
+	// Call once the command list passed to RecordPendingCopies() has been submitted and 'fenceValue' has been signaled
+	void OnSubmitted(UINT64 fenceValue) noexcept;
+
+	ND inline bool HasPendingCopies() const noexcept { return !m_pendingCopies.empty(); }
+	ND inline const Stats& GetStats() const noexcept { return m_stats; }
+	inline void ResetFrameStats() noexcept { m_stats = {}; }
+	ND inline UINT64 CapacityInBytes() const noexcept { return m_capacityInBytes; }
+	ND inline unsigned int PageCount() const noexcept { return static_cast<unsigned int>(m_pages.size()); }
+
+private:
+	StagingUploader(const StagingUploader&) = delete;
+	StagingUploader& operator=(const StagingUploader&) = delete;
+
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource = nullptr;
+		BYTE* CPU = nullptr;
+		UINT64 Size = 0;
+		UINT64 Offset = 0;
+		UINT64 FenceValue = 0;			// Last submission that read from the page
+		unsigned int PendingCopies = 0;	// Copies staged in the page that have not been recorded yet
+		bool Recorded = false;			// Copies have been recorded, but the command list has not been submitted yet
+
+		// Destinations of the copies read from this page. They are held until the GPU is done with the page, so a
+		// destination released by its owner right after staging stays alive until its copy has executed
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> Destinations;
+	};
+	struct PendingCopy
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Destination = nullptr;
+		size_t PageIndex = 0;
+		UINT64 ByteSize = 0;
+
+		// Buffers
+		UINT64 DestinationOffset = 0;
+		UINT64 SourceOffset = 0;
+
+		// Textures (SubresourceCount is 0 for buffers). Footprints live in m_footprints and already include the
+		// offset into the page
+		UINT FirstSubresource = 0;
+		UINT SubresourceCount = 0;
+		size_t FirstFootprint = 0;
+	};
+	struct StagingAllocation
+	{
+		size_t PageIndex = 0;
+		UINT64 Offset = 0;
+	};
+
+	ND StagingAllocation Allocate(UINT64 byteSize, UINT64 alignment);
+	ND size_t AcquirePage(UINT64 byteSize);
+	ND bool IsReusable(const Page& page, UINT64 completedFenceValue) const noexcept;
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+	UINT64 m_pageSize;
+	UINT64 m_capacityInBytes = 0;
+
+	std::vector<Page> m_pages;
+	size_t m_currentPage = 0; // Only valid if m_pages is not empty
+	std::vector<PendingCopy> m_pendingCopies;
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> m_footprints;
+
+	// Scratch space reused by StageTexture()
+	std::vector<UINT> m_numRows;
+	std::vector<UINT64> m_rowSizes;
+
+	Stats m_stats;
+};
+}
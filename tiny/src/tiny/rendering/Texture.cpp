@@ -3,6 +3,12 @@
 #include "tiny/utils/StringHelper.h"
 #include "tiny/utils/ConstexprMap.h"
 #include "tiny/Engine.h"
+#include "tiny/utils/Profile.h"
+#include "tiny/utils/Hash.h"
+#include "tiny/utils/BlockCompression.h"
+
+#include <charconv>
+#include <fstream>
 
 namespace tiny
 {
@@ -28,63 +34,103 @@ Texture::~Texture() noexcept
 	// If the texture has been moved from, then we don't want to clean up what it was referencing
 	if (!m_movedFrom)
 	{
-		// NOTE: Only do a delayed delete if the texture is NOT managed. If it is managed
-		//       then the texture manager will be responsible for clean up
-		if (m_isManagedTexture)
-		{
-			TextureManager::ReleaseTexture(m_indexIntoAllManagedTextures);
-		}
-		else
+		// NOTE: Only do a delayed delete if the texture is NOT managed. If it is managed then the texture manager
+		//       owns the Texture and has already released its resource (see TextureManager::Evict())
+		if (!m_isManagedTexture)
 		{
 			Engine::DelayedDelete(m_resource);
 		}
 	}
 }
 
-void Texture::CopyData(const std::vector<float>& data)
+void Texture::CopyData(const std::vector<float>& data, mips::Filter filter)
 {
 	TINY_CORE_ASSERT(m_currentResourceState == D3D12_RESOURCE_STATE_COPY_DEST, "Texure must be placed in state 'D3D12_RESOURCE_STATE_COPY_DEST' before you can copy data to it");
 
 	D3D12_RESOURCE_DESC desc = m_resource->GetDesc();
-	const UINT num2DSubresources = desc.DepthOrArraySize * desc.MipLevels;
-	const UINT64 uploadBufferSize = GetRequiredIntermediateSize(m_resource.Get(), 0, num2DSubresources);
-
-	Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer = nullptr;
-
-	CD3DX12_HEAP_PROPERTIES props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	CD3DX12_RESOURCE_DESC uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
-	GFX_THROW_INFO(
-		m_deviceResources->GetDevice()->CreateCommittedResource(
-			&props,
-			D3D12_HEAP_FLAG_NONE,
-			&uploadDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&uploadBuffer)
-		)
-	);
+	TINY_CORE_ASSERT(data.size() >= desc.Width * desc.Height, "Not enough data for mip 0");
 
 	D3D12_SUBRESOURCE_DATA subResourceData = {}; 
 	subResourceData.pData = data.data(); 
 	subResourceData.RowPitch = desc.Width * sizeof(float); 
 	subResourceData.SlicePitch = subResourceData.RowPitch * desc.Height; 
 
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources = { subResourceData };
+	std::vector<mips::Level> levels;
+	if (desc.MipLevels > 1)
+	{
+		TINY_CORE_ASSERT(desc.Format == DXGI_FORMAT_R32_FLOAT && desc.DepthOrArraySize == 1, "CopyData() can only generate mips for R32_FLOAT textures with a single array slice");
+
+		levels = mips::Generate(desc.Format, data.data(), static_cast<uint32_t>(desc.Width), desc.Height, subResourceData.RowPitch, filter, desc.MipLevels);
+		for (size_t iii = 1; iii < levels.size(); ++iii)
+			subresources.push_back({ levels[iii].Data.data(), static_cast<LONG_PTR>(levels[iii].RowPitch), static_cast<LONG_PTR>(levels[iii].Data.size()) });
+	}
+
+	const UINT num2DSubresources = static_cast<UINT>(subresources.size());
+	const UINT64 uploadBufferSize = GetRequiredIntermediateSize(m_resource.Get(), 0, num2DSubresources);
+
+	CD3DX12_RESOURCE_DESC uploadDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
+	Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer = Engine::CreateResource(MemoryCategory::Upload, D3D12_HEAP_TYPE_UPLOAD, uploadDesc, D3D12_RESOURCE_STATE_GENERIC_READ);
 
 	auto* commandList = m_deviceResources->GetCommandList();
 	GFX_THROW_INFO_ONLY(
-		UpdateSubresources(commandList, m_resource.Get(), uploadBuffer.Get(), 0, 0, num2DSubresources, &subResourceData)
+		UpdateSubresources(commandList, m_resource.Get(), uploadBuffer.Get(), 0, 0, num2DSubresources, subresources.data())
 	);
 	Engine::DelayedDelete(uploadBuffer);
 }
 void Texture::TransitionToState(D3D12_RESOURCE_STATES newState)
 {
+	TransitionToState(newState, m_deviceResources->GetCommandList());
+}
+void Texture::TransitionToState(D3D12_RESOURCE_STATES newState, ID3D12GraphicsCommandList* commandList)
+{
+	// NOTE: During Engine::Render(), the frame may be spread over several command lists, so any transition made from a
+	//       PreWork/PostWork method must be recorded into the command list that was passed to that method
 	if (m_currentResourceState != newState) LIKELY
 	{
 		CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(m_resource.Get(), m_currentResourceState, newState);
-		GFX_THROW_INFO_ONLY(m_deviceResources->GetCommandList()->ResourceBarrier(1, &transition));
+		GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(1, &transition));
 		m_currentResourceState = newState;
 	}
 }
+void Texture::GenerateMips()
+{
+	GenerateMips(m_deviceResources->GetCommandList());
+}
+void Texture::GenerateMips(ID3D12GraphicsCommandList* commandList)
+{
+	const D3D12_RESOURCE_DESC desc = m_resource->GetDesc();
+	if (desc.MipLevels <= 1)
+		return;
+
+	TINY_CORE_ASSERT(Engine::SupportsGPUMipGeneration(desc.Format), "The device cannot generate mips for this format on the GPU (see MipGenerator)");
+
+	if (m_mipUAVDescriptorIndices.empty())
+	{
+		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		uavDesc.Format = desc.Format;
+		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+
+		for (UINT mip = 0; mip < desc.MipLevels; ++mip)
+		{
+			uavDesc.Texture2D.MipSlice = mip;
+			m_mipUAVDescriptorIndices.push_back(DescriptorManager::EmplaceBackUnorderedAccessView(m_resource.Get(), &uavDesc));
+		}
+	}
+
+	// If mip 0 was just written through a UAV (i.e. by a compute shader), those writes have to finish before the
+	// generator reads them. Otherwise the transition takes care of that
+	if (m_currentResourceState == D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+	{
+		CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::UAV(m_resource.Get());
+		GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(1, &barrier));
+	}
+	else
+	{
+		TransitionToState(D3D12_RESOURCE_STATE_UNORDERED_ACCESS, commandList);
+	}
+	Engine::GenerateMips(commandList, m_resource.Get(), m_mipUAVDescriptorIndices);
+}
 
 
 // TextureVector ================================================================================================
@@ -97,20 +143,7 @@ Texture* TextureVector::EmplaceBack(const D3D12_RESOURCE_DESC& desc, bool create
 {
 	TINY_CORE_ASSERT(createSRV || createUAV, "It is an error not to create at least one view for the Texture");
 
-	CD3DX12_HEAP_PROPERTIES props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-
-	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
-
-	GFX_THROW_INFO(
-		m_deviceResources->GetDevice()->CreateCommittedResource(
-			&props,
-			D3D12_HEAP_FLAG_NONE,
-			&desc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(&resource)
-		)
-	);
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = Engine::CreateResource(MemoryCategory::TextureVector, D3D12_HEAP_TYPE_DEFAULT, desc, D3D12_RESOURCE_STATE_COMMON);
 
 	unsigned int srvIndex = 0;
 	unsigned int uavIndex = 0;
@@ -123,7 +156,7 @@ Texture* TextureVector::EmplaceBack(const D3D12_RESOURCE_DESC& desc, bool create
 		srvDesc.Format = desc.Format; 
 		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; 
 		srvDesc.Texture2D.MostDetailedMip = 0; 
-		srvDesc.Texture2D.MipLevels = 1; 
+		srvDesc.Texture2D.MipLevels = -1; // All of them
 
 		srvIndex = DescriptorManager::EmplaceBackShaderResourceView(resource.Get(), &srvDesc);
 	}
@@ -143,6 +176,80 @@ Texture* TextureVector::EmplaceBack(const D3D12_RESOURCE_DESC& desc, bool create
 	m_textures.push_back(std::move(t));
 	return m_textures.back().get();
 }
+Texture* TextureVector::EmplaceBackFromPixels(DXGI_FORMAT format, UINT width, UINT height, const void* pixels, size_t rowPitch, const ImportOptions& options)
+{
+	PROFILE_FUNCTION();
+
+	const bool compress = options.Compression != DXGI_FORMAT_UNKNOWN;
+	TINY_CORE_ASSERT(mips::IsSupported(format), "Format is not supported by mips::Generate()");
+	TINY_CORE_ASSERT(!compress || bc::IsSupported(options.Compression), "Compression must be BC1, BC4 or BC5");
+	TINY_CORE_ASSERT(!compress || format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, "Block compression needs R8G8B8A8 pixels");
+	TINY_CORE_ASSERT(!compress || (width % 4 == 0 && height % 4 == 0), "The size of a block compressed texture must be a multiple of 4");
+
+	std::vector<mips::Level> levels = mips::Generate(format, pixels, width, height, rowPitch, options.MipFilter, options.GenerateMips ? 0 : 1);
+	TINY_CORE_ASSERT(levels.size() > 0, "Failed to read the pixels");
+
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources(levels.size());
+	std::vector<std::vector<uint8_t>> blocks;
+	if (compress)
+	{
+		PROFILE_SCOPE("Block compression");
+
+		// Block rows don't depend on each other, so the mips are split into chunks of rows, and every chunk of every
+		// mip is compressed in parallel (mip 0 alone is 3/4 of the work)
+		static constexpr uint32_t BlockRowsPerChunk = 8;
+		struct Chunk
+		{
+			size_t Level;
+			uint32_t FirstBlockRow;
+		};
+		std::vector<Chunk> chunks;
+
+		blocks.resize(levels.size());
+		for (size_t iii = 0; iii < levels.size(); ++iii)
+		{
+			const uint32_t blockRows = bc::BlockCount(levels[iii].Height);
+			const size_t blockRowPitch = bc::RowPitch(options.Compression, levels[iii].Width);
+			blocks[iii].resize(blockRowPitch * blockRows);
+			subresources[iii] = { blocks[iii].data(), static_cast<LONG_PTR>(blockRowPitch), static_cast<LONG_PTR>(blocks[iii].size()) };
+
+			for (uint32_t row = 0; row < blockRows; row += BlockRowsPerChunk)
+				chunks.push_back({ iii, row });
+		}
+
+		concurrency::parallel_for(size_t(0), chunks.size(), [&](size_t index)
+			{
+				const Chunk& chunk = chunks[index];
+				const mips::Level& level = levels[chunk.Level];
+				bc::CompressBlockRows(options.Compression, level.Data.data(), level.Width, level.Height, level.RowPitch,
+									  blocks[chunk.Level].data(), static_cast<size_t>(subresources[chunk.Level].RowPitch), chunk.FirstBlockRow, BlockRowsPerChunk);
+			});
+	}
+	else
+	{
+		for (size_t iii = 0; iii < levels.size(); ++iii)
+			subresources[iii] = { levels[iii].Data.data(), static_cast<LONG_PTR>(levels[iii].RowPitch), static_cast<LONG_PTR>(levels[iii].Data.size()) };
+	}
+
+	const DXGI_FORMAT resourceFormat = compress ? options.Compression : format;
+	CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(resourceFormat, width, height, 1, static_cast<UINT16>(levels.size()));
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource = Engine::CreateResource(MemoryCategory::TextureVector, D3D12_HEAP_TYPE_DEFAULT, desc, D3D12_RESOURCE_STATE_COMMON);
+
+	// The data is copied into the staging pages right away. The texture is uploaded on the copy queue, stays in the
+	// COMMON state and is implicitly promoted when it is first read
+	Engine::StageTextureUpload(resource, subresources.data(), static_cast<UINT>(subresources.size()));
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = resourceFormat;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = static_cast<UINT>(levels.size());
+	const unsigned int srvIndex = DescriptorManager::EmplaceBackShaderResourceView(resource.Get(), &srvDesc);
+
+	m_textures.push_back(std::unique_ptr<Texture>(new Texture(m_deviceResources, resource, srvIndex)));
+	return m_textures.back().get();
+}
 
 
 
@@ -165,9 +272,9 @@ Texture* TextureVector::EmplaceBack(const D3D12_RESOURCE_DESC& desc, bool create
 
 
 // TextureManager ===========================================================================
-void TextureManager::InitImpl(std::shared_ptr<DeviceResources> deviceResources) noexcept
+void TextureManager::InitImpl(std::shared_ptr<DeviceResources> deviceResources, const std::filesystem::path& contentIndexFile) noexcept
 {
-	TINY_CORE_ASSERT(!m_initialized, "TextureManager has already been initialized");
+	TINY_CORE_ASSERT(deviceResources != nullptr, "No device resources");
 
 	m_deviceResources = deviceResources;
 
@@ -179,76 +286,684 @@ void TextureManager::InitImpl(std::shared_ptr<DeviceResources> deviceResources)
 	for (unsigned int iii = 0; iii < count; ++iii)
 		m_allTextures.emplace_back();
 
+	m_contentIndexFile = contentIndexFile;
+	if (!m_contentIndexFile.empty())
+		LoadContentIndex();
+
 	// Set Initialized flag
 	m_initialized = true;
 }
 
-Texture* TextureManager::GetTextureImpl(unsigned int indexIntoAllTextures)
+Texture* TextureManager::GetTextureImpl(unsigned int indexIntoAllTextures, int priority)
 {
 	TINY_CORE_ASSERT(m_initialized, "Cannot call TextureManager::GetTextureImpl before calling TextureManager::Init");
 	TINY_CORE_ASSERT(indexIntoAllTextures < GetTotalTextureCount(), "Texture does not exist for this index");
 
-	// Only read the texture from file if the ref count is 0
-	if (m_allTextures[indexIntoAllTextures].refCount == 0)
+	TextureInstanceData& data = m_allTextures[indexIntoAllTextures];
+
+	// Only read the texture from file if it is not already resident or on its way
+	if (data.state == State::Unloaded)
+	{
+		TINY_CORE_ASSERT(data.texture == nullptr, "Texture was not nullptr, but the texture is not loaded");
+		TINY_CORE_ASSERT(data.refCount == 0, "Texture is not loaded, but the ref count was not 0");
+
+		if (m_placeholder == nullptr)
+		{
+			LoadImmediately(indexIntoAllTextures);
+		}
+		else
+		{
+			// Hand out a Texture whose SRV slot holds a copy of the placeholder's SRV until the real data is resident
+			unsigned int srvIndex = DescriptorManager::EmplaceBackCopy(m_placeholder->m_srvDescriptorIndex);
+			data.texture = std::unique_ptr<Texture>(new Texture(m_deviceResources, m_placeholder->m_resource, srvIndex, 0, indexIntoAllTextures, true));
+			data.ownsSRV = true;
+			data.state = State::Queued;
+			data.priority = priority;
+
+			m_queuedLoads.push_back({ priority, m_requestCounter++, indexIntoAllTextures });
+			std::push_heap(m_queuedLoads.begin(), m_queuedLoads.end());
+			++m_stats.PendingLoads;
+		}
+	}
+	else
+	{
+		TINY_CORE_ASSERT(data.texture != nullptr, "Texture should have already been created");
+
+		// A cached texture is handed out again without reloading it
+		if (data.refCount == 0 && data.state == State::Resident)
+		{
+			ReferenceContent(data.contentHash);
+			++m_stats.CacheHits;
+		}
+
+		// A queued request that becomes more urgent is queued again (the stale entry is skipped when it is popped)
+		if (data.state == State::Queued && priority > data.priority)
+		{
+			data.priority = priority;
+			m_queuedLoads.push_back({ priority, m_requestCounter++, indexIntoAllTextures });
+			std::push_heap(m_queuedLoads.begin(), m_queuedLoads.end());
+		}
+	}
+
+	++data.refCount;
+	return data.texture.get();
+}
+
+void TextureManager::ReleaseTextureImpl(unsigned int indexIntoAllTextures) noexcept
+{
+	TINY_CORE_ASSERT(m_initialized, "Cannot call TextureManager::ReleaseTextureImpl before calling TextureManager::Init");
+	TINY_CORE_ASSERT(m_allTextures[indexIntoAllTextures].refCount > 0, "Should not be calling ReleaseTexture for a Texture that already has a ref count of 0");
+
+	TextureInstanceData& data = m_allTextures[indexIntoAllTextures];
+	if (--data.refCount > 0)
+		return;
+
+	switch (data.state)
 	{
-		TINY_CORE_ASSERT(m_allTextures[indexIntoAllTextures].texture == nullptr, "Texture was not nullptr, but ref count was 0");
+	case State::Queued:
+		// Nothing has been read yet, so just drop the request (its entry in the queue is skipped when it is popped)
+		DestroyTexture(data);
+		data.state = State::Unloaded;
+		--m_stats.PendingLoads;
+		break;
+
+	case State::Resident:
+		// Keep the texture around in case it is requested again, unless that puts us over budget
+		data.releasedAt = ++m_releaseCounter;
+		UnreferenceContent(data.contentHash);
+		EnforceBudget();
+		break;
+
+	default:
+		// Loading/Uploading: the work is already under way, so the texture is cached once it is resident
+		break;
+	}
+}
 
-		Microsoft::WRL::ComPtr<ID3D12Resource> textureResource = nullptr;
-		Microsoft::WRL::ComPtr<ID3D12Resource> uploadHeap = nullptr;
+void TextureManager::EnableStreamingImpl(unsigned int placeholderIndex)
+{
+	TINY_CORE_ASSERT(m_initialized, "Cannot call TextureManager::EnableStreaming before calling TextureManager::Init");
+	TINY_CORE_ASSERT(m_placeholder == nullptr, "Streaming has already been enabled");
 
-		// Load the texture from file
-		GFX_THROW_INFO(
-			DirectX::CreateDDSTextureFromFile12(
-				m_deviceResources->GetDevice(),
-				m_deviceResources->GetCommandList(),
-				GetTextureFilename(indexIntoAllTextures).c_str(),
-				textureResource,
-				uploadHeap
-			)
-		);
+	// Loaded before streaming is enabled so it is resident right away. The reference is never released, so the
+	// placeholder is never evicted
+	m_placeholder = GetTextureImpl(placeholderIndex, 0);
+}
 
-		// Do a delayed delete on the upload heap
-		Engine::DelayedDelete(uploadHeap);
+void TextureManager::PreloadAll()
+{
+	std::vector<unsigned int> indices(Get().m_allTextures.size());
+	for (unsigned int iii = 0; iii < indices.size(); ++iii)
+		indices[iii] = iii;
 
-		// Create the SRV descriptor for the texture
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Format = textureResource->GetDesc().Format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = -1;
+	Get().PreloadImpl(indices);
+}
+
+void TextureManager::PreloadImpl(std::span<const unsigned int> indicesIntoAllTextures)
+{
+	TINY_CORE_ASSERT(m_initialized, "Cannot call TextureManager::Preload before calling TextureManager::Init");
+
+	PROFILE_FUNCTION();
+
+	// Marking the textures as loading means duplicate indices are skipped, and DispatchLoads() skips the queue entries
+	// of streaming requests that are loaded here
+	std::vector<CompletedLoad> loads;
+	loads.reserve(indicesIntoAllTextures.size());
+	for (unsigned int index : indicesIntoAllTextures)
+	{
+		TINY_CORE_ASSERT(index < m_allTextures.size(), "Texture does not exist for this index");
+
+		TextureInstanceData& data = m_allTextures[index];
+		if (data.state != State::Unloaded && data.state != State::Queued)
+			continue;
+
+		// The content index may already know that this file is a copy of a resident texture
+		CompletedLoad& load = loads.emplace_back();
+		load.index = index;
+		load.filename = GetTextureFilename(index);
+		load.key = LookUpContentKey(load.filename);
+		if (TryShareResidentContent(index, load.key.hash))
+		{
+			loads.pop_back();
+			continue;
+		}
+
+		data.state = State::Loading;
+	}
+
+	if (loads.empty())
+		return;
+
+	// Same work as a streaming worker
+	ID3D12Device* device = m_deviceResources->GetDevice();
+	{
+		PROFILE_SCOPE("TextureManager::Preload - Read/Parse");
+
+		concurrency::parallel_for(size_t(0), loads.size(), [this, &loads, device](size_t iii)
+		{
+			LoadOnWorker(loads[iii], device);
+		});
+	}
+
+	// Staged in the order the textures were requested, so the single batch is deterministic. Copies of a texture that
+	// was loaded earlier in the batch are not staged at all
+	{
+		PROFILE_SCOPE("TextureManager::Preload - Stage");
+
+		for (CompletedLoad& load : loads)
+		{
+			GFX_THROW_INFO(load.hr);
+			RecordHash(load);
+
+			if (!TryShareResidentContent(load.index, load.key.hash))
+			{
+				Engine::StageTextureUpload(load.resource, load.subresources.data(), static_cast<UINT>(load.subresources.size()));
+				MakeResident(load.index, std::move(load.resource), load.key.hash);
+			}
+
+			load.file.Close();
+		}
+	}
+
+	SaveContentIndex();
+}
+
+void TextureManager::UpdateImpl()
+{
+	if (!m_initialized)
+		return;
+
+	PROFILE_FUNCTION();
+
+	ReleaseRetiredDescriptors();
+
+	// Stage the data for every file the workers have finished reading. The staging copy reads straight from the
+	// mapped files, which are unmapped as soon as it is done
+	std::vector<CompletedLoad> completedLoads;
+	{
+		std::lock_guard<std::mutex> lock(m_completedLoadsMutex);
+		completedLoads.swap(m_completedLoads);
+	}
+
+	if (!completedLoads.empty())
+	{
+		const size_t firstNewUpload = m_pendingUploads.size();
+		for (CompletedLoad& load : completedLoads)
+		{
+			--m_loadsInFlight;
+			GFX_THROW_INFO(load.hr);
+			RecordHash(load);
+
+			// A copy of a resident texture replaces the placeholder right away, and its data is never uploaded
+			if (TryShareResidentContent(load.index, load.key.hash))
+				continue;
+
+			Engine::StageStreamedTextureUpload(load.resource, load.subresources.data(), static_cast<UINT>(load.subresources.size()));
+			m_allTextures[load.index].state = State::Uploading;
+			m_pendingUploads.push_back({ load.index, std::move(load.resource), load.key.hash });
+		}
+
+		// Submitted right away, and the direct queue does not wait for it. Nothing reads these textures until
+		// their ticket has completed and they have replaced the placeholder. Anything else that was staged goes out in
+		// the same submission, and the Engine makes the direct queue wait for it before the next frame
+		if (m_pendingUploads.size() > firstNewUpload)
+		{
+			UploadTicket ticket = Engine::SubmitUploadsAsync();
+			for (size_t iii = firstNewUpload; iii < m_pendingUploads.size(); ++iii)
+				m_pendingUploads[iii].ticket = ticket;
+		}
+	}
+
+	// Textures whose copies have completed replace the placeholder
+	for (size_t iii = 0; iii < m_pendingUploads.size();)
+	{
+		if (Engine::IsUploadComplete(m_pendingUploads[iii].ticket))
+		{
+			MakeResident(m_pendingUploads[iii].index, std::move(m_pendingUploads[iii].resource), m_pendingUploads[iii].contentHash);
+			m_pendingUploads[iii] = std::move(m_pendingUploads.back());
+			m_pendingUploads.pop_back();
+		}
+		else
+		{
+			++iii;
+		}
+	}
+
+	DispatchLoads();
+	EnforceBudget();
+}
 
-		// Create a SRV and keep track of the index needed to look up this descriptor
-		unsigned int srvIndex = DescriptorManager::EmplaceBackShaderResourceView(textureResource.Get(), &srvDesc);
+void TextureManager::LoadImmediately(unsigned int indexIntoAllTextures)
+{
+	PROFILE_FUNCTION();
+
+	CompletedLoad load;
+	load.index = indexIntoAllTextures;
+	load.filename = GetTextureFilename(indexIntoAllTextures);
+	load.key = LookUpContentKey(load.filename);
+	if (TryShareResidentContent(indexIntoAllTextures, load.key.hash))
+		return;
+
+	// Load the texture from file (this only creates the resource, nothing is recorded)
+	LoadOnWorker(load, m_deviceResources->GetDevice());
+	GFX_THROW_INFO(load.hr);
+	RecordHash(load);
+
+	// Another texture with the same content may already be resident. Then the new resource is simply dropped (the
+	// GPU has never seen it)
+	if (TryShareResidentContent(indexIntoAllTextures, load.key.hash))
+		return;
+
+	// The data is copied straight from the mapped file into the staging pages (the only copy made on the CPU), so
+	// the file can be unmapped right away. The texture is uploaded on the copy queue. It stays in the COMMON state and is implicitly promoted when it is first read
+	Engine::StageTextureUpload(load.resource, load.subresources.data(), static_cast<UINT>(load.subresources.size()));
+
+	MakeResident(indexIntoAllTextures, std::move(load.resource), load.key.hash);
+}
 
-		m_allTextures[indexIntoAllTextures].refCount = 1;
-		m_allTextures[indexIntoAllTextures].texture = std::unique_ptr<Texture>(new Texture(m_deviceResources, textureResource, srvIndex, 0, indexIntoAllTextures, true));
+void TextureManager::DispatchLoads()
+{
+	ID3D12Device* device = m_deviceResources->GetDevice();
+
+	while (m_loadsInFlight < MaxLoadsInFlight && !m_queuedLoads.empty())
+	{
+		std::pop_heap(m_queuedLoads.begin(), m_queuedLoads.end());
+		QueuedLoad queued = m_queuedLoads.back();
+		m_queuedLoads.pop_back();
+
+		// Skip requests that were dropped or queued again at a different priority
+		TextureInstanceData& data = m_allTextures[queued.index];
+		if (data.state != State::Queued || data.priority != queued.priority)
+			continue;
+
+		std::wstring filename = GetTextureFilename(queued.index);
+		ContentKey key = LookUpContentKey(filename);
+		if (TryShareResidentContent(queued.index, key.hash))
+			continue;
+
+		data.state = State::Loading;
+		++m_loadsInFlight;
+
+		// The worker only reads/parses/hashes the file and creates the resource (device methods are free threaded).
+		// Staging and everything else that touches shared state happens back on the main thread in Update()
+		m_loadTasks.run([this, device, index = queued.index, filename = std::move(filename), key]()
+		{
+			CompletedLoad load;
+			load.index = index;
+			load.filename = filename;
+			load.key = key;
+			LoadOnWorker(load, device);
+
+			std::lock_guard<std::mutex> lock(m_completedLoadsMutex);
+			m_completedLoads.push_back(std::move(load));
+		});
+	}
+}
+
+void TextureManager::LoadOnWorker(CompletedLoad& load, ID3D12Device* device) const noexcept
+{
+	load.hr = DirectX::LoadDDSTextureFromFile12(device, load.filename.c_str(), load.resource, load.file, load.subresources);
+	if (FAILED(load.hr))
+		return;
+
+	// Hashing reads every page of the file, so by the time the main thread copies the data into the staging pages,
+	// the reads have finished. When the hash is already known, the pages are touched for the same reason
+	if (load.key.hash == 0)
+	{
+		load.key.hash = HashContent(load.resource.Get(), load.file, load.subresources);
 	}
 	else
 	{
-		TINY_CORE_ASSERT(m_allTextures[indexIntoAllTextures].texture != nullptr, "Texture should have already been created");
-		++m_allTextures[indexIntoAllTextures].refCount;
+		const volatile uint8_t* bytes = load.file.Data();
+		uint8_t touch = 0;
+		for (size_t offset = 0; offset < load.file.Size(); offset += 4096)
+			touch ^= bytes[offset];
 	}
+}
 
-	return m_allTextures[indexIntoAllTextures].texture.get();
+void TextureManager::RecordHash(const CompletedLoad& load)
+{
+	// Only remember files whose size/write time could be read, otherwise they could not be validated next time
+	if (load.key.fileSize == 0)
+		return;
+
+	ContentKey& entry = m_contentIndex[load.filename];
+	if (entry.hash != load.key.hash || entry.fileSize != load.key.fileSize || entry.lastWriteTime != load.key.lastWriteTime)
+	{
+		entry = load.key;
+		m_contentIndexDirty = true;
+	}
 }
 
-void TextureManager::ReleaseTextureImpl(unsigned int indexIntoAllTextures) noexcept
+bool TextureManager::TryShareResidentContent(unsigned int indexIntoAllTextures, UINT64 contentHash)
 {
-	TINY_CORE_ASSERT(m_initialized, "Cannot call TextureManager::ReleaseTextureImpl before calling TextureManager::Init");
-	TINY_CORE_ASSERT(m_allTextures[indexIntoAllTextures].refCount > 0, "Should not be calling ReleaseTexture for a Texture that already has a ref count of 0");
-	
-	--m_allTextures[indexIntoAllTextures].refCount;
+	if (contentHash == 0 || !m_contents.contains(contentHash))
+		return false;
+
+	MakeResident(indexIntoAllTextures, nullptr, contentHash);
+	return true;
+}
+
+void TextureManager::MakeResident(unsigned int indexIntoAllTextures, Microsoft::WRL::ComPtr<ID3D12Resource> resource, UINT64 contentHash)
+{
+	TINY_CORE_ASSERT(contentHash != 0, "Resident textures must have a content hash");
+
+	TextureInstanceData& data = m_allTextures[indexIntoAllTextures];
+
+	auto it = m_contents.find(contentHash);
+	if (it == m_contents.end())
+	{
+		TINY_CORE_ASSERT(resource != nullptr, "New content needs a resource");
+
+		SharedContent content;
+		content.srvIndex = CreateSRV(resource.Get());
+
+		D3D12_RESOURCE_DESC desc = resource->GetDesc();
+		content.sizeInBytes = m_deviceResources->GetDevice()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+		content.resource = std::move(resource);
+
+		// Nothing references it yet (see below), so it starts out evictable
+		Engine::TrackResource(content.resource.Get(), MemoryCategory::Texture);
+		content.residencyHandle = Engine::RegisterEvictable(content.sizeInBytes, [this, contentHash]() { EvictContent(contentHash); });
+		Engine::SetEvictable(content.residencyHandle, true);
+
+		m_stats.ResidentBytes += content.sizeInBytes;
+		m_stats.CachedBytes += content.sizeInBytes;
+
+		it = m_contents.emplace(contentHash, std::move(content)).first;
+	}
+	else
+	{
+		// Same content as a resident texture. A resource that was loaded anyway (both loads were in flight at the same
+		// time) may already have been copied to, so it is released once the GPU is done with it
+		if (resource != nullptr)
+			Engine::DelayedDelete(resource);
+
+		++m_stats.SharedTextures;
+		m_stats.SharedBytes += it->second.sizeInBytes;
+	}
+
+	SharedContent& content = it->second;
+	++content.users;
+
+	if (data.texture == nullptr)
+	{
+		data.texture = std::unique_ptr<Texture>(new Texture(m_deviceResources, content.resource, content.srvIndex, 0, indexIntoAllTextures, true));
+	}
+	else
+	{
+		// Streamed texture: overwrite the copy of the placeholder's SRV in its slot, so everything that already bound
+		// the slot now samples the real texture. Frames still in flight may read either view, and both resources
+		// outlive them (the placeholder is never evicted, and evicted content is released with a delayed delete)
+		data.texture->m_resource = content.resource;
+		DescriptorManager::CopyAt(data.texture->m_srvDescriptorIndex, content.srvIndex);
+		--m_stats.PendingLoads;
+	}
+
+	data.sizeInBytes = content.sizeInBytes;
+	data.contentHash = contentHash;
+	data.state = State::Resident;
+
+	++m_stats.ResidentTextures;
+	++m_stats.LoadsCompleted;
+
+	if (data.refCount > 0)
+	{
+		ReferenceContent(contentHash);
+	}
+	else
+	{
+		// Released while it was loading (or preloaded)
+		data.releasedAt = ++m_releaseCounter;
+	}
+}
+
+void TextureManager::ReferenceContent(UINT64 contentHash) noexcept
+{
+	auto it = m_contents.find(contentHash);
+	TINY_CORE_ASSERT(it != m_contents.end(), "Resident texture has no content");
+
+	if (it->second.referencedUsers++ == 0)
+	{
+		m_stats.CachedBytes -= it->second.sizeInBytes;
+		Engine::SetEvictable(it->second.residencyHandle, false);
+	}
+}
+void TextureManager::UnreferenceContent(UINT64 contentHash) noexcept
+{
+	auto it = m_contents.find(contentHash);
+	TINY_CORE_ASSERT(it != m_contents.end(), "Resident texture has no content");
+	TINY_CORE_ASSERT(it->second.referencedUsers > 0, "Content is not referenced");
+
+	if (--it->second.referencedUsers == 0)
+	{
+		m_stats.CachedBytes += it->second.sizeInBytes;
+		Engine::SetEvictable(it->second.residencyHandle, true);
+	}
+}
+
+void TextureManager::Evict(unsigned int indexIntoAllTextures) noexcept
+{
+	TextureInstanceData& data = m_allTextures[indexIntoAllTextures];
 
-	// If refCount is down to 0, then go ahead and delete the Texture data
-	if (m_allTextures[indexIntoAllTextures].refCount == 0)
+	TINY_CORE_ASSERT(data.state == State::Resident, "Only resident textures can be evicted");
+	TINY_CORE_ASSERT(data.refCount == 0, "Cannot evict a texture that is still referenced");
+
+	auto it = m_contents.find(data.contentHash);
+	TINY_CORE_ASSERT(it != m_contents.end(), "Resident texture has no content");
+
+	SharedContent& content = it->second;
+	if (--content.users == 0)
 	{
 		// Do a delayed delete of the resource because it might still be in use by the GPU
-		Engine::DelayedDelete(m_allTextures[indexIntoAllTextures].texture->m_resource);
+		Engine::DelayedDelete(content.resource);
+
+		// Inform the descriptor vector that the view for this texture can be removed (once the GPU is done with it)
+		RetireDescriptor(content.srvIndex);
+		Engine::UnregisterEvictable(content.residencyHandle);
+
+		// Content without users is never referenced, so it was counted as cached
+		m_stats.ResidentBytes -= content.sizeInBytes;
+		m_stats.CachedBytes -= content.sizeInBytes;
+		m_contents.erase(it);
+	}
+	else
+	{
+		--m_stats.SharedTextures;
+		m_stats.SharedBytes -= content.sizeInBytes;
+	}
+
+	--m_stats.ResidentTextures;
+	++m_stats.Evictions;
+
+	DestroyTexture(data);
+	data.state = State::Unloaded;
+	data.sizeInBytes = 0;
+	data.contentHash = 0;
+}
+
+void TextureManager::DestroyTexture(TextureInstanceData& data) noexcept
+{
+	// A streamed texture's own SRV slot may still be bound by frames in flight
+	if (data.ownsSRV)
+	{
+		RetireDescriptor(data.texture->m_srvDescriptorIndex);
+		data.ownsSRV = false;
+	}
+	data.texture = nullptr;
+}
+
+void TextureManager::EvictContent(UINT64 contentHash) noexcept
+{
+	// Called by the Engine's residency manager, which only evicts content while it is cached, so every texture using
+	// it has a ref count of 0. The content is released along with the last of them
+	for (unsigned int iii = 0; iii < m_allTextures.size(); ++iii)
+	{
+		const TextureInstanceData& data = m_allTextures[iii];
+		if (data.state == State::Resident && data.contentHash == contentHash)
+			Evict(iii);
+	}
+}
+
+void TextureManager::EnforceBudget() noexcept
+{
+	// Evict the least recently released textures until we are back under budget. Evicting a texture whose content is
+	// still used by another one frees nothing, so this keeps going until the content itself is released
+	while (m_stats.ResidentBytes > m_budgetInBytes && m_stats.CachedBytes > 0)
+	{
+		unsigned int oldest = 0;
+		UINT64 oldestReleasedAt = UINT64_MAX;
+		for (unsigned int iii = 0; iii < m_allTextures.size(); ++iii)
+		{
+			const TextureInstanceData& data = m_allTextures[iii];
+			if (data.state == State::Resident && data.refCount == 0 && data.releasedAt < oldestReleasedAt)
+			{
+				oldest = iii;
+				oldestReleasedAt = data.releasedAt;
+			}
+		}
+
+		TINY_CORE_ASSERT(oldestReleasedAt != UINT64_MAX, "Cached bytes were not 0, but there is no cached texture");
+		Evict(oldest);
+	}
+}
+
+unsigned int TextureManager::CreateSRV(ID3D12Resource* resource)
+{
+	// Create the SRV descriptor for the texture
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = resource->GetDesc().Format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = -1;
+
+	return DescriptorManager::EmplaceBackShaderResourceView(resource, &srvDesc);
+}
+
+void TextureManager::RetireDescriptor(unsigned int descriptorIndex) noexcept
+{
+	// Frames that are still in flight may have bound the descriptor, so it can only be reused once they are done
+	m_retiredDescriptors.push_back({ descriptorIndex, Engine::GetFrameNumber() });
+}
+void TextureManager::ReleaseRetiredDescriptors() noexcept
+{
+	const UINT64 frameNumber = Engine::GetFrameNumber();
+	const UINT64 frameCount = Engine::GetFrameResourceCount();
+
+	std::erase_if(m_retiredDescriptors, [frameNumber, frameCount](const RetiredDescriptor& retired)
+	{
+		if (retired.frameNumber + frameCount > frameNumber)
+			return false;
+
+		DescriptorManager::ReleaseAt(retired.index);
+		return true;
+	});
+}
 
-		// Inform the descriptor vector that the view for this texture can be removed
-		DescriptorManager::ReleaseAt(m_allTextures[indexIntoAllTextures].texture->m_srvDescriptorIndex);
+UINT64 TextureManager::HashContent(ID3D12Resource* resource, const DirectX::MappedDDSFile& file, const std::vector<D3D12_SUBRESOURCE_DATA>& subresources) noexcept
+{
+	// The same bytes only make the same texture if the resources are described the same way. Fields are hashed one
+	// at a time so padding in the desc does not matter
+	D3D12_RESOURCE_DESC desc = resource->GetDesc();
+	utility::Hash64 hash;
+	hash.Update(&desc.Dimension, sizeof(desc.Dimension));
+	hash.Update(&desc.Width, sizeof(desc.Width));
+	hash.Update(&desc.Height, sizeof(desc.Height));
+	hash.Update(&desc.DepthOrArraySize, sizeof(desc.DepthOrArraySize));
+	hash.Update(&desc.MipLevels, sizeof(desc.MipLevels));
+	hash.Update(&desc.Format, sizeof(desc.Format));
+
+	// The subresources are stored back to back, from the first one to the end of the file
+	const uint8_t* first = static_cast<const uint8_t*>(subresources.front().pData);
+	hash.Update(first, static_cast<size_t>(file.Data() + file.Size() - first));
+
+	// 0 means "not hashed"
+	const UINT64 value = hash.Digest();
+	return value != 0 ? value : 1;
+}
+
+TextureManager::ContentKey TextureManager::LookUpContentKey(const std::wstring& filename)
+{
+	// The size and write time are needed either way: to validate the index entry, or to record a new one
+	ContentKey key;
+	std::error_code ec;
+	const UINT64 fileSize = std::filesystem::file_size(filename, ec);
+	if (ec)
+		return key;
+	const auto lastWriteTime = std::filesystem::last_write_time(filename, ec);
+	if (ec)
+		return key;
+
+	key.fileSize = fileSize;
+	key.lastWriteTime = static_cast<INT64>(lastWriteTime.time_since_epoch().count());
+
+	auto it = m_contentIndex.find(filename);
+	if (it != m_contentIndex.end() && it->second.fileSize == key.fileSize && it->second.lastWriteTime == key.lastWriteTime)
+	{
+		key.hash = it->second.hash;
+		++m_stats.IndexHits;
 	}
+
+	return key;
 }
 
-}
\ No newline at end of file
+// Content index file format: a version line, then one line per file:
+//     <hash (16 hex digits)> <file size> <last write time> <filename (UTF-8)>
+// Anything that does not parse is ignored (the file is rewritten on the next save)
+static constexpr std::string_view ContentIndexVersion = "tiny-texture-index 1";
+
+void TextureManager::LoadContentIndex() noexcept
+{
+	std::ifstream file(m_contentIndexFile, std::ios::binary);
+	if (!file)
+		return;
+
+	std::string line;
+	if (!std::getline(file, line) || line != ContentIndexVersion)
+		return;
+
+	while (std::getline(file, line))
+	{
+		const char* p = line.data();
+		const char* end = line.data() + line.size();
+
+		ContentKey key;
+		auto parse = [&p, end](auto& value, int base)
+		{
+			auto result = std::from_chars(p, end, value, base);
+			if (result.ec != std::errc() || result.ptr == end || *result.ptr != ' ')
+				return false;
+			p = result.ptr + 1;
+			return true;
+		};
+		if (!parse(key.hash, 16) || !parse(key.fileSize, 10) || !parse(key.lastWriteTime, 10) || p == end || key.hash == 0)
+			continue;
+
+		std::u8string filename(reinterpret_cast<const char8_t*>(p), reinterpret_cast<const char8_t*>(end));
+		m_contentIndex[std::filesystem::path(filename).wstring()] = key;
+	}
+}
+
+void TextureManager::SaveContentIndex() noexcept
+{
+	if (!m_contentIndexDirty || m_contentIndexFile.empty())
+		return;
+
+	std::ofstream file(m_contentIndexFile, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return;
+
+	file << ContentIndexVersion << '\n';
+	for (const auto& [filename, key] : m_contentIndex)
+	{
+		const std::u8string utf8 = std::filesystem::path(filename).u8string();
+		file << std::format("{:016x} {} {} ", key.hash, key.fileSize, key.lastWriteTime);
+		file.write(reinterpret_cast<const char*>(utf8.data()), utf8.size());
+		file << '\n';
+	}
+
+	m_contentIndexDirty = false;
+}
+
+}
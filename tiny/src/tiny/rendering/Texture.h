@@ -3,6 +3,9 @@
 #include "tiny/Core.h"
 #include "tiny/DeviceResources.h"
 #include "tiny/rendering/DescriptorManager.h"
+#include "tiny/rendering/ResidencyManager.h"
+#include "tiny/rendering/UploadScheduler.h"
+#include "tiny/utils/MipChain.h"
 
 // External methods so that the client can define which textures are included in the app
 extern std::wstring GetTextureFilename(unsigned int index);
@@ -21,8 +24,16 @@ public:
 	ND inline D3D12_GPU_DESCRIPTOR_HANDLE GetSRVHandle() const noexcept { return DescriptorManager::GetGPUHandleAt(m_srvDescriptorIndex); }
 	ND inline D3D12_GPU_DESCRIPTOR_HANDLE GetUAVHandle() const noexcept { return DescriptorManager::GetGPUHandleAt(m_uavDescriptorIndex); }
 
-	void CopyData(const std::vector<float>& data);
+	// 'data' is mip 0 (R32_FLOAT). If the texture has more mips, they are filled in on the CPU with 'filter'
+	void CopyData(const std::vector<float>& data, mips::Filter filter = mips::Filter::Box);
 	void TransitionToState(D3D12_RESOURCE_STATES newState);
+	void TransitionToState(D3D12_RESOURCE_STATES newState, ID3D12GraphicsCommandList* commandList);
+
+	// Fills in mips 1 and up from mip 0 on the GPU (see MipGenerator), i.e. after mip 0 was written by a compute
+	// shader (which needs no barrier of its own). The texture must have been created with
+	// D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, and is left in the UNORDERED_ACCESS state
+	void GenerateMips();
+	void GenerateMips(ID3D12GraphicsCommandList* commandList);
 
 protected:
 	Texture(std::shared_ptr<DeviceResources> deviceResources,
@@ -38,6 +49,7 @@ protected:
 		m_currentResourceState(rhs.m_currentResourceState),
 		m_srvDescriptorIndex(rhs.m_srvDescriptorIndex),
 		m_uavDescriptorIndex(rhs.m_uavDescriptorIndex),
+		m_mipUAVDescriptorIndices(std::move(rhs.m_mipUAVDescriptorIndices)),
 		m_indexIntoAllManagedTextures(rhs.m_indexIntoAllManagedTextures),
 		m_isManagedTexture(rhs.m_isManagedTexture),
 		m_movedFrom(false)
@@ -51,6 +63,7 @@ protected:
 		m_currentResourceState = rhs.m_currentResourceState;
 		m_srvDescriptorIndex = rhs.m_srvDescriptorIndex;
 		m_uavDescriptorIndex = rhs.m_uavDescriptorIndex;
+		m_mipUAVDescriptorIndices = std::move(rhs.m_mipUAVDescriptorIndices);
 		m_indexIntoAllManagedTextures = rhs.m_indexIntoAllManagedTextures;
 		m_isManagedTexture = rhs.m_isManagedTexture;
 		m_movedFrom = false;
@@ -72,6 +85,7 @@ protected:
 	// Data for accessing the descriptors for the texture
 	unsigned int	  m_srvDescriptorIndex = 0;
 	unsigned int	  m_uavDescriptorIndex = 0;
+	std::vector<unsigned int> m_mipUAVDescriptorIndices; // One per mip, created by the first GenerateMips()
 
 	// Data for managed textures
 	unsigned int	  m_indexIntoAllManagedTextures = 0;
@@ -95,7 +109,20 @@ public:
 		m_textures.clear();
 	}
 
+	struct ImportOptions
+	{
+		bool GenerateMips = true;
+		mips::Filter MipFilter = mips::Filter::Box;
+		// BC1_UNORM, BC1_UNORM_SRGB, BC4_UNORM or BC5_UNORM to block compress every mip (see bc::Compress(), the
+		// pixels must then be R8G8B8A8), or UNKNOWN to keep the format of the pixels
+		DXGI_FORMAT Compression = DXGI_FORMAT_UNKNOWN;
+	};
+
 	ND Texture* EmplaceBack(const D3D12_RESOURCE_DESC& desc, bool createSRV = true, bool createUAV = false);
+	// Creates a static texture from pixels on the CPU (any format mips::Generate() supports): builds the mip chain,
+	// optionally compresses it (split across PPL workers) and stages the upload on the copy queue. The texture only
+	// has an SRV (covering every mip), and the pixels can be freed as soon as this returns
+	ND Texture* EmplaceBackFromPixels(DXGI_FORMAT format, UINT width, UINT height, const void* pixels, size_t rowPitch, const ImportOptions& options = {});
 	ND inline Texture* operator[](size_t index) { return m_textures[index].get(); }
 
 private:
@@ -107,27 +134,117 @@ private:
 // TextureManager is used for managing textures the are read from file. Texture Manager is a singleton, therefore,
 // all code can lookup any texture at any time. There is also automatic reference counting - textures are only 
 // loaded into GPU memory when being referenced and are released when the reference counts drops to 0.
+//
+// Streaming: once EnableStreaming() has been called, GetTexture() no longer reads the file on the calling thread.
+// The request is queued (highest priority first), the file is read and parsed on a PPL worker, and the data is
+// uploaded on the copy queue. Each streamed Texture gets its own SRV slot, which holds a copy of the placeholder
+// texture's SRV until the data is resident, so it can be bound right away. The real SRV is then written into the same
+// slot, so handles that were read from GetSRVHandle() before that point pick up the real texture as well.
+// Update() (called by Engine::Update()) moves loads through these steps on the main thread.
+//
+// Budget: textures whose ref count drops to 0 stay resident (so they can be handed out again without reloading)
+// until the bytes of all resident textures exceed the budget, at which point the least recently released ones are
+// evicted. With the default budget of 0, textures are released as soon as their ref count drops to 0.
+//
+// De-duplication: every loaded texture is hashed (its resource description plus its pixel data). Textures with the
+// same content share one resource and one SRV, which is only released once every texture using it is evicted. When
+// Init() is given a content index file, the hash of each file is saved along with its size and last write time, so
+// later runs can skip hashing, and can skip reading files whose content is already resident.
+//
+// Cached content is also subject to the Engine's memory budget (see ResidencyManager), which may evict it along with
+// other idle GPU data, regardless of the TextureManager's own budget.
 class TextureManager
 {
 private:
+	enum class State
+	{
+		Unloaded,
+		Queued,		// Waiting for a worker
+		Loading,	// Being read/parsed on a worker
+		Uploading,	// Waiting for the copy queue
+		Resident
+	};
 	struct TextureInstanceData
 	{
 		unsigned int refCount = 0;
 		std::unique_ptr<Texture> texture = nullptr;
+		State state = State::Unloaded;
+		int priority = 0;
+		UINT64 sizeInBytes = 0;
+		UINT64 releasedAt = 0;	// Value of m_releaseCounter when the ref count last dropped to 0 (for LRU eviction)
+		UINT64 contentHash = 0;	// Key into m_contents while resident
+		bool ownsSRV = false;	// Streamed: the Texture's SRV slot is its own (see GetTextureImpl()) and is retired along with it
+	};
+	// GPU data shared by all resident textures with the same content
+	struct SharedContent
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
+		unsigned int srvIndex = 0;
+		UINT64 sizeInBytes = 0;
+		unsigned int users = 0;				// Resident textures using it
+		unsigned int referencedUsers = 0;	// ... that have a ref count above 0 (when 0, the content is cached)
+		ResidencyManager::Handle residencyHandle = ResidencyManager::InvalidHandle; // Evictable while cached
+	};
+	// What the content index remembers about a file. A hash of 0 means the content has not been hashed
+	struct ContentKey
+	{
+		UINT64 hash = 0;
+		UINT64 fileSize = 0;
+		INT64 lastWriteTime = 0;
 	};
 
 public:
+	struct Stats
+	{
+		UINT64 ResidentBytes = 0;			// All resident textures, including the ones that are only cached (shared content is counted once)
+		UINT64 CachedBytes = 0;				// Content that no texture with a ref count above 0 is using
+		unsigned int ResidentTextures = 0;
+		unsigned int PendingLoads = 0;		// Queued, loading or uploading
+		unsigned int LoadsCompleted = 0;	// Totals since Init()
+		unsigned int CacheHits = 0;
+		unsigned int Evictions = 0;
+		unsigned int SharedTextures = 0;	// Resident textures using content that another texture loaded first
+		UINT64 SharedBytes = 0;				// GPU memory those textures did not need
+		unsigned int IndexHits = 0;			// Files whose hash came from the content index instead of being computed
+	};
+
+	// Worker loads that may be in flight at the same time. Additional requests wait in the priority queue
+	static constexpr unsigned int MaxLoadsInFlight = 4;
+
 	~TextureManager() noexcept
 	{
-		// For some reason, if we don't explicitly clear the textures first, then the destructor for the
-		// DescriptorVector gets called first. This is an issue because the Texture destructor attempts to
-		// call TextureManager::ReleaseTexture() which calls DescriptorVector::ReleaseAt(). So we manually
-		// clear all the Textures to ensure their destructors run first.
+		// Workers write to m_completedLoads, so they must be finished before anything is destroyed
+		m_loadTasks.wait();
+		SaveContentIndex();
 		m_allTextures.clear();
 	}
 
-	static inline void Init(std::shared_ptr<DeviceResources> deviceResources) noexcept { Get().InitImpl(deviceResources); }
-	ND static inline Texture* GetTexture(unsigned int indexIntoAllTextures) { return std::move(Get().GetTextureImpl(indexIntoAllTextures)); }
+	// 'contentIndexFile' is optional. If it is given, it is read now (if it exists) and written back whenever new
+	// hashes have been computed (after Preload() and on shutdown)
+	static inline void Init(std::shared_ptr<DeviceResources> deviceResources, const std::filesystem::path& contentIndexFile = {}) noexcept { Get().InitImpl(deviceResources, contentIndexFile); }
+	ND static inline Texture* GetTexture(unsigned int indexIntoAllTextures) { return Get().GetTextureImpl(indexIntoAllTextures, 0); }
+	// Same as GetTexture(), but when streaming, higher priority requests are loaded first
+	ND static inline Texture* RequestTexture(unsigned int indexIntoAllTextures, int priority) { return Get().GetTextureImpl(indexIntoAllTextures, priority); }
+	static void ReleaseTexture(unsigned int indexIntoAllTextures) noexcept { Get().ReleaseTextureImpl(indexIntoAllTextures); }
+
+	// Loads a batch of textures up front (i.e. at startup) instead of one GetTexture() at a time. The files are read
+	// and parsed in parallel on PPL workers, then all of the uploads are staged together so they go out in a single
+	// copy queue submission. Preloaded textures are resident but not referenced: GetTexture() hands them out as cache
+	// hits, and the ones nobody requests are subject to the budget at the next Update(). Textures that are already
+	// resident or loading are skipped. Queued streaming requests are loaded right away
+	static inline void Preload(std::span<const unsigned int> indicesIntoAllTextures) { Get().PreloadImpl(indicesIntoAllTextures); }
+	static void PreloadAll();
+
+	// The placeholder is loaded immediately and is never evicted. It must be a 2D texture because its SRV is
+	// bound in place of the requested textures until they are resident
+	static inline void EnableStreaming(unsigned int placeholderIndex) { Get().EnableStreamingImpl(placeholderIndex); }
+	ND static inline bool IsStreaming() noexcept { return Get().m_placeholder != nullptr; }
+	static inline void SetBudget(UINT64 bytes) noexcept { Get().m_budgetInBytes = bytes; }
+	ND static inline UINT64 GetBudget() noexcept { return Get().m_budgetInBytes; }
+	ND static inline bool IsResident(unsigned int indexIntoAllTextures) noexcept { return Get().m_allTextures[indexIntoAllTextures].state == State::Resident; }
+	ND static inline const Stats& GetStats() noexcept { return Get().m_stats; }
+
+	static inline void Update() { Get().UpdateImpl(); }
 
 private:
 	TextureManager() noexcept = default;
@@ -138,12 +255,65 @@ private:
 
 	static TextureManager& Get() noexcept { static TextureManager tm; return tm; }
 
-	void InitImpl(std::shared_ptr<DeviceResources> deviceResources) noexcept;
-	ND Texture* GetTextureImpl(unsigned int indexIntoAllTextures);
-
-private:
-	static void ReleaseTexture(unsigned int indexIntoAllTextures) noexcept { Get().ReleaseTextureImpl(indexIntoAllTextures); }
+	void InitImpl(std::shared_ptr<DeviceResources> deviceResources, const std::filesystem::path& contentIndexFile) noexcept;
+	ND Texture* GetTextureImpl(unsigned int indexIntoAllTextures, int priority);
 	void ReleaseTextureImpl(unsigned int indexIntoAllTextures) noexcept;
+	void EnableStreamingImpl(unsigned int placeholderIndex);
+	void PreloadImpl(std::span<const unsigned int> indicesIntoAllTextures);
+	void UpdateImpl();
+
+	// Result of reading/parsing a file on a worker
+	struct CompletedLoad
+	{
+		unsigned int index = 0;
+		std::wstring filename;
+		ContentKey key;			// The worker fills in the hash if the content index did not have it
+		HRESULT hr = S_OK;
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
+		DirectX::MappedDDSFile file;	// 'subresources' point into the mapped file
+		std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+	};
+	struct QueuedLoad
+	{
+		int priority = 0;
+		UINT64 order = 0; // Requests with the same priority are loaded in the order they were made
+		unsigned int index = 0;
+
+		ND inline bool operator<(const QueuedLoad& rhs) const noexcept { return priority < rhs.priority || (priority == rhs.priority && order > rhs.order); }
+	};
+	struct PendingUpload
+	{
+		unsigned int index = 0;
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
+		UINT64 contentHash = 0;
+		UploadTicket ticket;
+	};
+	struct RetiredDescriptor
+	{
+		unsigned int index = 0;
+		UINT64 frameNumber = 0;
+	};
+
+	void LoadImmediately(unsigned int indexIntoAllTextures);
+	void DispatchLoads();
+	void LoadOnWorker(CompletedLoad& load, ID3D12Device* device) const noexcept;
+	void RecordHash(const CompletedLoad& load);
+	ND bool TryShareResidentContent(unsigned int indexIntoAllTextures, UINT64 contentHash);
+	void MakeResident(unsigned int indexIntoAllTextures, Microsoft::WRL::ComPtr<ID3D12Resource> resource, UINT64 contentHash);
+	void ReferenceContent(UINT64 contentHash) noexcept;
+	void UnreferenceContent(UINT64 contentHash) noexcept;
+	void Evict(unsigned int indexIntoAllTextures) noexcept;
+	void DestroyTexture(TextureInstanceData& data) noexcept;
+	void EvictContent(UINT64 contentHash) noexcept;
+	void EnforceBudget() noexcept;
+	ND unsigned int CreateSRV(ID3D12Resource* resource);
+	void RetireDescriptor(unsigned int descriptorIndex) noexcept;
+	void ReleaseRetiredDescriptors() noexcept;
+
+	ND static UINT64 HashContent(ID3D12Resource* resource, const DirectX::MappedDDSFile& file, const std::vector<D3D12_SUBRESOURCE_DATA>& subresources) noexcept;
+	ND ContentKey LookUpContentKey(const std::wstring& filename);
+	void LoadContentIndex() noexcept;
+	void SaveContentIndex() noexcept;
 
 	bool m_initialized = false;
 	std::shared_ptr<DeviceResources> m_deviceResources = nullptr;
@@ -151,7 +321,27 @@ private:
 	// all textures, their reference count, and their index into the DescriptorVector
 	std::vector<TextureInstanceData> m_allTextures;
 
-	// Make Texture a friend so its destructor can call ReleaseTexture()
-	friend Texture;
+	Texture* m_placeholder = nullptr;	// Only set when streaming
+	UINT64 m_budgetInBytes = 0;
+	UINT64 m_releaseCounter = 0;
+	Stats m_stats;
+
+	// Streaming state. Everything except m_completedLoads is only touched on the main thread
+	std::vector<QueuedLoad> m_queuedLoads; // Max heap
+	UINT64 m_requestCounter = 0;
+	unsigned int m_loadsInFlight = 0;
+	concurrency::task_group m_loadTasks;
+	std::mutex m_completedLoadsMutex;
+	std::vector<CompletedLoad> m_completedLoads;
+	std::vector<PendingUpload> m_pendingUploads;
+
+	// SRVs that may still be referenced by frames in flight
+	std::vector<RetiredDescriptor> m_retiredDescriptors;
+
+	// De-duplication. Only touched on the main thread
+	std::unordered_map<UINT64, SharedContent> m_contents;
+	std::unordered_map<std::wstring, ContentKey> m_contentIndex; // Keyed by filename
+	std::filesystem::path m_contentIndexFile;
+	bool m_contentIndexDirty = false;
 };
 }
\ No newline at end of file
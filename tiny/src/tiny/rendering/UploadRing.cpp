@@ -0,0 +1,133 @@
+#include "tiny-pch.h"
+#include "UploadRing.h"
+#include "tiny/Engine.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+UploadRing::UploadRing(std::shared_ptr<DeviceResources> deviceResources, unsigned int frameResourceCount, UINT64 pageSize) :
+	m_deviceResources(deviceResources),
+	m_pageSize(pageSize),
+	m_regions(frameResourceCount)
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+	TINY_CORE_ASSERT(m_pageSize > 0, "Page size must be greater than 0");
+	TINY_CORE_ASSERT(frameResourceCount > 0, "Must have at least 1 frame resource");
+}
+UploadRing::~UploadRing() noexcept
+{
+	for (FrameRegion& region : m_regions)
+		ReleasePages(region);
+}
+
+void UploadRing::ReleasePages(FrameRegion& region) noexcept
+{
+	// Pages are persistently mapped, so unmap them before the resources are released
+	for (Page& page : region.Pages)
+	{
+		if (page.Resource != nullptr)
+			page.Resource->Unmap(0, nullptr);
+
+		m_capacityInBytes -= page.Size;
+		--m_pageCount;
+	}
+	region.Pages.clear();
+	region.CurrentPage = 0;
+	region.Offset = 0;
+	region.BytesAllocated = 0;
+}
+
+UploadRing::Page UploadRing::CreatePage(UINT64 byteSize)
+{
+	PROFILE_FUNCTION();
+
+	Page page;
+	page.Size = byteSize;
+
+	auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto desc = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+
+	GFX_THROW_INFO(
+		m_deviceResources->GetDevice()->CreateCommittedResource(
+			&props,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&page.Resource)
+		)
+	);
+
+	// We never unmap until the ring is destroyed. However, we must not write to a page while it is in use by
+	// the GPU, which is guaranteed by only ever calling Reset() once the frame's fence has been reached
+	GFX_THROW_INFO(
+		page.Resource->Map(0, nullptr, reinterpret_cast<void**>(&page.CPU))
+	);
+	page.GPU = page.Resource->GetGPUVirtualAddress();
+	Engine::TrackResource(page.Resource.Get(), MemoryCategory::ConstantBuffer);
+
+	m_capacityInBytes += byteSize;
+	++m_pageCount;
+
+	return page;
+}
+
+UploadRing::Allocation UploadRing::Allocate(UINT64 byteSize, UINT64 alignment)
+{
+	TINY_CORE_ASSERT(byteSize > 0, "Cannot allocate 0 bytes");
+	TINY_CORE_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of 2");
+
+	FrameRegion& region = m_regions[m_currentFrameIndex];
+
+	while (true)
+	{
+		if (region.CurrentPage < region.Pages.size()) LIKELY
+		{
+			Page& page = region.Pages[region.CurrentPage];
+			UINT64 alignedOffset = (region.Offset + alignment - 1) & ~(alignment - 1);
+
+			if (alignedOffset + byteSize <= page.Size) LIKELY
+			{
+				region.Offset = alignedOffset + byteSize;
+				region.BytesAllocated += byteSize;
+				m_peakBytesPerFrame = MathHelper::Max(m_peakBytesPerFrame, region.BytesAllocated);
+				return { page.CPU + alignedOffset, page.GPU + alignedOffset };
+			}
+
+			// Current page is full - move on to the next one (whatever remains at the end of this page is wasted for this frame)
+			++region.CurrentPage;
+			region.Offset = 0;
+			continue;
+		}
+
+		// Out of pages for this frame resource, so grow the region. NOTE: Page resources are always 64KB aligned,
+		// so an offset of 0 satisfies any constant buffer alignment
+		region.Pages.push_back(CreatePage(MathHelper::Max(m_pageSize, byteSize)));
+	}
+}
+
+void UploadRing::Reset(unsigned int frameIndex) noexcept
+{
+	TINY_CORE_ASSERT(frameIndex < m_regions.size(), "Frame index is larger than expected");
+
+	m_currentFrameIndex = frameIndex;
+
+	FrameRegion& region = m_regions[m_currentFrameIndex];
+	region.CurrentPage = 0;
+	region.Offset = 0;
+	region.BytesAllocated = 0;
+}
+
+void UploadRing::SetFrameResourceCount(unsigned int frameResourceCount) noexcept
+{
+	TINY_CORE_ASSERT(frameResourceCount > 0, "Must have at least 1 frame resource");
+
+	for (size_t iii = frameResourceCount; iii < m_regions.size(); ++iii)
+		ReleasePages(m_regions[iii]);
+
+	m_regions.resize(frameResourceCount);
+	m_currentFrameIndex = 0;
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+#include "tiny/utils/Constants.h"
+
+namespace tiny
+{
+// UploadRing is a linear allocator over large, persistently mapped UPLOAD heap pages. Each frame resource owns
+// its own set of pages. Allocations for a frame are simply bumped through those pages, and the whole set is
+// recycled in one go (via Reset()) once the Engine has waited on the fence for that frame resource. This means
+// thousands of small constant buffers cost a handful of committed resources instead of one resource each.
+class UploadRing
+{
+public:
+	struct Allocation
+	{
+		BYTE* CPU = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GPU = 0;
+	};
+
+	static constexpr UINT64 DefaultPageSize = 2 * 1024 * 1024; // 2MB
+
+	UploadRing(std::shared_ptr<DeviceResources> deviceResources, unsigned int frameResourceCount, UINT64 pageSize = DefaultPageSize);
+	~UploadRing() noexcept;
+
+	ND Allocation Allocate(UINT64 byteSize, UINT64 alignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+	// Must ONLY be called once the GPU has finished with all commands that referenced the frame resource
+	void Reset(unsigned int frameIndex) noexcept;
+
+	// Must ONLY be called while the GPU is idle. Pages belonging to frame resources that no longer exist are released
+	void SetFrameResourceCount(unsigned int frameResourceCount) noexcept;
+
+	// Stats
+	ND inline UINT64 BytesAllocatedThisFrame() const noexcept { return m_regions[m_currentFrameIndex].BytesAllocated; }
+	ND inline UINT64 PeakBytesPerFrame() const noexcept { return m_peakBytesPerFrame; }
+	ND inline UINT64 CapacityInBytes() const noexcept { return m_capacityInBytes; }
+	ND inline unsigned int PageCount() const noexcept { return m_pageCount; }
+
+private:
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource = nullptr;
+		BYTE* CPU = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GPU = 0;
+		UINT64 Size = 0;
+	};
+	struct FrameRegion
+	{
+		std::vector<Page> Pages;
+		size_t CurrentPage = 0;
+		UINT64 Offset = 0;
+		UINT64 BytesAllocated = 0;
+	};
+
+	ND Page CreatePage(UINT64 byteSize);
+	void ReleasePages(FrameRegion& region) noexcept;
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	UINT64 m_pageSize;
+
+	std::vector<FrameRegion> m_regions; // One per frame resource
+	unsigned int m_currentFrameIndex = 0;
+
+	UINT64 m_peakBytesPerFrame = 0;
+	UINT64 m_capacityInBytes = 0;
+	unsigned int m_pageCount = 0;
+};
+}
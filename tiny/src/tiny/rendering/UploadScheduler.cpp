@@ -0,0 +1,113 @@
+#include "tiny-pch.h"
+#include "UploadScheduler.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+UploadScheduler::UploadScheduler(std::shared_ptr<DeviceResources> deviceResources) :
+	m_deviceResources(deviceResources)
+{
+	TINY_CORE_ASSERT(m_deviceResources != nullptr, "No device resources");
+
+	auto device = m_deviceResources->GetDevice();
+
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	GFX_THROW_INFO(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(m_queue.GetAddressOf())));
+	GFX_THROW_INFO(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_fence.GetAddressOf())));
+
+	m_fenceEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+	TINY_CORE_ASSERT(m_fenceEvent != NULL, "Failed to create fence event");
+
+	m_staging = std::make_unique<StagingUploader>(m_deviceResources, m_fence);
+}
+UploadScheduler::~UploadScheduler() noexcept
+{
+	// The staging pages and command allocators must not be released while the copy queue may still be using them
+	if (m_lastSubmittedFenceValue > m_fence->GetCompletedValue() && m_fenceEvent != NULL)
+	{
+		if (SUCCEEDED(m_fence->SetEventOnCompletion(m_lastSubmittedFenceValue, m_fenceEvent)))
+			WaitForSingleObject(m_fenceEvent, INFINITE);
+	}
+
+	if (m_fenceEvent != NULL)
+		CloseHandle(m_fenceEvent);
+}
+
+UploadScheduler::CommandContext& UploadScheduler::AcquireContext()
+{
+	UINT64 completedFenceValue = m_fence->GetCompletedValue();
+	for (CommandContext& context : m_contexts)
+	{
+		if (context.FenceValue <= completedFenceValue)
+		{
+			GFX_THROW_INFO(context.Allocator->Reset());
+			GFX_THROW_INFO(context.CommandList->Reset(context.Allocator.Get(), nullptr));
+			return context;
+		}
+	}
+
+	// Every list is still in flight, so add another one (they are created in the recording state)
+	auto device = m_deviceResources->GetDevice();
+	CommandContext& context = m_contexts.emplace_back();
+	GFX_THROW_INFO(
+		device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(context.Allocator.GetAddressOf()))
+	);
+	GFX_THROW_INFO(
+		device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, context.Allocator.Get(), nullptr, IID_PPV_ARGS(context.CommandList.GetAddressOf()))
+	);
+	return context;
+}
+
+UploadTicket UploadScheduler::Submit()
+{
+	if (!m_staging->HasPendingCopies())
+		return LastSubmitted();
+
+	PROFILE_FUNCTION();
+
+	CommandContext& context = AcquireContext();
+	m_staging->RecordPendingCopies(context.CommandList.Get());
+	GFX_THROW_INFO(context.CommandList->Close());
+
+	ID3D12CommandList* lists[] = { context.CommandList.Get() };
+	GFX_THROW_INFO_ONLY(m_queue->ExecuteCommandLists(1, lists));
+
+	UINT64 fenceValue = ++m_lastSubmittedFenceValue;
+	GFX_THROW_INFO(m_queue->Signal(m_fence.Get(), fenceValue));
+
+	context.FenceValue = fenceValue;
+	m_staging->OnSubmitted(fenceValue);
+	++m_submissionsThisFrame;
+
+	return { fenceValue };
+}
+
+void UploadScheduler::Wait(UploadTicket ticket)
+{
+	TINY_CORE_ASSERT(ticket.FenceValue <= m_lastSubmittedFenceValue, "Ticket has not been submitted");
+
+	if (IsComplete(ticket))
+		return;
+
+	PROFILE_FUNCTION();
+
+	GFX_THROW_INFO(m_fence->SetEventOnCompletion(ticket.FenceValue, m_fenceEvent));
+	WaitForSingleObject(m_fenceEvent, INFINITE);
+}
+void UploadScheduler::WaitOnQueue(ID3D12CommandQueue* queue, UploadTicket ticket)
+{
+	TINY_CORE_ASSERT(queue != nullptr, "No queue");
+	TINY_CORE_ASSERT(ticket.FenceValue <= m_lastSubmittedFenceValue, "Ticket has not been submitted");
+
+	// Fence values only increase, so once a queue has waited for a value it never has to wait for an older one
+	if (ticket.FenceValue <= m_lastQueueWaitFenceValue || IsComplete(ticket))
+		return;
+
+	GFX_THROW_INFO(queue->Wait(m_fence.Get(), ticket.FenceValue));
+	m_lastQueueWaitFenceValue = ticket.FenceValue;
+}
+
+}
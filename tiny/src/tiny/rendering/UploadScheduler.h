@@ -0,0 +1,76 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/DeviceResources.h"
+#include "StagingUploader.h"
+
+namespace tiny
+{
+// Identifies a submission on the copy queue. Resources whose copies were staged before the submission are ready to
+// use once the ticket is complete. A default constructed ticket is always complete
+struct UploadTicket
+{
+	UINT64 FenceValue = 0;
+};
+
+// UploadScheduler owns a dedicated COPY queue (with its own fence) and submits staged uploads to it, so copying
+// asset data does not occupy the direct queue. Nothing waits for a submission unless asked to:
+//     - IsComplete() polls a ticket (i.e. for streaming, where an asset is only used once its data has arrived)
+//     - WaitOnQueue() makes another queue wait on the GPU timeline, without blocking the CPU
+//     - Wait() blocks the CPU
+class UploadScheduler
+{
+public:
+	UploadScheduler(std::shared_ptr<DeviceResources> deviceResources);
+	~UploadScheduler() noexcept;
+
+	// See StagingUploader. Destinations must be in the COMMON state and are in the COMMON state once the copy completes
+	inline void StageBuffer(Microsoft::WRL::ComPtr<ID3D12Resource> destination, UINT64 destinationOffset, const void* data, UINT64 byteSize)
+	{
+		m_staging->StageBuffer(std::move(destination), destinationOffset, data, byteSize);
+	}
+	inline void StageTexture(Microsoft::WRL::ComPtr<ID3D12Resource> destination, const D3D12_SUBRESOURCE_DATA* subresources, UINT firstSubresource, UINT subresourceCount)
+	{
+		m_staging->StageTexture(std::move(destination), subresources, firstSubresource, subresourceCount);
+	}
+
+	// Submits everything staged so far. If nothing is pending, the ticket of the most recent submission is returned
+	ND UploadTicket Submit();
+
+	ND inline bool IsComplete(UploadTicket ticket) const { return ticket.FenceValue <= m_fence->GetCompletedValue(); }
+	void Wait(UploadTicket ticket);
+	void WaitOnQueue(ID3D12CommandQueue* queue, UploadTicket ticket);
+
+	ND inline bool HasPendingUploads() const noexcept { return m_staging->HasPendingCopies(); }
+	ND inline UploadTicket LastSubmitted() const noexcept { return { m_lastSubmittedFenceValue }; }
+	ND inline ID3D12CommandQueue* GetQueue() const noexcept { return m_queue.Get(); }
+	ND inline const StagingUploader& GetStaging() const noexcept { return *m_staging; }
+	inline void ResetFrameStats() noexcept { m_staging->ResetFrameStats(); m_submissionsThisFrame = 0; }
+	ND inline unsigned int SubmissionsThisFrame() const noexcept { return m_submissionsThisFrame; }
+
+private:
+	UploadScheduler(const UploadScheduler&) = delete;
+	UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+	// Allocator/list pairs are recycled once the fence value of their last submission has completed
+	struct CommandContext
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator = nullptr;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> CommandList = nullptr;
+		UINT64 FenceValue = 0;
+	};
+	ND CommandContext& AcquireContext();
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_queue = nullptr;
+	Microsoft::WRL::ComPtr<ID3D12Fence> m_fence = nullptr;
+	HANDLE m_fenceEvent = nullptr;
+	UINT64 m_lastSubmittedFenceValue = 0;
+	UINT64 m_lastQueueWaitFenceValue = 0; // Most recent value passed to WaitOnQueue() (only for a single queue)
+	unsigned int m_submissionsThisFrame = 0;
+
+	std::vector<CommandContext> m_contexts;
+	std::unique_ptr<StagingUploader> m_staging = nullptr;
+};
+}
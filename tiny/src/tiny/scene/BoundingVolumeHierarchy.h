@@ -0,0 +1,386 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+#include "tiny/utils/MathHelper.h"
+#include "tiny/utils/Profile.h"
+
+
+namespace tiny
+{
+// BoundingVolumeHierarchy is a dynamic AABB tree. Each leaf holds the world space bounds of one value, and each
+// internal node holds the union of its two children. It supports:
+//    - Insert/Remove in O(log n) (on average)
+//    - Refit: when a value moves, only its leaf and that leaf's ancestors are updated. Refitting never changes the
+//      structure of the tree, so the tree slowly degrades as values move. Call Rebuild() to rebuild it from scratch
+//    - Frustum queries that skip entire subtrees that are fully inside/outside of the frustum
+//    - Ray casts that return the closest leaf whose bounds are hit
+template<typename T>
+class BoundingVolumeHierarchy
+{
+public:
+	static constexpr int NullNode = -1;
+
+	BoundingVolumeHierarchy() noexcept = default;
+	BoundingVolumeHierarchy(BoundingVolumeHierarchy&&) noexcept = default;
+	BoundingVolumeHierarchy& operator=(BoundingVolumeHierarchy&&) noexcept = default;
+	~BoundingVolumeHierarchy() noexcept {}
+
+	// Returns the proxy id for the value. The id stays valid until the value is removed (even across Rebuild())
+	ND int Insert(const DirectX::BoundingBox& bounds, T* value)
+	{
+		int leaf = AllocateNode();
+		m_nodes[leaf].Bounds = bounds;
+		m_nodes[leaf].Value = value;
+		InsertLeaf(leaf);
+		++m_leafCount;
+		return leaf;
+	}
+	void Remove(int proxy) noexcept
+	{
+		TINY_CORE_ASSERT(IsLeaf(proxy), "Proxy is not a leaf of this BVH");
+		RemoveLeaf(proxy);
+		FreeNode(proxy);
+		--m_leafCount;
+	}
+	// Updates the bounds of a value and refits its ancestors
+	void Refit(int proxy, const DirectX::BoundingBox& bounds) noexcept
+	{
+		TINY_CORE_ASSERT(IsLeaf(proxy), "Proxy is not a leaf of this BVH");
+		m_nodes[proxy].Bounds = bounds;
+		RefitAncestors(m_nodes[proxy].Parent);
+	}
+	// Changes the value a proxy refers to (i.e. when the value has been moved in memory)
+	inline void SetValue(int proxy, T* value) noexcept
+	{
+		TINY_CORE_ASSERT(IsLeaf(proxy), "Proxy is not a leaf of this BVH");
+		m_nodes[proxy].Value = value;
+	}
+	ND inline T* GetValue(int proxy) const noexcept { return m_nodes[proxy].Value; }
+	ND inline const DirectX::BoundingBox& GetBounds(int proxy) const noexcept { return m_nodes[proxy].Bounds; }
+
+	// Rebuilds the tree top-down by splitting each node's leaves at the median of its longest axis. Leaves (and therefore
+	// proxy ids) are kept, only the internal nodes are recreated
+	void Rebuild()
+	{
+		PROFILE_FUNCTION();
+
+		std::vector<int> leaves;
+		leaves.reserve(m_leafCount);
+		for (int iii = 0; iii < static_cast<int>(m_nodes.size()); ++iii)
+		{
+			if (m_nodes[iii].Height == 0)
+				leaves.push_back(iii);
+			else if (m_nodes[iii].Height > 0)
+				FreeNode(iii);
+		}
+
+		m_root = leaves.size() > 0 ? BuildTopDown(leaves.data(), leaves.size()) : NullNode;
+		if (m_root != NullNode)
+			m_nodes[m_root].Parent = NullNode;
+	}
+
+	// Calls f(T*) for every value whose bounds are entirely outside of the planes (see BoundingFrustum::GetPlanes)
+	template<typename F>
+	void ForEachOutside(const DirectX::XMVECTOR* planes, F&& f) const
+	{
+		Query(planes, std::forward<F>(f), true);
+	}
+	// Calls f(T*) for every value whose bounds are inside of or intersect the planes
+	template<typename F>
+	void ForEachInside(const DirectX::XMVECTOR* planes, F&& f) const
+	{
+		Query(planes, std::forward<F>(f), false);
+	}
+
+	// Returns the value with the closest bounds hit by the ray (or nullptr). 'direction' must be normalized
+	ND T* RayCast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float& distance) const
+	{
+		T* closest = nullptr;
+		distance = FLT_MAX;
+		if (m_root == NullNode)
+			return nullptr;
+
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(m_root);
+		while (stack.size() > 0)
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+
+			// NOTE: The distance is negative if the origin is inside the box
+			float d = 0.0f;
+			if (!node.Bounds.Intersects(origin, direction, d))
+				continue;
+			d = MathHelper::Max(d, 0.0f);
+			if (d >= distance)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				distance = d;
+				closest = node.Value;
+			}
+			else
+			{
+				stack.push_back(node.Left);
+				stack.push_back(node.Right);
+			}
+		}
+		return closest;
+	}
+
+	ND inline size_t size() const noexcept { return m_leafCount; }
+	ND inline int GetHeight() const noexcept { return m_root == NullNode ? 0 : m_nodes[m_root].Height; }
+
+private:
+	BoundingVolumeHierarchy(const BoundingVolumeHierarchy&) = delete;
+	BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy&) = delete;
+
+	struct Node
+	{
+		DirectX::BoundingBox Bounds;
+		T* Value = nullptr;
+		int Parent = NullNode;	// Also used as the 'next' link when the node is on the free list
+		int Left = NullNode;
+		int Right = NullNode;
+		int Height = -1;		// 0 for leaves, -1 for free nodes
+
+		ND inline bool IsLeaf() const noexcept { return Left == NullNode; }
+	};
+
+	ND inline bool IsLeaf(int node) const noexcept { return node >= 0 && node < static_cast<int>(m_nodes.size()) && m_nodes[node].Height == 0; }
+
+	ND static inline float SurfaceArea(const DirectX::BoundingBox& box) noexcept
+	{
+		const DirectX::XMFLOAT3& e = box.Extents;
+		return 8.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+	}
+	ND static inline DirectX::BoundingBox Union(const DirectX::BoundingBox& a, const DirectX::BoundingBox& b) noexcept
+	{
+		DirectX::BoundingBox result;
+		DirectX::BoundingBox::CreateMerged(result, a, b);
+		return result;
+	}
+
+	ND int AllocateNode()
+	{
+		if (m_freeList == NullNode)
+		{
+			m_nodes.emplace_back();
+			m_nodes.back().Height = 0;
+			return static_cast<int>(m_nodes.size()) - 1;
+		}
+
+		int node = m_freeList;
+		m_freeList = m_nodes[node].Parent;
+		m_nodes[node] = Node();
+		m_nodes[node].Height = 0;
+		return node;
+	}
+	void FreeNode(int node) noexcept
+	{
+		m_nodes[node].Parent = m_freeList;
+		m_nodes[node].Value = nullptr;
+		m_nodes[node].Height = -1;
+		m_freeList = node;
+	}
+
+	void InsertLeaf(int leaf)
+	{
+		if (m_root == NullNode)
+		{
+			m_root = leaf;
+			m_nodes[leaf].Parent = NullNode;
+			return;
+		}
+
+		// Walk down the tree, at each level choosing the child whose surface area grows the least (the same cost
+		// heuristic as Box2D's dynamic tree)
+		const DirectX::BoundingBox leafBounds = m_nodes[leaf].Bounds;
+		int sibling = m_root;
+		while (!m_nodes[sibling].IsLeaf())
+		{
+			const Node& node = m_nodes[sibling];
+			const float area = SurfaceArea(node.Bounds);
+			const float combinedArea = SurfaceArea(Union(node.Bounds, leafBounds));
+
+			// Cost of creating a new parent for this node and the new leaf, and the cost pushed down to the children
+			const float cost = 2.0f * combinedArea;
+			const float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto childCost = [&](int child)
+			{
+				const Node& c = m_nodes[child];
+				float newArea = SurfaceArea(Union(c.Bounds, leafBounds));
+				return c.IsLeaf() ? newArea + inheritanceCost : (newArea - SurfaceArea(c.Bounds)) + inheritanceCost;
+			};
+			const float costLeft = childCost(node.Left);
+			const float costRight = childCost(node.Right);
+
+			if (cost < costLeft && cost < costRight)
+				break;
+
+			sibling = costLeft < costRight ? node.Left : node.Right;
+		}
+
+		// Create a new parent for the sibling and the leaf
+		const int oldParent = m_nodes[sibling].Parent;
+		const int newParent = AllocateNode();
+		m_nodes[newParent].Parent = oldParent;
+		m_nodes[newParent].Bounds = Union(leafBounds, m_nodes[sibling].Bounds);
+		m_nodes[newParent].Height = m_nodes[sibling].Height + 1;
+		m_nodes[newParent].Left = sibling;
+		m_nodes[newParent].Right = leaf;
+		m_nodes[sibling].Parent = newParent;
+		m_nodes[leaf].Parent = newParent;
+
+		if (oldParent == NullNode)
+			m_root = newParent;
+		else if (m_nodes[oldParent].Left == sibling)
+			m_nodes[oldParent].Left = newParent;
+		else
+			m_nodes[oldParent].Right = newParent;
+
+		RefitAncestors(newParent);
+	}
+	void RemoveLeaf(int leaf) noexcept
+	{
+		if (leaf == m_root)
+		{
+			m_root = NullNode;
+			return;
+		}
+
+		// Replace the parent with the leaf's sibling
+		const int parent = m_nodes[leaf].Parent;
+		const int grandParent = m_nodes[parent].Parent;
+		const int sibling = m_nodes[parent].Left == leaf ? m_nodes[parent].Right : m_nodes[parent].Left;
+
+		if (grandParent == NullNode)
+		{
+			m_root = sibling;
+			m_nodes[sibling].Parent = NullNode;
+		}
+		else
+		{
+			if (m_nodes[grandParent].Left == parent)
+				m_nodes[grandParent].Left = sibling;
+			else
+				m_nodes[grandParent].Right = sibling;
+			m_nodes[sibling].Parent = grandParent;
+			RefitAncestors(grandParent);
+		}
+		FreeNode(parent);
+	}
+	void RefitAncestors(int node) noexcept
+	{
+		while (node != NullNode)
+		{
+			Node& n = m_nodes[node];
+			n.Bounds = Union(m_nodes[n.Left].Bounds, m_nodes[n.Right].Bounds);
+			n.Height = 1 + MathHelper::Max(m_nodes[n.Left].Height, m_nodes[n.Right].Height);
+			node = n.Parent;
+		}
+	}
+
+	ND int BuildTopDown(int* leaves, size_t count)
+	{
+		if (count == 1)
+			return leaves[0];
+
+		// Split at the median centroid along the longest axis of the centroid bounds
+		DirectX::XMVECTOR minCentroid = DirectX::XMLoadFloat3(&m_nodes[leaves[0]].Bounds.Center);
+		DirectX::XMVECTOR maxCentroid = minCentroid;
+		for (size_t iii = 1; iii < count; ++iii)
+		{
+			DirectX::XMVECTOR c = DirectX::XMLoadFloat3(&m_nodes[leaves[iii]].Bounds.Center);
+			minCentroid = DirectX::XMVectorMin(minCentroid, c);
+			maxCentroid = DirectX::XMVectorMax(maxCentroid, c);
+		}
+		DirectX::XMFLOAT3 size;
+		DirectX::XMStoreFloat3(&size, DirectX::XMVectorSubtract(maxCentroid, minCentroid));
+		const int axis = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+
+		const size_t half = count / 2;
+		std::nth_element(leaves, leaves + half, leaves + count, [this, axis](int a, int b)
+			{
+				return (&m_nodes[a].Bounds.Center.x)[axis] < (&m_nodes[b].Bounds.Center.x)[axis];
+			}
+		);
+
+		const int left = BuildTopDown(leaves, half);
+		const int right = BuildTopDown(leaves + half, count - half);
+
+		const int node = AllocateNode();
+		Node& n = m_nodes[node];
+		n.Left = left;
+		n.Right = right;
+		n.Bounds = Union(m_nodes[left].Bounds, m_nodes[right].Bounds);
+		n.Height = 1 + MathHelper::Max(m_nodes[left].Height, m_nodes[right].Height);
+		m_nodes[left].Parent = node;
+		m_nodes[right].Parent = node;
+		return node;
+	}
+
+	template<typename F>
+	void Query(const DirectX::XMVECTOR* planes, F&& f, bool reportOutside) const
+	{
+		if (m_root == NullNode)
+			return;
+
+		std::vector<int> stack;
+		stack.reserve(64);
+		stack.push_back(m_root);
+		while (stack.size() > 0)
+		{
+			const int index = stack.back();
+			stack.pop_back();
+			const Node& node = m_nodes[index];
+
+			DirectX::ContainmentType containment = node.Bounds.ContainedBy(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5]);
+			if (node.IsLeaf())
+			{
+				if ((containment == DirectX::DISJOINT) == reportOutside)
+					f(node.Value);
+			}
+			else if (containment == DirectX::INTERSECTS)
+			{
+				stack.push_back(node.Left);
+				stack.push_back(node.Right);
+			}
+			else if ((containment == DirectX::DISJOINT) == reportOutside)
+			{
+				// The whole subtree has the same result, so report every leaf without testing it
+				ForEachLeaf(index, f);
+			}
+		}
+	}
+	template<typename F>
+	void ForEachLeaf(int root, F& f) const
+	{
+		std::vector<int> stack;
+		stack.push_back(root);
+		while (stack.size() > 0)
+		{
+			const Node& node = m_nodes[stack.back()];
+			stack.pop_back();
+			if (node.IsLeaf())
+			{
+				f(node.Value);
+			}
+			else
+			{
+				stack.push_back(node.Left);
+				stack.push_back(node.Right);
+			}
+		}
+	}
+
+	std::vector<Node> m_nodes;
+	int m_root = NullNode;
+	int m_freeList = NullNode;
+	size_t m_leafCount = 0;
+};
+}
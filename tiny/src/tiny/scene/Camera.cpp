@@ -157,4 +157,29 @@ void Camera::UpdateViewMatrix() noexcept
 		m_viewDirty = false;
 	}
 }
+
+DirectX::BoundingFrustum Camera::GetWorldFrustum() const noexcept
+{
+	// Build the frustum in view space from the projection, then move it into world space with the inverse view
+	BoundingFrustum frustum;
+	BoundingFrustum::CreateFromMatrix(frustum, GetProj());
+
+	XMMATRIX view = GetView();
+	XMVECTOR det = XMMatrixDeterminant(view);
+	frustum.Transform(frustum, XMMatrixInverse(&det, view));
+	return frustum;
+}
+void Camera::GetPickingRay(float screenX, float screenY, float screenWidth, float screenHeight, XMVECTOR& origin, XMVECTOR& direction) const noexcept
+{
+	// Compute the ray in view space (it starts at the eye and passes through the point on the near plane)
+	float vx = (+2.0f * screenX / screenWidth - 1.0f) / m_proj(0, 0);
+	float vy = (-2.0f * screenY / screenHeight + 1.0f) / m_proj(1, 1);
+
+	XMMATRIX view = GetView();
+	XMVECTOR det = XMMatrixDeterminant(view);
+	XMMATRIX invView = XMMatrixInverse(&det, view);
+
+	origin = XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), invView);
+	direction = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(vx, vy, 1.0f, 0.0f), invView));
+}
 }
\ No newline at end of file
@@ -69,6 +69,12 @@ public:
 	}
 	ND inline DirectX::XMFLOAT4X4 GetProj4x4f() const noexcept { return m_proj; }
 
+	// Get the view frustum in world space (i.e. for frustum culling).
+	ND DirectX::BoundingFrustum GetWorldFrustum() const noexcept;
+
+	// Get the world space picking ray through a point on the screen (direction is normalized).
+	void GetPickingRay(float screenX, float screenY, float screenWidth, float screenHeight, DirectX::XMVECTOR& origin, DirectX::XMVECTOR& direction) const noexcept;
+
 	// Strafe/Walk the camera a distance d.
 	void Strafe(float d) noexcept;
 	void Walk(float d) noexcept;
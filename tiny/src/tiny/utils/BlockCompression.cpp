@@ -0,0 +1,521 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace tiny
+{
+namespace bc
+{
+namespace
+{
+struct Color
+{
+	float r = 0.0f;
+	float g = 0.0f;
+	float b = 0.0f;
+};
+
+ND inline Color operator+(const Color& lhs, const Color& rhs) noexcept { return { lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b }; }
+ND inline Color operator-(const Color& lhs, const Color& rhs) noexcept { return { lhs.r - rhs.r, lhs.g - rhs.g, lhs.b - rhs.b }; }
+ND inline Color operator*(const Color& lhs, float rhs) noexcept { return { lhs.r * rhs, lhs.g * rhs, lhs.b * rhs }; }
+ND inline float Dot(const Color& lhs, const Color& rhs) noexcept { return lhs.r * rhs.r + lhs.g * rhs.g + lhs.b * rhs.b; }
+
+// BC1 ==========================================================================================================
+// 565 endpoints. In '4 color' mode (color0 > color1) the palette is c0, c1, 2/3 c0 + 1/3 c1 and 1/3 c0 + 2/3 c1. In
+// '3 color' mode (color0 <= color1) it is c0, c1, 1/2 c0 + 1/2 c1 and transparent black
+ND inline uint32_t Quantize(float value, uint32_t maxValue) noexcept
+{
+	const float scaled = value * maxValue / 255.0f + 0.5f;
+	return scaled <= 0.0f ? 0 : std::min(static_cast<uint32_t>(scaled), maxValue);
+}
+ND inline uint32_t Expand5(uint32_t value) noexcept { return (value << 3) | (value >> 2); }
+ND inline uint32_t Expand6(uint32_t value) noexcept { return (value << 2) | (value >> 4); }
+
+ND inline uint16_t Pack565(const Color& color) noexcept
+{
+	return static_cast<uint16_t>((Quantize(color.r, 31) << 11) | (Quantize(color.g, 63) << 5) | Quantize(color.b, 31));
+}
+ND inline Color Unpack565(uint16_t packed) noexcept
+{
+	return {
+		static_cast<float>(Expand5(packed >> 11)),
+		static_cast<float>(Expand6((packed >> 5) & 0x3F)),
+		static_cast<float>(Expand5(packed & 0x1F))
+	};
+}
+
+// For blocks of a single color: the pair of 5 (or 6) bit endpoints whose 2/3 + 1/3 mix is closest to each 8 bit
+// value. Much closer than quantizing the color itself (which is off by up to 4 for the 5 bit channels)
+struct SingleColorTables
+{
+	SingleColorTables() noexcept
+	{
+		Build(Table5, 31, Expand5);
+		Build(Table6, 63, Expand6);
+	}
+
+	struct Entry
+	{
+		uint8_t Endpoint0 = 0;
+		uint8_t Endpoint1 = 0;
+	};
+
+	template<typename ExpandFn>
+	static void Build(std::array<Entry, 256>& table, uint32_t maxValue, ExpandFn expand) noexcept
+	{
+		for (int value = 0; value < 256; ++value)
+		{
+			int bestError = INT32_MAX;
+			for (uint32_t e0 = 0; e0 <= maxValue; ++e0)
+			{
+				for (uint32_t e1 = 0; e1 <= maxValue; ++e1)
+				{
+					// Decoders are allowed some leeway here, so only use pairs that are not far apart
+					const int c0 = static_cast<int>(expand(e0));
+					const int c1 = static_cast<int>(expand(e1));
+					const int error = std::abs((2 * c0 + c1) / 3 - value) * 100 + std::abs(c0 - c1) * 3;
+					if (error < bestError)
+					{
+						bestError = error;
+						table[value] = { static_cast<uint8_t>(e0), static_cast<uint8_t>(e1) };
+					}
+				}
+			}
+		}
+	}
+
+	std::array<Entry, 256> Table5 = {};
+	std::array<Entry, 256> Table6 = {};
+};
+
+const SingleColorTables& GetSingleColorTables() noexcept
+{
+	static const SingleColorTables tables;
+	return tables;
+}
+
+struct BC1Input
+{
+	std::array<Color, 16> Colors;
+	uint32_t TransparentMask = 0; // Bit i is set if texel i has alpha < 128
+};
+
+struct BC1Encoding
+{
+	uint16_t Color0 = 0;
+	uint16_t Color1 = 0;
+	uint32_t Indices = 0;
+	float Error = 0.0f;
+};
+
+// Builds the block for (already chosen) endpoints: quantizes them, orders them for the mode, and picks the closest
+// palette entry for each texel
+BC1Encoding EncodeBC1(const BC1Input& input, const Color& endpoint0, const Color& endpoint1, bool threeColor) noexcept
+{
+	BC1Encoding encoding;
+	encoding.Color0 = Pack565(endpoint0);
+	encoding.Color1 = Pack565(endpoint1);
+
+	if (threeColor ? encoding.Color0 > encoding.Color1 : encoding.Color0 < encoding.Color1)
+		std::swap(encoding.Color0, encoding.Color1);
+
+	const Color c0 = Unpack565(encoding.Color0);
+	const Color c1 = Unpack565(encoding.Color1);
+
+	// The palette colors are evenly spaced along the line from c0 to c1, so the closest one is found by rounding the
+	// texel's position along that line. When the endpoints end up equal, it is a 3 color block, and index 0 is right
+	// for every opaque texel
+	static constexpr unsigned int FourColorIndices[4] = { 0, 2, 3, 1 };	// Palette order along the line
+	static constexpr unsigned int ThreeColorIndices[3] = { 0, 2, 1 };
+	const bool fourColor = encoding.Color0 > encoding.Color1;
+	const unsigned int steps = fourColor ? 3 : 2;
+	const unsigned int* indices = fourColor ? FourColorIndices : ThreeColorIndices;
+
+	const Color direction = c1 - c0;
+	const float lengthSquared = Dot(direction, direction);
+	const float toStep = lengthSquared > 0.0f ? steps / lengthSquared : 0.0f;
+	const Color stepSize = direction * (1.0f / steps);
+
+	for (unsigned int texel = 0; texel < 16; ++texel)
+	{
+		unsigned int index = 3;
+		if (!(input.TransparentMask & (1u << texel)))
+		{
+			const Color offset = input.Colors[texel] - c0;
+			const float position = std::clamp(Dot(offset, direction) * toStep + 0.5f, 0.0f, steps + 0.5f);
+			const unsigned int step = std::min(static_cast<unsigned int>(position), steps);
+
+			const Color difference = offset - stepSize * static_cast<float>(step);
+			encoding.Error += Dot(difference, difference);
+			index = indices[step];
+		}
+		encoding.Indices |= index << (texel * 2);
+	}
+	return encoding;
+}
+
+// Least squares endpoints for the indices of 'encoding': each opaque texel is a known mix (weight, 1 - weight) of
+// the two endpoints, so minimizing the squared error is a 2x2 linear system per channel. Returns false if the
+// system is singular (i.e. every texel uses the same index)
+bool FitEndpoints(const BC1Input& input, const BC1Encoding& encoding, Color& endpoint0, Color& endpoint1) noexcept
+{
+	static constexpr float FourColorWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	static constexpr float ThreeColorWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+	const float* weights = encoding.Color0 > encoding.Color1 ? FourColorWeights : ThreeColorWeights;
+
+	float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+	Color ax, bx;
+	for (unsigned int texel = 0; texel < 16; ++texel)
+	{
+		if (input.TransparentMask & (1u << texel))
+			continue;
+
+		const float a = weights[(encoding.Indices >> (texel * 2)) & 3];
+		const float b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		ax = ax + input.Colors[texel] * a;
+		bx = bx + input.Colors[texel] * b;
+	}
+
+	const float determinant = aa * bb - ab * ab;
+	if (std::abs(determinant) < 1e-6f)
+		return false;
+
+	const float inverse = 1.0f / determinant;
+	endpoint0 = (ax * bb - bx * ab) * inverse;
+	endpoint1 = (bx * aa - ax * ab) * inverse;
+	return true;
+}
+
+bool TrySingleColor(const BC1Input& input, BC1Encoding& encoding) noexcept
+{
+	const Color* first = nullptr;
+	for (unsigned int texel = 0; texel < 16; ++texel)
+	{
+		if (input.TransparentMask & (1u << texel))
+			continue;
+
+		const Color& color = input.Colors[texel];
+		if (first == nullptr)
+			first = &color;
+		else if (color.r != first->r || color.g != first->g || color.b != first->b)
+			return false;
+	}
+	if (first == nullptr || input.TransparentMask != 0)
+		return false; // Fully transparent, or needs 3 color mode (where the 1/3 mixes don't exist)
+
+	const SingleColorTables& tables = GetSingleColorTables();
+	const auto& r = tables.Table5[static_cast<uint8_t>(first->r)];
+	const auto& g = tables.Table6[static_cast<uint8_t>(first->g)];
+	const auto& b = tables.Table5[static_cast<uint8_t>(first->b)];
+
+	encoding.Color0 = static_cast<uint16_t>((r.Endpoint0 << 11) | (g.Endpoint0 << 5) | b.Endpoint0);
+	encoding.Color1 = static_cast<uint16_t>((r.Endpoint1 << 11) | (g.Endpoint1 << 5) | b.Endpoint1);
+
+	if (encoding.Color0 == encoding.Color1)
+	{
+		encoding.Indices = 0;							// Every palette entry is the same color
+	}
+	else if (encoding.Color0 > encoding.Color1)
+	{
+		encoding.Indices = 0xAAAAAAAA;					// Index 2 (2/3 c0 + 1/3 c1)
+	}
+	else
+	{
+		std::swap(encoding.Color0, encoding.Color1);
+		encoding.Indices = 0xFFFFFFFF;					// Index 3 (1/3 c0 + 2/3 c1), with the endpoints swapped
+	}
+	return true;
+}
+
+// BC4 ==========================================================================================================
+// 8 value mode (v0 > v1): v0, v1 and 6 mixes. 6 value mode (v0 <= v1): v0, v1, 4 mixes, 0 and 255
+struct BC4Encoding
+{
+	uint8_t Value0 = 0;
+	uint8_t Value1 = 0;
+	uint64_t Indices = 0;
+	float Error = 0.0f;
+};
+
+BC4Encoding EncodeBC4(const uint8_t values[16], uint8_t value0, uint8_t value1) noexcept
+{
+	BC4Encoding encoding;
+	encoding.Value0 = value0;
+	encoding.Value1 = value1;
+
+	// Like BC1, the mixes are evenly spaced from v0 to v1 (step 0 is index 0, the last step is index 1 and step k in
+	// between is index k + 1), so the closest one is found by rounding. 6 value mode also checks 0 and 255
+	const bool eightValues = value0 > value1;
+	const unsigned int steps = eightValues ? 7 : 5;
+	const float range = static_cast<float>(value1) - value0;
+	const float toStep = range != 0.0f ? steps / range : 0.0f;
+	const float stepSize = range / steps;
+
+	for (unsigned int texel = 0; texel < 16; ++texel)
+	{
+		const float value = values[texel];
+		const float offset = value - value0;
+		const float position = std::clamp(offset * toStep + 0.5f, 0.0f, steps + 0.5f);
+		const unsigned int step = std::min(static_cast<unsigned int>(position), steps);
+
+		const float difference = offset - stepSize * step;
+		float error = difference * difference;
+		unsigned int index = step == 0 ? 0 : (step == steps ? 1 : step + 1);
+
+		if (!eightValues)
+		{
+			if (value * value < error)
+			{
+				error = value * value;
+				index = 6;
+			}
+			if ((255.0f - value) * (255.0f - value) < error)
+			{
+				error = (255.0f - value) * (255.0f - value);
+				index = 7;
+			}
+		}
+
+		encoding.Error += error;
+		encoding.Indices |= static_cast<uint64_t>(index) << (texel * 3);
+	}
+	return encoding;
+}
+
+// Gathers one 4x4 block, repeating the last row/column for partial blocks
+template<typename Fn>
+inline void ForEachTexel(const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch, uint32_t blockX, uint32_t blockY, Fn fn) noexcept
+{
+	for (uint32_t y = 0; y < 4; ++y)
+	{
+		const uint8_t* row = pixels + std::min(blockY * 4 + y, height - 1) * rowPitch;
+		for (uint32_t x = 0; x < 4; ++x)
+			fn(y * 4 + x, row + std::min(blockX * 4 + x, width - 1) * 4);
+	}
+}
+
+} // namespace
+
+
+void CompressBC1Block(const uint8_t rgba[16 * 4], uint8_t block[8]) noexcept
+{
+	BC1Input input;
+	for (unsigned int texel = 0; texel < 16; ++texel)
+	{
+		const uint8_t* p = rgba + texel * 4;
+		input.Colors[texel] = { static_cast<float>(p[0]), static_cast<float>(p[1]), static_cast<float>(p[2]) };
+		if (p[3] < 128)
+			input.TransparentMask |= 1u << texel;
+	}
+
+	BC1Encoding best;
+	if (input.TransparentMask == 0xFFFF)
+	{
+		best.Indices = 0xFFFFFFFF; // 3 color mode (both endpoints 0), every texel transparent
+	}
+	else if (!TrySingleColor(input, best))
+	{
+		// Principal axis of the opaque colors (power iteration on the covariance matrix)
+		Color mean;
+		unsigned int count = 0;
+		for (unsigned int texel = 0; texel < 16; ++texel)
+		{
+			if (!(input.TransparentMask & (1u << texel)))
+			{
+				mean = mean + input.Colors[texel];
+				++count;
+			}
+		}
+		mean = mean * (1.0f / count);
+
+		float rr = 0.0f, rg = 0.0f, rb = 0.0f, gg = 0.0f, gb = 0.0f, bb = 0.0f;
+		Color minimum = { FLT_MAX, FLT_MAX, FLT_MAX };
+		Color maximum = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+		for (unsigned int texel = 0; texel < 16; ++texel)
+		{
+			if (input.TransparentMask & (1u << texel))
+				continue;
+
+			const Color& color = input.Colors[texel];
+			const Color d = color - mean;
+			rr += d.r * d.r; rg += d.r * d.g; rb += d.r * d.b;
+			gg += d.g * d.g; gb += d.g * d.b; bb += d.b * d.b;
+			minimum = { std::min(minimum.r, color.r), std::min(minimum.g, color.g), std::min(minimum.b, color.b) };
+			maximum = { std::max(maximum.r, color.r), std::max(maximum.g, color.g), std::max(maximum.b, color.b) };
+		}
+
+		Color axis = maximum - minimum;
+		for (unsigned int iteration = 0; iteration < 4; ++iteration)
+		{
+			axis = {
+				rr * axis.r + rg * axis.g + rb * axis.b,
+				rg * axis.r + gg * axis.g + gb * axis.b,
+				rb * axis.r + gb * axis.g + bb * axis.b
+			};
+			const float length = std::max(std::abs(axis.r), std::max(std::abs(axis.g), std::abs(axis.b)));
+			if (length < 1e-6f)
+				break;
+			axis = axis * (1.0f / length);
+		}
+
+		// The texels at either end of the axis are the starting endpoints
+		Color endpoint0 = maximum;
+		Color endpoint1 = minimum;
+		float lowest = FLT_MAX, highest = -FLT_MAX;
+		for (unsigned int texel = 0; texel < 16; ++texel)
+		{
+			if (input.TransparentMask & (1u << texel))
+				continue;
+
+			const float projection = Dot(input.Colors[texel], axis);
+			if (projection < lowest) { lowest = projection; endpoint1 = input.Colors[texel]; }
+			if (projection > highest) { highest = projection; endpoint0 = input.Colors[texel]; }
+		}
+
+		// Blocks with transparent texels need 3 color mode. Opaque blocks only use 4 color mode: also trying 3 color
+		// mode lowered the error by about 1% on test images, at twice the cost
+		const bool threeColor = input.TransparentMask != 0;
+		best = EncodeBC1(input, endpoint0, endpoint1, threeColor);
+
+		for (unsigned int iteration = 0; iteration < 2; ++iteration)
+		{
+			Color fit0, fit1;
+			if (!FitEndpoints(input, best, fit0, fit1))
+				break;
+
+			const BC1Encoding refined = EncodeBC1(input, fit0, fit1, threeColor);
+			if (refined.Error >= best.Error)
+				break;
+			best = refined;
+		}
+	}
+
+	std::memcpy(block, &best.Color0, 2);
+	std::memcpy(block + 2, &best.Color1, 2);
+	std::memcpy(block + 4, &best.Indices, 4);
+}
+
+void CompressBC4Block(const uint8_t values[16], uint8_t block[8]) noexcept
+{
+	uint8_t minimum = 255, maximum = 0;
+	uint8_t innerMinimum = 255, innerMaximum = 0; // Ignoring 0 and 255 (which the 6 value mode has for free)
+	for (unsigned int texel = 0; texel < 16; ++texel)
+	{
+		const uint8_t value = values[texel];
+		minimum = std::min(minimum, value);
+		maximum = std::max(maximum, value);
+		if (value != 0 && value != 255)
+		{
+			innerMinimum = std::min(innerMinimum, value);
+			innerMaximum = std::max(innerMaximum, value);
+		}
+	}
+
+	BC4Encoding best;
+	if (minimum == maximum)
+	{
+		best.Value0 = minimum; // Both endpoints the same, every index 0
+		best.Value1 = minimum;
+	}
+	else
+	{
+		best = EncodeBC4(values, maximum, minimum);
+
+		if (innerMinimum > innerMaximum)
+		{
+			innerMinimum = 0; // Only 0s and 255s: any endpoints work, indices 6 and 7 are exact
+			innerMaximum = 0;
+		}
+
+		const BC4Encoding sixValues = EncodeBC4(values, innerMinimum, innerMaximum);
+		if (sixValues.Error < best.Error)
+			best = sixValues;
+	}
+
+	block[0] = best.Value0;
+	block[1] = best.Value1;
+	for (unsigned int iii = 0; iii < 6; ++iii)
+		block[2 + iii] = static_cast<uint8_t>(best.Indices >> (iii * 8));
+}
+
+bool IsSupported(DXGI_FORMAT format) noexcept
+{
+	return BlockSize(format) != 0;
+}
+size_t BlockSize(DXGI_FORMAT format) noexcept
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_UNORM:			return 8;
+	case DXGI_FORMAT_BC5_UNORM:			return 16;
+	default:							return 0;
+	}
+}
+
+void CompressBlockRows(DXGI_FORMAT format, const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch,
+					   uint8_t* blocks, size_t blockRowPitch, uint32_t firstBlockRow, uint32_t blockRowCount) noexcept
+{
+	const size_t blockSize = BlockSize(format);
+	const uint32_t blocksWide = BlockCount(width);
+	const uint32_t lastBlockRow = std::min(firstBlockRow + blockRowCount, BlockCount(height));
+
+	for (uint32_t blockY = firstBlockRow; blockY < lastBlockRow; ++blockY)
+	{
+		uint8_t* out = blocks + blockY * blockRowPitch;
+		for (uint32_t blockX = 0; blockX < blocksWide; ++blockX, out += blockSize)
+		{
+			switch (format)
+			{
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+			{
+				// NOTE: sRGB blocks are fit in sRGB space, like most encoders do
+				uint8_t rgba[16 * 4];
+				ForEachTexel(pixels, width, height, rowPitch, blockX, blockY, [&](uint32_t texel, const uint8_t* p) { std::memcpy(rgba + texel * 4, p, 4); });
+				CompressBC1Block(rgba, out);
+				break;
+			}
+			case DXGI_FORMAT_BC4_UNORM:
+			{
+				uint8_t red[16];
+				ForEachTexel(pixels, width, height, rowPitch, blockX, blockY, [&](uint32_t texel, const uint8_t* p) { red[texel] = p[0]; });
+				CompressBC4Block(red, out);
+				break;
+			}
+			case DXGI_FORMAT_BC5_UNORM:
+			{
+				uint8_t red[16], green[16];
+				ForEachTexel(pixels, width, height, rowPitch, blockX, blockY, [&](uint32_t texel, const uint8_t* p) { red[texel] = p[0]; green[texel] = p[1]; });
+				CompressBC4Block(red, out);
+				CompressBC4Block(green, out + 8);
+				break;
+			}
+			default:
+				return;
+			}
+		}
+	}
+}
+
+std::vector<uint8_t> Compress(DXGI_FORMAT format, const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch)
+{
+	if (!IsSupported(format) || pixels == nullptr || width == 0 || height == 0)
+		return {};
+
+	const size_t blockRowPitch = RowPitch(format, width);
+	std::vector<uint8_t> blocks(blockRowPitch * BlockCount(height));
+	CompressBlockRows(format, pixels, width, height, rowPitch, blocks.data(), blockRowPitch, 0, BlockCount(height));
+	return blocks;
+}
+
+}
+}
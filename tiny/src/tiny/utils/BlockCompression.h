@@ -0,0 +1,43 @@
+#pragma once
+#include "tiny/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DxgiFormat.h"
+
+namespace tiny
+{
+namespace bc
+{
+// CPU block compression for static textures:
+//     BC1 (and BC1 sRGB): RGB plus 1 bit alpha, from R8G8B8A8 texels. Texels with alpha < 128 become transparent
+//     BC4: one channel, from the red channel
+//     BC5: two channels, from the red and green channels
+//
+// The input is always R8G8B8A8 (the channels a format doesn't use are ignored), so a level of a mips::Generate()
+// chain can be passed straight in. BC1 endpoints start on the principal axis of the block's colors and are refined
+// with a least squares fit, BC4 tries both of its modes. Partial blocks at the right/bottom edge repeat the last
+// row/column. Nothing here touches a device, so it can also run offline
+
+// BC1_UNORM, BC1_UNORM_SRGB, BC4_UNORM or BC5_UNORM
+ND bool IsSupported(DXGI_FORMAT format) noexcept;
+ND size_t BlockSize(DXGI_FORMAT format) noexcept; // 8 or 16 bytes
+ND inline uint32_t BlockCount(uint32_t texels) noexcept { return (texels + 3) / 4; }
+ND inline size_t RowPitch(DXGI_FORMAT format, uint32_t width) noexcept { return BlockCount(width) * BlockSize(format); }
+
+// Compresses block rows [firstBlockRow, firstBlockRow + blockRowCount). Rows don't depend on each other, so large
+// surfaces can be split across threads. 'blocks' points at the first block row of the surface (not at firstBlockRow)
+void CompressBlockRows(DXGI_FORMAT format, const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch,
+					   uint8_t* blocks, size_t blockRowPitch, uint32_t firstBlockRow, uint32_t blockRowCount) noexcept;
+
+// Whole surface, tightly packed (RowPitch(format, width) bytes per block row). Empty if the format is not supported
+ND std::vector<uint8_t> Compress(DXGI_FORMAT format, const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch);
+
+// Single blocks. Texels are in row order
+void CompressBC1Block(const uint8_t rgba[16 * 4], uint8_t block[8]) noexcept;
+void CompressBC4Block(const uint8_t values[16], uint8_t block[8]) noexcept;
+
+}
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+
+
+namespace tiny
+{
+namespace utility
+{
+
+// BuddyAllocator hands out ranges of a fixed size address space. The space is split into blocks of
+// MinBlockSize * 2^order bytes, and every block is aligned to its own size. Freeing a block merges it with its
+// buddy (the other half of the block it was split from) whenever the buddy is also free.
+//
+// It only does the bookkeeping (offsets), so it knows nothing about D3D12 and can be exercised on the CPU alone
+class BuddyAllocator
+{
+public:
+	struct Block
+	{
+		UINT64 Offset = 0;
+		unsigned int Order = 0;
+	};
+
+	BuddyAllocator(UINT64 minBlockSize, unsigned int maxOrder) :
+		m_minBlockSize(minBlockSize),
+		m_maxOrder(maxOrder),
+		m_freeLists(maxOrder + 1)
+	{
+		TINY_CORE_ASSERT(m_minBlockSize > 0, "Min block size must be greater than 0");
+		TINY_CORE_ASSERT(m_maxOrder < 48, "Max order is too large");
+		m_freeLists[m_maxOrder].insert(0);
+	}
+
+	// Returns std::nullopt if there is no free block large enough
+	ND std::optional<Block> Allocate(UINT64 byteSize)
+	{
+		const unsigned int order = OrderFor(byteSize);
+		if (order > m_maxOrder)
+			return std::nullopt;
+
+		// Smallest free block that fits
+		unsigned int available = order;
+		while (available <= m_maxOrder && m_freeLists[available].empty())
+			++available;
+
+		if (available > m_maxOrder)
+			return std::nullopt;
+
+		// Take the lowest offset so allocations stay packed towards the start of the space
+		std::set<UINT64>& freeList = m_freeLists[available];
+		const UINT64 offset = *freeList.begin();
+		freeList.erase(freeList.begin());
+
+		// Split until the block is the requested size. The upper halves become free
+		while (available > order)
+		{
+			--available;
+			m_freeLists[available].insert(offset + BlockSize(available));
+		}
+
+		m_allocatedBytes += BlockSize(order);
+		return Block{ offset, order };
+	}
+
+	void Free(const Block& block)
+	{
+		TINY_CORE_ASSERT(block.Order <= m_maxOrder, "Invalid block order");
+		TINY_CORE_ASSERT(block.Offset % BlockSize(block.Order) == 0, "Block is not aligned to its size");
+		TINY_CORE_ASSERT(m_allocatedBytes >= BlockSize(block.Order), "Freeing more than was allocated");
+
+		m_allocatedBytes -= BlockSize(block.Order);
+
+		UINT64 offset = block.Offset;
+		unsigned int order = block.Order;
+		while (order < m_maxOrder)
+		{
+			const UINT64 buddy = offset ^ BlockSize(order);
+			std::set<UINT64>& freeList = m_freeLists[order];
+			auto it = freeList.find(buddy);
+			if (it == freeList.end())
+				break;
+
+			freeList.erase(it);
+			offset = MathHelper::Min(offset, buddy);
+			++order;
+		}
+		TINY_CORE_ASSERT(!m_freeLists[order].contains(offset), "Block was freed twice");
+		m_freeLists[order].insert(offset);
+	}
+
+	ND inline UINT64 BlockSize(unsigned int order) const noexcept { return m_minBlockSize << order; }
+	ND inline UINT64 Capacity() const noexcept { return BlockSize(m_maxOrder); }
+	ND inline UINT64 AllocatedBytes() const noexcept { return m_allocatedBytes; }
+	ND inline UINT64 FreeBytes() const noexcept { return Capacity() - m_allocatedBytes; }
+	ND inline bool Empty() const noexcept { return m_allocatedBytes == 0; }
+
+	ND UINT64 LargestFreeBlock() const noexcept
+	{
+		for (unsigned int order = m_maxOrder + 1; order-- > 0;)
+		{
+			if (!m_freeLists[order].empty())
+				return BlockSize(order);
+		}
+		return 0;
+	}
+
+	// Smallest order whose block size holds byteSize (greater than the max order if it does not fit at all)
+	ND unsigned int OrderFor(UINT64 byteSize) const noexcept
+	{
+		unsigned int order = 0;
+		while (order <= m_maxOrder && BlockSize(order) < byteSize)
+			++order;
+		return order;
+	}
+
+private:
+	UINT64 m_minBlockSize;
+	unsigned int m_maxOrder;
+	UINT64 m_allocatedBytes = 0;
+
+	// Offsets of the free blocks of each order. std::set keeps them sorted (lowest offset first) and makes the
+	// buddy lookup during Free() logarithmic
+	std::vector<std::set<UINT64>> m_freeLists;
+};
+
+} // namespace utility
+} // namespace tiny
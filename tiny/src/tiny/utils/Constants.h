@@ -3,5 +3,9 @@
 
 namespace tiny
 {
-	const int gNumFrameResources = 3;
+	// Number of frame resources (frames the CPU may record ahead of the GPU). The actual count is a runtime Engine setting
+	// (see Engine::SetFrameResourceCount), these only bound it. 2 favors latency, 3-4 favor throughput
+	constexpr unsigned int gDefaultFrameResources = 3;
+	constexpr unsigned int gMinFrameResources = 1;
+	constexpr unsigned int gMaxFrameResources = 4;
 }
\ No newline at end of file
@@ -0,0 +1,715 @@
+#include "DDSParser.h"
+
+#include <algorithm>
+#include <cstring>
+
+// NOTE: The format tables and the header decoding below started out as the DDSTextureLoader code (see DDS.h in the
+//       'Texconv' sample and the 'DirectXTex' library), but nothing here may touch a device or the file system, so it
+//       can be built (and fuzzed) on any platform.
+
+namespace tiny
+{
+namespace dds
+{
+const char* ToString(Result result) noexcept
+{
+	switch (result)
+	{
+	case Result::Ok:					return "Ok";
+	case Result::TooSmall:				return "TooSmall";
+	case Result::BadMagic:				return "BadMagic";
+	case Result::BadHeader:				return "BadHeader";
+	case Result::UnsupportedFormat:		return "UnsupportedFormat";
+	case Result::UnsupportedDimension:	return "UnsupportedDimension";
+	case Result::InvalidData:			return "InvalidData";
+	case Result::TooLarge:				return "TooLarge";
+	case Result::Truncated:				return "Truncated";
+	case Result::NoSubresources:		return "NoSubresources";
+	}
+	return "Unknown";
+}
+
+size_t BitsPerPixel(DXGI_FORMAT format) noexcept
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_SINT:
+		return 128;
+
+	case DXGI_FORMAT_R32G32B32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_UINT:
+	case DXGI_FORMAT_R32G32B32_SINT:
+		return 96;
+
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_UINT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+	case DXGI_FORMAT_R16G16B16A16_SINT:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32_UINT:
+	case DXGI_FORMAT_R32G32_SINT:
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+	case DXGI_FORMAT_Y416:
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		return 64;
+
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+	case DXGI_FORMAT_R10G10B10A2_UINT:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UINT:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_SINT:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_UINT:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_SINT:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+	case DXGI_FORMAT_AYUV:
+	case DXGI_FORMAT_Y410:
+	case DXGI_FORMAT_YUY2:
+		return 32;
+
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		return 24;
+
+	case DXGI_FORMAT_R8G8_TYPELESS:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8_UINT:
+	case DXGI_FORMAT_R8G8_SNORM:
+	case DXGI_FORMAT_R8G8_SINT:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_D16_UNORM:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_A8P8:
+	case DXGI_FORMAT_B4G4R4A4_UNORM:
+		return 16;
+
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+	case DXGI_FORMAT_NV11:
+		return 12;
+
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SNORM:
+	case DXGI_FORMAT_R8_SINT:
+	case DXGI_FORMAT_A8_UNORM:
+	case DXGI_FORMAT_AI44:
+	case DXGI_FORMAT_IA44:
+	case DXGI_FORMAT_P8:
+		return 8;
+
+	case DXGI_FORMAT_R1_UNORM:
+		return 1;
+
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return 4;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 8;
+
+	default:
+		return 0;
+	}
+}
+
+void GetSurfaceInfo(size_t width, size_t height, DXGI_FORMAT format, size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows) noexcept
+{
+	size_t numBytes = 0;
+	size_t rowBytes = 0;
+	size_t numRows = 0;
+
+	bool bc = false;
+	bool packed = false;
+	bool planar = false;
+	size_t bpe = 0;
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		bc = true;
+		bpe = 8;
+		break;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		bc = true;
+		bpe = 16;
+		break;
+
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_YUY2:
+		packed = true;
+		bpe = 4;
+		break;
+
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		packed = true;
+		bpe = 8;
+		break;
+
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+		planar = true;
+		bpe = 2;
+		break;
+
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		planar = true;
+		bpe = 4;
+		break;
+
+	default:
+		break;
+	}
+
+	if (bc)
+	{
+		size_t numBlocksWide = 0;
+		if (width > 0)
+			numBlocksWide = std::max<size_t>(1, (width + 3) / 4);
+
+		size_t numBlocksHigh = 0;
+		if (height > 0)
+			numBlocksHigh = std::max<size_t>(1, (height + 3) / 4);
+
+		rowBytes = numBlocksWide * bpe;
+		numRows = numBlocksHigh;
+		numBytes = rowBytes * numBlocksHigh;
+	}
+	else if (packed)
+	{
+		rowBytes = ((width + 1) >> 1) * bpe;
+		numRows = height;
+		numBytes = rowBytes * height;
+	}
+	else if (format == DXGI_FORMAT_NV11)
+	{
+		rowBytes = ((width + 3) >> 2) * 4;
+		numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+		numBytes = rowBytes * numRows;
+	}
+	else if (planar)
+	{
+		rowBytes = ((width + 1) >> 1) * bpe;
+		numBytes = (rowBytes * height) + ((rowBytes * height + 1) >> 1);
+		numRows = height + ((height + 1) >> 1);
+	}
+	else
+	{
+		size_t bpp = BitsPerPixel(format);
+		rowBytes = (width * bpp + 7) / 8; // round up to nearest byte
+		numRows = height;
+		numBytes = rowBytes * height;
+	}
+
+	if (outNumBytes)
+		*outNumBytes = numBytes;
+	if (outRowBytes)
+		*outRowBytes = rowBytes;
+	if (outNumRows)
+		*outNumRows = numRows;
+}
+
+DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf) noexcept
+{
+	auto isBitMask = [&ddpf](uint32_t r, uint32_t g, uint32_t b, uint32_t a) noexcept
+	{
+		return ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a;
+	};
+
+	if (ddpf.flags & DDS_RGB)
+	{
+		// Note that sRGB formats are written using the "DX10" extended header
+		switch (ddpf.RGBBitCount)
+		{
+		case 32:
+			if (isBitMask(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+				return DXGI_FORMAT_R8G8B8A8_UNORM;
+
+			if (isBitMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
+				return DXGI_FORMAT_B8G8R8A8_UNORM;
+
+			if (isBitMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
+				return DXGI_FORMAT_B8G8R8X8_UNORM;
+
+			// No DXGI format maps to isBitMask(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+			// Note that many common DDS reader/writers (including D3DX) swap the RED/BLUE masks for 10:10:10:2
+			// formats. We assume below that the 'backwards' header mask is being used since it is most likely
+			// written by D3DX. The more robust solution is to use the 'DX10' header extension and specify the
+			// DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+			// For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+			if (isBitMask(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
+				return DXGI_FORMAT_R10G10B10A2_UNORM;
+
+			// No DXGI format maps to isBitMask(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+			if (isBitMask(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+				return DXGI_FORMAT_R16G16_UNORM;
+
+			if (isBitMask(0xffffffff, 0x00000000, 0x00000000, 0x00000000))
+				return DXGI_FORMAT_R32_FLOAT; // Only 32-bit color channel format in D3D9 was R32F (D3DX writes this out as a FourCC of 114)
+			break;
+
+		case 24:
+			// No 24bpp DXGI formats aka D3DFMT_R8G8B8
+			break;
+
+		case 16:
+			if (isBitMask(0x7c00, 0x03e0, 0x001f, 0x8000))
+				return DXGI_FORMAT_B5G5R5A1_UNORM;
+			if (isBitMask(0xf800, 0x07e0, 0x001f, 0x0000))
+				return DXGI_FORMAT_B5G6R5_UNORM;
+
+			// No DXGI format maps to isBitMask(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+			if (isBitMask(0x0f00, 0x00f0, 0x000f, 0xf000))
+				return DXGI_FORMAT_B4G4R4A4_UNORM;
+
+			// No DXGI format maps to isBitMask(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+			// No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+			break;
+		}
+	}
+	else if (ddpf.flags & DDS_LUMINANCE)
+	{
+		if (8 == ddpf.RGBBitCount)
+		{
+			if (isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x00000000))
+				return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+
+			// No DXGI format maps to isBitMask(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+		}
+
+		if (16 == ddpf.RGBBitCount)
+		{
+			if (isBitMask(0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
+				return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+			if (isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
+				return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+		}
+	}
+	else if (ddpf.flags & DDS_ALPHA)
+	{
+		if (8 == ddpf.RGBBitCount)
+			return DXGI_FORMAT_A8_UNORM;
+	}
+	else if (ddpf.flags & DDS_FOURCC)
+	{
+		switch (ddpf.fourCC)
+		{
+		case MakeFourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+		case MakeFourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+		case MakeFourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+
+		// While pre-multiplied alpha isn't directly supported by the DXGI formats, they are basically the same as
+		// these BC formats so they can be mapped
+		case MakeFourCC('D', 'X', 'T', '2'): return DXGI_FORMAT_BC2_UNORM;
+		case MakeFourCC('D', 'X', 'T', '4'): return DXGI_FORMAT_BC3_UNORM;
+
+		case MakeFourCC('A', 'T', 'I', '1'): return DXGI_FORMAT_BC4_UNORM;
+		case MakeFourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+		case MakeFourCC('B', 'C', '4', 'S'): return DXGI_FORMAT_BC4_SNORM;
+
+		case MakeFourCC('A', 'T', 'I', '2'): return DXGI_FORMAT_BC5_UNORM;
+		case MakeFourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+		case MakeFourCC('B', 'C', '5', 'S'): return DXGI_FORMAT_BC5_SNORM;
+
+		// BC6H and BC7 are written using the "DX10" extended header
+
+		case MakeFourCC('R', 'G', 'B', 'G'): return DXGI_FORMAT_R8G8_B8G8_UNORM;
+		case MakeFourCC('G', 'R', 'G', 'B'): return DXGI_FORMAT_G8R8_G8B8_UNORM;
+
+		case MakeFourCC('Y', 'U', 'Y', '2'): return DXGI_FORMAT_YUY2;
+
+		// Check for D3DFORMAT enums being set here
+		case 36:  return DXGI_FORMAT_R16G16B16A16_UNORM;	// D3DFMT_A16B16G16R16
+		case 110: return DXGI_FORMAT_R16G16B16A16_SNORM;	// D3DFMT_Q16W16V16U16
+		case 111: return DXGI_FORMAT_R16_FLOAT;				// D3DFMT_R16F
+		case 112: return DXGI_FORMAT_R16G16_FLOAT;			// D3DFMT_G16R16F
+		case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT;	// D3DFMT_A16B16G16R16F
+		case 114: return DXGI_FORMAT_R32_FLOAT;				// D3DFMT_R32F
+		case 115: return DXGI_FORMAT_R32G32_FLOAT;			// D3DFMT_G32R32F
+		case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT;	// D3DFMT_A32B32G32R32F
+		}
+	}
+
+	return DXGI_FORMAT_UNKNOWN;
+}
+
+DXGI_FORMAT MakeSRGB(DXGI_FORMAT format) noexcept
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:	return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+	case DXGI_FORMAT_BC1_UNORM:			return DXGI_FORMAT_BC1_UNORM_SRGB;
+	case DXGI_FORMAT_BC2_UNORM:			return DXGI_FORMAT_BC2_UNORM_SRGB;
+	case DXGI_FORMAT_BC3_UNORM:			return DXGI_FORMAT_BC3_UNORM_SRGB;
+	case DXGI_FORMAT_B8G8R8A8_UNORM:	return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+	case DXGI_FORMAT_B8G8R8X8_UNORM:	return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+	case DXGI_FORMAT_BC7_UNORM:			return DXGI_FORMAT_BC7_UNORM_SRGB;
+	default:							return format;
+	}
+}
+
+AlphaMode GetAlphaMode(const DDS_HEADER* header) noexcept
+{
+	if (header->ddspf.flags & DDS_FOURCC)
+	{
+		if (MakeFourCC('D', 'X', '1', '0') == header->ddspf.fourCC)
+		{
+			DDS_HEADER_DXT10 d3d10ext;
+			std::memcpy(&d3d10ext, reinterpret_cast<const uint8_t*>(header) + sizeof(DDS_HEADER), sizeof(DDS_HEADER_DXT10));
+
+			auto mode = static_cast<AlphaMode>(d3d10ext.miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK);
+			switch (mode)
+			{
+			case AlphaMode::Straight:
+			case AlphaMode::Premultiplied:
+			case AlphaMode::Opaque:
+			case AlphaMode::Custom:
+				return mode;
+			default:
+				break;
+			}
+		}
+		else if (MakeFourCC('D', 'X', 'T', '2') == header->ddspf.fourCC || MakeFourCC('D', 'X', 'T', '4') == header->ddspf.fourCC)
+		{
+			return AlphaMode::Premultiplied;
+		}
+	}
+
+	return AlphaMode::Unknown;
+}
+
+// Largest number of mips a texture of this size can have
+static uint32_t FullMipCount(uint32_t width, uint32_t height, uint32_t depth) noexcept
+{
+	uint32_t largest = std::max(width, std::max(height, depth));
+	uint32_t count = 1;
+	while (largest > 1)
+	{
+		largest >>= 1;
+		++count;
+	}
+	return count;
+}
+
+Result Parse(std::span<const uint8_t> file, ParsedTexture& texture, size_t maxSize)
+{
+	texture.Desc = {};
+	texture.Subresources.clear();
+
+	// Need at least enough data to fill the header and magic number to be a valid DDS
+	if (file.size() < sizeof(uint32_t) + sizeof(DDS_HEADER))
+		return Result::TooSmall;
+
+	// Headers are copied out rather than cast in place, so the file data does not have to be aligned
+	uint32_t magic = 0;
+	std::memcpy(&magic, file.data(), sizeof(uint32_t));
+	if (magic != DDS_MAGIC)
+		return Result::BadMagic;
+
+	DDS_HEADER header;
+	std::memcpy(&header, file.data() + sizeof(uint32_t), sizeof(DDS_HEADER));
+	if (header.size != sizeof(DDS_HEADER) || header.ddspf.size != sizeof(DDS_PIXELFORMAT))
+		return Result::BadHeader;
+
+	size_t dataOffset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+
+	uint32_t width = header.width;
+	uint32_t height = header.height;
+	uint32_t depth = header.depth;
+	uint32_t mipCount = header.mipMapCount == 0 ? 1 : header.mipMapCount;
+	uint32_t arraySize = 1;
+	bool isCubeMap = false;
+	Dimension dimension = Dimension::Unknown;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+	if ((header.ddspf.flags & DDS_FOURCC) && MakeFourCC('D', 'X', '1', '0') == header.ddspf.fourCC)
+	{
+		// Must be long enough for both headers and magic value
+		if (file.size() < dataOffset + sizeof(DDS_HEADER_DXT10))
+			return Result::TooSmall;
+
+		DDS_HEADER_DXT10 d3d10ext;
+		std::memcpy(&d3d10ext, file.data() + dataOffset, sizeof(DDS_HEADER_DXT10));
+		dataOffset += sizeof(DDS_HEADER_DXT10);
+
+		arraySize = d3d10ext.arraySize;
+		if (arraySize == 0)
+			return Result::InvalidData;
+
+		switch (d3d10ext.dxgiFormat)
+		{
+		case DXGI_FORMAT_AI44:
+		case DXGI_FORMAT_IA44:
+		case DXGI_FORMAT_P8:
+		case DXGI_FORMAT_A8P8:
+			return Result::UnsupportedFormat;
+
+		default:
+			if (BitsPerPixel(d3d10ext.dxgiFormat) == 0)
+				return Result::UnsupportedFormat;
+		}
+
+		format = d3d10ext.dxgiFormat;
+
+		switch (static_cast<Dimension>(d3d10ext.resourceDimension))
+		{
+		case Dimension::Texture1D:
+			if ((header.flags & DDS_HEIGHT) && height != 1)
+				return Result::InvalidData;
+			height = depth = 1;
+			dimension = Dimension::Texture1D;
+			break;
+
+		case Dimension::Texture2D:
+			if (d3d10ext.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE)
+			{
+				// Bound the number of cubes before multiplying so a huge value cannot wrap around
+				if (arraySize > MaxTexture2DArraySize / 6)
+					return Result::TooLarge;
+				arraySize *= 6;
+				isCubeMap = true;
+			}
+			depth = 1;
+			dimension = Dimension::Texture2D;
+			break;
+
+		case Dimension::Texture3D:
+			if (!(header.flags & DDS_HEADER_FLAGS_VOLUME))
+				return Result::InvalidData;
+			if (arraySize > 1)
+				return Result::UnsupportedDimension;
+			dimension = Dimension::Texture3D;
+			break;
+
+		default:
+			return Result::UnsupportedDimension;
+		}
+	}
+	else
+	{
+		format = GetDXGIFormat(header.ddspf);
+		if (format == DXGI_FORMAT_UNKNOWN)
+			return Result::UnsupportedFormat;
+
+		if (header.flags & DDS_HEADER_FLAGS_VOLUME)
+		{
+			dimension = Dimension::Texture3D;
+		}
+		else
+		{
+			if (header.caps2 & DDS_CUBEMAP)
+			{
+				// We require all six faces to be defined
+				if ((header.caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+					return Result::UnsupportedDimension;
+				arraySize = 6;
+				isCubeMap = true;
+			}
+
+			depth = 1;
+			dimension = Dimension::Texture2D;
+		}
+	}
+
+	// Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
+	if (mipCount > MaxMipLevels)
+		return Result::TooLarge;
+
+	switch (dimension)
+	{
+	case Dimension::Texture1D:
+		if (arraySize > MaxTexture1DArraySize || width > MaxTexture1DDimension)
+			return Result::TooLarge;
+		break;
+
+	case Dimension::Texture2D:
+		if (isCubeMap)
+		{
+			// This is the right bound because we set arraySize to (NumCubes*6) above
+			if (arraySize > MaxTexture2DArraySize || width > MaxTextureCubeDimension || height > MaxTextureCubeDimension)
+				return Result::TooLarge;
+		}
+		else if (arraySize > MaxTexture2DArraySize || width > MaxTexture2DDimension || height > MaxTexture2DDimension)
+		{
+			return Result::TooLarge;
+		}
+		break;
+
+	default: // Texture3D
+		if (width > MaxTexture3DDimension || height > MaxTexture3DDimension || depth > MaxTexture3DDimension)
+			return Result::TooLarge;
+		break;
+	}
+
+	// Things the loader used to leave for the device to reject
+	if (width == 0 || height == 0 || depth == 0)
+		return Result::InvalidData;
+	if (mipCount > FullMipCount(width, height, depth))
+		return Result::InvalidData;
+
+	// Build the subresource table. Every size below is bounded by the checks above (at most 16384^2 * 16 bytes for
+	// one slice), so only the running offset can get large, and it is compared against what is left of the file
+	// before it is advanced
+	texture.Subresources.reserve(static_cast<size_t>(mipCount) * arraySize);
+
+	const size_t fileSize = file.size();
+	size_t offset = dataOffset;
+	uint32_t skippedMips = 0;
+	uint32_t topWidth = 0;
+	uint32_t topHeight = 0;
+	uint32_t topDepth = 0;
+
+	for (uint32_t slice = 0; slice < arraySize; ++slice)
+	{
+		size_t w = width;
+		size_t h = height;
+		size_t d = depth;
+		for (uint32_t mip = 0; mip < mipCount; ++mip)
+		{
+			size_t numBytes = 0;
+			size_t rowBytes = 0;
+			GetSurfaceInfo(w, h, format, &numBytes, &rowBytes, nullptr);
+
+			const size_t byteSize = numBytes * d;
+			if (byteSize > fileSize - offset)
+				return Result::Truncated;
+
+			if (mipCount <= 1 || maxSize == 0 || (w <= maxSize && h <= maxSize && d <= maxSize))
+			{
+				if (topWidth == 0)
+				{
+					topWidth = static_cast<uint32_t>(w);
+					topHeight = static_cast<uint32_t>(h);
+					topDepth = static_cast<uint32_t>(d);
+				}
+
+				Subresource& subresource = texture.Subresources.emplace_back();
+				subresource.Offset = offset;
+				subresource.RowPitch = rowBytes;
+				subresource.SlicePitch = numBytes;
+				subresource.ByteSize = byteSize;
+			}
+			else if (slice == 0)
+			{
+				// Count number of skipped mipmaps (first item only)
+				++skippedMips;
+			}
+
+			offset += byteSize;
+
+			w = std::max<size_t>(w >> 1, 1);
+			h = std::max<size_t>(h >> 1, 1);
+			d = std::max<size_t>(d >> 1, 1);
+		}
+	}
+
+	if (texture.Subresources.empty())
+		return Result::NoSubresources;
+
+	TextureDesc& desc = texture.Desc;
+	desc.ResourceDimension = dimension;
+	desc.Format = format;
+	desc.Width = topWidth;
+	desc.Height = topHeight;
+	desc.Depth = topDepth;
+	desc.MipCount = mipCount - skippedMips;
+	desc.ArraySize = arraySize;
+	desc.SkippedMips = skippedMips;
+	desc.IsCubeMap = isCubeMap;
+
+	// Only read now that we know the DX10 header (if there is one) is inside the file
+	desc.Alpha = GetAlphaMode(reinterpret_cast<const DDS_HEADER*>(file.data() + sizeof(uint32_t)));
+
+	return Result::Ok;
+}
+}
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include "tiny/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "DxgiFormat.h"
+
+namespace tiny
+{
+namespace dds
+{
+// DDS file structure definitions. See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
+#pragma pack(push,1)
+
+constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t RGBBitCount;
+	uint32_t RBitMask;
+	uint32_t GBitMask;
+	uint32_t BBitMask;
+	uint32_t ABitMask;
+};
+
+struct DDS_HEADER
+{
+	uint32_t        size;
+	uint32_t        flags;
+	uint32_t        height;
+	uint32_t        width;
+	uint32_t        pitchOrLinearSize;
+	uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+	uint32_t        mipMapCount;
+	uint32_t        reserved1[11];
+	DDS_PIXELFORMAT ddspf;
+	uint32_t        caps;
+	uint32_t        caps2;
+	uint32_t        caps3;
+	uint32_t        caps4;
+	uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+	DXGI_FORMAT     dxgiFormat;
+	uint32_t        resourceDimension; // see Dimension
+	uint32_t        miscFlag;
+	uint32_t        arraySize;
+	uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(DDS_PIXELFORMAT) == 32, "DDS pixel format size mismatch");
+static_assert(sizeof(DDS_HEADER) == 124, "DDS header size mismatch");
+static_assert(sizeof(DDS_HEADER_DXT10) == 20, "DDS DX10 extended header size mismatch");
+
+constexpr uint32_t MakeFourCC(char ch0, char ch1, char ch2, char ch3) noexcept
+{
+	return static_cast<uint32_t>(static_cast<uint8_t>(ch0)) | (static_cast<uint32_t>(static_cast<uint8_t>(ch1)) << 8) |
+		(static_cast<uint32_t>(static_cast<uint8_t>(ch2)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(ch3)) << 24);
+}
+
+constexpr uint32_t DDS_FOURCC    = 0x00000004; // DDPF_FOURCC
+constexpr uint32_t DDS_RGB       = 0x00000040; // DDPF_RGB
+constexpr uint32_t DDS_LUMINANCE = 0x00020000; // DDPF_LUMINANCE
+constexpr uint32_t DDS_ALPHA     = 0x00000002; // DDPF_ALPHA
+
+constexpr uint32_t DDS_HEADER_FLAGS_VOLUME = 0x00800000; // DDSD_DEPTH
+
+constexpr uint32_t DDS_HEIGHT = 0x00000002; // DDSD_HEIGHT
+constexpr uint32_t DDS_WIDTH  = 0x00000004; // DDSD_WIDTH
+
+constexpr uint32_t DDS_CUBEMAP_POSITIVEX = 0x00000600; // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+constexpr uint32_t DDS_CUBEMAP_NEGATIVEX = 0x00000a00; // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+constexpr uint32_t DDS_CUBEMAP_POSITIVEY = 0x00001200; // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+constexpr uint32_t DDS_CUBEMAP_NEGATIVEY = 0x00002200; // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+constexpr uint32_t DDS_CUBEMAP_POSITIVEZ = 0x00004200; // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+constexpr uint32_t DDS_CUBEMAP_NEGATIVEZ = 0x00008200; // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+constexpr uint32_t DDS_CUBEMAP_ALLFACES = DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |
+										  DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |
+										  DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ;
+
+constexpr uint32_t DDS_CUBEMAP = 0x00000200; // DDSCAPS2_CUBEMAP
+
+constexpr uint32_t DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7;
+constexpr uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4; // D3D11_RESOURCE_MISC_TEXTURECUBE
+
+// Same values as D3D12_RESOURCE_DIMENSION (and D3D11_RESOURCE_DIMENSION, which is what the DX10 header stores)
+enum class Dimension : uint32_t
+{
+	Unknown = 0,
+	Buffer = 1,
+	Texture1D = 2,
+	Texture2D = 3,
+	Texture3D = 4
+};
+
+// Same values as DirectX::DDS_ALPHA_MODE
+enum class AlphaMode : uint32_t
+{
+	Unknown = 0,
+	Straight = 1,
+	Premultiplied = 2,
+	Opaque = 3,
+	Custom = 4
+};
+
+enum class Result : uint32_t
+{
+	Ok = 0,
+	TooSmall,				// Not even enough bytes for the magic number and the header(s)
+	BadMagic,
+	BadHeader,				// Header/pixel format size fields are wrong
+	UnsupportedFormat,
+	UnsupportedDimension,
+	InvalidData,			// The header contradicts itself (i.e. a 0 sized dimension, or too many mips)
+	TooLarge,				// Larger than the D3D 11.x/12 hardware requirements
+	Truncated,				// The file ends before the last subresource does
+	NoSubresources			// Every mip was skipped by 'maxSize'
+};
+ND const char* ToString(Result result) noexcept;
+
+// Hardware limits (same values as the D3D12_REQ_* constants). Nothing in the file is trusted beyond these
+constexpr uint32_t MaxMipLevels = 15;
+constexpr uint32_t MaxTexture1DArraySize = 2048;
+constexpr uint32_t MaxTexture1DDimension = 16384;
+constexpr uint32_t MaxTexture2DArraySize = 2048;
+constexpr uint32_t MaxTexture2DDimension = 16384;
+constexpr uint32_t MaxTextureCubeDimension = 16384;
+constexpr uint32_t MaxTexture3DDimension = 2048;
+
+struct TextureDesc
+{
+	Dimension	ResourceDimension = Dimension::Unknown;
+	DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+	uint32_t	Width = 0;		// Of the most detailed mip that was not skipped
+	uint32_t	Height = 0;
+	uint32_t	Depth = 0;
+	uint32_t	MipCount = 0;	// Not including skipped mips
+	uint32_t	ArraySize = 0;	// Includes the 6 faces of each cube
+	uint32_t	SkippedMips = 0;
+	bool		IsCubeMap = false;
+	AlphaMode	Alpha = AlphaMode::Unknown;
+};
+
+// Where a subresource's data lives within the file. Subresources are ordered the way D3D12CalcSubresource() orders
+// them (index = mip + arraySlice * MipCount)
+struct Subresource
+{
+	size_t Offset = 0;		// From the start of the file (not from the start of the pixel data)
+	size_t RowPitch = 0;
+	size_t SlicePitch = 0;	// One depth slice
+	size_t ByteSize = 0;	// SlicePitch * depth
+};
+
+struct ParsedTexture
+{
+	TextureDesc Desc;
+	std::vector<Subresource> Subresources;
+};
+
+// Decodes the header(s) and builds the subresource table for a whole DDS file. Mips larger than 'maxSize' in any
+// dimension are skipped (0 means no limit). The file data is never written to, and nothing is read outside of 'file'
+ND Result Parse(std::span<const uint8_t> file, ParsedTexture& texture, size_t maxSize = 0);
+
+// Format helpers
+ND size_t BitsPerPixel(DXGI_FORMAT format) noexcept;
+void GetSurfaceInfo(size_t width, size_t height, DXGI_FORMAT format, size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows) noexcept;
+ND DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf) noexcept;
+ND DXGI_FORMAT MakeSRGB(DXGI_FORMAT format) noexcept;
+ND AlphaMode GetAlphaMode(const DDS_HEADER* header) noexcept; // 'header' must be followed by the DX10 header if it has one
+}
+}
@@ -22,6 +22,8 @@
 #pragma once
 #endif
 
+#include <memory>
+#include <vector>
 #include <wrl.h>
 #include <d3d11_1.h>
 #include "d3dx12.h"
@@ -92,6 +94,51 @@ namespace DirectX
 		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                               );
 
+	// Read-only view of an entire file through a file mapping. Pages are only read from disk when they are touched,
+	// and nothing is copied into a heap buffer. The view is unmapped when the object is destroyed (or re-opened)
+	class MappedDDSFile
+	{
+	public:
+		MappedDDSFile() noexcept = default;
+		MappedDDSFile(MappedDDSFile&& rhs) noexcept : m_data(rhs.m_data), m_size(rhs.m_size) { rhs.m_data = nullptr; rhs.m_size = 0; }
+		MappedDDSFile& operator=(MappedDDSFile&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				Close();
+				m_data = rhs.m_data;
+				m_size = rhs.m_size;
+				rhs.m_data = nullptr;
+				rhs.m_size = 0;
+			}
+			return *this;
+		}
+		MappedDDSFile(const MappedDDSFile&) = delete;
+		MappedDDSFile& operator=(const MappedDDSFile&) = delete;
+		~MappedDDSFile() noexcept { Close(); }
+
+		HRESULT Open(_In_z_ const wchar_t* szFileName) noexcept;
+		void Close() noexcept;
+
+		const uint8_t* Data() const noexcept { return m_data; }
+		size_t Size() const noexcept { return m_size; }
+
+	private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+	};
+
+	// Creates the texture (in the COMMON state) without recording any commands. The caller is responsible for
+	// uploading 'subresources', which point directly into the mapped file and so are only valid while it is open
+	HRESULT LoadDDSTextureFromFile12(_In_ ID3D12Device* device,
+		                             _In_z_ const wchar_t* szFileName,
+		                             _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                             _Out_ MappedDDSFile& file,
+		                             _Out_ std::vector<D3D12_SUBRESOURCE_DATA>& subresources,
+		                             _In_ size_t maxsize = 0,
+		                             _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                             );
+
     // Standard version with optional auto-gen mipmap support
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_opt_ ID3D11DeviceContext* d3dContext,
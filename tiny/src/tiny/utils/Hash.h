@@ -0,0 +1,140 @@
+#pragma once
+#include "tiny/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+namespace tiny
+{
+namespace utility
+{
+
+// 64-bit xxHash (XXH64). Fast and well distributed, but NOT cryptographic, so it is only suitable for finding
+// identical data (i.e. texture de-duplication), not for anything an attacker controls.
+//
+// Streaming use: construct a Hash64, call Update() for each piece of data, then Digest(). The result is the same as
+// hashing all of the pieces in one call to Hash64::Of()
+class Hash64
+{
+public:
+	explicit Hash64(uint64_t seed = 0) noexcept :
+		m_seed(seed)
+	{
+		m_acc[0] = seed + Prime1 + Prime2;
+		m_acc[1] = seed + Prime2;
+		m_acc[2] = seed;
+		m_acc[3] = seed - Prime1;
+	}
+
+	ND static inline uint64_t Of(const void* data, size_t byteSize, uint64_t seed = 0) noexcept
+	{
+		Hash64 hash(seed);
+		hash.Update(data, byteSize);
+		return hash.Digest();
+	}
+
+	void Update(const void* data, size_t byteSize) noexcept
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* const end = p + byteSize;
+		m_totalSize += byteSize;
+
+		// Top up a partially filled stripe first
+		if (m_bufferSize > 0)
+		{
+			const size_t count = (StripeSize - m_bufferSize < byteSize) ? StripeSize - m_bufferSize : byteSize;
+			std::memcpy(m_buffer + m_bufferSize, p, count);
+			m_bufferSize += count;
+			p += count;
+
+			if (m_bufferSize < StripeSize)
+				return;
+
+			ConsumeStripe(m_buffer);
+			m_bufferSize = 0;
+		}
+
+		while (static_cast<size_t>(end - p) >= StripeSize)
+		{
+			ConsumeStripe(p);
+			p += StripeSize;
+		}
+
+		m_bufferSize = static_cast<size_t>(end - p);
+		if (m_bufferSize > 0)
+			std::memcpy(m_buffer, p, m_bufferSize);
+	}
+
+	ND uint64_t Digest() const noexcept
+	{
+		uint64_t h;
+		if (m_totalSize >= StripeSize)
+		{
+			h = RotateLeft(m_acc[0], 1) + RotateLeft(m_acc[1], 7) + RotateLeft(m_acc[2], 12) + RotateLeft(m_acc[3], 18);
+			for (uint64_t acc : m_acc)
+				h = (h ^ Round(0, acc)) * Prime1 + Prime4;
+		}
+		else
+		{
+			h = m_seed + Prime5;
+		}
+
+		h += m_totalSize;
+
+		// Remaining bytes of the last partial stripe
+		const uint8_t* p = m_buffer;
+		size_t remaining = m_bufferSize;
+		for (; remaining >= 8; p += 8, remaining -= 8)
+			h = RotateLeft(h ^ Round(0, Read64(p)), 27) * Prime1 + Prime4;
+		if (remaining >= 4)
+		{
+			h = RotateLeft(h ^ (static_cast<uint64_t>(Read32(p)) * Prime1), 23) * Prime2 + Prime3;
+			p += 4;
+			remaining -= 4;
+		}
+		for (; remaining > 0; ++p, --remaining)
+			h = RotateLeft(h ^ (*p * Prime5), 11) * Prime1;
+
+		// Avalanche
+		h ^= h >> 33;
+		h *= Prime2;
+		h ^= h >> 29;
+		h *= Prime3;
+		h ^= h >> 32;
+		return h;
+	}
+
+private:
+	static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+	static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+	static constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+	static constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+	static constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+	static constexpr size_t StripeSize = 32;
+
+	ND static constexpr uint64_t RotateLeft(uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+	ND static constexpr uint64_t Round(uint64_t acc, uint64_t input) noexcept { return RotateLeft(acc + input * Prime2, 31) * Prime1; }
+
+	// Little endian loads (every platform D3D12 runs on is little endian)
+	ND static inline uint64_t Read64(const uint8_t* p) noexcept { uint64_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+	ND static inline uint32_t Read32(const uint8_t* p) noexcept { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+	inline void ConsumeStripe(const uint8_t* p) noexcept
+	{
+		m_acc[0] = Round(m_acc[0], Read64(p));
+		m_acc[1] = Round(m_acc[1], Read64(p + 8));
+		m_acc[2] = Round(m_acc[2], Read64(p + 16));
+		m_acc[3] = Round(m_acc[3], Read64(p + 24));
+	}
+
+	uint64_t m_seed;
+	uint64_t m_acc[4];
+	uint64_t m_totalSize = 0;
+	uint8_t  m_buffer[StripeSize] = {};
+	size_t   m_bufferSize = 0;
+};
+
+}
+}
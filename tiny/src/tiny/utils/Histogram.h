@@ -0,0 +1,79 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+
+
+namespace tiny
+{
+namespace utility
+{
+
+// Histogram counts samples into fixed buckets. Bucket i holds samples in (UpperBound(i - 1), UpperBound(i)], and the
+// last bucket has no upper bound. Adding a sample never allocates, so it is cheap enough to do every frame
+class Histogram
+{
+public:
+	// Default buckets are meant for durations in microseconds. The frame time buckets line up with common refresh
+	// rates (144/120/90/60/30 Hz)
+	Histogram() :
+		Histogram({ 0.0, 50.0, 100.0, 250.0, 500.0, 1000.0, 2000.0, 4000.0, 6944.0, 8333.0, 11111.0, 16667.0, 33333.0, 66667.0 })
+	{}
+	Histogram(std::vector<double> upperBounds) :
+		m_upperBounds(std::move(upperBounds)),
+		m_counts(m_upperBounds.size() + 1, 0)
+	{
+		TINY_CORE_ASSERT(std::is_sorted(m_upperBounds.begin(), m_upperBounds.end()), "Histogram bounds must be sorted");
+	}
+
+	inline void Add(double value) noexcept
+	{
+		size_t bucket = static_cast<size_t>(std::lower_bound(m_upperBounds.begin(), m_upperBounds.end(), value) - m_upperBounds.begin());
+		++m_counts[bucket];
+		++m_totalCount;
+		m_sum += value;
+		m_max = m_totalCount == 1 ? value : MathHelper::Max(m_max, value);
+	}
+	inline void Reset() noexcept
+	{
+		std::fill(m_counts.begin(), m_counts.end(), 0);
+		m_totalCount = 0;
+		m_sum = 0.0;
+		m_max = 0.0;
+	}
+
+	ND inline size_t BucketCount() const noexcept { return m_counts.size(); }
+	ND inline double UpperBound(size_t bucket) const noexcept { return bucket < m_upperBounds.size() ? m_upperBounds[bucket] : DBL_MAX; }
+	ND inline UINT64 Count(size_t bucket) const noexcept { return m_counts[bucket]; }
+	ND inline const std::vector<UINT64>& Counts() const noexcept { return m_counts; }
+	ND inline UINT64 TotalCount() const noexcept { return m_totalCount; }
+	ND inline double Max() const noexcept { return m_max; }
+	ND inline double Mean() const noexcept { return m_totalCount > 0 ? m_sum / static_cast<double>(m_totalCount) : 0.0; }
+
+	// Upper bound of the bucket that contains the p-th percentile (0 < p <= 100). Samples in the last bucket report Max()
+	ND double Percentile(double p) const noexcept
+	{
+		if (m_totalCount == 0)
+			return 0.0;
+
+		UINT64 target = static_cast<UINT64>(std::ceil(p / 100.0 * static_cast<double>(m_totalCount)));
+		UINT64 seen = 0;
+		for (size_t iii = 0; iii < m_counts.size(); ++iii)
+		{
+			seen += m_counts[iii];
+			if (seen >= target)
+				return iii < m_upperBounds.size() ? m_upperBounds[iii] : m_max;
+		}
+		return m_max;
+	}
+
+private:
+	std::vector<double> m_upperBounds;
+	std::vector<UINT64> m_counts;
+	UINT64 m_totalCount = 0;
+	double m_sum = 0.0;
+	double m_max = 0.0;
+};
+
+} // namespace utility
+} // namespace tiny
@@ -0,0 +1,549 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace tiny
+{
+namespace mips
+{
+namespace
+{
+// Every format is filtered as 4 floats per texel (one SSE register). Channels the format does not have are carried
+// along as 0 (or 1 for alpha) and dropped again when the level is stored
+struct Image
+{
+	Image(uint32_t width, uint32_t height) :
+		Width(width),
+		Height(height),
+		Texels(static_cast<size_t>(width) * height * 4)
+	{}
+
+	ND inline float* Row(uint32_t y) noexcept { return Texels.data() + static_cast<size_t>(y) * Width * 4; }
+	ND inline const float* Row(uint32_t y) const noexcept { return Texels.data() + static_cast<size_t>(y) * Width * 4; }
+
+	uint32_t Width;
+	uint32_t Height;
+	std::vector<float> Texels;
+};
+
+enum class PixelLayout
+{
+	R32,
+	RG32,
+	RGBA32,
+	R8,
+	RG8,
+	RGBA8	// Also BGRA8: the filter doesn't care about the order of the color channels
+};
+
+struct FormatInfo
+{
+	bool Supported = false;
+	PixelLayout Layout = PixelLayout::R32;
+	size_t BytesPerPixel = 0;
+	bool SRGB = false;
+};
+
+FormatInfo GetFormatInfo(DXGI_FORMAT format) noexcept
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32_FLOAT:				return { true, PixelLayout::R32, 4, false };
+	case DXGI_FORMAT_R32G32_FLOAT:			return { true, PixelLayout::RG32, 8, false };
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:	return { true, PixelLayout::RGBA32, 16, false };
+	case DXGI_FORMAT_R8_UNORM:				return { true, PixelLayout::R8, 1, false };
+	case DXGI_FORMAT_R8G8_UNORM:			return { true, PixelLayout::RG8, 2, false };
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:		return { true, PixelLayout::RGBA8, 4, false };
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:	return { true, PixelLayout::RGBA8, 4, true };
+	default:								return {};
+	}
+}
+
+// sRGB ---------------------------------------------------------------------------------------------------------
+ND inline float SRGBToLinear(float c) noexcept
+{
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+struct SRGBTables
+{
+	static constexpr unsigned int BucketCount = 4096;
+
+	SRGBTables() noexcept
+	{
+		for (unsigned int iii = 0; iii < 256; ++iii)
+			ToLinear[iii] = SRGBToLinear(iii / 255.0f);
+
+		// Boundary between codes i and i + 1, measured in linear space, so encoding rounds to the nearest sRGB code
+		for (unsigned int iii = 0; iii < 255; ++iii)
+			Thresholds[iii] = SRGBToLinear((iii + 0.5f) / 255.0f);
+
+		for (unsigned int iii = 0; iii < BucketCount; ++iii)
+		{
+			const float linear = static_cast<float>(iii) / (BucketCount - 1);
+			Guesses[iii] = static_cast<uint8_t>(std::upper_bound(Thresholds.begin(), Thresholds.end(), linear) - Thresholds.begin());
+		}
+	}
+
+	// The bucket is at most a code or two away from the exact answer (codes are closest together near 0), and the
+	// thresholds settle the rest
+	ND inline uint8_t Encode(float linear) const noexcept
+	{
+		if (!(linear > 0.0f))
+			return 0; // Also NaN
+		if (linear >= 1.0f)
+			return 255;
+
+		unsigned int code = Guesses[static_cast<unsigned int>(linear * (BucketCount - 1))];
+		while (code < 255 && linear >= Thresholds[code])
+			++code;
+		while (code > 0 && linear < Thresholds[code - 1])
+			--code;
+		return static_cast<uint8_t>(code);
+	}
+
+	std::array<float, 256> ToLinear = {};
+	std::array<float, 255> Thresholds = {};
+	std::array<uint8_t, BucketCount> Guesses = {};
+};
+
+const SRGBTables& GetSRGBTables() noexcept
+{
+	static const SRGBTables tables;
+	return tables;
+}
+
+// Load/Store ---------------------------------------------------------------------------------------------------
+// The format is switched on once per row, and 8 bit RGBA rows are converted 4 texels (16 bytes) at a time
+void LoadRGBA8Row(const uint8_t* src, float* dst, uint32_t width) noexcept
+{
+	const __m128 toUnit = _mm_set1_ps(1.0f / 255.0f);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32_t x = 0;
+	for (; x + 4 <= width; x += 4)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+		const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_ps(dst + x * 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), toUnit));
+		_mm_storeu_ps(dst + x * 4 + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), toUnit));
+		_mm_storeu_ps(dst + x * 4 + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), toUnit));
+		_mm_storeu_ps(dst + x * 4 + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), toUnit));
+	}
+	for (; x < width; ++x)
+	{
+		int packed;
+		std::memcpy(&packed, src + x * 4, 4);
+		const __m128i ints = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+		_mm_storeu_ps(dst + x * 4, _mm_mul_ps(_mm_cvtepi32_ps(ints), toUnit));
+	}
+}
+
+// Clamped first (Kaiser can overshoot). _mm_max_ps returns its second operand for NaN, so NaN ends up as 0 as well
+ND inline __m128i ToUNorm8x4(const float* texel) noexcept
+{
+	const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(texel), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)));
+}
+
+void StoreRGBA8Row(const float* src, uint8_t* dst, uint32_t width) noexcept
+{
+	uint32_t x = 0;
+	for (; x + 4 <= width; x += 4)
+	{
+		const __m128i first = _mm_packs_epi32(ToUNorm8x4(src + x * 4), ToUNorm8x4(src + x * 4 + 4));
+		const __m128i second = _mm_packs_epi32(ToUNorm8x4(src + x * 4 + 8), ToUNorm8x4(src + x * 4 + 12));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(first, second));
+	}
+	for (; x < width; ++x)
+	{
+		const __m128i ints = ToUNorm8x4(src + x * 4);
+		const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(ints, ints), ints));
+		std::memcpy(dst + x * 4, &packed, 4);
+	}
+}
+
+ND inline uint8_t ToUNorm8(float value) noexcept
+{
+	// Also maps NaN to 0
+	return static_cast<uint8_t>(value > 0.0f ? (value < 1.0f ? value * 255.0f + 0.5f : 255.0f) : 0.0f);
+}
+
+void LoadRow(const FormatInfo& info, const uint8_t* src, float* dst, uint32_t width) noexcept
+{
+	const SRGBTables* srgb = info.SRGB ? &GetSRGBTables() : nullptr;
+
+	switch (info.Layout)
+	{
+	case PixelLayout::R32:
+	case PixelLayout::RG32:
+	{
+		const size_t channels = info.Layout == PixelLayout::R32 ? 1 : 2;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			float* texel = dst + x * 4;
+			texel[1] = 0.0f; texel[2] = 0.0f; texel[3] = 1.0f;
+			std::memcpy(texel, src + x * channels * 4, channels * 4);
+		}
+		break;
+	}
+	case PixelLayout::RGBA32:
+		std::memcpy(dst, src, static_cast<size_t>(width) * 16);
+		break;
+	case PixelLayout::R8:
+	case PixelLayout::RG8:
+	{
+		const size_t channels = info.Layout == PixelLayout::R8 ? 1 : 2;
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			float* texel = dst + x * 4;
+			texel[1] = 0.0f; texel[2] = 0.0f; texel[3] = 1.0f;
+			for (size_t channel = 0; channel < channels; ++channel)
+				texel[channel] = src[x * channels + channel] / 255.0f;
+		}
+		break;
+	}
+	case PixelLayout::RGBA8:
+		LoadRGBA8Row(src, dst, width);
+		if (srgb != nullptr)
+		{
+			for (uint32_t x = 0; x < width; ++x)
+			{
+				dst[x * 4] = srgb->ToLinear[src[x * 4]];
+				dst[x * 4 + 1] = srgb->ToLinear[src[x * 4 + 1]];
+				dst[x * 4 + 2] = srgb->ToLinear[src[x * 4 + 2]];
+			}
+		}
+		break;
+	}
+}
+
+// Where a downsample reads its source rows from. Level 0 is converted from the caller's pixels a row at a time, so
+// the full resolution level (three quarters of the chain) is never held as floats
+class RowSource
+{
+public:
+	explicit RowSource(const Image& image) noexcept :
+		Width(image.Width),
+		Height(image.Height),
+		m_image(&image)
+	{}
+	RowSource(const FormatInfo& info, const uint8_t* pixels, uint32_t width, uint32_t height, size_t rowPitch) :
+		Width(width),
+		Height(height),
+		m_info(&info),
+		m_pixels(pixels),
+		m_rowPitch(rowPitch)
+	{
+		m_rows[0].resize(static_cast<size_t>(width) * 4);
+		m_rows[1].resize(static_cast<size_t>(width) * 4);
+	}
+
+	// Converted rows alternate between two buffers, so a row stays valid until the row after next is requested
+	ND inline const float* Row(uint32_t y) noexcept
+	{
+		if (m_image != nullptr)
+			return m_image->Row(y);
+
+		float* row = m_rows[y & 1].data();
+		LoadRow(*m_info, m_pixels + y * m_rowPitch, row, Width);
+		return row;
+	}
+
+	const uint32_t Width;
+	const uint32_t Height;
+
+private:
+	const Image* m_image = nullptr;
+	const FormatInfo* m_info = nullptr;
+	const uint8_t* m_pixels = nullptr;
+	size_t m_rowPitch = 0;
+	std::vector<float> m_rows[2];
+};
+
+void Store(const FormatInfo& info, const Image& image, Level& level)
+{
+	level.Width = image.Width;
+	level.Height = image.Height;
+	level.RowPitch = image.Width * info.BytesPerPixel;
+	level.Data.resize(level.RowPitch * image.Height);
+
+	const SRGBTables* srgb = info.SRGB ? &GetSRGBTables() : nullptr;
+
+	for (uint32_t y = 0; y < image.Height; ++y)
+	{
+		const float* src = image.Row(y);
+		uint8_t* dst = level.Data.data() + y * level.RowPitch;
+
+		switch (info.Layout)
+		{
+		case PixelLayout::R32:
+		case PixelLayout::RG32:
+		{
+			const size_t channels = info.Layout == PixelLayout::R32 ? 1 : 2;
+			for (uint32_t x = 0; x < image.Width; ++x)
+				std::memcpy(dst + x * channels * 4, src + x * 4, channels * 4);
+			break;
+		}
+		case PixelLayout::RGBA32:
+			std::memcpy(dst, src, level.RowPitch);
+			break;
+		case PixelLayout::R8:
+		case PixelLayout::RG8:
+		{
+			const size_t channels = info.Layout == PixelLayout::R8 ? 1 : 2;
+			for (uint32_t x = 0; x < image.Width; ++x)
+				for (size_t channel = 0; channel < channels; ++channel)
+					dst[x * channels + channel] = ToUNorm8(src[x * 4 + channel]);
+			break;
+		}
+		case PixelLayout::RGBA8:
+			StoreRGBA8Row(src, dst, image.Width);
+			if (srgb != nullptr)
+			{
+				for (uint32_t x = 0; x < image.Width; ++x)
+				{
+					dst[x * 4] = srgb->Encode(src[x * 4]);
+					dst[x * 4 + 1] = srgb->Encode(src[x * 4 + 1]);
+					dst[x * 4 + 2] = srgb->Encode(src[x * 4 + 2]);
+				}
+			}
+			break;
+		}
+	}
+}
+
+// Filtering ----------------------------------------------------------------------------------------------------
+// The taps of one axis: destination texel i reads source texels Indices[Offsets[i]] to Indices[Offsets[i + 1] - 1].
+// Weights are normalized, and indices are clamped to the edge
+struct Kernel
+{
+	std::vector<uint32_t> Offsets;
+	std::vector<uint32_t> Indices;
+	std::vector<float> Weights;
+};
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr double KaiserRadius = 1.5;	// In destination texels
+constexpr double KaiserAlpha = 4.0;
+
+ND double BesselI0(double x) noexcept
+{
+	// Power series. Converges quickly for the arguments used here (at most KaiserAlpha)
+	double sum = 1.0;
+	double term = 1.0;
+	const double halfXSquared = x * x * 0.25;
+	for (int k = 1; k < 32 && term > sum * 1e-12; ++k)
+	{
+		term *= halfXSquared / (static_cast<double>(k) * k);
+		sum += term;
+	}
+	return sum;
+}
+
+ND double KaiserWeight(double t) noexcept
+{
+	const double x = t / KaiserRadius;
+	if (x <= -1.0 || x >= 1.0)
+		return 0.0;
+
+	const double sinc = t == 0.0 ? 1.0 : std::sin(Pi * t) / (Pi * t);
+	return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0 - x * x)) / BesselI0(KaiserAlpha);
+}
+
+Kernel BuildKernel(uint32_t sourceSize, uint32_t destinationSize, Filter filter)
+{
+	Kernel kernel;
+	kernel.Offsets.reserve(static_cast<size_t>(destinationSize) + 1);
+	kernel.Offsets.push_back(0);
+
+	const double scale = static_cast<double>(sourceSize) / destinationSize;
+	const int64_t lastIndex = static_cast<int64_t>(sourceSize) - 1;
+
+	for (uint32_t x = 0; x < destinationSize; ++x)
+	{
+		const size_t first = kernel.Indices.size();
+
+		auto addTap = [&](int64_t index, double weight)
+		{
+			const uint32_t clamped = static_cast<uint32_t>(std::clamp<int64_t>(index, 0, lastIndex));
+
+			// Clamped taps land on the same (edge) texel, and indices only increase, so merge with the previous tap
+			if (kernel.Indices.size() > first && kernel.Indices.back() == clamped)
+				kernel.Weights.back() += static_cast<float>(weight);
+			else
+			{
+				kernel.Indices.push_back(clamped);
+				kernel.Weights.push_back(static_cast<float>(weight));
+			}
+		};
+
+		if (filter == Filter::Box)
+		{
+			const double start = x * scale;
+			const double end = (x + 1) * scale;
+			const int64_t last = std::min<int64_t>(static_cast<int64_t>(std::ceil(end)), sourceSize) - 1;
+			for (int64_t iii = static_cast<int64_t>(std::floor(start)); iii <= last; ++iii)
+			{
+				const double weight = std::min<double>(iii + 1, end) - std::max<double>(iii, start);
+				if (weight > 1e-9)
+					addTap(iii, weight);
+			}
+		}
+		else
+		{
+			const double center = (x + 0.5) * scale;
+			const double radius = KaiserRadius * scale;
+			const int64_t last = static_cast<int64_t>(std::ceil(center + radius));
+			for (int64_t iii = static_cast<int64_t>(std::floor(center - radius)); iii <= last; ++iii)
+			{
+				const double weight = KaiserWeight((iii + 0.5 - center) / scale);
+				if (weight != 0.0)
+					addTap(iii, weight);
+			}
+		}
+
+		float sum = 0.0f;
+		for (size_t iii = first; iii < kernel.Weights.size(); ++iii)
+			sum += kernel.Weights[iii];
+		for (size_t iii = first; iii < kernel.Weights.size(); ++iii)
+			kernel.Weights[iii] /= sum;
+
+		kernel.Offsets.push_back(static_cast<uint32_t>(kernel.Indices.size()));
+	}
+	return kernel;
+}
+
+// Separable: horizontal pass into 'scratch' (destination width, source height), then the vertical pass. The
+// vertical pass walks whole rows per tap, so both passes read memory in order
+void Downsample(RowSource& source, Image& destination, Image& scratch, Filter filter)
+{
+	// Box with both sizes even (always the case for power of 2 textures): every destination texel is the average of
+	// a 2x2 quad, so neither the kernels nor the scratch image are needed
+	if (filter == Filter::Box && source.Width == destination.Width * 2 && source.Height == destination.Height * 2)
+	{
+		const __m128 quarter = _mm_set1_ps(0.25f);
+		for (uint32_t y = 0; y < destination.Height; ++y)
+		{
+			const float* top = source.Row(y * 2);
+			const float* bottom = source.Row(y * 2 + 1);
+			float* dst = destination.Row(y);
+			for (uint32_t x = 0; x < destination.Width; ++x, top += 8, bottom += 8, dst += 4)
+			{
+				const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(top), _mm_loadu_ps(top + 4)),
+											  _mm_add_ps(_mm_loadu_ps(bottom), _mm_loadu_ps(bottom + 4)));
+				_mm_storeu_ps(dst, _mm_mul_ps(sum, quarter));
+			}
+		}
+		return;
+	}
+
+	const Kernel horizontal = BuildKernel(source.Width, destination.Width, filter);
+	const Kernel vertical = BuildKernel(source.Height, destination.Height, filter);
+
+	scratch.Width = destination.Width;
+	scratch.Height = source.Height;
+	scratch.Texels.resize(static_cast<size_t>(scratch.Width) * scratch.Height * 4);
+
+	for (uint32_t y = 0; y < source.Height; ++y)
+	{
+		const float* src = source.Row(y);
+		float* dst = scratch.Row(y);
+
+		for (uint32_t x = 0; x < destination.Width; ++x, dst += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (uint32_t tap = horizontal.Offsets[x]; tap < horizontal.Offsets[x + 1]; ++tap)
+			{
+				const __m128 texel = _mm_loadu_ps(src + static_cast<size_t>(horizontal.Indices[tap]) * 4);
+				sum = _mm_add_ps(sum, _mm_mul_ps(texel, _mm_set1_ps(horizontal.Weights[tap])));
+			}
+			_mm_storeu_ps(dst, sum);
+		}
+	}
+
+	const size_t floatsPerRow = static_cast<size_t>(destination.Width) * 4;
+	for (uint32_t y = 0; y < destination.Height; ++y)
+	{
+		float* dst = destination.Row(y);
+		std::fill(dst, dst + floatsPerRow, 0.0f);
+
+		for (uint32_t tap = vertical.Offsets[y]; tap < vertical.Offsets[y + 1]; ++tap)
+		{
+			const float* src = scratch.Row(vertical.Indices[tap]);
+			const __m128 weight = _mm_set1_ps(vertical.Weights[tap]);
+			for (size_t iii = 0; iii < floatsPerRow; iii += 4)
+				_mm_storeu_ps(dst + iii, _mm_add_ps(_mm_loadu_ps(dst + iii), _mm_mul_ps(_mm_loadu_ps(src + iii), weight)));
+		}
+	}
+}
+
+} // namespace
+
+
+bool IsSupported(DXGI_FORMAT format) noexcept
+{
+	return GetFormatInfo(format).Supported;
+}
+size_t BytesPerPixel(DXGI_FORMAT format) noexcept
+{
+	return GetFormatInfo(format).BytesPerPixel;
+}
+uint32_t FullMipCount(uint32_t width, uint32_t height) noexcept
+{
+	uint32_t count = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+		++count;
+	return count;
+}
+
+std::vector<Level> Generate(DXGI_FORMAT format, const void* pixels, uint32_t width, uint32_t height, size_t rowPitch, Filter filter, uint32_t mipCount)
+{
+	const FormatInfo info = GetFormatInfo(format);
+	if (!info.Supported || pixels == nullptr || width == 0 || height == 0 || rowPitch < width * info.BytesPerPixel)
+		return {};
+
+	const uint32_t fullCount = FullMipCount(width, height);
+	const uint32_t count = (mipCount == 0 || mipCount > fullCount) ? fullCount : mipCount;
+
+	std::vector<Level> levels(count);
+
+	// Level 0 is copied as is, so it is bit exact even for formats that don't survive the round trip through float
+	const uint8_t* source = static_cast<const uint8_t*>(pixels);
+	Level& top = levels[0];
+	top.Width = width;
+	top.Height = height;
+	top.RowPitch = width * info.BytesPerPixel;
+	top.Data.resize(top.RowPitch * height);
+	for (uint32_t y = 0; y < height; ++y)
+		std::memcpy(top.Data.data() + y * top.RowPitch, source + y * rowPitch, top.RowPitch);
+
+	if (count == 1)
+		return levels;
+
+	Image scratch(0, 0);
+	RowSource topRows(info, source, width, height, rowPitch);
+	Image current(std::max(1u, width >> 1), std::max(1u, height >> 1));
+	Downsample(topRows, current, scratch, filter);
+	Store(info, current, levels[1]);
+
+	for (uint32_t level = 2; level < count; ++level)
+	{
+		RowSource rows(current);
+		Image next(std::max(1u, current.Width >> 1), std::max(1u, current.Height >> 1));
+		Downsample(rows, next, scratch, filter);
+		Store(info, next, levels[level]);
+		current = std::move(next);
+	}
+	return levels;
+}
+
+}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "tiny/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DxgiFormat.h"
+
+namespace tiny
+{
+namespace mips
+{
+// Box: every destination texel is the area weighted average of the source texels it covers (an exact 2x2 average
+//      when the size is even, and odd sizes don't drop the last row/column)
+// Kaiser: windowed sinc (3 destination texels wide, alpha = 4). Sharper than Box, but may ring slightly on hard edges
+enum class Filter : uint32_t
+{
+	Box,
+	Kaiser
+};
+
+// One level of a mip chain. Rows are tightly packed (RowPitch = Width * BytesPerPixel())
+struct Level
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	size_t RowPitch = 0;
+	std::vector<uint8_t> Data;
+};
+
+// Formats Generate() accepts. sRGB formats are filtered in linear space
+ND bool IsSupported(DXGI_FORMAT format) noexcept;
+ND size_t BytesPerPixel(DXGI_FORMAT format) noexcept;
+
+// Number of levels in a full chain (down to 1x1)
+ND uint32_t FullMipCount(uint32_t width, uint32_t height) noexcept;
+
+// Builds levels 0 to mipCount - 1 (mipCount = 0 means the full chain). Level 0 is a copy of the source. Each level is
+// filtered from the previous one, which is kept at float precision, so rounding errors don't build up down the chain.
+// Returns an empty vector if the format is not supported or the source is empty.
+//
+// Nothing here touches a device, so the same code can run offline (i.e. in an asset tool) or at load time
+ND std::vector<Level> Generate(DXGI_FORMAT format, const void* pixels, uint32_t width, uint32_t height, size_t rowPitch, Filter filter = Filter::Box, uint32_t mipCount = 0);
+
+}
+}
@@ -72,20 +72,45 @@ void Instrumentor::BeginSession() noexcept
 	m_dataCount = 0;
 	m_filepath = m_filepath;
 	m_currentSession = new InstrumentationSession{ m_name };
+
+	for (RegisteredHistogram& rh : m_histograms)
+		rh.CountsAtSessionStart = rh.Histogram->Counts();
 }
 void Instrumentor::BeginSession(const std::string& name, std::string filepath) noexcept
 {
 	m_dataCount = 0;
 	m_filepath = filepath;
 	m_currentSession = new InstrumentationSession{ name };
+
+	for (RegisteredHistogram& rh : m_histograms)
+		rh.CountsAtSessionStart = rh.Histogram->Counts();
 }
 
 void Instrumentor::EndSession() noexcept
 {
 	std::ofstream outFile(m_filepath);
 
-	// Header
-	outFile << "{\"otherData\": {},\"traceEvents\":[";
+	// Header (histograms are written as { "name": { "upperBounds": [...], "counts": [...] } })
+	outFile << "{\"otherData\": {";
+	for (size_t iii = 0; iii < m_histograms.size(); ++iii)
+	{
+		const RegisteredHistogram& rh = m_histograms[iii];
+		if (iii != 0)
+			outFile << ",";
+
+		outFile << "\"" << rh.Name << "\":{\"upperBounds\":[";
+		for (size_t jjj = 0; jjj + 1 < rh.Histogram->BucketCount(); ++jjj)
+			outFile << (jjj != 0 ? "," : "") << rh.Histogram->UpperBound(jjj);
+		outFile << "],\"counts\":[";
+		for (size_t jjj = 0; jjj < rh.Histogram->BucketCount(); ++jjj)
+		{
+			UINT64 atStart = jjj < rh.CountsAtSessionStart.size() ? rh.CountsAtSessionStart[jjj] : 0;
+			UINT64 count = rh.Histogram->Count(jjj);
+			outFile << (jjj != 0 ? "," : "") << (count >= atStart ? count - atStart : count); // The histogram may have been reset during the session
+		}
+		outFile << "]}";
+	}
+	outFile << "},\"traceEvents\":[";
 
 	// Data
 	for (unsigned int iii = 0; iii < m_dataCount; ++iii)
@@ -93,6 +118,18 @@ void Instrumentor::EndSession() noexcept
 		if (iii != 0)
 			outFile << ",";
 
+		if (m_data[iii].isCounter)
+		{
+			outFile << "{";
+			outFile << "\"name\":\"" << m_data[iii].name << "\",";
+			outFile << "\"ph\":\"C\",";
+			outFile << "\"pid\":0,";
+			outFile << "\"ts\":" << m_data[iii].start << ",";
+			outFile << "\"args\":{\"value\":" << m_data[iii].value << "}";
+			outFile << "}";
+			continue;
+		}
+
 		outFile << "{";
 		outFile << "\"cat\":\"function\",";
 		outFile << "\"dur\":" << (m_data[iii].end - m_data[iii].start) << ",";
@@ -115,16 +152,50 @@ void Instrumentor::EndSession() noexcept
 
 void Instrumentor::WriteProfile(const std::string& name, long long start, long long end, uint32_t threadID) noexcept
 {
+	concurrency::critical_section::scoped_lock lock(m_dataLock);
+
 	if (m_dataCount < 999999)
 	{
 		m_data[m_dataCount].name = name;
 		m_data[m_dataCount].start = start;
 		m_data[m_dataCount].end = end;
 		m_data[m_dataCount].threadID = threadID;
+		m_data[m_dataCount].isCounter = false;
 
 		++m_dataCount;
 	}
 }
+void Instrumentor::WriteCounter(const std::string& name, double value) noexcept
+{
+	if (!SessionIsActive())
+		return;
+
+	long long timestamp = std::chrono::time_point_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now()).time_since_epoch().count();
+
+	concurrency::critical_section::scoped_lock lock(m_dataLock);
+
+	if (m_dataCount < 999999)
+	{
+		m_data[m_dataCount].name = name;
+		m_data[m_dataCount].start = timestamp;
+		m_data[m_dataCount].end = timestamp;
+		m_data[m_dataCount].threadID = 0;
+		m_data[m_dataCount].isCounter = true;
+		m_data[m_dataCount].value = value;
+
+		++m_dataCount;
+	}
+}
+
+void Instrumentor::RegisterHistogram(const std::string& name, const utility::Histogram* histogram) noexcept
+{
+	TINY_CORE_ASSERT(histogram != nullptr, "Cannot register a null histogram");
+	m_histograms.push_back({ name, histogram, histogram->Counts() });
+}
+void Instrumentor::UnregisterHistogram(const utility::Histogram* histogram) noexcept
+{
+	std::erase_if(m_histograms, [histogram](const RegisteredHistogram& rh) { return rh.Histogram == histogram; });
+}
 
 // -----------------------------------------------------------------------
 // InstrumentationTimer
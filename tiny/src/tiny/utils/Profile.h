@@ -1,6 +1,7 @@
 #pragma once
 #include "tiny-pch.h"
 #include "tiny/Core.h"
+#include "tiny/utils/Histogram.h"
 
 //
 // View results using chrome://tracing
@@ -24,12 +25,21 @@
 	#define PROFILE_SCOPE(name) tiny::InstrumentationTimer TIMER_VAR_NAME(name)
 	#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCSIG__)
 
+	// Counters show up as graphs in the trace. Histograms that are registered are written to the trace's "otherData"
+	// (only the samples added while the session was active)
+	#define PROFILE_COUNTER(name, value) tiny::Instrumentor::Get().WriteCounter(name, value)
+	#define PROFILE_REGISTER_HISTOGRAM(name, histogram) tiny::Instrumentor::Get().RegisterHistogram(name, histogram)
+	#define PROFILE_UNREGISTER_HISTOGRAM(histogram) tiny::Instrumentor::Get().UnregisterHistogram(histogram)
+
 #else
 	#define PROFILE_BEGIN_SESSION(name, filepath)
 	#define PROFILE_END_SESSION()
 	#define PROFILE_NEXT_FRAME()
 	#define PROFILE_SCOPE(name)
 	#define PROFILE_FUNCTION()
+	#define PROFILE_COUNTER(name, value)
+	#define PROFILE_REGISTER_HISTOGRAM(name, histogram)
+	#define PROFILE_UNREGISTER_HISTOGRAM(histogram)
 #endif
 
 
@@ -42,6 +52,8 @@ struct ProfileResult
 	std::string name = "";
 	long long start = 0, end = 0;
 	uint32_t threadID = 0;
+	bool isCounter = false;	// Counters only use 'start' (as the timestamp) and 'value'
+	double value = 0.0;
 };
 
 struct InstrumentationSession
@@ -79,6 +91,11 @@ public:
 	void EndSession() noexcept;
 
 	void WriteProfile(const std::string& name, long long start, long long end, uint32_t threadID) noexcept;
+	void WriteCounter(const std::string& name, double value) noexcept;
+
+	// The histogram must stay alive until it is unregistered
+	void RegisterHistogram(const std::string& name, const utility::Histogram* histogram) noexcept;
+	void UnregisterHistogram(const utility::Histogram* histogram) noexcept;
 
 	static Instrumentor& Get() noexcept
 	{
@@ -94,6 +111,15 @@ private:
 
 	std::array<ProfileResult, 1000000> m_data;
 	unsigned int m_dataCount;
+	concurrency::critical_section m_dataLock; // Profile results may be written from multiple threads
+
+	struct RegisteredHistogram
+	{
+		std::string Name;
+		const utility::Histogram* Histogram = nullptr;
+		std::vector<UINT64> CountsAtSessionStart;
+	};
+	std::vector<RegisteredHistogram> m_histograms;
 
 	unsigned int m_remainingFrames;
 	bool m_capturingFrames;
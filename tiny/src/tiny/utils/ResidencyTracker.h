@@ -0,0 +1,224 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+
+
+namespace tiny
+{
+namespace utility
+{
+
+// ResidencyTracker does the bookkeeping behind GPU memory budgeting:
+//     - Usage: current/peak bytes and allocation counts for a fixed number of categories (plus the total)
+//     - LRU: a list of the entries that may currently be evicted, ordered by the frame they were last used in
+//
+// An entry is something that can give its memory back and recreate it later (i.e. a cached texture or a mesh that
+// keeps a CPU copy of its data). Only entries that are evictable are on the LRU list, so finding the least recently
+// used one is O(1), as are Touch(), SetEvictable() and Unregister().
+//
+// Like BuddyAllocator, it knows nothing about D3D12 (and is not synchronized), so it can be exercised on the CPU alone
+class ResidencyTracker
+{
+public:
+	using Handle = std::uint32_t;
+	static constexpr Handle InvalidHandle = UINT32_MAX;
+
+	struct Usage
+	{
+		UINT64 CurrentBytes = 0;
+		UINT64 PeakBytes = 0;
+		unsigned int Allocations = 0;
+	};
+
+	explicit ResidencyTracker(unsigned int categoryCount) :
+		m_categories(categoryCount)
+	{
+		TINY_CORE_ASSERT(categoryCount > 0, "Must have at least one category");
+	}
+
+	// Usage ------------------------------------------------------------------------------------------------------
+	void AddAllocation(unsigned int category, UINT64 byteSize) noexcept
+	{
+		TINY_CORE_ASSERT(category < m_categories.size(), "Invalid category");
+		Add(m_categories[category], byteSize);
+		Add(m_total, byteSize);
+	}
+	void RemoveAllocation(unsigned int category, UINT64 byteSize) noexcept
+	{
+		TINY_CORE_ASSERT(category < m_categories.size(), "Invalid category");
+		Remove(m_categories[category], byteSize);
+		Remove(m_total, byteSize);
+	}
+
+	ND inline const Usage& GetUsage(unsigned int category) const noexcept { return m_categories[category]; }
+	ND inline const Usage& GetTotalUsage() const noexcept { return m_total; }
+	ND inline unsigned int CategoryCount() const noexcept { return static_cast<unsigned int>(m_categories.size()); }
+
+	// LRU --------------------------------------------------------------------------------------------------------
+	// New entries are not evictable until SetEvictable() is called
+	ND Handle Register(UINT64 byteSize)
+	{
+		Handle handle;
+		if (m_freeEntries.size() > 0)
+		{
+			handle = m_freeEntries.back();
+			m_freeEntries.pop_back();
+		}
+		else
+		{
+			handle = static_cast<Handle>(m_entries.size());
+			m_entries.emplace_back();
+		}
+
+		Entry& entry = m_entries[handle];
+		entry = {};
+		entry.ByteSize = byteSize;
+		entry.Registered = true;
+		++m_registeredCount;
+		return handle;
+	}
+	void Unregister(Handle handle) noexcept
+	{
+		TINY_CORE_ASSERT(IsRegistered(handle), "Handle is not registered");
+
+		if (m_entries[handle].Evictable)
+			Unlink(handle);
+
+		m_entries[handle].Registered = false;
+		m_freeEntries.push_back(handle);
+		--m_registeredCount;
+	}
+
+	// Making an entry evictable counts as a use (it becomes the most recently used entry)
+	void SetEvictable(Handle handle, bool evictable, UINT64 frameNumber) noexcept
+	{
+		TINY_CORE_ASSERT(IsRegistered(handle), "Handle is not registered");
+
+		Entry& entry = m_entries[handle];
+		if (entry.Evictable)
+			Unlink(handle);
+
+		entry.LastUsedFrame = frameNumber;
+		if (evictable)
+			LinkAtBack(handle);
+	}
+
+	// Marks the entry as used during 'frameNumber'. Entries that are not evictable only have their frame updated
+	void Touch(Handle handle, UINT64 frameNumber) noexcept
+	{
+		TINY_CORE_ASSERT(IsRegistered(handle), "Handle is not registered");
+
+		Entry& entry = m_entries[handle];
+		entry.LastUsedFrame = frameNumber;
+		if (entry.Evictable && m_tail != handle)
+		{
+			Unlink(handle);
+			LinkAtBack(handle);
+		}
+	}
+
+	void SetByteSize(Handle handle, UINT64 byteSize) noexcept
+	{
+		TINY_CORE_ASSERT(IsRegistered(handle), "Handle is not registered");
+
+		Entry& entry = m_entries[handle];
+		if (entry.Evictable)
+			m_evictableBytes = m_evictableBytes - entry.ByteSize + byteSize;
+		entry.ByteSize = byteSize;
+	}
+
+	// The least recently used evictable entry, as long as it was last used at or before 'lastFrameNumber'. Because
+	// the list is ordered by use, if the front entry was used too recently, so was every other entry
+	ND std::optional<Handle> LeastRecentlyUsed(UINT64 lastFrameNumber) const noexcept
+	{
+		if (m_head == InvalidHandle || m_entries[m_head].LastUsedFrame > lastFrameNumber)
+			return std::nullopt;
+		return m_head;
+	}
+
+	ND inline bool IsRegistered(Handle handle) const noexcept { return handle < m_entries.size() && m_entries[handle].Registered; }
+	ND inline bool IsEvictable(Handle handle) const noexcept { return m_entries[handle].Evictable; }
+	ND inline UINT64 GetByteSize(Handle handle) const noexcept { return m_entries[handle].ByteSize; }
+	ND inline UINT64 GetLastUsedFrame(Handle handle) const noexcept { return m_entries[handle].LastUsedFrame; }
+	ND inline UINT64 EvictableBytes() const noexcept { return m_evictableBytes; }
+	ND inline unsigned int EvictableCount() const noexcept { return m_evictableCount; }
+	ND inline unsigned int RegisteredCount() const noexcept { return m_registeredCount; }
+
+private:
+	struct Entry
+	{
+		UINT64 ByteSize = 0;
+		UINT64 LastUsedFrame = 0;
+		Handle Previous = InvalidHandle; // Towards the least recently used end
+		Handle Next = InvalidHandle;
+		bool Registered = false;
+		bool Evictable = false;		// Whether the entry is on the LRU list
+	};
+
+	static inline void Add(Usage& usage, UINT64 byteSize) noexcept
+	{
+		usage.CurrentBytes += byteSize;
+		usage.PeakBytes = MathHelper::Max(usage.PeakBytes, usage.CurrentBytes);
+		++usage.Allocations;
+	}
+	static inline void Remove(Usage& usage, UINT64 byteSize) noexcept
+	{
+		TINY_CORE_ASSERT(usage.CurrentBytes >= byteSize && usage.Allocations > 0, "Removing more than was added");
+		usage.CurrentBytes -= byteSize;
+		--usage.Allocations;
+	}
+
+	void LinkAtBack(Handle handle) noexcept
+	{
+		Entry& entry = m_entries[handle];
+		entry.Previous = m_tail;
+		entry.Next = InvalidHandle;
+		entry.Evictable = true;
+
+		if (m_tail != InvalidHandle)
+			m_entries[m_tail].Next = handle;
+		else
+			m_head = handle;
+		m_tail = handle;
+
+		m_evictableBytes += entry.ByteSize;
+		++m_evictableCount;
+	}
+	void Unlink(Handle handle) noexcept
+	{
+		Entry& entry = m_entries[handle];
+
+		if (entry.Previous != InvalidHandle)
+			m_entries[entry.Previous].Next = entry.Next;
+		else
+			m_head = entry.Next;
+
+		if (entry.Next != InvalidHandle)
+			m_entries[entry.Next].Previous = entry.Previous;
+		else
+			m_tail = entry.Previous;
+
+		entry.Previous = InvalidHandle;
+		entry.Next = InvalidHandle;
+		entry.Evictable = false;
+
+		m_evictableBytes -= entry.ByteSize;
+		--m_evictableCount;
+	}
+
+	std::vector<Usage> m_categories;
+	Usage m_total;
+
+	// Entries are linked by index so handles stay valid as the vector grows. Unregistered entries are reused
+	std::vector<Entry> m_entries;
+	std::vector<Handle> m_freeEntries;
+	Handle m_head = InvalidHandle;	// Least recently used
+	Handle m_tail = InvalidHandle;	// Most recently used
+	UINT64 m_evictableBytes = 0;
+	unsigned int m_evictableCount = 0;
+	unsigned int m_registeredCount = 0;
+};
+
+} // namespace utility
+} // namespace tiny
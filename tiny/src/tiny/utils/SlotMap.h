@@ -0,0 +1,113 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+
+
+namespace tiny
+{
+namespace utility
+{
+
+// Handle returned by SlotMap::Insert(). A handle stays valid until the value it refers to is removed, no matter how
+// many other values are inserted/removed in the meantime. A default constructed handle is invalid
+struct SlotMapHandle
+{
+	std::uint32_t Index = UINT32_MAX;
+	std::uint32_t Generation = 0;
+
+	ND inline bool IsValid() const noexcept { return Index != UINT32_MAX; }
+};
+
+// SlotMap keeps its values densely packed (so iterating over them is as fast as iterating over a std::vector) and
+// uses an indirection table so that Insert(), Remove() and Replace() are all O(1).
+// NOTE: Remove() moves the last value into the removed value's position, so iteration order is NOT preserved
+template<typename T>
+class SlotMap
+{
+public:
+	ND SlotMapHandle Insert(T* value)
+	{
+		std::uint32_t slotIndex;
+		if (m_freeSlots.size() > 0)
+		{
+			slotIndex = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			slotIndex = static_cast<std::uint32_t>(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		Slot& slot = m_slots[slotIndex];
+		slot.DenseIndex = static_cast<std::uint32_t>(m_values.size());
+		m_values.push_back(value);
+		m_denseToSlot.push_back(slotIndex);
+
+		return { slotIndex, slot.Generation };
+	}
+	void Remove(SlotMapHandle handle) noexcept
+	{
+		TINY_CORE_ASSERT(Contains(handle), "Handle is not valid for this SlotMap");
+
+		Slot& slot = m_slots[handle.Index];
+		const std::uint32_t denseIndex = slot.DenseIndex;
+		const std::uint32_t lastIndex = static_cast<std::uint32_t>(m_values.size()) - 1;
+
+		// Move the last value into the hole and point its slot at the new location
+		if (denseIndex != lastIndex)
+		{
+			m_values[denseIndex] = m_values[lastIndex];
+			m_denseToSlot[denseIndex] = m_denseToSlot[lastIndex];
+			m_slots[m_denseToSlot[denseIndex]].DenseIndex = denseIndex;
+		}
+		m_values.pop_back();
+		m_denseToSlot.pop_back();
+
+		// Bumping the generation invalidates any outstanding copies of the handle
+		++slot.Generation;
+		m_freeSlots.push_back(handle.Index);
+	}
+	// Changes the value a handle refers to (i.e. when the object that owns the handle is moved)
+	inline void Replace(SlotMapHandle handle, T* value) noexcept
+	{
+		TINY_CORE_ASSERT(Contains(handle), "Handle is not valid for this SlotMap");
+		m_values[m_slots[handle.Index].DenseIndex] = value;
+	}
+	// Removes every value (all outstanding handles become invalid)
+	void clear() noexcept
+	{
+		for (std::uint32_t slotIndex : m_denseToSlot)
+		{
+			++m_slots[slotIndex].Generation;
+			m_freeSlots.push_back(slotIndex);
+		}
+		m_values.clear();
+		m_denseToSlot.clear();
+	}
+	ND inline bool Contains(SlotMapHandle handle) const noexcept
+	{
+		return handle.Index < m_slots.size() && m_slots[handle.Index].Generation == handle.Generation;
+	}
+
+	ND inline const std::vector<T*>& Values() const noexcept { return m_values; }
+	ND inline size_t size() const noexcept { return m_values.size(); }
+	ND inline typename std::vector<T*>::const_iterator begin() const noexcept { return m_values.begin(); }
+	ND inline typename std::vector<T*>::const_iterator end() const noexcept { return m_values.end(); }
+
+private:
+	struct Slot
+	{
+		std::uint32_t DenseIndex = 0;
+		std::uint32_t Generation = 0;
+	};
+
+	std::vector<Slot> m_slots;
+	std::vector<std::uint32_t> m_freeSlots;
+	std::vector<T*> m_values;
+	std::vector<std::uint32_t> m_denseToSlot;
+};
+
+} // namespace utility
+} // namespace tiny
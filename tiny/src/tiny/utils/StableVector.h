@@ -0,0 +1,179 @@
+#pragma once
+#include "tiny-pch.h"
+#include "tiny/Core.h"
+#include "tiny/Log.h"
+
+
+namespace tiny
+{
+namespace utility
+{
+
+// StableVector stores its values in fixed size pages that are never reallocated, so adding values never moves the
+// ones that already exist and pointers/references to them stay valid until they are erased. It behaves like a
+// std::vector for iteration and indexing (via a dense list of pointers), and erase() is O(1).
+// NOTE: erase() moves the last value's POINTER into the erased position (the value itself never moves), so iteration
+//       order is NOT preserved once values have been erased
+template<typename T, size_t ValuesPerPage = 256>
+class StableVector
+{
+private:
+	// Storage is the first member of a standard-layout struct, so a T* can be converted back to its Slot
+	struct Slot
+	{
+		alignas(T) std::byte Storage[sizeof(T)];
+		std::uint32_t DenseIndex;
+	};
+	using Page = std::array<Slot, ValuesPerPage>;
+
+	ND static inline Slot* SlotOf(const T* value) noexcept { return reinterpret_cast<Slot*>(const_cast<T*>(value)); }
+
+public:
+	template<typename U>
+	class Iterator
+	{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::remove_const_t<U>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = U*;
+		using reference = U&;
+
+		Iterator() noexcept = default;
+		Iterator(T* const* position) noexcept : m_position(position) {}
+
+		ND inline reference operator*() const noexcept { return **m_position; }
+		ND inline pointer operator->() const noexcept { return *m_position; }
+		inline Iterator& operator++() noexcept { ++m_position; return *this; }
+		inline Iterator operator++(int) noexcept { Iterator tmp = *this; ++m_position; return tmp; }
+		inline Iterator& operator--() noexcept { --m_position; return *this; }
+		inline Iterator& operator+=(difference_type n) noexcept { m_position += n; return *this; }
+		ND inline Iterator operator+(difference_type n) const noexcept { return Iterator(m_position + n); }
+		ND inline difference_type operator-(const Iterator& rhs) const noexcept { return m_position - rhs.m_position; }
+		ND inline bool operator==(const Iterator& rhs) const noexcept { return m_position == rhs.m_position; }
+		ND inline bool operator!=(const Iterator& rhs) const noexcept { return m_position != rhs.m_position; }
+
+	private:
+		T* const* m_position = nullptr;
+	};
+	using iterator = Iterator<T>;
+	using const_iterator = Iterator<const T>;
+
+	StableVector() noexcept = default;
+	StableVector(StableVector&& rhs) noexcept :
+		m_pages(std::move(rhs.m_pages)),
+		m_values(std::move(rhs.m_values)),
+		m_freeSlots(std::move(rhs.m_freeSlots)),
+		m_slotsUsedInLastPage(rhs.m_slotsUsedInLastPage),
+		m_insertionCount(rhs.m_insertionCount)
+	{
+		rhs.m_slotsUsedInLastPage = ValuesPerPage;
+	}
+	StableVector& operator=(StableVector&& rhs) noexcept
+	{
+		clear();
+		m_pages = std::move(rhs.m_pages);
+		m_values = std::move(rhs.m_values);
+		m_freeSlots = std::move(rhs.m_freeSlots);
+		m_slotsUsedInLastPage = rhs.m_slotsUsedInLastPage;
+		m_insertionCount = rhs.m_insertionCount;
+		rhs.m_slotsUsedInLastPage = ValuesPerPage;
+		return *this;
+	}
+	~StableVector() noexcept { clear(); }
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		Slot* slot = AllocateSlot();
+		T* value = new (slot->Storage) T(std::forward<Args>(args)...);
+
+		slot->DenseIndex = static_cast<std::uint32_t>(m_values.size());
+		m_values.push_back(value);
+		++m_insertionCount;
+		return *value;
+	}
+
+	// O(1): destroys the value and fills its position in the dense list with the last value
+	void erase(const T* value) noexcept
+	{
+		TINY_CORE_ASSERT(value != nullptr, "Cannot erase nullptr");
+
+		Slot* slot = SlotOf(value);
+		const std::uint32_t denseIndex = slot->DenseIndex;
+		TINY_CORE_ASSERT(denseIndex < m_values.size() && m_values[denseIndex] == value, "Value does not belong to this StableVector");
+
+		T* last = m_values.back();
+		m_values[denseIndex] = last;
+		SlotOf(last)->DenseIndex = denseIndex;
+		m_values.pop_back();
+
+		slot->DenseIndex = UINT32_MAX;
+		const_cast<T*>(value)->~T();
+		m_freeSlots.push_back(slot);
+	}
+	void clear() noexcept
+	{
+		for (T* value : m_values)
+			value->~T();
+
+		m_values.clear();
+		m_freeSlots.clear();
+		m_pages.clear();
+		m_slotsUsedInLastPage = ValuesPerPage;
+	}
+
+	// Only the bookkeeping is reserved - pages are still allocated as they are needed
+	void reserve(size_t count)
+	{
+		m_values.reserve(count);
+		m_pages.reserve((count + ValuesPerPage - 1) / ValuesPerPage);
+	}
+
+	ND inline size_t size() const noexcept { return m_values.size(); }
+	ND inline bool empty() const noexcept { return m_values.empty(); }
+	ND inline size_t PageCount() const noexcept { return m_pages.size(); }
+
+	// Total number of values ever added. Unlike size(), this tells whether anything was added since it was last read,
+	// even if the same number of values has been erased in the meantime
+	ND inline std::uint64_t InsertionCount() const noexcept { return m_insertionCount; }
+
+	ND inline T& operator[](size_t index) noexcept { return *m_values[index]; }
+	ND inline const T& operator[](size_t index) const noexcept { return *m_values[index]; }
+	ND inline T& back() noexcept { return *m_values.back(); }
+
+	ND inline iterator begin() noexcept { return iterator(m_values.data()); }
+	ND inline iterator end() noexcept { return iterator(m_values.data() + m_values.size()); }
+	ND inline const_iterator begin() const noexcept { return const_iterator(m_values.data()); }
+	ND inline const_iterator end() const noexcept { return const_iterator(m_values.data() + m_values.size()); }
+
+private:
+	StableVector(const StableVector&) = delete;
+	StableVector& operator=(const StableVector&) = delete;
+
+	ND Slot* AllocateSlot()
+	{
+		if (m_freeSlots.size() > 0)
+		{
+			Slot* slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			return slot;
+		}
+
+		if (m_slotsUsedInLastPage == ValuesPerPage) UNLIKELY
+		{
+			m_pages.push_back(std::make_unique<Page>());
+			m_slotsUsedInLastPage = 0;
+		}
+		return &(*m_pages.back())[m_slotsUsedInLastPage++];
+	}
+
+	std::vector<std::unique_ptr<Page>> m_pages;
+	std::vector<T*> m_values;		// Dense list of live values (this is what gets iterated/indexed)
+	std::vector<Slot*> m_freeSlots;	// Slots of erased values, reused before taking new slots from the last page
+	size_t m_slotsUsedInLastPage = ValuesPerPage;
+	std::uint64_t m_insertionCount = 0;
+};
+
+} // namespace utility
+} // namespace tiny